@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+// ciclos de uma repetição: o contador só vale enquanto não deu uma volta inteira
+static uint32_t elapsed_cycles(const bench_clock_t *clock, uint32_t start, uint32_t end, uint32_t us)
+{
+    uint32_t wrap = clock->wrap();
+    uint32_t cycles = wrap ? (end + wrap - start) % wrap : end - start;
+
+    // UMA VOLTA DO CONTADOR EM MICROSSEGUNDOS, COM 1us DE MARGEM PELA RESOLUÇÃO DO RELÓGIO
+    uint64_t wrap_us = wrap ? (uint64_t)wrap * 1000000 / clock->cpu_hz : (uint64_t)UINT32_MAX * 1000000 / clock->cpu_hz;
+    if (us + 1 >= wrap_us)
+        return (uint64_t)us * clock->cpu_hz / 1000000;
+    return cycles;
+}
+
+static uint32_t cycles_to_ns(const bench_clock_t *clock, uint32_t cycles, uint16_t batch)
+{
+    return (uint64_t)cycles * 1000000000 / clock->cpu_hz / batch;
+}
+
+// ordena as amostras para a mediana (no máximo BENCH_MAX_REPETITIONS)
+static void sort_samples(uint32_t *samples, uint16_t count)
+{
+    for (uint16_t i = 1; i < count; i++)
+    {
+        uint32_t value = samples[i];
+        uint16_t j = i;
+        while (j > 0 && samples[j - 1] > value)
+        {
+            samples[j] = samples[j - 1];
+            j--;
+        }
+        samples[j] = value;
+    }
+}
+
+void bench_run(const bench_case_t *bench, const bench_clock_t *clock, uint16_t warmup, uint16_t repetitions,
+               bench_result_t *result)
+{
+    static uint32_t cycles[BENCH_MAX_REPETITIONS];
+    uint16_t batch = bench->batch ? bench->batch : 1;
+
+    repetitions = repetitions == 0 ? 1 : repetitions > BENCH_MAX_REPETITIONS ? BENCH_MAX_REPETITIONS : repetitions;
+
+    if (bench->setup)
+        bench->setup();
+
+    for (uint16_t w = 0; w < warmup; w++)
+    {
+        for (uint16_t b = 0; b < batch; b++)
+            bench->run();
+    }
+
+    for (uint16_t r = 0; r < repetitions; r++)
+    {
+        uint32_t start_us = clock->micros();
+        uint32_t start = clock->cycles();
+        for (uint16_t b = 0; b < batch; b++)
+            bench->run();
+        uint32_t end = clock->cycles();
+        uint32_t us = clock->micros() - start_us;
+
+        cycles[r] = elapsed_cycles(clock, start, end, us);
+    }
+
+    sort_samples(cycles, repetitions);
+
+    // VALORES POR CHAMADA; OS NANOSSEGUNDOS SAEM DOS CICLOS, MAIS FINOS QUE O RELÓGIO DE 1us
+    *result = (bench_result_t){
+        .name = bench->name,
+        .batch = batch,
+        .repetitions = repetitions,
+        .min_cycles = cycles[0] / batch,
+        .median_cycles = cycles[repetitions / 2] / batch,
+        .max_cycles = cycles[repetitions - 1] / batch,
+        .min_ns = cycles_to_ns(clock, cycles[0], batch),
+        .median_ns = cycles_to_ns(clock, cycles[repetitions / 2], batch),
+        .max_ns = cycles_to_ns(clock, cycles[repetitions - 1], batch)};
+}
+
+void bench_print_header(const bench_clock_t *clock, uint16_t warmup, uint16_t repetitions)
+{
+    printf("# semafaro-bench plataforma=%s cpu_hz=%lu aquecimento=%u repeticoes=%u\n", clock->platform,
+           (unsigned long)clock->cpu_hz, warmup, repetitions);
+    printf("caso,lote,repeticoes,min_ciclos,mediana_ciclos,max_ciclos,min_ns,mediana_ns,max_ns\n");
+}
+
+void bench_print(const bench_result_t *result)
+{
+    printf("%s,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu\n", result->name, result->batch, result->repetitions,
+           (unsigned long)result->min_cycles, (unsigned long)result->median_cycles,
+           (unsigned long)result->max_cycles, (unsigned long)result->min_ns, (unsigned long)result->median_ns,
+           (unsigned long)result->max_ns);
+}
+
+uint8_t bench_run_all(const bench_clock_t *clock, const char *filter, uint16_t warmup, uint16_t repetitions)
+{
+    uint8_t ran = 0;
+    size_t filter_len = filter ? strlen(filter) : 0;
+
+    bench_print_header(clock, warmup, repetitions);
+    for (uint8_t i = 0; i < bench_case_count; i++)
+    {
+        if (filter_len && strncmp(bench_cases[i].name, filter, filter_len) != 0)
+            continue;
+
+        bench_result_t result;
+        bench_run(&bench_cases[i], clock, warmup, repetitions, &result);
+        bench_print(&result);
+        ran++;
+    }
+    return ran;
+}
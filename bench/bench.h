@@ -0,0 +1,69 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    microbenchmarks dos caminhos quentes (sem dependência do SDK)
+
+    os casos ficam na tabela de bench/bench_cases.c e rodam pelo mesmo executor na placa
+    (bench/bench_rp2040.c, alvo semafaro-bench) e no computador (bench/bench_host.c). cada
+    caso é chamado algumas vezes para aquecer (cache da XIP, ramos) e depois repetições
+    vezes; cada repetição mede um lote de chamadas seguidas, para funções mais curtas que
+    a resolução do relógio. o resultado é o mínimo, a mediana e o máximo por chamada
+
+    cada plataforma fornece dois relógios: um contador de ciclos (o SysTick na placa) que
+    pode dar a volta em wrap e um relógio de microssegundos de 32 bits. quando a repetição
+    demora mais que uma volta do contador, os ciclos saem do relógio de microssegundos.
+    os nanossegundos do resultado são os ciclos convertidos por cpu_hz
+
+    a saída é CSV, com uma linha de comentário descrevendo a plataforma:
+    caso,lote,repeticoes,min_ciclos,mediana_ciclos,max_ciclos,min_ns,mediana_ns,max_ns
+*/
+
+#define BENCH_MAX_REPETITIONS 101
+#define BENCH_WARMUP 5
+#define BENCH_REPETITIONS 31
+
+typedef struct
+{
+    const char *name;
+    void (*setup)(void); // opcional: chamado uma vez antes do aquecimento
+    void (*run)(void);
+    uint16_t batch;      // chamadas de run por repetição
+} bench_case_t;
+
+typedef struct
+{
+    const char *platform;
+    uint32_t (*cycles)(void); // contador crescente de ciclos
+    uint32_t (*wrap)(void);   // módulo do contador de ciclos (0 = 2^32)
+    uint32_t (*micros)(void);
+    uint32_t cpu_hz;          // ciclos por segundo
+} bench_clock_t;
+
+typedef struct
+{
+    const char *name;
+    uint16_t batch, repetitions;
+    uint32_t min_cycles, median_cycles, max_cycles; // por chamada
+    uint32_t min_ns, median_ns, max_ns;
+} bench_result_t;
+
+extern const bench_case_t bench_cases[];
+extern const uint8_t bench_case_count;
+
+// roda um caso: warmup lotes descartados e repetitions (até BENCH_MAX_REPETITIONS) lotes medidos
+void bench_run(const bench_case_t *bench, const bench_clock_t *clock, uint16_t warmup, uint16_t repetitions,
+               bench_result_t *result);
+
+// escreve o cabeçalho do CSV com a linha de comentário da plataforma
+void bench_print_header(const bench_clock_t *clock, uint16_t warmup, uint16_t repetitions);
+
+void bench_print(const bench_result_t *result);
+
+// roda os casos cujo nome começa com filter (NULL ou "" = todos) e imprime o CSV; retorna quantos rodaram
+uint8_t bench_run_all(const bench_clock_t *clock, const char *filter, uint16_t warmup, uint16_t repetitions);
+
+#endif
@@ -0,0 +1,152 @@
+#include "bench_cases.h"
+#include "leds.h"
+#include "matrix_anim.h"
+
+#if BENCH_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
+
+bench_fixture_t bench_fixture;
+
+// resultados guardados aqui para o compilador não descartar as chamadas
+static volatile uint32_t sink;
+static uint32_t step;
+
+static void bench_ssd1306_fill(void)
+{
+    ssd1306_fill(bench_fixture.ssd, step++ & 1);
+}
+
+static void bench_ssd1306_draw_string(void)
+{
+    ssd1306_draw_string(bench_fixture.ssd, "PODE SEGUIR!", 0, (step++ & 7) * 8);
+}
+
+static void bench_ssd1306_rotated_rect_angle(void)
+{
+    ssd1306_rotated_rect_angle(bench_fixture.ssd, 64, 32, 40, 20, step++ % 360, true);
+}
+
+// quadro inteiro pelo I2C a 400kHz: na placa o tempo é quase todo do barramento
+static void bench_ssd1306_send_data(void)
+{
+    bench_fixture.ssd->ram_buffer[1 + step++ % (bench_fixture.ssd->bufsize - 1)] ^= 1;
+    ssd1306_send_data(bench_fixture.ssd);
+}
+
+static void bench_matrix_rgb(void)
+{
+    step++;
+    sink += matrix_rgb(step & 0xFF, step >> 3 & 0xFF, step >> 6 & 0xFF, 0.25f);
+}
+
+static frame bench_frame;
+
+static void bench_draw_pio_setup(void)
+{
+    for (int16_t i = 0; i < PIXELS; i++)
+        bench_frame[i] = (pixel){.red = 255, .green = i * 10, .blue = 0, .intensity = 0.1f};
+}
+
+// 25 palavras pela FIFO da PIO: limitado pelos ~30us por LED do WS2812B
+static void bench_draw_pio(void)
+{
+    draw_pio(bench_frame, bench_fixture.pio, bench_fixture.sm);
+}
+
+static void bench_draw_traffic_light(void)
+{
+    static const color_options colors[] = {GREEN, YELLOW, RED};
+    draw_traffic_light(bench_fixture.pio, bench_fixture.sm, colors[step++ % 3], false);
+}
+
+// um quadro da animação da matriz como em matrix_render, ANIM_FRAME_MS depois do anterior
+static matrix_anim_t bench_anim;
+
+static void bench_matrix_anim_setup(void)
+{
+    step = 0;
+    matrix_anim_init(&bench_anim, traffic_levels_red.levels, 0);
+}
+
+static void bench_matrix_anim_frame(const dither_level_t *target, bool bar)
+{
+    static const dither_level_t bar_color = {0x0400, 0, 0};
+    uint32_t now = step++ * ANIM_FRAME_MS;
+
+    matrix_anim_set_target(&bench_anim, target, now);
+    matrix_anim_render(&bench_anim, now);
+    if (bar)
+        matrix_anim_bar(&bench_anim, traffic_bar_pixels, TRAFFIC_BAR_LENGTH, (uint16_t)(step * 997), bar_color);
+    sink += bench_anim.out[step % DITHER_PIXELS].green;
+}
+
+// fase nova a cada 10 quadros (200ms, menos que ANIM_FADE_MS): todo quadro está no meio de uma transição
+static void bench_matrix_anim_fade(void)
+{
+    static const traffic_levels_t *const phases[] = {&traffic_levels_green, &traffic_levels_yellow,
+                                                     &traffic_levels_red};
+    bench_matrix_anim_frame(phases[step / 10 % 3]->levels, true);
+}
+
+// depois da primeira transição o quadro só recebe a barra
+static void bench_matrix_anim_static(void)
+{
+    bench_matrix_anim_frame(traffic_levels_green.levels, true);
+}
+
+// pisca do modo noturno: uma borda a cada 25 quadros (500ms), sem barra
+static void bench_matrix_anim_night(void)
+{
+    bench_matrix_anim_frame(step / 25 & 1 ? traffic_levels_off.levels : traffic_levels_night.levels, false);
+}
+
+#if BENCH_FREERTOS
+static TaskHandle_t bench_task, echo_task;
+
+// devolve cada notificação para a task da suíte
+static void vBenchEchoTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xTaskNotifyGive(bench_task);
+    }
+}
+
+static void bench_task_notify_setup(void)
+{
+    bench_task = xTaskGetCurrentTaskHandle();
+    // PRIORIDADE MAIOR: A NOTIFICAÇÃO TROCA DE CONTEXTO NA HORA, NOS DOIS SENTIDOS
+    if (!echo_task)
+        xTaskCreate(vBenchEchoTask, "Bench eco", configMINIMAL_STACK_SIZE, NULL, uxTaskPriorityGet(NULL) + 1,
+                    &echo_task);
+}
+
+static void bench_task_notify(void)
+{
+    xTaskNotifyGive(echo_task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+#endif
+
+const bench_case_t bench_cases[] = {
+    {.name = "ssd1306_fill", .run = bench_ssd1306_fill, .batch = 16},
+    {.name = "ssd1306_draw_string", .run = bench_ssd1306_draw_string, .batch = 16},
+    {.name = "ssd1306_rotated_rect_angle", .run = bench_ssd1306_rotated_rect_angle, .batch = 8},
+    {.name = "ssd1306_send_data", .run = bench_ssd1306_send_data, .batch = 1},
+    {.name = "matrix_rgb", .run = bench_matrix_rgb, .batch = 256},
+    {.name = "draw_pio", .setup = bench_draw_pio_setup, .run = bench_draw_pio, .batch = 1},
+    {.name = "draw_traffic_light", .run = bench_draw_traffic_light, .batch = 1},
+    {.name = "matrix_anim_fade", .setup = bench_matrix_anim_setup, .run = bench_matrix_anim_fade, .batch = 1},
+    {.name = "matrix_anim_static", .setup = bench_matrix_anim_setup, .run = bench_matrix_anim_static, .batch = 1},
+    {.name = "matrix_anim_night", .setup = bench_matrix_anim_setup, .run = bench_matrix_anim_night, .batch = 1},
+#if BENCH_FREERTOS
+    {.name = "task_notify_round_trip", .setup = bench_task_notify_setup, .run = bench_task_notify, .batch = 64},
+#endif
+};
+
+const uint8_t bench_case_count = count_of(bench_cases);
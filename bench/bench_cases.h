@@ -0,0 +1,27 @@
+#ifndef BENCH_CASES_H
+#define BENCH_CASES_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "ssd1306.h"
+#include "bench.h"
+
+/*
+    periféricos usados pelos casos de bench/bench_cases.c, preparados por quem roda a
+    suíte: na placa o display de verdade no I2C e a matriz na PIO; no computador os
+    mesmos tipos vêm dos cabeçalhos de bench/host, que só descartam os bytes
+
+    com BENCH_FREERTOS a tabela inclui a ida e volta de notificação entre duas tasks,
+    que só existe com o escalonador rodando (a suíte roda dentro de uma task)
+*/
+
+typedef struct
+{
+    ssd1306_t *ssd;
+    PIO pio;
+    uint sm;
+} bench_fixture_t;
+
+extern bench_fixture_t bench_fixture;
+
+#endif
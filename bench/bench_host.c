@@ -0,0 +1,95 @@
+/*
+    a suíte de bench/bench_cases.c rodando no computador
+
+    compila as mesmas bibliotecas do firmware com os cabeçalhos mínimos de bench/host no
+    lugar do SDK: o I2C e a PIO só recebem os bytes, então ssd1306_send_data, draw_pio e
+    draw_traffic_light medem a parte da CPU. sem contador de ciclos portátil, os ciclos
+    são nanossegundos do CLOCK_MONOTONIC (cpu_hz=1000000000 no cabeçalho do CSV)
+
+    tools/font_compiler.py -o build assets/font.txt
+    cc -std=gnu11 -O2 -Ibench/host -Ibench -Ilib -o bench_host bench/bench_host.c bench/bench.c \
+       bench/bench_cases.c lib/ssd1306.c lib/blit.c build/font.c lib/leds.c lib/matrix_anim.c \
+       -x c++ lib/traffic_frames.cpp -x none -lm -lstdc++
+    ./bench_host [caso] [repeticoes] > resultado.csv
+*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bench_cases.h"
+
+static volatile uint32_t sink;
+
+void sleep_ms(uint32_t ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)nostop;
+
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++)
+        sum += src[i];
+    sink += sum;
+    return len;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    (void)pio;
+    (void)sm;
+
+    sink += data;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t host_cycles(void)
+{
+    return now_ns();
+}
+
+static uint32_t host_wrap(void)
+{
+    return 0;
+}
+
+static uint32_t host_micros(void)
+{
+    return now_ns() / 1000;
+}
+
+int main(int argc, char **argv)
+{
+    static ssd1306_t ssd;
+    const bench_clock_t bench_clock = {
+        .platform = "host",
+        .cycles = host_cycles,
+        .wrap = host_wrap,
+        .micros = host_micros,
+        .cpu_hz = 1000000000};
+
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+    bench_fixture = (bench_fixture_t){.ssd = &ssd, .pio = NULL, .sm = 0};
+
+    const char *filter = argc >= 2 ? argv[1] : NULL;
+    uint16_t repetitions = argc >= 3 ? atoi(argv[2]) : BENCH_REPETITIONS;
+
+    if (bench_run_all(&bench_clock, filter, BENCH_WARMUP, repetitions) == 0)
+    {
+        fprintf(stderr, "nenhum caso comeca com '%s'\n", filter);
+        return 2;
+    }
+    return 0;
+}
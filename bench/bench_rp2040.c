@@ -0,0 +1,404 @@
+/*
+    semafaro-bench: a suíte de bench/bench_cases.c rodando na placa
+
+    usa os mesmos periféricos do firmware (display no I2C1, matriz na PIO0) e imprime o CSV
+    pela USB. os ciclos vêm do SysTick, que depois do escalonador é o tick do FreeRTOS:
+    conta de rvr até 0 a cada 1ms (125000 ciclos a 125MHz); repetições mais longas que
+    uma volta usam o timer de 1us
+
+    depois da primeira passada, uma linha com o começo do nome de um caso (ou vazia, para
+    todos) roda a suíte de novo; a linha "rta" roda as tasks do firmware por RTA_RUN_MS e
+    imprime o relatório de lib/sched_stats.c com a análise de tempo de resposta medida; a
+    linha "display" roda vários produtores no servidor do display (lib/display_server.c) e a
+    linha "painel" mede painéis de LED maiores com led_panel_benchmark (lib/led_panel.c)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/i2c.h"
+#include "hardware/pio.h"
+#include "hardware/structs/systick.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "power.h"
+#include "sched_stats.h"
+#include "control.h"
+#include "display_server.h"
+#include "supervisor.h"
+#include "leds.h"
+#include "led_panel.h"
+#include "pio_matrix.pio.h"
+#include "bench_cases.h"
+
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+#define DISPLAY_ADDRESS 0x3C
+#define USB_WAIT_MS 5000      // espera o terminal abrir a porta antes da primeira passada
+#define FILTER_LENGTH 32
+#define RTA_RUN_MS 10000      // duração da execução medida pelo comando "rta"
+#define DISPLAY_RUN_MS 5000   // duração de cada modo do comando "display"
+#define PANEL_PIN_BASE 16     // primeira fita do comando "painel" (as outras nos GPIOs seguintes)
+#define PANEL_MAX_W 64
+#define PANEL_MAX_H 64
+#define PANEL_FRAMES 10       // quadros medidos por configuração do comando "painel"
+#define DISPLAY_STRIP_W 40    // colunas da faixa de cada produtor
+
+static ssd1306_t ssd;
+
+// o SysTick conta para baixo: rvr - cvr é o contador crescente, com módulo rvr + 1
+static uint32_t systick_cycles(void)
+{
+    return systick_hw->rvr - systick_hw->cvr;
+}
+
+static uint32_t systick_wrap(void)
+{
+    return systick_hw->rvr + 1;
+}
+
+static bench_clock_t bench_clock = {
+    .platform = "rp2040",
+    .cycles = systick_cycles,
+    .wrap = systick_wrap,
+    .micros = time_us_32,
+};
+
+/*
+    execução para a análise de tempo de resposta
+
+    tasks com o período e a prioridade das tasks do firmware (todas acima da task da
+    suíte) rodam os mesmos caminhos: o controlador avança um cruzamento por lib/control.c,
+    a matriz desenha o semáforo na PIO segurando o mutex da PIO e o display envia o
+    quadro inteiro pelo I2C. como no firmware, só a matriz pega o mutex
+*/
+typedef struct
+{
+    const char *name;
+    uint32_t period_ms;
+    UBaseType_t priority;
+    void (*job)(uint8_t sched_id);
+    uint8_t sched_id;
+} rta_task_t;
+
+static SemaphoreHandle_t rta_pio_mutex;
+static volatile bool rta_running;
+static intersections_t rta_intersections;
+static control_t rta_control = {.ctl = &rta_intersections};
+
+static void rta_controller(uint8_t sched_id)
+{
+    static const control_inputs_t inputs = {0};
+    (void)sched_id;
+    control_step(&rta_control, &inputs, pdTICKS_TO_MS(xTaskGetTickCount()));
+}
+
+static void rta_matrix(uint8_t sched_id)
+{
+    static const color_options colors[] = {GREEN, YELLOW, RED};
+    static uint32_t frame;
+
+    sched_stats_lock(sched_id, rta_pio_mutex);
+    draw_traffic_light(bench_fixture.pio, bench_fixture.sm, colors[frame++ / 50 % 3], false);
+    sched_stats_unlock(sched_id, rta_pio_mutex);
+}
+
+static void rta_display(uint8_t sched_id)
+{
+    (void)sched_id;
+    ssd1306_send_data(&ssd);
+}
+
+// os mesmos períodos e prioridades de semafaro-inteligente-raspberry-pico-w.c
+static rta_task_t rta_tasks[] = {
+    {.name = "controlador", .period_ms = 50, .priority = tskIDLE_PRIORITY + 7, .job = rta_controller},
+    {.name = "matriz", .period_ms = 20, .priority = tskIDLE_PRIORITY + 4, .job = rta_matrix},
+    {.name = "display", .period_ms = 100, .priority = tskIDLE_PRIORITY + 3, .job = rta_display},
+};
+
+static void vRtaTask(void *pvParameters)
+{
+    const rta_task_t *task = pvParameters;
+    TickType_t wake = xTaskGetTickCount();
+
+    while (rta_running)
+    {
+        sched_stats_job_begin(task->sched_id);
+        task->job(task->sched_id);
+        sched_stats_job_end(task->sched_id);
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(task->period_ms));
+    }
+    vTaskDelete(NULL);
+}
+
+static void rta_run(void)
+{
+    static char report[1024];
+
+    // AS TASKS SÃO REGISTRADAS UMA VEZ: AS EXECUÇÕES SEGUINTES ACUMULAM NOS MESMOS MÁXIMOS
+    if (!rta_pio_mutex)
+    {
+        rta_pio_mutex = xSemaphoreCreateMutex();
+        intersections_init(&rta_intersections, pdTICKS_TO_MS(xTaskGetTickCount()));
+        intersections_add(&rta_intersections, 0);
+        for (uint i = 0; i < count_of(rta_tasks); i++)
+            rta_tasks[i].sched_id = sched_stats_register(rta_tasks[i].name, rta_tasks[i].period_ms,
+                                                         rta_tasks[i].priority);
+    }
+
+    printf("# rta: %u tasks por %u ms\n", (unsigned)count_of(rta_tasks), RTA_RUN_MS);
+    rta_running = true;
+    for (uint i = 0; i < count_of(rta_tasks); i++)
+        xTaskCreate(vRtaTask, rta_tasks[i].name, configMINIMAL_STACK_SIZE, &rta_tasks[i], rta_tasks[i].priority, NULL);
+
+    vTaskDelay(pdMS_TO_TICKS(RTA_RUN_MS));
+    rta_running = false;
+
+    // O MAIOR PERÍODO PARA TODAS TERMINAREM O ÚLTIMO JOB
+    vTaskDelay(pdMS_TO_TICKS(100));
+    sched_stats_report(report, sizeof(report));
+    printf("%s", report);
+}
+
+/*
+    servidor do display com vários produtores
+
+    cada produtor redesenha a sua faixa de colunas (fundo, contador e borda) e pede o envio
+    só dela, no seu período. no modo "quadro" cada redesenho fica entre display_begin e
+    display_end; no modo "solto" os comandos vão um a um, como antes, e os de outras tasks
+    podem entrar no meio. mede os comandos e quadros por segundo, a latência do flush ao
+    fim do envio e a maior espera de um produtor pelo quadro aberto por outro
+*/
+typedef struct
+{
+    const char *name;
+    uint32_t period_ms;
+    UBaseType_t priority;
+    uint8_t x;
+    uint32_t wait_max_us; // maior espera em display_begin (modo "quadro")
+} display_producer_t;
+
+static display_producer_t display_producers[] = {
+    {.name = "produtor 20ms", .period_ms = 20, .priority = tskIDLE_PRIORITY + 4, .x = 0},
+    {.name = "produtor 30ms", .period_ms = 30, .priority = tskIDLE_PRIORITY + 3, .x = DISPLAY_STRIP_W},
+    {.name = "produtor 50ms", .period_ms = 50, .priority = tskIDLE_PRIORITY + 3, .x = 2 * DISPLAY_STRIP_W},
+};
+
+static volatile bool display_running;
+static volatile bool display_batched;
+
+static void vDisplayProducer(void *pvParameters)
+{
+    display_producer_t *producer = pvParameters;
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t count = 0;
+    char text[DISPLAY_TEXT_MAX + 1];
+
+    while (display_running)
+    {
+        if (display_batched)
+        {
+            uint32_t start = time_us_32();
+            display_begin();
+            uint32_t waited = time_us_32() - start;
+            if (waited > producer->wait_max_us)
+                producer->wait_max_us = waited;
+        }
+
+        snprintf(text, sizeof(text), "%lu", (unsigned long)count++);
+        display_rect(producer->x, 16, DISPLAY_STRIP_W, 24, false, true);
+        display_text(text, producer->x + 2, 24);
+        display_rect(producer->x, 16, DISPLAY_STRIP_W, 24, true, false);
+        display_flush_region(producer->x, DISPLAY_STRIP_W);
+
+        if (display_batched)
+            display_end();
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(producer->period_ms));
+    }
+    vTaskDelete(NULL);
+}
+
+static void display_run_mode(bool batched)
+{
+    display_batched = batched;
+    for (uint i = 0; i < count_of(display_producers); i++)
+        display_producers[i].wait_max_us = 0;
+
+    display_stats_t before = display_stats;
+    display_stats.max_latency_us = 0;
+
+    display_running = true;
+    for (uint i = 0; i < count_of(display_producers); i++)
+        xTaskCreate(vDisplayProducer, display_producers[i].name, 512, &display_producers[i],
+                    display_producers[i].priority, NULL);
+    vTaskDelay(pdMS_TO_TICKS(DISPLAY_RUN_MS));
+    display_running = false;
+
+    // O MAIOR PERÍODO PARA OS PRODUTORES TERMINAREM E O SERVIDOR ESVAZIAR A FILA
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    uint32_t commands = display_stats.commands - before.commands;
+    uint32_t frames = display_stats.frames - before.frames;
+    uint32_t latency_us = display_stats.sum_latency_us - before.sum_latency_us;
+    uint32_t wait_max_us = 0;
+    for (uint i = 0; i < count_of(display_producers); i++)
+        wait_max_us = display_producers[i].wait_max_us > wait_max_us ? display_producers[i].wait_max_us : wait_max_us;
+
+    printf("%s,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n", batched ? "quadro" : "solto", (unsigned)count_of(display_producers),
+           (unsigned long)(commands * 1000ull / DISPLAY_RUN_MS), (unsigned long)(frames * 1000ull / DISPLAY_RUN_MS),
+           (unsigned long)(display_stats.producer_frames - before.producer_frames),
+           (unsigned long)(frames ? latency_us / frames : 0), (unsigned long)display_stats.max_latency_us,
+           (unsigned long)wait_max_us, (unsigned long)(display_stats.errors - before.errors));
+}
+
+static void display_run(void)
+{
+    static bool started;
+
+    // O SERVIDOR FICA NO MESMO I2C DO DISPLAY DA SUÍTE; DEPOIS DA EXECUÇÃO ELE SÓ ESPERA COMANDOS
+    if (!started)
+    {
+        display_server_init(I2C_PORT, I2C_SDA, I2C_SCL, DISPLAY_ADDRESS);
+        xTaskCreate(vDisplayServerTask, "Servidor do display", configMINIMAL_STACK_SIZE,
+                    (void *)(uintptr_t)SUPERVISOR_NONE, tskIDLE_PRIORITY + 3, NULL);
+        started = true;
+        display_clear();
+        display_flush();
+        vTaskDelay(pdMS_TO_TICKS(200));
+    }
+
+    printf("# display: %u produtores por %u ms em cada modo\n", (unsigned)count_of(display_producers), DISPLAY_RUN_MS);
+    printf("modo,produtores,comandos_s,quadros_s,quadros_produtor,latencia_media_us,latencia_max_us,espera_max_us,"
+           "erros\n");
+    display_run_mode(false);
+    display_run_mode(true);
+}
+
+/*
+    painéis de LED maiores (lib/led_panel.c)
+
+    cada configuração é iniciada na PIO1, medida por PANEL_FRAMES quadros com
+    led_panel_benchmark e devolvida com led_panel_deinit. o envio é medido até a state
+    machine parar sem dados, então bit_ns é o tempo de bit do divisor de clock de verdade
+    (1250 ns esperados). os pinos ficam como entrada: a PIO roda igual sem acionar nada
+    nos GPIOs PANEL_PIN_BASE em diante, que podem não estar livres na placa
+*/
+typedef struct
+{
+    uint16_t width;
+    uint16_t height;
+    uint8_t strings;
+} panel_config_t;
+
+static const panel_config_t panel_configs[] = {
+    {.width = 16, .height = 16, .strings = 1}, {.width = 16, .height = 16, .strings = 8},
+    {.width = 32, .height = 32, .strings = 1}, {.width = 32, .height = 32, .strings = 8},
+    {.width = 64, .height = 64, .strings = 1}, {.width = 64, .height = 64, .strings = 8},
+};
+
+static void panel_run(void)
+{
+    static uint8_t framebuffer[LED_PANEL_FRAMEBUFFER_BYTES(PANEL_MAX_W, PANEL_MAX_H)];
+    static uint32_t dma_buffer[LED_PANEL_DMA_WORDS(PANEL_MAX_W, PANEL_MAX_H, 1)];
+    static led_panel_t panel;
+
+    printf("# painel: %u quadros por configuracao na PIO1\n", PANEL_FRAMES);
+    printf("leds,fitas,codificacao_us,envio_us,bit_ns,quadro_us,hz\n");
+
+    for (uint i = 0; i < count_of(panel_configs); i++)
+    {
+        const panel_config_t *config = &panel_configs[i];
+        led_panel_init(&panel, pio1, PANEL_PIN_BASE, config->strings, config->width, config->height, false,
+                       framebuffer, dma_buffer);
+        pio_sm_set_consecutive_pindirs(pio1, panel.sm, PANEL_PIN_BASE, config->strings, false);
+
+        // PIOR CASO DA CODIFICAÇÃO: TODOS OS LEDS ACESOS COM BITS DIFERENTES POR CANAL
+        led_panel_fill(&panel, 0x55, 0xAA, 0x0F);
+
+        led_panel_bench_t result, worst = {0};
+        for (uint f = 0; f < PANEL_FRAMES; f++)
+        {
+            led_panel_benchmark(&panel, &result);
+            if (result.frame_us > worst.frame_us)
+                worst = result;
+        }
+        led_panel_deinit(&panel);
+
+        printf("%lu,%u,%lu,%lu,%lu,%lu,%lu\n", (unsigned long)worst.leds, config->strings,
+               (unsigned long)worst.encode_us, (unsigned long)worst.send_us, (unsigned long)worst.bit_ns,
+               (unsigned long)worst.frame_us, (unsigned long)worst.refresh_hz);
+    }
+}
+
+static void vBenchTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    char filter[FILTER_LENGTH] = "";
+    uint8_t length = 0;
+
+    while (1)
+    {
+        if (strcmp(filter, "rta") == 0)
+            rta_run();
+        else if (strcmp(filter, "display") == 0)
+            display_run();
+        else if (strcmp(filter, "painel") == 0)
+            panel_run();
+        else if (bench_run_all(&bench_clock, filter, BENCH_WARMUP, BENCH_REPETITIONS) == 0)
+            printf("# nenhum caso comeca com '%s'\n", filter);
+        printf("# fim\n");
+
+        // ESPERA A PRÓXIMA LINHA SEM OCUPAR A CPU
+        length = 0;
+        while (1)
+        {
+            int c = getchar_timeout_us(0);
+            if (c == PICO_ERROR_TIMEOUT)
+            {
+                vTaskDelay(pdMS_TO_TICKS(20));
+                continue;
+            }
+            if (c == '\r' || c == '\n')
+                break;
+            if (length < FILTER_LENGTH - 1)
+                filter[length++] = c;
+        }
+        filter[length] = '\0';
+    }
+}
+
+int main()
+{
+    stdio_init_all();
+    for (uint32_t waited = 0; !stdio_usb_connected() && waited < USB_WAIT_MS; waited += 10)
+        sleep_ms(10);
+
+    bench_clock.cpu_hz = clock_get_hz(clk_sys);
+
+    // display com a mesma configuração do servidor do display
+    i2c_init(I2C_PORT, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, DISPLAY_ADDRESS, I2C_PORT);
+    ssd1306_config(&ssd);
+
+    // matriz de LEDs como em PIO_setup
+    PIO pio = pio0;
+    uint offset = pio_add_program(pio, &pio_matrix_program);
+    uint sm = pio_claim_unused_sm(pio, true);
+    pio_matrix_program_init(pio, sm, offset, LED_PIN);
+
+    bench_fixture = (bench_fixture_t){.ssd = &ssd, .pio = pio, .sm = sm};
+
+    // O IDLE SEM TICK DO FIRMWARE (lib/power.c) PRECISA DO ALARME RESERVADO
+    power_init();
+
+    xTaskCreate(vBenchTask, "Bench", 1024, NULL, tskIDLE_PRIORITY + 2, NULL);
+    vTaskStartScheduler();
+    panic_unsupported();
+}
@@ -0,0 +1,19 @@
+#ifndef BENCH_HOST_FREERTOS_H
+#define BENCH_HOST_FREERTOS_H
+
+// o pouco do FreeRTOS que as bibliotecas testadas no computador usam; as funções são do programa
+// de teste (tools/phase_log_host.c), com um tick de 1 ms como lib/FreeRTOSConfig.h
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ ((TickType_t)1000)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks) ((TickType_t)(ticks))
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef BENCH_HOST_HARDWARE_FLASH_H
+#define BENCH_HOST_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+// a flash no computador é do programa de teste (tools/phase_log_host.c): a imagem inteira fica em
+// flash_host_image, lida pelo "XIP" como na placa, e ele guarda a região gravada em um arquivo
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+extern uint8_t flash_host_image[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)flash_host_image)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef BENCH_HOST_HARDWARE_I2C_H
+#define BENCH_HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// no computador o I2C só percorre os bytes (bench/bench_host.c): mede a CPU, não o barramento;
+// tools/ssd1306_host.c implementa um barramento falso que conta transações, START e STOP
+typedef struct bench_i2c i2c_inst_t;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#endif
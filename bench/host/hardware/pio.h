@@ -0,0 +1,15 @@
+#ifndef BENCH_HOST_HARDWARE_PIO_H
+#define BENCH_HOST_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+// no computador a FIFO da PIO nunca enche (bench/bench_host.c); a DMA só usa o endereço do FIFO (tools/dither_host.c)
+typedef struct bench_pio
+{
+    volatile uint32_t txf[4];
+} *PIO;
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef BENCH_HOST_HARDWARE_SYNC_H
+#define BENCH_HOST_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+// um único fluxo de execução no computador: travas e interrupções não fazem nada
+typedef volatile uint32_t spin_lock_t;
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+static inline int spin_lock_claim_unused(bool required)
+{
+    (void)required;
+    return 0;
+}
+
+static inline spin_lock_t *spin_lock_instance(uint lock_num)
+{
+    static spin_lock_t locks[32];
+    return &locks[lock_num];
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock)
+{
+    (void)lock;
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved_irq)
+{
+    (void)lock;
+    (void)saved_irq;
+}
+
+#endif
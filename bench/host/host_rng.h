@@ -0,0 +1,35 @@
+#ifndef BENCH_HOST_HOST_RNG_H
+#define BENCH_HOST_HOST_RNG_H
+
+#include <stdint.h>
+
+/*
+    números pseudoaleatórios das ferramentas do computador (os tools/..._host.c)
+
+    xorshift32: a mesma semente repete a mesma sequência, então um caso que falhou pode ser
+    repetido passando a semente na linha de comando. cada programa inclui em um único arquivo
+*/
+
+static uint32_t rng_state = 1;
+
+// a semente 0 prenderia o xorshift em 0
+static inline void rng_seed(uint32_t seed)
+{
+    rng_state = seed ? seed : 1;
+}
+
+static inline uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// inteiro aleatório em [low, high]
+static inline int rng_range(int low, int high)
+{
+    return low + (int)(rng() % (uint32_t)(high - low + 1));
+}
+
+#endif
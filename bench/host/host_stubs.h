@@ -0,0 +1,30 @@
+#ifndef BENCH_HOST_HOST_STUBS_H
+#define BENCH_HOST_HOST_STUBS_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+/*
+    I2C e espera que não fazem nada, para as ferramentas que só conferem o framebuffer
+    (tools/asset_host.c, tools/font_host.c): ssd1306_init e o envio da tela ligam nelas
+
+    são definições, não só declarações: cada programa inclui em um único arquivo. quem
+    mede o barramento ou o tempo tem as suas (bench/bench_host.c percorre os bytes,
+    tools/boot_host.c e tools/ssd1306_host.c simulam o barramento)
+*/
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return len;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    (void)ms;
+}
+
+#endif
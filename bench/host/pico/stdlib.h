@@ -0,0 +1,36 @@
+#ifndef BENCH_HOST_PICO_STDLIB_H
+#define BENCH_HOST_PICO_STDLIB_H
+
+// o pouco do pico/stdlib.h que as bibliotecas medidas usam, para compilar a suíte no computador
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define PICO_ERROR_GENERIC (-2) // i2c_write_blocking com NAK (pico/error.h)
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(name) name // no computador todo o código fica na RAM
+
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+
+// o timer repetitivo no computador é do programa de teste, que chama o callback quando quiser
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer
+{
+    int64_t delay_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef BENCH_HOST_TASK_H
+#define BENCH_HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+TickType_t xTaskGetTickCount(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+BaseType_t xTaskCatchUpTicks(TickType_t ticks);
+
+#endif
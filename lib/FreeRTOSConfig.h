@@ -42,7 +42,13 @@
  
  /* Scheduler Related */
  #define configUSE_PREEMPTION                    1
- #define configUSE_TICKLESS_IDLE                 0
+ /* Idle sem tick implementado em lib/power.c: o núcleo dorme no timer do RP2040 até o próximo prazo */
+ #define configUSE_TICKLESS_IDLE                 2
+ #define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+ #ifndef __ASSEMBLER__
+ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
+ #endif
+ #define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vApplicationSleep( xExpectedIdleTime )
  #define configUSE_IDLE_HOOK                     0
  #define configUSE_TICK_HOOK                     0
  #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
@@ -80,7 +86,13 @@
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
- #define configGENERATE_RUN_TIME_STATS           0
+ /* O contador de run-time usa o timer de 1us do RP2040 (medição de WCET em sched_stats) */
+ #define configGENERATE_RUN_TIME_STATS           1
+ #ifndef __ASSEMBLER__
+ #include "hardware/timer.h"
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ #define portGET_RUN_TIME_COUNTER_VALUE()        time_us_32()
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
  
@@ -134,5 +146,10 @@
  #define INCLUDE_xQueueGetMutexHolder            1
  
  /* A header file that defines trace macro can be included here. */
+ /* Trocas de contexto contadas para o relatório de sched_stats (custo do motor de saídas) */
+ #ifndef __ASSEMBLER__
+ extern volatile uint32_t sched_context_switches;
+ #endif
+ #define traceTASK_SWITCHED_IN()                 sched_context_switches++
  
  #endif /* FREERTOS_CONFIG_H */
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "asset.h"
+
+const asset_sprite_frame_t *asset_sprite_frame(const asset_sprite_t *sprite, uint32_t elapsed_ms)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < sprite->frame_count; i++)
+        total += sprite->frames[i].duration_ms;
+
+    // imagem parada (duração 0): sempre o primeiro quadro
+    if (total == 0)
+        return &sprite->frames[0];
+
+    uint32_t position = elapsed_ms % total;
+    uint8_t i = 0;
+    while (i < sprite->frame_count - 1 && position >= sprite->frames[i].duration_ms)
+        position -= sprite->frames[i++].duration_ms;
+
+    return &sprite->frames[i];
+}
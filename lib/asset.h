@@ -0,0 +1,46 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <stdint.h>
+
+/*
+    imagens geradas em tempo de compilação por tools/asset_compiler.py a partir dos arquivos .txt de assets/
+
+    os dados são const e ficam na flash, já no formato usado pelo hardware: nada é montado
+    em tempo de execução. duration_ms é o tempo de exibição do quadro nas animações
+*/
+
+// quadro do display OLED no formato de ssd1306_bitmap (coluna a coluna, ceil(altura / 8) bytes por coluna)
+typedef struct
+{
+    const uint8_t *bitmap;
+    uint16_t duration_ms;
+} asset_sprite_frame_t;
+
+typedef struct
+{
+    uint8_t width;
+    uint8_t height;
+    uint8_t frame_count;
+    const asset_sprite_frame_t *frames;
+} asset_sprite_t;
+
+// quadro da matriz WS2812: uma palavra GRB por pixel, pronta para a PIO
+typedef struct
+{
+    const uint32_t *pixels;
+    uint16_t duration_ms;
+} asset_matrix_frame_t;
+
+typedef struct
+{
+    uint8_t width;
+    uint8_t height;
+    uint8_t frame_count;
+    const asset_matrix_frame_t *frames;
+} asset_matrix_t;
+
+// quadro a exibir elapsed_ms depois do início da animação (a animação se repete)
+const asset_sprite_frame_t *asset_sprite_frame(const asset_sprite_t *sprite, uint32_t elapsed_ms);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stddef.h>
+#include "blit.h"
+
+// lê até count bytes (no máximo 4) da coluna a partir de byte; bytes além de pages valem 0
+static uint32_t column_load(const uint8_t *column, int pages, int byte, int count)
+{
+    uint32_t word = 0;
+    for (int i = 0; i < count && byte + i < pages; i++)
+        word |= (uint32_t)column[byte + i] << (8 * i);
+    return word;
+}
+
+// 32 linhas da coluna a partir de row, com a linha row no bit 0
+static uint32_t column_read(const uint8_t *column, int pages, int row)
+{
+    int byte = row >> 3;
+    int shift = row & 7;
+    uint32_t word = column_load(column, pages, byte, 4);
+
+    if (shift)
+        word = word >> shift | column_load(column, pages, byte + 4, 1) << (32 - shift);
+    return word;
+}
+
+/*
+    recorta um eixo: as duas posições passam para dentro das imagens e o tamanho diminui
+    junto. as contas são em 64 bits para coordenadas extremas não estourarem
+*/
+static bool clip_axis(int *dst_pos, int *src_pos, int *size, int dst_size, int src_size)
+{
+    int64_t d = *dst_pos, s = *src_pos, len = *size;
+
+    if (d < 0)
+    {
+        s -= d;
+        len += d;
+        d = 0;
+    }
+    if (s < 0)
+    {
+        d -= s;
+        len += s;
+        s = 0;
+    }
+    if (len > dst_size - d)
+        len = dst_size - d;
+    if (len > src_size - s)
+        len = src_size - s;
+    if (len <= 0)
+        return false;
+
+    *dst_pos = d;
+    *src_pos = s;
+    *size = len;
+    return true;
+}
+
+// copia o retângulo já recortado; sem src a origem é a palavra fill em todas as linhas
+static void blit_columns(const blit_surface_t *dst, int dx, int dy, const blit_source_t *src, int sx, int sy,
+                         int w, int h, uint32_t fill, blit_rop_t rop)
+{
+    for (int i = 0; i < w; i++)
+    {
+        uint8_t *out = &dst->bits[(dx + i) * dst->pages];
+        const uint8_t *in = src ? &src->bits[(sx + i) * src->pages] : NULL;
+        int from = sy;
+
+        for (int row = dy, end = dy + h; row < end;)
+        {
+            // UMA PALAVRA ALINHADA AO BYTE DO DESTINO: ATÉ 32 LINHAS, ESCRITAS EM ATÉ 4 BYTES
+            int byte = row >> 3;
+            int first = row & 7;
+            int n = end - row < 32 - first ? end - row : 32 - first;
+            int count = (first + n + 7) >> 3;
+            uint32_t mask = (n == 32 ? 0xFFFFFFFFu : (1u << n) - 1) << first;
+            uint32_t bits = in ? column_read(in, src->pages, from) << first : fill;
+            uint32_t word = column_load(out, dst->pages, byte, count);
+
+            switch (rop)
+            {
+            case BLIT_COPY:
+                word = (word & ~mask) | (bits & mask);
+                break;
+            case BLIT_OR:
+                word |= bits & mask;
+                break;
+            case BLIT_AND:
+                word &= bits | ~mask;
+                break;
+            case BLIT_XOR:
+                word ^= bits & mask;
+                break;
+            }
+
+            for (int k = 0; k < count; k++)
+                out[byte + k] = word >> (8 * k);
+
+            row += n;
+            from += n;
+        }
+    }
+}
+
+void blit(const blit_surface_t *dst, int dx, int dy, const blit_source_t *src, int sx, int sy, int w, int h, blit_rop_t rop)
+{
+    if (!clip_axis(&dx, &sx, &w, dst->width, src->width) || !clip_axis(&dy, &sy, &h, dst->height, src->height))
+        return;
+
+    blit_columns(dst, dx, dy, src, sx, sy, w, h, 0, rop);
+}
+
+void blit_fill(const blit_surface_t *dst, int x, int y, int w, int h, bool value, blit_rop_t rop)
+{
+    // A ORIGEM CONSTANTE NÃO TEM LIMITE: SÓ O DESTINO RECORTA
+    int sx = 0, sy = 0;
+    if (!clip_axis(&x, &sx, &w, dst->width, INT32_MAX) || !clip_axis(&y, &sy, &h, dst->height, INT32_MAX))
+        return;
+
+    blit_columns(dst, x, y, NULL, 0, 0, w, h, value ? 0xFFFFFFFFu : 0, rop);
+}
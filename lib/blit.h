@@ -0,0 +1,52 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    cópia de retângulos entre imagens de 1 bit por pixel (sem dependência do SDK)
+
+    as imagens ficam coluna a coluna, com pages bytes por coluna e o bit 0 na linha de
+    cima: o formato do ram_buffer do SSD1306 (endereçamento vertical) e dos sprites de
+    tools/asset_compiler.py. cada coluna é copiada em palavras de 32 linhas, com o
+    deslocamento entre a linha de origem e a de destino feito por shift, em vez de
+    pixel a pixel
+
+    o retângulo é recortado pela origem e pelo destino antes da cópia: coordenadas
+    negativas ou fora da tela desenham só a parte visível, e nenhum byte fora das
+    imagens é lido ou escrito. tools/blit_host.c compara com uma cópia pixel a pixel
+    em retângulos aleatórios e mede o ganho no computador
+*/
+
+// operação entre a origem e o destino
+typedef enum
+{
+    BLIT_COPY, // destino = origem
+    BLIT_OR,   // acende os pixels acesos da origem
+    BLIT_AND,  // apaga os pixels apagados da origem
+    BLIT_XOR   // inverte os pixels acesos da origem
+} blit_rop_t;
+
+typedef struct
+{
+    uint8_t *bits;
+    uint16_t width, height;
+    uint8_t pages; // bytes por coluna, ceil(height / 8) ou mais
+} blit_surface_t;
+
+// imagem só de leitura (sprites na flash)
+typedef struct
+{
+    const uint8_t *bits;
+    uint16_t width, height;
+    uint8_t pages;
+} blit_source_t;
+
+// copia o retângulo w x h de src em (sx, sy) para dst em (dx, dy)
+void blit(const blit_surface_t *dst, int dx, int dy, const blit_source_t *src, int sx, int sy, int w, int h, blit_rop_t rop);
+
+// aplica rop com uma origem de pixels todos iguais a value ao retângulo w x h em (x, y)
+void blit_fill(const blit_surface_t *dst, int x, int y, int w, int h, bool value, blit_rop_t rop);
+
+#endif
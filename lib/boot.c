@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "boot.h"
+
+boot_stage_t boot_stages[BOOT_MAX_STAGES];
+volatile uint8_t boot_stage_count;
+
+void boot_mark(const char *name)
+{
+    // as tasks marcam as suas etapas em paralelo
+    uint32_t save = save_and_disable_interrupts();
+    if (boot_stage_count < BOOT_MAX_STAGES)
+    {
+        boot_stages[boot_stage_count].name = name;
+        boot_stages[boot_stage_count].us = time_us_32();
+        boot_stage_count++;
+    }
+    restore_interrupts(save);
+}
+
+uint32_t boot_stage_us(const char *name)
+{
+    for (uint8_t i = 0; i < boot_stage_count; i++)
+    {
+        if (strcmp(boot_stages[i].name, name) == 0)
+            return boot_stages[i].us;
+    }
+    return 0;
+}
+
+size_t boot_report(char *buf, size_t len)
+{
+    size_t used = snprintf(buf, len, "etapa,us,delta_us\n");
+    uint32_t previous = 0;
+
+    for (uint8_t i = 0; i < boot_stage_count && used < len; i++)
+    {
+        used += snprintf(buf + used, len - used, "%s,%lu,%lu\n", boot_stages[i].name,
+                         (unsigned long)boot_stages[i].us, (unsigned long)(boot_stages[i].us - previous));
+        previous = boot_stages[i].us;
+    }
+
+    return used < len ? used : len - 1;
+}
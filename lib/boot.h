@@ -0,0 +1,35 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+    marcas de tempo da sequência de boot
+
+    cada etapa registra o instante (us desde o reset do timer, no início do boot) em que
+    terminou; as etapas depois do escalonador são marcadas pelas próprias tasks e podem
+    vir em qualquer ordem
+*/
+
+#define BOOT_MAX_STAGES 12
+
+typedef struct
+{
+    const char *name;
+    uint32_t us;
+} boot_stage_t;
+
+extern boot_stage_t boot_stages[BOOT_MAX_STAGES];
+extern volatile uint8_t boot_stage_count;
+
+// registra o fim de uma etapa (pode ser chamada antes do escalonador e de qualquer task)
+void boot_mark(const char *name);
+
+// instante em que a etapa terminou, 0 se ainda não terminou
+uint32_t boot_stage_us(const char *name);
+
+// escreve as etapas em CSV (etapa,us,delta_us) em buf; retorna a quantidade de caracteres escritos
+size_t boot_report(char *buf, size_t len);
+
+#endif
@@ -0,0 +1,56 @@
+#include "control.h"
+
+/*
+verde atuado pelos detectores de demanda: um veículo na via principal segura o verde
+(no máximo DETECTOR_MAX_EXTENSION_MS a mais); com a via principal livre e demanda na
+transversal o verde termina assim que cumprir o verde mínimo
+*/
+static void actuate_green(control_t *control, uint8_t demand, uint32_t now_ms)
+{
+    intersections_t *ctl = control->ctl;
+    uint16_t id = control->main;
+
+    if (ctl->phase[id] != GREEN_LIGHT || (ctl->flags[id] & (INTERSECTION_NIGHT | INTERSECTION_PREEMPT)))
+    {
+        control->extension_ms = 0;
+        return;
+    }
+
+    uint32_t remaining = intersections_remaining(ctl, id, now_ms);
+    uint32_t elapsed = phase_duration_ms[GREEN_LIGHT] + control->extension_ms - remaining;
+
+    if (demand & CONTROL_DEMAND_MAIN)
+    {
+        uint32_t delta = remaining < DETECTOR_GAP_MS ? DETECTOR_GAP_MS - remaining : 0;
+        if (delta > DETECTOR_MAX_EXTENSION_MS - control->extension_ms)
+            delta = DETECTOR_MAX_EXTENSION_MS - control->extension_ms;
+        intersections_shift(ctl, id, delta);
+        control->extension_ms += delta;
+    }
+    else if ((demand & CONTROL_DEMAND_CROSS) && elapsed >= DETECTOR_MIN_GREEN_MS)
+    {
+        intersections_shift(ctl, id, -(int32_t)remaining);
+    }
+}
+
+bool control_step(control_t *control, const control_inputs_t *inputs, uint32_t now_ms)
+{
+    intersections_t *ctl = control->ctl;
+
+    // MODO PEDIDO PELO BOTÃO EM TODOS OS CRUZAMENTOS, SÓ NA MUDANÇA (A VOLTA NORMAL NÃO PERCORRE OS N)
+    if (inputs->night != control->inputs.night)
+        intersections_set_night_all(ctl, inputs->night);
+
+    // PREEMPÇÃO PEDIDA PELO DETECTOR (A SEQUÊNCIA DE SEGURANÇA COMEÇA AGORA)
+    if (inputs->preempt != control->inputs.preempt)
+        intersections_set_preempt_all(ctl, inputs->preempt);
+
+    // DEMANDA DOS DETECTORES (NOS SEGUIDORES DA ONDA A CORREÇÃO DESFARIA O AJUSTE)
+    if (control->actuated)
+        actuate_green(control, inputs->demand, now_ms);
+
+    intersections_step(ctl, now_ms);
+    control->inputs = *inputs;
+
+    return intersections_take_changed(ctl, control->main);
+}
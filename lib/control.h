@@ -0,0 +1,47 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "intersections.h"
+
+/*
+    uma volta do controlador (sem dependência do SDK)
+
+    o controlador do firmware lê as entradas uma vez por volta e chama control_step, que
+    aplica o modo, a preempção e a demanda dos detectores aos cruzamentos e avança a roda.
+    o modo e a preempção só percorrem os cruzamentos quando mudam (comparados com as
+    entradas da volta anterior), então uma volta sem mudança custa só as posições da roda.
+    tools/replay_host.c roda este mesmo código com as entradas gravadas por
+    lib/input_record.c, então a reprodução segue exatamente o caminho do firmware
+*/
+
+#define DETECTOR_GAP_MS 1500           // verde que sobra depois de um veículo na via principal
+#define DETECTOR_MAX_EXTENSION_MS 6000 // maior extensão de um verde pela demanda
+#define DETECTOR_MIN_GREEN_MS 1500     // verde mínimo antes de atender a via transversal
+
+// bits de control_inputs_t.demand
+#define CONTROL_DEMAND_MAIN (1u << 0)  // veículo na via principal (a do semáforo da placa)
+#define CONTROL_DEMAND_CROSS (1u << 1) // veículo na via transversal
+
+// entradas lidas pelo controlador no início de cada volta
+typedef struct
+{
+    bool night;     // modo noturno pedido (botão A ou terminal)
+    bool preempt;   // detector do veículo de emergência ativo
+    uint8_t demand; // detectores de demanda (CONTROL_DEMAND_*)
+} control_inputs_t;
+
+typedef struct
+{
+    intersections_t *ctl;
+    uint16_t main;           // cruzamento exibido pelos periféricos da placa
+    bool actuated;           // verde atuado pela demanda (só no mestre da onda verde)
+    uint32_t extension_ms;   // extensão já dada ao verde atual
+    control_inputs_t inputs; // entradas aplicadas na última volta
+} control_t;
+
+// aplica as entradas a todos os cruzamentos e avança até now_ms; retorna true se a fase do principal mudou
+bool control_step(control_t *control, const control_inputs_t *inputs, uint32_t now_ms);
+
+#endif
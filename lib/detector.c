@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "detector.h"
+#include "phase_log.h"
+#include "sched_stats.h"
+
+#define DETECTOR_FIRST_GPIO 26 // o ADCn fica no GPIO 26 + n
+#define DETECTOR_BLOCK_WORDS (DETECTOR_CHANNELS * DETECTOR_BLOCK_SAMPLES)
+#define DETECTOR_ADC_HZ 48000000 // clk_adc: uma conversão a cada (div + 1) ciclos
+#define DETECTOR_BLOCK_US (DETECTOR_BLOCK_SAMPLES * 1000000u / DETECTOR_SAMPLE_HZ)
+#define DETECTOR_RING_BITS 8      // cada buffer tem 2^8 bytes e o endereço de escrita dá a volta dentro dele
+
+volatile detector_stats_t detector_stats;
+
+// os dois eixos com os limiares padrão (o centro é medido no primeiro bloco)
+static const detector_config_t detector_configs[DETECTOR_CHANNELS] = {
+    {.center = 0, .on_level = DETECTOR_ON_LEVEL, .off_level = DETECTOR_OFF_LEVEL, .shift = DETECTOR_IIR_SHIFT},
+    {.center = 0, .on_level = DETECTOR_ON_LEVEL, .off_level = DETECTOR_OFF_LEVEL, .shift = DETECTOR_IIR_SHIFT}};
+
+// o anel do DMA só troca os bits baixos do endereço: cada buffer começa em múltiplo do seu tamanho
+static uint16_t buffers[2][DETECTOR_BLOCK_WORDS] __attribute__((aligned(1u << DETECTOR_RING_BITS)));
+_Static_assert(sizeof(buffers[0]) == 1u << DETECTOR_RING_BITS, "o bloco tem que ocupar o anel inteiro");
+static uint dma_channels[2];
+static detector_filter_t filter;
+static TaskHandle_t detector_task;
+static TaskHandle_t detector_controller;
+static uint8_t detector_sched;
+static volatile uint32_t occupied;
+static volatile uint8_t pending;  // buffers cheios ainda não filtrados
+static uint8_t last_buffer;       // buffer do último bloco filtrado
+static uint32_t block_end_us;     // fim do último bloco contado (o ADC e o timer vêm do mesmo cristal)
+
+// fim de um bloco: só avisa a task (o canal que terminou já voltou ao início do seu buffer pelo anel)
+static void detector_dma_irq(void)
+{
+    uint8_t done = 0;
+    for (uint8_t b = 0; b < 2; b++)
+    {
+        if (dma_channel_get_irq1_status(dma_channels[b]))
+        {
+            dma_channel_acknowledge_irq1(dma_channels[b]);
+            done |= 1u << b;
+        }
+    }
+    if (!done)
+        return;
+
+    // INTERRUPÇÃO ATRASADA MAIS DE UM BLOCO (APAGAR UM SETOR DA FLASH): O DMA DEU VOLTAS NOS
+    // BUFFERS E SÓ OS DOIS ÚLTIMOS BLOCOS SOBRARAM. OS OUTROS SÃO CONTADOS PELO TEMPO
+    uint32_t blocks = (time_us_32() - block_end_us) / DETECTOR_BLOCK_US;
+    uint32_t filled = (done & 1) + (done >> 1);
+    block_end_us += blocks * DETECTOR_BLOCK_US;
+    if (blocks > filled)
+        detector_stats.overruns += blocks - filled;
+
+    // O MESMO BUFFER CHEIO DE NOVO ANTES DE SER FILTRADO: O BLOCO ANTERIOR FOI SOBRESCRITO
+    if (pending & done)
+        detector_stats.overruns++;
+    pending |= done;
+
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(detector_task, done, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void detector_init(TaskHandle_t controller, uint8_t sched_id)
+{
+    detector_controller = controller;
+    detector_sched = sched_id;
+    detector_filter_init(&filter, detector_configs, DETECTOR_CHANNELS);
+
+    adc_init();
+    for (uint c = 0; c < DETECTOR_CHANNELS; c++)
+        adc_gpio_init(DETECTOR_FIRST_GPIO + c);
+    adc_select_input(0);
+    adc_set_round_robin((1u << DETECTOR_CHANNELS) - 1);
+    // DREQ A CADA AMOSTRA, SEM O BIT DE ERRO E SEM REDUZIR PARA 8 BITS
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv(DETECTOR_ADC_HZ / (DETECTOR_SAMPLE_HZ * DETECTOR_CHANNELS) - 1);
+
+    for (uint8_t b = 0; b < 2; b++)
+        dma_channels[b] = dma_claim_unused_channel(true);
+
+    // CADA CANAL ENCHE UM BUFFER E DISPARA O OUTRO: O ADC NUNCA FICA SEM DESTINO. O ANEL
+    // NA ESCRITA TRAZ O ENDEREÇO DE VOLTA AO INÍCIO DO BUFFER SEM DEPENDER DA INTERRUPÇÃO
+    for (uint8_t b = 0; b < 2; b++)
+    {
+        dma_channel_config config = dma_channel_get_default_config(dma_channels[b]);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+        channel_config_set_read_increment(&config, false);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_dreq(&config, DREQ_ADC);
+        channel_config_set_ring(&config, true, DETECTOR_RING_BITS);
+        channel_config_set_chain_to(&config, dma_channels[!b]);
+        dma_channel_configure(dma_channels[b], &config, buffers[b], &adc_hw->fifo, DETECTOR_BLOCK_WORDS, false);
+        dma_channel_set_irq1_enabled(dma_channels[b], true);
+    }
+
+    irq_add_shared_handler(DMA_IRQ_1, detector_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+uint32_t detector_occupied(void)
+{
+    return occupied;
+}
+
+// filtra o bloco do buffer b e publica as mudanças
+static void detector_block(uint8_t b)
+{
+    sched_stats_job_begin(detector_sched);
+
+    uint32_t start = time_us_32();
+    uint32_t changed = detector_filter_block(&filter, buffers[b], DETECTOR_BLOCK_SAMPLES);
+    uint32_t cost = time_us_32() - start;
+
+    taskENTER_CRITICAL();
+    pending &= ~(1u << b);
+    taskEXIT_CRITICAL();
+    last_buffer = b;
+
+    detector_stats.blocks++;
+    detector_stats.last_cost_us = cost;
+    detector_stats.total_cost_us += cost;
+    if (cost > detector_stats.max_cost_us)
+        detector_stats.max_cost_us = cost;
+
+    if (changed)
+    {
+        occupied = detector_filter_occupied(&filter);
+        for (uint8_t c = 0; c < DETECTOR_CHANNELS; c++)
+        {
+            if (changed & (1u << c))
+                phase_log_append(PHASE_LOG_DETECTOR, c << 1 | (occupied >> c & 1));
+        }
+        xTaskNotifyGive(detector_controller);
+    }
+
+    sched_stats_job_end(detector_sched);
+}
+
+void vDetectorTask(void *pvParameters)
+{
+    detector_task = xTaskGetCurrentTaskHandle();
+
+    // A PRIMEIRA AMOSTRA É DO ADC0: AS AMOSTRAS FICAM INTERCALADAS NA ORDEM DOS CANAIS
+    adc_fifo_drain();
+    block_end_us = time_us_32();
+    dma_channel_start(dma_channels[0]);
+    adc_run(true);
+
+    uint8_t next = 0;
+    while (1)
+    {
+        uint32_t ready;
+        xTaskNotifyWait(0, UINT32_MAX, &ready, portMAX_DELAY);
+
+        // OS BUFFERS TERMINAM ALTERNADOS: COM OS DOIS PRONTOS, next É O MAIS ANTIGO
+        while (ready)
+        {
+            uint8_t b = ready & (1u << next) ? next : !next;
+            detector_block(b);
+            ready &= ~(1u << b);
+            next = !b;
+        }
+    }
+}
+
+size_t detector_report(char *buf, size_t len)
+{
+    size_t used = snprintf(buf, len, "canal,centro,desvio,liga,desliga,ocupado,deteccoes\n");
+
+    for (uint8_t c = 0; c < filter.count && used < len; c++)
+    {
+        const detector_channel_t *channel = &filter.channels[c];
+        used += snprintf(buf + used, len - used, "%u,%u,%ld,%u,%u,%u,%lu\n", c, channel->config.center,
+                         (long)(channel->filtered >> 8), channel->config.on_level, channel->config.off_level,
+                         channel->occupied, (unsigned long)channel->detections);
+    }
+
+    if (used < len)
+    {
+        uint32_t blocks = detector_stats.blocks;
+        used += snprintf(buf + used, len - used, "blocos %lu, perdidos %lu, custo_us %lu (medio %lu, max %lu)\n",
+                         (unsigned long)blocks, (unsigned long)detector_stats.overruns,
+                         (unsigned long)detector_stats.last_cost_us,
+                         (unsigned long)(blocks ? detector_stats.total_cost_us / blocks : 0),
+                         (unsigned long)detector_stats.max_cost_us);
+    }
+
+    return used < len ? used : len - 1;
+}
+
+void detector_last_block(uint16_t *samples)
+{
+    // O DMA SÓ VOLTA A ESSE BUFFER DEPOIS DE ENCHER O OUTRO (64ms)
+    memcpy(samples, buffers[last_buffer], sizeof(buffers[0]));
+}
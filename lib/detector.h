@@ -0,0 +1,55 @@
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "detector_filter.h"
+
+/*
+    detectores de demanda pelo ADC (os eixos do joystick da BitDogLab fazem o papel dos laços)
+
+    o ADC converte sem parar, em round-robin pelos canais, a DETECTOR_SAMPLE_HZ por canal.
+    dois canais de DMA encadeados enchem dois buffers alternados (ping-pong) direto da
+    FIFO do ADC: a CPU não toca em nenhuma amostra. cada canal escreve em anel dentro do
+    seu buffer, então volta sozinho ao início dele mesmo que a interrupção atrase. no fim
+    de cada bloco a interrupção do DMA só acorda a task dos detectores, que filtra o
+    bloco (lib/detector_filter.c) enquanto o DMA enche o outro
+
+    quando um canal muda de estado a task registra o evento (PHASE_LOG_DETECTOR) e acorda
+    o controlador, que lê os canais ocupados em detector_occupied
+*/
+
+#define DETECTOR_CHANNELS 2 // ADC0 (GPIO26, eixo Y) e ADC1 (GPIO27, eixo X)
+#define DETECTOR_MAIN 0     // canal da via principal (a do semáforo da placa)
+#define DETECTOR_CROSS 1    // canal da via transversal
+
+typedef struct
+{
+    uint32_t blocks;       // blocos filtrados
+    uint32_t overruns;     // blocos perdidos: o DMA voltou ao buffer antes da task ou da interrupção
+    uint32_t last_cost_us; // tempo de filtragem do último bloco
+    uint32_t max_cost_us;
+    uint32_t total_cost_us;
+} detector_stats_t;
+
+extern volatile detector_stats_t detector_stats;
+
+// configura o ADC e o DMA; o controlador é acordado a cada mudança e sched_id mede os blocos em sched_stats
+void detector_init(TaskHandle_t controller, uint8_t sched_id);
+
+// bits dos canais ocupados (1u << DETECTOR_MAIN, 1u << DETECTOR_CROSS)
+uint32_t detector_occupied(void);
+
+// task dos detectores: liga a conversão e filtra cada bloco entregue pelo DMA
+void vDetectorTask(void *pvParameters);
+
+// escreve o estado dos canais em CSV em buf; retorna a quantidade de caracteres escritos
+size_t detector_report(char *buf, size_t len);
+
+// copia o último bloco filtrado (amostras intercaladas, DETECTOR_CHANNELS * DETECTOR_BLOCK_SAMPLES)
+void detector_last_block(uint16_t *samples);
+
+#endif
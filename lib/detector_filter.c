@@ -0,0 +1,77 @@
+#include "detector_filter.h"
+
+void detector_filter_init(detector_filter_t *filter, const detector_config_t *configs, uint8_t count)
+{
+    filter->count = count < DETECTOR_MAX_CHANNELS ? count : DETECTOR_MAX_CHANNELS;
+    filter->blocks = 0;
+
+    for (uint8_t c = 0; c < filter->count; c++)
+    {
+        filter->channels[c] = (detector_channel_t){.config = configs[c]};
+    }
+}
+
+// média do canal no bloco (calibração do centro)
+static uint16_t block_mean(const uint16_t *samples, uint8_t stride, uint16_t per_channel)
+{
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < per_channel; i++)
+        sum += samples[i * stride] & DETECTOR_ADC_MASK;
+    return sum / per_channel;
+}
+
+uint32_t detector_filter_block(detector_filter_t *filter, const uint16_t *samples, uint16_t per_channel)
+{
+    uint32_t changed = 0;
+    uint8_t stride = filter->count;
+
+    if (per_channel == 0)
+        return 0;
+
+    for (uint8_t c = 0; c < filter->count; c++)
+    {
+        detector_channel_t *channel = &filter->channels[c];
+        const uint16_t *in = &samples[c];
+
+        if (channel->config.center == 0)
+            channel->config.center = block_mean(in, stride, per_channel);
+
+        // MÉDIA MÓVEL DO BLOCO: SÓ SOMA E SUBTRAÇÃO POR AMOSTRA, UMA DIVISÃO POR BLOCO
+        int32_t center = channel->config.center;
+        uint32_t sum = 0;
+        for (uint16_t i = 0; i < per_channel; i++)
+        {
+            int32_t deviation = (int32_t)(in[i * stride] & DETECTOR_ADC_MASK) - center;
+            sum += deviation < 0 ? -deviation : deviation;
+        }
+        int32_t mean = (sum << 8) / per_channel;
+
+        // IIR EM Q8: O DESLOCAMENTO ARITMÉTICO MANTÉM O SINAL DA DIFERENÇA
+        channel->filtered += (mean - channel->filtered) >> channel->config.shift;
+
+        // HISTERESE: RUÍDO PERTO DE UM LIMIAR NÃO FAZ O CANAL ALTERNAR
+        uint32_t level = channel->filtered >> 8;
+        bool occupied = channel->occupied ? level >= channel->config.off_level : level > channel->config.on_level;
+        if (occupied != channel->occupied)
+        {
+            channel->occupied = occupied;
+            if (occupied)
+                channel->detections++;
+            changed |= 1u << c;
+        }
+    }
+
+    filter->blocks++;
+    return changed;
+}
+
+uint32_t detector_filter_occupied(const detector_filter_t *filter)
+{
+    uint32_t occupied = 0;
+    for (uint8_t c = 0; c < filter->count; c++)
+    {
+        if (filter->channels[c].occupied)
+            occupied |= 1u << c;
+    }
+    return occupied;
+}
@@ -0,0 +1,62 @@
+#ifndef DETECTOR_FILTER_H
+#define DETECTOR_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    filtro dos detectores de demanda (sem dependência do SDK)
+
+    as amostras chegam em blocos, intercaladas por canal (canal 0, canal 1, ..., canal 0, ...),
+    como o ADC em round-robin as escreve pelo DMA (lib/detector.c). cada bloco vira um
+    valor por canal, em inteiros:
+
+    - média móvel do bloco: soma de |amostra - centro| dividida pelo tamanho do bloco;
+    - IIR de um polo em Q8: filtrado += (média - filtrado) >> shift a cada bloco;
+    - histerese: o canal fica ocupado acima de on_level e só volta a livre abaixo de off_level
+
+    com center = 0 o primeiro bloco define o centro (o joystick parado, no lugar de um laço
+    indutivo vazio). tools/detector_host.c passa amostras gravadas por este mesmo código
+*/
+
+#define DETECTOR_MAX_CHANNELS 4    // ADC0 a ADC3 (o ADC4 é o sensor de temperatura)
+#define DETECTOR_SAMPLE_HZ 1000    // amostras por segundo de cada canal
+#define DETECTOR_BLOCK_SAMPLES 64  // amostras de cada canal por bloco (64ms)
+#define DETECTOR_ADC_MASK 0x0FFF   // 12 bits do ADC
+#define DETECTOR_ON_LEVEL 600      // limiares padrão em unidades do ADC (eixo do joystick: ±2048)
+#define DETECTOR_OFF_LEVEL 300
+#define DETECTOR_IIR_SHIFT 2       // ~4 blocos (256ms) para o filtrado chegar à média
+
+typedef struct
+{
+    uint16_t center;    // leitura sem veículo (0 = medir no primeiro bloco)
+    uint16_t on_level;  // desvio filtrado que liga a detecção
+    uint16_t off_level; // desvio filtrado que desliga (menor que on_level)
+    uint8_t shift;      // constante do IIR: cada bloco anda 1/2^shift do caminho até a média
+} detector_config_t;
+
+typedef struct
+{
+    detector_config_t config;
+    int32_t filtered;    // desvio filtrado em Q8 (unidades do ADC << 8)
+    bool occupied;
+    uint32_t detections; // vezes que o canal passou a ocupado
+} detector_channel_t;
+
+typedef struct
+{
+    detector_channel_t channels[DETECTOR_MAX_CHANNELS];
+    uint8_t count;
+    uint32_t blocks; // blocos processados
+} detector_filter_t;
+
+// configura count canais (no máximo DETECTOR_MAX_CHANNELS), todos livres
+void detector_filter_init(detector_filter_t *filter, const detector_config_t *configs, uint8_t count);
+
+// processa um bloco com per_channel (até 4096) amostras de cada canal; retorna os bits dos canais que mudaram
+uint32_t detector_filter_block(detector_filter_t *filter, const uint16_t *samples, uint16_t per_channel);
+
+// bits dos canais ocupados
+uint32_t detector_filter_occupied(const detector_filter_t *filter);
+
+#endif
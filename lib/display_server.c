@@ -0,0 +1,253 @@
+#include <string.h>
+#include "display_server.h"
+#include "boot.h"
+#include "supervisor.h"
+
+volatile display_stats_t display_stats;
+
+static ssd1306_t ssd;         // framebuffer, acessado só pela task do servidor
+static QueueHandle_t display_queue;
+static SemaphoreHandle_t display_producer; // mutex recursivo do quadro de um produtor
+
+// configuração do barramento, aplicada pela task do servidor
+static i2c_inst_t *display_i2c;
+static uint display_sda, display_scl;
+static uint8_t display_address;
+
+void display_server_init(i2c_inst_t *i2c, uint sda, uint scl, uint8_t address)
+{
+    display_queue = xQueueCreate(DISPLAY_QUEUE_LENGTH, sizeof(display_cmd_t));
+    display_producer = xSemaphoreCreateRecursiveMutex();
+
+    display_i2c = i2c;
+    display_sda = sda;
+    display_scl = scl;
+    display_address = address;
+}
+
+// inicialização bloqueante do display (dezenas de ms de I2C), feita já com o escalonador rodando
+static void display_setup(void)
+{
+    // I2C Initialisation. Using it at 400Khz.
+    i2c_init(display_i2c, 400 * 1000);
+
+    gpio_set_function(display_sda, GPIO_FUNC_I2C);                          // Set the GPIO pin function to I2C
+    gpio_set_function(display_scl, GPIO_FUNC_I2C);                          // Set the GPIO pin function to I2C
+    gpio_pull_up(display_sda);                                              // Pull up the data line
+    gpio_pull_up(display_scl);                                              // Pull up the clock line
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, display_address, display_i2c); // Inicializa o display
+    ssd1306_config(&ssd);                                                   // Configura o display
+
+    // Limpa o display. O display inicia com todos os pixels apagados.
+    ssd1306_fill(&ssd, false);
+    ssd1306_send_data(&ssd);
+
+    boot_mark("display pronto");
+}
+
+// colunas pedidas pelos flushes parciais do lote atual
+static uint8_t region_x0, region_x1;
+
+// aplica um comando ao framebuffer; retorna true se o comando pede o envio do quadro
+static bool display_apply(const display_cmd_t *cmd)
+{
+    switch (cmd->type)
+    {
+    case DISPLAY_CMD_CLEAR:
+        ssd1306_fill(&ssd, false);
+        break;
+
+    case DISPLAY_CMD_TEXT:
+        ssd1306_draw_string_scaled(&ssd, cmd->text, cmd->x, cmd->y, cmd->scale ? cmd->scale : 1);
+        break;
+
+    case DISPLAY_CMD_RECT:
+        ssd1306_rect(&ssd, cmd->y, cmd->x, cmd->w, cmd->h, cmd->value, cmd->fill);
+        break;
+
+    case DISPLAY_CMD_ROTATED_RECT:
+        ssd1306_rotated_rect_angle(&ssd, cmd->x, cmd->y, cmd->w, cmd->h, cmd->angle, cmd->value);
+        break;
+
+    case DISPLAY_CMD_SPRITE:
+        ssd1306_bitmap(&ssd, cmd->bitmap, cmd->x, cmd->y, cmd->w, cmd->h);
+        break;
+
+    case DISPLAY_CMD_EFFECT:
+        if (cmd->period_ms == 0)
+            ssd1306_effect_stop(&ssd);
+        else
+            ssd1306_effect_start(&ssd, cmd->effect, cmd->period_ms, pdTICKS_TO_MS(xTaskGetTickCount()));
+        break;
+
+    case DISPLAY_CMD_FLUSH:
+        region_x0 = 0;
+        region_x1 = WIDTH - 1;
+        return true;
+
+    case DISPLAY_CMD_FLUSH_REGION:
+        if (cmd->x < region_x0)
+            region_x0 = cmd->x;
+        if (cmd->x + cmd->w - 1 > region_x1)
+            region_x1 = cmd->x + cmd->w - 1;
+        return true;
+
+    default:
+        break;
+    }
+
+    display_stats.commands++;
+    return false;
+}
+
+void vDisplayServerTask(void *pvParameters)
+{
+    uint8_t supervisor_id = (uintptr_t)pvParameters;
+    display_cmd_t cmd;
+
+    display_setup();
+
+    while (1)
+    {
+        bool flush = false;
+        uint32_t flush_stamp = 0;
+
+        // nenhuma coluna pedida ainda
+        region_x0 = WIDTH - 1;
+        region_x1 = 0;
+
+        // SEM COMANDOS O SERVIDOR SÓ ACORDA NA PRÓXIMA MUDANÇA DO EFEITO (OU NUNCA, SEM EFEITO)
+        uint32_t idle_ms = ssd1306_effect_next_ms(&ssd, pdTICKS_TO_MS(xTaskGetTickCount()));
+        TickType_t idle = idle_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(idle_ms);
+
+        // ESPERAR COMANDOS NÃO É TRAVAMENTO; UM ENVIO PRESO NO I2C É
+        if (idle == portMAX_DELAY)
+            supervisor_idle(supervisor_id);
+
+        // ESPERA O PRIMEIRO COMANDO E APLICA OS QUE JÁ ESTÃO NA FILA ATÉ O PRIMEIRO FLUSH
+        bool received = xQueueReceive(display_queue, &cmd, idle) == pdTRUE;
+        supervisor_checkin(supervisor_id, pdTICKS_TO_MS(xTaskGetTickCount()));
+        if (received)
+        {
+            do
+            {
+                flush = display_apply(&cmd);
+            } while (!flush && xQueueReceive(display_queue, &cmd, 0) == pdTRUE);
+
+            // PEDIDOS DE FLUSH SEGUIDOS (DE OUTROS PRODUTORES) SÃO ATENDIDOS PELO MESMO ENVIO
+            flush_stamp = cmd.stamp_us;
+            while (flush && xQueuePeek(display_queue, &cmd, 0) == pdTRUE &&
+                   (cmd.type == DISPLAY_CMD_FLUSH || cmd.type == DISPLAY_CMD_FLUSH_REGION))
+            {
+                xQueueReceive(display_queue, &cmd, 0);
+                display_apply(&cmd);
+            }
+        }
+
+        // UM ÚNICO ENVIO POR LOTE, MESMO COM VÁRIOS PEDIDOS DE FLUSH
+        if (flush)
+        {
+            // SÓ AS COLUNAS ALTERADAS QUANDO NENHUM PEDIDO FOI DO QUADRO INTEIRO; UM ENVIO QUE NÃO
+            // CHEGOU INTEIRO (NAK, RUÍDO NO BARRAMENTO) É REFEITO UMA VEZ COM O QUADRO INTEIRO
+            if (!ssd1306_send_columns(&ssd, region_x0, region_x1))
+            {
+                display_stats.errors++;
+                region_x0 = 0;
+                region_x1 = WIDTH - 1;
+                if (!ssd1306_send_data(&ssd))
+                    display_stats.errors++;
+            }
+            display_stats.bytes += (region_x1 - region_x0 + 1) * ssd.pages;
+            if (region_x0 > 0 || region_x1 < WIDTH - 1)
+                display_stats.partial_frames++;
+
+            if (display_stats.frames == 0)
+                boot_mark("primeiro quadro do display");
+
+            uint32_t latency = time_us_32() - flush_stamp;
+            display_stats.frames++;
+            display_stats.last_latency_us = latency;
+            display_stats.sum_latency_us += latency;
+            if (latency > display_stats.max_latency_us)
+                display_stats.max_latency_us = latency;
+        }
+
+        ssd1306_effect_update(&ssd, pdTICKS_TO_MS(xTaskGetTickCount()));
+    }
+}
+
+// UM COMANDO SOLTO TAMBÉM PEGA O MUTEX: ELE NÃO ENTRA NO MEIO DO QUADRO ABERTO POR OUTRA TASK
+static void display_send(display_cmd_t *cmd)
+{
+    xSemaphoreTakeRecursive(display_producer, portMAX_DELAY);
+    xQueueSend(display_queue, cmd, portMAX_DELAY);
+    xSemaphoreGiveRecursive(display_producer);
+}
+
+void display_begin(void)
+{
+    xSemaphoreTakeRecursive(display_producer, portMAX_DELAY);
+}
+
+void display_end(void)
+{
+    display_stats.producer_frames++;
+    xSemaphoreGiveRecursive(display_producer);
+}
+
+void display_clear(void)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_CLEAR};
+    display_send(&cmd);
+}
+
+void display_text(const char *text, uint8_t x, uint8_t y)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_TEXT, .x = x, .y = y};
+    strncpy(cmd.text, text, DISPLAY_TEXT_MAX);
+    display_send(&cmd);
+}
+
+void display_rect(int x, int y, uint8_t w, uint8_t h, bool value, bool fill)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_RECT, .x = x, .y = y, .w = w, .h = h, .value = value, .fill = fill};
+    display_send(&cmd);
+}
+
+void display_rotated_rect(int cx, int cy, int w, int h, int16_t angle, bool value)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_ROTATED_RECT, .x = cx, .y = cy, .w = w, .h = h, .angle = angle, .value = value};
+    display_send(&cmd);
+}
+
+void display_sprite(const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_SPRITE, .x = x, .y = y, .w = w, .h = h, .bitmap = bitmap};
+    display_send(&cmd);
+}
+
+// period_ms = 0 encerra o efeito em andamento
+void display_effect(ssd1306_effect_t effect, uint16_t period_ms)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_EFFECT, .effect = effect, .period_ms = period_ms};
+    display_send(&cmd);
+}
+
+void display_text_scaled(const char *text, uint8_t x, uint8_t y, uint8_t scale)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_TEXT, .x = x, .y = y, .scale = scale};
+    strncpy(cmd.text, text, DISPLAY_TEXT_MAX);
+    display_send(&cmd);
+}
+
+void display_flush(void)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_FLUSH, .stamp_us = time_us_32()};
+    display_send(&cmd);
+}
+
+void display_flush_region(uint8_t x, uint8_t w)
+{
+    display_cmd_t cmd = {.type = DISPLAY_CMD_FLUSH_REGION, .x = x, .w = w, .stamp_us = time_us_32()};
+    display_send(&cmd);
+}
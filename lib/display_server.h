@@ -0,0 +1,92 @@
+#ifndef DISPLAY_SERVER_H
+#define DISPLAY_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "ssd1306.h"
+
+#define DISPLAY_QUEUE_LENGTH 32 // comandos pendentes antes de bloquear quem desenha
+#define DISPLAY_TEXT_MAX 16     // bytes (UTF-8) copiados por comando de texto
+
+// comandos aceitos pelo servidor de display
+typedef enum
+{
+    DISPLAY_CMD_CLEAR,
+    DISPLAY_CMD_TEXT,
+    DISPLAY_CMD_RECT,
+    DISPLAY_CMD_ROTATED_RECT,
+    DISPLAY_CMD_SPRITE,
+    DISPLAY_CMD_EFFECT,
+    DISPLAY_CMD_FLUSH,
+    DISPLAY_CMD_FLUSH_REGION
+} display_cmd_type;
+
+typedef struct
+{
+    uint8_t type;              // display_cmd_type
+    int16_t x, y, w, h;        // região do comando (centro no retângulo rotacionado)
+    bool value, fill;          // cor e preenchimento
+    int16_t angle;             // ângulo em graus do retângulo rotacionado
+    uint8_t effect;            // ssd1306_effect_t
+    uint8_t scale;             // ampliação do texto (0 ou 1 = tamanho normal)
+    uint16_t period_ms;        // período do efeito
+    uint32_t stamp_us;         // instante do pedido de flush (latência do quadro)
+    const uint8_t *bitmap;     // sprite no formato de ssd1306_bitmap, na flash
+    char text[DISPLAY_TEXT_MAX + 1];
+} display_cmd_t;
+
+typedef struct
+{
+    uint32_t commands;         // comandos aplicados ao framebuffer
+    uint32_t frames;           // quadros enviados pelo barramento
+    uint32_t partial_frames;   // quadros enviados só com as colunas alteradas
+    uint32_t bytes;            // bytes de imagem enviados
+    uint32_t errors;           // envios que o I2C não aceitou inteiros (refeitos com o quadro inteiro)
+    uint32_t producer_frames;  // quadros de produtor fechados por display_end
+    uint32_t last_latency_us;  // pedido de flush -> fim do envio do quadro
+    uint32_t max_latency_us;
+    uint32_t sum_latency_us;   // soma das latências (dá a volta: use a diferença entre duas leituras)
+} display_stats_t;
+
+extern volatile display_stats_t display_stats;
+
+// cria a fila de comandos e guarda a configuração do I2C; o servidor passa a ser o único dono do barramento
+// (as tasks já podem desenhar: os comandos esperam na fila até o display ficar pronto)
+void display_server_init(i2c_inst_t *i2c, uint sda, uint scl, uint8_t address);
+
+// task do servidor: inicializa o I2C e o display fora do boot e depois aplica os comandos em lote,
+// enviando o quadro uma vez por lote, mesmo com vários pedidos de flush
+// (pvParameters é o índice da task no supervisor, convertido com (void *)(uintptr_t))
+void vDisplayServerTask(void *pvParameters);
+
+/*
+    quadro de um produtor
+
+    os comandos de uma task entre display_begin e display_end chegam ao servidor juntos, sem
+    comandos de outras tasks no meio: um flush de outro produtor nunca envia o desenho pela
+    metade. as outras tasks que desenham nesse intervalo esperam o display_end (o mutex
+    herda a prioridade). o flush (ou flush_region) do quadro vai antes do display_end
+*/
+void display_begin(void);
+void display_end(void);
+
+// comandos de desenho, seguros para qualquer task (retângulos e sprites podem sair da tela: o servidor recorta)
+void display_clear(void);
+void display_text(const char *text, uint8_t x, uint8_t y);
+void display_rect(int x, int y, uint8_t w, uint8_t h, bool value, bool fill);
+void display_rotated_rect(int cx, int cy, int w, int h, int16_t angle, bool value);
+void display_sprite(const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h);
+void display_effect(ssd1306_effect_t effect, uint16_t period_ms);
+void display_text_scaled(const char *text, uint8_t x, uint8_t y, uint8_t scale);
+void display_flush(void);
+
+// envia só as colunas x a x + w - 1; pedidos do mesmo lote são unidos em um único envio
+void display_flush_region(uint8_t x, uint8_t w);
+
+#endif
@@ -0,0 +1,65 @@
+#include "green_wave.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+volatile green_wave_stats_t green_wave_stats;
+
+static uart_inst_t *wave_uart;
+static green_wave_sync_t wave;
+
+// interrupção de recepção: entrega cada byte ao analisador com o instante de chegada
+static void green_wave_rx_irq(void)
+{
+    while (uart_is_readable(wave_uart))
+        green_wave_sync_receive(&wave, uart_getc(wave_uart), time_us_32());
+}
+
+void green_wave_init(uart_inst_t *uart, uint tx_pin, uint rx_pin, uint8_t node_id,
+                     const uint16_t *offsets_ms, uint8_t node_count)
+{
+    green_wave_sync_init(&wave, node_id, offsets_ms, node_count, &green_wave_stats);
+    wave_uart = uart;
+
+    uart_init(uart, GREEN_WAVE_BAUDRATE);
+    gpio_set_function(tx_pin, GPIO_FUNC_UART);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+
+    // O MESTRE SÓ TRANSMITE: COM A FIFO O QUADRO INTEIRO É ESCRITO SEM ESPERAR A LINHA
+    uart_set_fifo_enabled(uart, node_id == 0);
+
+    if (node_id != 0)
+    {
+        // sem FIFO a interrupção acontece a cada byte, deixando a marca de tempo precisa
+        uint irq = uart_get_index(uart) == 0 ? UART0_IRQ : UART1_IRQ;
+        irq_set_exclusive_handler(irq, green_wave_rx_irq);
+        irq_set_enabled(irq, true);
+        uart_set_irq_enables(uart, true, false);
+    }
+}
+
+void green_wave_update(intersections_t *ctl, uint16_t id, bool phase_changed)
+{
+    if (wave_uart == NULL || !green_wave_sync_active(ctl, id))
+        return;
+
+    if (wave.node == 0)
+    {
+        // O QUADRO (NO MÁXIMO 23 BYTES) CABE NA FIFO DE 32: A ESCRITA NÃO BLOQUEIA O CONTROLADOR
+        if (phase_changed)
+        {
+            uint8_t frame[GREEN_WAVE_FRAME_SIZE(GREEN_WAVE_MAX_NODES)];
+            uint8_t len = green_wave_sync_encode(&wave, ctl, id, frame);
+            uart_write_blocking(wave_uart, frame, len);
+        }
+    }
+    else if (wave.sample_pending)
+    {
+        // COPIA A AMOSTRA SEM A INTERRUPÇÃO DE RECEPÇÃO NO MEIO
+        uint32_t save = save_and_disable_interrupts();
+        green_wave_sample_t sample = wave.sample;
+        wave.sample_pending = false;
+        restore_interrupts(save);
+
+        green_wave_sync_discipline(&wave, ctl, id, &sample, time_us_32());
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef GREEN_WAVE_H
+#define GREEN_WAVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "intersections.h"
+#include "green_wave_sync.h"
+
+/*
+    transporte da onda verde pela UART (o protocolo e a disciplina ficam em lib/green_wave_sync.c)
+
+    o mestre escreve o quadro na FIFO de transmissão (um quadro cabe nos 32 bytes dela, então
+    o controlador não espera a linha); os seguidores desligam a FIFO para a interrupção de
+    recepção acontecer a cada byte e marcar o instante de chegada com precisão
+*/
+
+extern volatile green_wave_stats_t green_wave_stats;
+
+// inicializa a UART e o tratamento de recepção do nó indicado (0 = mestre)
+void green_wave_init(uart_inst_t *uart, uint tx_pin, uint rx_pin, uint8_t node_id,
+                     const uint16_t *offsets_ms, uint8_t node_count);
+
+// chamada periodicamente pelo controlador: o mestre transmite, os seguidores corrigem a fase
+void green_wave_update(intersections_t *ctl, uint16_t id, bool phase_changed);
+
+#endif
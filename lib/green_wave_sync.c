@@ -0,0 +1,140 @@
+#include "green_wave_sync.h"
+
+// crc-8 (polinomio 0x07) do quadro
+static uint8_t crc8(const uint8_t *data, uint8_t len)
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+void green_wave_sync_init(green_wave_sync_t *sync, uint8_t node_id, const uint16_t *offsets_ms, uint8_t node_count,
+                          volatile green_wave_stats_t *stats)
+{
+    *sync = (green_wave_sync_t){
+        .node = node_id,
+        .offsets = offsets_ms,
+        .node_count = node_count > GREEN_WAVE_MAX_NODES ? GREEN_WAVE_MAX_NODES : node_count,
+        .stats = stats};
+}
+
+bool green_wave_sync_locked(const green_wave_sync_t *sync)
+{
+    return sync->in_range >= GREEN_WAVE_LOCK_FRAMES;
+}
+
+bool green_wave_sync_active(const intersections_t *ctl, uint16_t id)
+{
+    return ctl->phase[id] < NIGHT_MODE && !(ctl->flags[id] & INTERSECTION_PREEMPT);
+}
+
+uint8_t green_wave_sync_encode(green_wave_sync_t *sync, const intersections_t *ctl, uint16_t id, uint8_t *frame)
+{
+    uint16_t position = intersections_cycle_position(ctl, id);
+
+    frame[0] = GREEN_WAVE_SYNC_BYTE;
+    frame[1] = GREEN_WAVE_CYCLE_FRAME;
+    frame[2] = sync->seq++;
+    frame[3] = position & 0xFF;
+    frame[4] = position >> 8;
+    frame[5] = sync->node_count;
+    for (uint8_t i = 0; i < sync->node_count; i++)
+    {
+        frame[6 + 2 * i] = sync->offsets[i] & 0xFF;
+        frame[7 + 2 * i] = sync->offsets[i] >> 8;
+    }
+
+    uint8_t len = GREEN_WAVE_FRAME_SIZE(sync->node_count);
+    frame[len - 1] = crc8(frame, len - 1);
+    return len;
+}
+
+// valida o quadro completo e guarda a amostra de sincronismo deste nó
+static void handle_frame(green_wave_sync_t *sync)
+{
+    const uint8_t *frame = sync->rx_frame;
+    uint8_t count = frame[5];
+
+    if (crc8(frame, sync->rx_len - 1) != frame[sync->rx_len - 1] || sync->node >= count)
+    {
+        sync->stats->frames_bad++;
+        return;
+    }
+
+    sync->sample.rx_us = sync->rx_start_us;
+    sync->sample.position_ms = frame[3] | (frame[4] << 8);
+    sync->sample.offset_ms = frame[6 + 2 * sync->node] | (frame[7 + 2 * sync->node] << 8);
+    sync->sample_pending = true;
+
+    sync->stats->frames_ok++;
+    sync->stats->last_rx_us = sync->rx_start_us;
+}
+
+void green_wave_sync_receive(green_wave_sync_t *sync, uint8_t byte, uint32_t byte_end_us)
+{
+    if (sync->rx_len == 0)
+    {
+        if (byte != GREEN_WAVE_SYNC_BYTE)
+            return;
+        // o byte já terminou de chegar; desconta o seu tempo na linha
+        sync->rx_start_us = byte_end_us - GREEN_WAVE_BYTE_US;
+    }
+
+    sync->rx_frame[sync->rx_len++] = byte;
+
+    if (sync->rx_len == GREEN_WAVE_HEADER_SIZE)
+    {
+        uint8_t count = sync->rx_frame[5];
+        if (sync->rx_frame[1] != GREEN_WAVE_CYCLE_FRAME || count == 0 || count > GREEN_WAVE_MAX_NODES)
+        {
+            sync->stats->frames_bad++;
+            sync->rx_len = 0;
+        }
+    }
+    else if (sync->rx_len > GREEN_WAVE_HEADER_SIZE && sync->rx_len == GREEN_WAVE_FRAME_SIZE(sync->rx_frame[5]))
+    {
+        handle_frame(sync);
+        sync->rx_len = 0;
+    }
+}
+
+int32_t green_wave_sync_discipline(green_wave_sync_t *sync, intersections_t *ctl, uint16_t id,
+                                   const green_wave_sample_t *sample, uint32_t now_us)
+{
+    int32_t cycle = intersections_cycle_length();
+
+    // posição do mestre agora, somando o tempo desde que o quadro começou a chegar
+    uint32_t master_position = sample->position_ms + (now_us - sample->rx_us) / 1000;
+    int32_t desired = (int32_t)((master_position + cycle - sample->offset_ms % cycle) % cycle);
+
+    // erro no intervalo [-ciclo/2, ciclo/2)
+    int32_t error = (int32_t)intersections_cycle_position(ctl, id) - desired;
+    if (error >= cycle / 2)
+        error -= cycle;
+    else if (error < -cycle / 2)
+        error += cycle;
+
+    // O MÁXIMO SÓ CONTA DEPOIS DA SINCRONIA: A CAPTURA SE APROXIMA GREEN_WAVE_MAX_SLEW_MS POR QUADRO, E
+    // SÓ HÁ SINCRONIA COM GREEN_WAVE_LOCK_FRAMES QUADROS SEGUIDOS CORRIGIDOS POR INTEIRO (UM SÓ PODE SER
+    // UMA MEDIDA NO MEIO DA CAPTURA)
+    int32_t magnitude = error < 0 ? -error : error;
+    sync->stats->last_error_ms = error;
+    if (green_wave_sync_locked(sync) && magnitude > sync->stats->max_error_ms)
+        sync->stats->max_error_ms = magnitude;
+    else if (!green_wave_sync_locked(sync))
+        sync->in_range = magnitude <= GREEN_WAVE_MAX_SLEW_MS ? sync->in_range + 1 : 0;
+
+    // adiantado -> atrasa o fim da fase atual; atrasado -> antecipa
+    if (error > GREEN_WAVE_MAX_SLEW_MS)
+        error = GREEN_WAVE_MAX_SLEW_MS;
+    else if (error < -GREEN_WAVE_MAX_SLEW_MS)
+        error = -GREEN_WAVE_MAX_SLEW_MS;
+
+    intersections_shift(ctl, id, error);
+    return error;
+}
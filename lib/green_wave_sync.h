@@ -0,0 +1,94 @@
+#ifndef GREEN_WAVE_SYNC_H
+#define GREEN_WAVE_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "intersections.h"
+
+/*
+    protocolo e disciplina da onda verde, sem o transporte (sem dependência do SDK)
+
+    lib/green_wave.c liga este núcleo à UART da placa: entrega cada byte recebido com o
+    instante em que terminou de chegar e transmite os quadros que o mestre monta.
+    tools/green_wave_host.c liga vários nós por pipes no computador
+*/
+
+#define GREEN_WAVE_BAUDRATE 115200
+#define GREEN_WAVE_MAX_NODES 8      // quantidade maxima de controladores na onda verde
+#define GREEN_WAVE_MAX_SLEW_MS 100  // correção máxima aplicada a cada quadro recebido
+#define GREEN_WAVE_LOCK_FRAMES 3    // quadros seguidos com o erro dentro da correção para estar em sincronia
+#define GREEN_WAVE_SYNC_BYTE 0xA5   // primeiro byte de todo quadro
+#define GREEN_WAVE_CYCLE_FRAME 0x01 // quadro de início de ciclo com os offsets
+
+// tempo de um byte na linha (start + 8 bits + stop) em us
+#define GREEN_WAVE_BYTE_US (10 * 1000000 / GREEN_WAVE_BAUDRATE)
+
+/*
+    quadro de sincronismo (little endian)
+
+    [0xA5][tipo][seq][posição no ciclo u16][n][offset 0 u16]...[offset n-1 u16][crc8]
+
+    o mestre (nó 0) envia a sua posição no ciclo a cada troca de fase
+    e os offsets de todos os nós; cada seguidor corrige o prazo da sua fase
+    para ficar offset ms atrás do mestre
+*/
+#define GREEN_WAVE_HEADER_SIZE 6
+#define GREEN_WAVE_FRAME_SIZE(n) (GREEN_WAVE_HEADER_SIZE + 2 * (n) + 1)
+
+typedef struct
+{
+    uint32_t frames_ok;      // quadros válidos recebidos
+    uint32_t frames_bad;     // quadros descartados por crc ou tamanho
+    int32_t last_error_ms;   // erro de alinhamento de fase medido no último quadro
+    int32_t max_error_ms;    // maior erro absoluto depois da sincronia (sem a captura)
+    uint32_t last_rx_us;     // instante em que o último quadro começou a chegar
+} green_wave_stats_t;
+
+// amostra de sincronismo do último quadro válido
+typedef struct
+{
+    uint32_t rx_us;       // instante em que o quadro começou a chegar
+    uint16_t position_ms; // posição do mestre no ciclo ao transmitir
+    uint16_t offset_ms;   // offset deste nó
+} green_wave_sample_t;
+
+typedef struct
+{
+    uint8_t node; // 0 = mestre
+    const uint16_t *offsets;
+    uint8_t node_count;
+    uint8_t seq;
+
+    // analisador de quadros (na placa roda na interrupção de recepção)
+    uint8_t rx_frame[GREEN_WAVE_FRAME_SIZE(GREEN_WAVE_MAX_NODES)];
+    uint8_t rx_len;
+    uint32_t rx_start_us;
+
+    // último quadro válido aguardando o controlador
+    volatile bool sample_pending;
+    green_wave_sample_t sample;
+    uint8_t in_range; // quadros seguidos com o erro até GREEN_WAVE_MAX_SLEW_MS, até GREEN_WAVE_LOCK_FRAMES
+
+    volatile green_wave_stats_t *stats;
+} green_wave_sync_t;
+
+void green_wave_sync_init(green_wave_sync_t *sync, uint8_t node_id, const uint16_t *offsets_ms, uint8_t node_count,
+                          volatile green_wave_stats_t *stats);
+
+// true depois de GREEN_WAVE_LOCK_FRAMES quadros seguidos com o erro corrigido por inteiro
+bool green_wave_sync_locked(const green_wave_sync_t *sync);
+
+// true se o cruzamento participa da onda agora (o modo noturno e a preempção ficam de fora)
+bool green_wave_sync_active(const intersections_t *ctl, uint16_t id);
+
+// mestre: monta em frame o quadro com a posição atual no ciclo; retorna o tamanho
+uint8_t green_wave_sync_encode(green_wave_sync_t *sync, const intersections_t *ctl, uint16_t id, uint8_t *frame);
+
+// seguidor: um byte recebido, com o instante (us) em que ele terminou de chegar
+void green_wave_sync_receive(green_wave_sync_t *sync, uint8_t byte, uint32_t byte_end_us);
+
+// seguidor: mede o erro em relação ao mestre em now_us e corrige o prazo com passo limitado; retorna a correção
+int32_t green_wave_sync_discipline(green_wave_sync_t *sync, intersections_t *ctl, uint16_t id,
+                                   const green_wave_sample_t *sample, uint32_t now_us);
+
+#endif
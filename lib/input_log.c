@@ -0,0 +1,253 @@
+#include "input_log.h"
+
+static const char *const type_names[INPUT_LOG_TYPES] = {
+    "volta", "noturno", "preempcao", "demanda", "duracao", "onda", "borda", "nivel", "fase", "toque", "mudo", "detector"};
+
+// bits do byte de entradas do cabeçalho
+#define HEADER_NIGHT (1u << 0)
+#define HEADER_PREEMPT (1u << 1)
+#define HEADER_ACTUATED (1u << 2)
+#define HEADER_MUTED (1u << 3)
+#define HEADER_DETECTOR (1u << 4)
+
+static uint8_t *put_u16(uint8_t *p, uint16_t value)
+{
+    p[0] = value;
+    p[1] = value >> 8;
+    return p + 2;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t value)
+{
+    for (uint8_t i = 0; i < 4; i++)
+        p[i] = value >> (8 * i);
+    return p + 4;
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// zigzag: valores pequenos com ou sem sinal viram varints curtos
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static size_t put_varint(uint8_t *p, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80)
+    {
+        p[n++] = value | 0x80;
+        value >>= 7;
+    }
+    p[n++] = value;
+    return n;
+}
+
+static bool get_varint(input_log_reader_t *reader, uint32_t *value)
+{
+    *value = 0;
+    for (uint8_t shift = 0; shift < 35 && reader->pos < reader->len; shift += 7)
+    {
+        uint8_t byte = reader->buf[reader->pos++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool has_extra(uint8_t type)
+{
+    return type == INPUT_LOG_DURATION || type == INPUT_LOG_SHIFT;
+}
+
+void input_log_capture(input_log_snapshot_t *snapshot, const control_t *control, uint8_t node, bool muted)
+{
+    const intersections_t *ctl = control->ctl;
+
+    snapshot->node = node;
+    snapshot->muted = muted;
+    snapshot->now_ms = ctl->now;
+    for (uint8_t p = 0; p < NUM_PHASES; p++)
+        snapshot->durations[p] = phase_duration_ms[p];
+    snapshot->inputs = control->inputs;
+    snapshot->detector = (preempt_filter_t){.level = control->inputs.preempt, .level_ms = ctl->now,
+                                            .active = control->inputs.preempt, .active_ms = ctl->now};
+    snapshot->actuated = control->actuated;
+    snapshot->extension_ms = control->extension_ms;
+    snapshot->main = control->main;
+    snapshot->count = ctl->count;
+    for (uint16_t i = 0; i < ctl->count; i++)
+    {
+        snapshot->phase[i] = ctl->phase[i];
+        snapshot->flags[i] = ctl->flags[i];
+        snapshot->deadline[i] = ctl->deadline[i];
+    }
+}
+
+void input_log_restore(const input_log_snapshot_t *snapshot, control_t *control)
+{
+    intersections_t *ctl = control->ctl;
+
+    for (uint8_t p = 0; p < NUM_PHASES; p++)
+        phase_duration_ms[p] = snapshot->durations[p];
+
+    // CADA CRUZAMENTO ENTRA NA RODA PELO PRAZO GRAVADO (intersections_add SOMA O VERDE AO DESLOCAMENTO)
+    intersections_init(ctl, snapshot->now_ms);
+    for (uint8_t i = 0; i < snapshot->count; i++)
+    {
+        intersections_add(ctl, snapshot->deadline[i] - snapshot->now_ms - phase_duration_ms[GREEN_LIGHT]);
+        ctl->phase[i] = snapshot->phase[i];
+        ctl->flags[i] = snapshot->flags[i];
+    }
+
+    control->main = snapshot->main;
+    control->actuated = snapshot->actuated;
+    control->extension_ms = snapshot->extension_ms;
+    control->inputs = snapshot->inputs;
+}
+
+bool input_log_begin(input_log_t *log, uint8_t *buf, size_t size, const input_log_snapshot_t *snapshot)
+{
+    uint8_t count = snapshot->count < MAX_INTERSECTIONS ? snapshot->count : MAX_INTERSECTIONS;
+
+    *log = (input_log_t){.buf = buf, .size = size, .last_ms = snapshot->now_ms};
+    if (size < INPUT_LOG_HEADER_SIZE(count))
+    {
+        log->full = true;
+        return false;
+    }
+
+    uint8_t *p = put_u16(buf, INPUT_LOG_MAGIC);
+    *p++ = INPUT_LOG_VERSION;
+    *p++ = snapshot->node;
+    p = put_u32(p, snapshot->now_ms);
+    for (uint8_t i = 0; i < NUM_PHASES; i++)
+        p = put_u32(p, snapshot->durations[i]);
+    *p++ = (snapshot->inputs.night ? HEADER_NIGHT : 0) | (snapshot->inputs.preempt ? HEADER_PREEMPT : 0) |
+           (snapshot->actuated ? HEADER_ACTUATED : 0) | (snapshot->muted ? HEADER_MUTED : 0) |
+           (snapshot->detector.level ? HEADER_DETECTOR : 0);
+    *p++ = snapshot->inputs.demand;
+    p = put_u32(p, snapshot->extension_ms);
+    p = put_u32(p, snapshot->detector.level_ms);
+    p = put_u32(p, snapshot->detector.active_ms);
+    p = put_u16(p, snapshot->main);
+    *p++ = count;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        *p++ = snapshot->phase[i];
+        *p++ = snapshot->flags[i];
+        p = put_u32(p, snapshot->deadline[i]);
+    }
+
+    log->used = p - buf;
+    return true;
+}
+
+bool input_log_append(input_log_t *log, input_log_type_t type, uint8_t value, uint32_t ms, int32_t extra)
+{
+    uint8_t record[INPUT_LOG_RECORD_MAX];
+    size_t len = 0;
+
+    if (log->full)
+        return false;
+
+    record[len++] = type << 4 | (value & 0x0F);
+    len += put_varint(&record[len], zigzag((int32_t)(ms - log->last_ms)));
+    if (has_extra(type))
+        len += put_varint(&record[len], type == INPUT_LOG_SHIFT ? zigzag(extra) : (uint32_t)extra);
+
+    if (log->used + len > log->size)
+    {
+        log->full = true;
+        return false;
+    }
+
+    for (size_t i = 0; i < len; i++)
+        log->buf[log->used++] = record[i];
+    log->last_ms = ms;
+    log->records++;
+    return true;
+}
+
+bool input_log_open(input_log_reader_t *reader, const uint8_t *buf, size_t len, input_log_snapshot_t *snapshot)
+{
+    if (len < INPUT_LOG_HEADER_SIZE(0) || get_u16(buf) != INPUT_LOG_MAGIC || buf[2] != INPUT_LOG_VERSION)
+        return false;
+
+    const uint8_t *p = buf + 3;
+    snapshot->node = *p++;
+    snapshot->now_ms = get_u32(p);
+    p += 4;
+    for (uint8_t i = 0; i < NUM_PHASES; i++, p += 4)
+        snapshot->durations[i] = get_u32(p);
+    snapshot->inputs.night = *p & HEADER_NIGHT;
+    snapshot->inputs.preempt = *p & HEADER_PREEMPT;
+    snapshot->actuated = *p & HEADER_ACTUATED;
+    snapshot->detector.level = *p & HEADER_DETECTOR;
+    snapshot->muted = *p++ & HEADER_MUTED;
+    snapshot->inputs.demand = *p++;
+    snapshot->extension_ms = get_u32(p);
+    snapshot->detector.level_ms = get_u32(p + 4);
+    snapshot->detector.active_ms = get_u32(p + 8);
+    snapshot->detector.active = snapshot->inputs.preempt;
+    p += 12;
+    snapshot->main = get_u16(p);
+    p += 2;
+    snapshot->count = *p++;
+
+    if (snapshot->count > MAX_INTERSECTIONS || snapshot->main >= snapshot->count ||
+        len < INPUT_LOG_HEADER_SIZE(snapshot->count))
+        return false;
+
+    for (uint8_t i = 0; i < snapshot->count; i++)
+    {
+        snapshot->phase[i] = *p++;
+        snapshot->flags[i] = *p++;
+        snapshot->deadline[i] = get_u32(p);
+        p += 4;
+    }
+
+    *reader = (input_log_reader_t){.buf = buf, .len = len, .pos = p - buf, .ms = snapshot->now_ms};
+    return true;
+}
+
+bool input_log_next(input_log_reader_t *reader, input_log_record_t *record)
+{
+    uint32_t delta, extra = 0;
+
+    if (reader->pos >= reader->len)
+        return false;
+
+    uint8_t head = reader->buf[reader->pos++];
+    record->type = head >> 4;
+    record->value = head & 0x0F;
+    if (record->type >= INPUT_LOG_TYPES || !get_varint(reader, &delta))
+        return false;
+    if (has_extra(record->type) && !get_varint(reader, &extra))
+        return false;
+
+    reader->ms += unzigzag(delta);
+    record->ms = reader->ms;
+    record->extra = record->type == INPUT_LOG_SHIFT ? unzigzag(extra) : (int32_t)extra;
+    return true;
+}
+
+const char *input_log_type_name(input_log_type_t type)
+{
+    return type < INPUT_LOG_TYPES ? type_names[type] : "?";
+}
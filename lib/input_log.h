@@ -0,0 +1,120 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "intersections.h"
+#include "control.h"
+#include "preempt_filter.h"
+
+/*
+    gravação das entradas do controlador para reprodução determinística (sem dependência do SDK)
+
+    a gravação começa com um retrato do controlador (cabeçalho) e segue com um registro
+    por entrada lida na fronteira com o hardware: o relógio de cada volta do controlador,
+    as entradas que mudaram, as bordas e os níveis dos botões, os níveis do detector de
+    emergência antes do filtro, as durações mudadas pelo terminal e as correções da onda
+    verde. as fases publicadas e os toques do buzzer
+    também são gravados, para a reprodução conferir a saída
+
+    cada registro: 1 byte (tipo << 4 | valor) + os ms desde o registro anterior em varint
+    zigzag (registros de contextos diferentes podem chegar fora de ordem por 1ms) e, nos
+    tipos INPUT_LOG_DURATION e INPUT_LOG_SHIFT, mais um varint (ms, zigzag na correção).
+    uma volta normal do controlador custa 2 bytes
+
+    cabeçalho (little endian): magic, versão, nó da onda, now_ms, durações das fases,
+    entradas aplicadas, verde atuado, buzzer mudo, nível do detector, extensão do verde,
+    instantes do filtro do detector (última mudança de nível e confirmação), cruzamento
+    principal, quantidade de cruzamentos e fase, flags e prazo de cada um
+*/
+
+#define INPUT_LOG_MAGIC 0x5249 // "IR"
+#define INPUT_LOG_VERSION 2
+#define INPUT_LOG_HEADER_SIZE(count) (25u + 4u * NUM_PHASES + 6u * (count))
+#define INPUT_LOG_RECORD_MAX 11 // tipo + dois varints de 32 bits
+
+// tipos de registro (4 bits)
+typedef enum
+{
+    INPUT_LOG_TICK,     // volta do controlador no instante do registro (avança os cruzamentos)
+    INPUT_LOG_NIGHT,    // modo noturno pedido, lido pelo controlador (valor 1 = noturno)
+    INPUT_LOG_PREEMPT,  // detector de emergência lido pelo controlador (valor 1 = ativo)
+    INPUT_LOG_DEMAND,   // detectores de demanda lidos pelo controlador (valor = CONTROL_DEMAND_*)
+    INPUT_LOG_DURATION, // duração de uma fase mudada pelo terminal (valor = fase, extra = ms)
+    INPUT_LOG_SHIFT,    // correção do prazo pela onda verde (extra = ms, com sinal)
+    INPUT_LOG_EDGE,     // borda de descida de um botão na interrupção (valor = botão)
+    INPUT_LOG_LEVEL,    // nível do botão lido depois do repique (valor = botão << 1 | pressionado)
+    INPUT_LOG_PHASE,    // saída: fase publicada (valor = fase | pisca aceso << 3)
+    INPUT_LOG_BEEP,     // saída: toque do buzzer (valor = fase em que tocou)
+    INPUT_LOG_MUTE,     // buzzer mudo pelo botão B ou pelo terminal (valor 1 = mudo)
+    INPUT_LOG_DETECTOR, // nível do detector de emergência na interrupção, antes do filtro (valor 1 = ativo)
+    INPUT_LOG_TYPES
+} input_log_type_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t value;
+    uint32_t ms;
+    int32_t extra; // INPUT_LOG_DURATION e INPUT_LOG_SHIFT
+} input_log_record_t;
+
+// estado do controlador no início da gravação
+typedef struct
+{
+    uint8_t node;                    // nó da onda verde (0 = mestre)
+    bool muted;                      // buzzer mudo
+    uint32_t now_ms;                 // último instante processado pelos cruzamentos
+    uint32_t durations[NUM_PHASES];  // phase_duration_ms
+    control_inputs_t inputs;         // entradas aplicadas na última volta
+    preempt_filter_t detector;       // filtro do detector (a saída é inputs.preempt)
+    bool actuated;
+    uint32_t extension_ms;
+    uint16_t main;
+    uint8_t count;
+    uint8_t phase[MAX_INTERSECTIONS];
+    uint8_t flags[MAX_INTERSECTIONS];
+    uint32_t deadline[MAX_INTERSECTIONS];
+} input_log_snapshot_t;
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t size;
+    size_t used;
+    uint32_t last_ms;
+    uint32_t records;
+    bool full; // um registro não coube: a gravação termina aqui
+} input_log_t;
+
+typedef struct
+{
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint32_t ms;
+} input_log_reader_t;
+
+// retrato do controlador, das durações atuais e do buzzer (o filtro do detector sai assentado na
+// saída aplicada: quem tem o filtro de verdade o copia por cima)
+void input_log_capture(input_log_snapshot_t *snapshot, const control_t *control, uint8_t node, bool muted);
+
+// recria o controlador do retrato (os cruzamentos em control->ctl e as durações das fases)
+void input_log_restore(const input_log_snapshot_t *snapshot, control_t *control);
+
+// começa uma gravação em buf com o cabeçalho do retrato; false se o cabeçalho não couber
+bool input_log_begin(input_log_t *log, uint8_t *buf, size_t size, const input_log_snapshot_t *snapshot);
+
+// acrescenta um registro; false (e full) se não couber
+bool input_log_append(input_log_t *log, input_log_type_t type, uint8_t value, uint32_t ms, int32_t extra);
+
+// lê o cabeçalho; false se não for uma gravação válida
+bool input_log_open(input_log_reader_t *reader, const uint8_t *buf, size_t len, input_log_snapshot_t *snapshot);
+
+// próximo registro; false no fim (ou em um registro cortado)
+bool input_log_next(input_log_reader_t *reader, input_log_record_t *record);
+
+const char *input_log_type_name(input_log_type_t type);
+
+#endif
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "input_record.h"
+
+static uint8_t buffer[INPUT_RECORD_SIZE];
+static input_log_t recording;
+static volatile bool pending; // início pedido, esperando o retrato do controlador
+static volatile bool active;
+
+// acrescenta um registro com as interrupções desligadas
+static void record(input_log_type_t type, uint8_t value, uint32_t ms, int32_t extra)
+{
+    uint32_t save = save_and_disable_interrupts();
+    if (active && !input_log_append(&recording, type, value, ms, extra))
+        active = false;
+    restore_interrupts(save);
+}
+
+static uint32_t tick_ms(void)
+{
+    return pdTICKS_TO_MS(xTaskGetTickCount());
+}
+
+void input_record_start(void)
+{
+    uint32_t save = save_and_disable_interrupts();
+    active = false;
+    pending = true;
+    restore_interrupts(save);
+}
+
+void input_record_stop(void)
+{
+    uint32_t save = save_and_disable_interrupts();
+    active = false;
+    pending = false;
+    restore_interrupts(save);
+}
+
+void input_record_prepare(const control_t *control, uint8_t node, bool muted, const preempt_filter_t *detector)
+{
+    if (!pending)
+        return;
+
+    static input_log_snapshot_t snapshot;
+    input_log_capture(&snapshot, control, node, muted);
+
+    uint32_t save = save_and_disable_interrupts();
+    snapshot.detector = *detector;
+    active = input_log_begin(&recording, buffer, sizeof(buffer), &snapshot);
+    pending = false;
+    restore_interrupts(save);
+}
+
+void input_record_inputs(const control_t *control, const control_inputs_t *inputs, uint32_t now_ms)
+{
+    if (!active)
+        return;
+
+    // SÓ AS ENTRADAS QUE MUDARAM DESDE A ÚLTIMA VOLTA; A VOLTA VEM DEPOIS DELAS
+    if (inputs->night != control->inputs.night)
+        record(INPUT_LOG_NIGHT, inputs->night, now_ms, 0);
+    if (inputs->preempt != control->inputs.preempt)
+        record(INPUT_LOG_PREEMPT, inputs->preempt, now_ms, 0);
+    if (inputs->demand != control->inputs.demand)
+        record(INPUT_LOG_DEMAND, inputs->demand, now_ms, 0);
+    record(INPUT_LOG_TICK, 0, now_ms, 0);
+}
+
+void input_record_phase(uint8_t phase, bool toggle, uint32_t now_ms)
+{
+    record(INPUT_LOG_PHASE, phase | toggle << 3, now_ms, 0);
+}
+
+void input_record_shift(int32_t delta_ms, uint32_t now_ms)
+{
+    record(INPUT_LOG_SHIFT, 0, now_ms, delta_ms);
+}
+
+void input_record_set_duration(uint8_t phase, uint32_t duration_ms)
+{
+    uint32_t save = save_and_disable_interrupts();
+    phase_duration_ms[phase] = duration_ms;
+    record(INPUT_LOG_DURATION, phase, tick_ms(), duration_ms);
+    restore_interrupts(save);
+}
+
+void input_record_edge_from_isr(uint8_t button)
+{
+    record(INPUT_LOG_EDGE, button, pdTICKS_TO_MS(xTaskGetTickCountFromISR()), 0);
+}
+
+void input_record_level(uint8_t button, bool pressed)
+{
+    record(INPUT_LOG_LEVEL, button << 1 | pressed, tick_ms(), 0);
+}
+
+void input_record_detector_from_isr(bool level, uint32_t now_ms)
+{
+    record(INPUT_LOG_DETECTOR, level, now_ms, 0);
+}
+
+void input_record_beep(uint8_t phase)
+{
+    record(INPUT_LOG_BEEP, phase, tick_ms(), 0);
+}
+
+void input_record_mute(bool muted)
+{
+    record(INPUT_LOG_MUTE, muted, tick_ms(), 0);
+}
+
+const uint8_t *input_record_data(size_t *len)
+{
+    input_record_stop();
+    *len = recording.used;
+    return buffer;
+}
+
+size_t input_record_report(char *buf, size_t len)
+{
+    size_t used = snprintf(buf, len, "gravando %s, registros %lu, bytes %lu de %u%s\n",
+                           active ? "sim" : pending ? "aguardando" : "nao", (unsigned long)recording.records,
+                           (unsigned long)recording.used, INPUT_RECORD_SIZE, recording.full ? " (cheio)" : "");
+    return used < len ? used : len - 1;
+}
@@ -0,0 +1,62 @@
+#ifndef INPUT_RECORD_H
+#define INPUT_RECORD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "input_log.h"
+
+/*
+    gravação das entradas na placa, para reproduzir no computador (tools/replay_host.c)
+
+    o terminal pede o início (gravar sim) e o controlador tira o retrato do estado na
+    próxima volta; dali em diante cada leitura na fronteira com o hardware vira um
+    registro de lib/input_log.c em um buffer na RAM: o relógio e as entradas de cada volta
+    do controlador, as bordas dos botões e os níveis do detector de emergência (na
+    interrupção), os níveis lidos pela task dos botões, as durações mudadas pelo terminal, as correções da onda verde, as fases
+    publicadas, os toques do buzzer e o mudo. com o buffer cheio a gravação para sozinha
+
+    cada registro é escrito com as interrupções desligadas (alguns bytes), então as
+    funções servem para tasks e interrupções
+*/
+
+#ifndef INPUT_RECORD_SIZE
+#define INPUT_RECORD_SIZE 8192 // ~3 min de ciclo normal (2 bytes a cada 50ms)
+#endif
+
+// pede o início de uma gravação (descarta a anterior) ou para a atual
+void input_record_start(void);
+void input_record_stop(void);
+
+// controlador, no início da volta: começa a gravação pedida com o retrato do estado
+// (o filtro do detector é copiado com as interrupções desligadas, junto com o início)
+void input_record_prepare(const control_t *control, uint8_t node, bool muted, const preempt_filter_t *detector);
+
+// controlador, antes de control_step: as entradas que mudaram e a volta em now_ms
+void input_record_inputs(const control_t *control, const control_inputs_t *inputs, uint32_t now_ms);
+
+// controlador: fase publicada e correção do prazo pela onda verde, no instante da volta
+void input_record_phase(uint8_t phase, bool toggle, uint32_t now_ms);
+void input_record_shift(int32_t delta_ms, uint32_t now_ms);
+
+// muda a duração de uma fase e grava a mudança juntas (o controlador nunca vê uma sem a outra)
+void input_record_set_duration(uint8_t phase, uint32_t duration_ms);
+
+// botões: borda na interrupção e nível lido pela task depois do repique
+void input_record_edge_from_isr(uint8_t button);
+void input_record_level(uint8_t button, bool pressed);
+
+// detector de emergência: nível na interrupção, antes do filtro, no instante entregue ao filtro
+void input_record_detector_from_isr(bool level, uint32_t now_ms);
+
+// toque do buzzer na fase indicada e mudança do mudo
+void input_record_beep(uint8_t phase);
+void input_record_mute(bool muted);
+
+// para a gravação e devolve os bytes gravados (cabeçalho + registros)
+const uint8_t *input_record_data(size_t *len);
+
+// escreve o estado da gravação em buf; retorna a quantidade de caracteres escritos
+size_t input_record_report(char *buf, size_t len);
+
+#endif
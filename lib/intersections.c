@@ -0,0 +1,342 @@
+#include "intersections.h"
+
+uint32_t phase_duration_ms[NUM_PHASES] = {
+    3000, // verde
+    1500, // amarelo
+    4000, // vermelho
+    1000, // pisca do modo noturno
+    5000  // tempo mínimo na preempção
+};
+
+// posição da roda correspondente a um instante
+static inline uint16_t wheel_slot(uint32_t time_ms)
+{
+    return (time_ms / WHEEL_TICK_MS) & (WHEEL_SLOTS - 1);
+}
+
+// true se o instante a já foi alcançado em b (seguro contra overflow do contador)
+static inline bool time_reached(uint32_t a, uint32_t b)
+{
+    return (int32_t)(b - a) >= 0;
+}
+
+// encadeia o cruzamento na posição da roda do seu prazo
+static void wheel_insert(intersections_t *ctl, uint16_t id)
+{
+    uint16_t slot = wheel_slot(ctl->deadline[id]);
+    ctl->next[id] = ctl->wheel[slot];
+    ctl->wheel[slot] = id;
+}
+
+// remove o cruzamento da posição da roda do seu prazo
+static void wheel_remove(intersections_t *ctl, uint16_t id)
+{
+    uint16_t *link = &ctl->wheel[wheel_slot(ctl->deadline[id])];
+
+    while (*link != INTERSECTION_NONE)
+    {
+        if (*link == id)
+        {
+            *link = ctl->next[id];
+            return;
+        }
+        link = &ctl->next[*link];
+    }
+}
+
+// troca a fase do cruzamento e calcula o próximo prazo
+static void advance_phase(intersections_t *ctl, uint16_t id)
+{
+    uint32_t duration;
+
+    if (ctl->flags[id] & INTERSECTION_PREEMPT)
+    {
+        // SEQUÊNCIA DE SEGURANÇA: AMARELO -> VERMELHO CURTO -> PREEMPÇÃO (RETIDA ENQUANTO SOLICITADA)
+        if (ctl->phase[id] == YELLOW_LIGHT)
+        {
+            ctl->phase[id] = RED_LIGHT;
+            duration = PREEMPT_CLEARANCE_MS;
+        }
+        else
+        {
+            ctl->phase[id] = ctl->phase[id] == PREEMPT_MODE || ctl->phase[id] == RED_LIGHT ? PREEMPT_MODE : YELLOW_LIGHT;
+            duration = phase_duration_ms[ctl->phase[id]];
+        }
+    }
+    else if (ctl->flags[id] & INTERSECTION_NIGHT)
+    {
+        ctl->phase[id] = NIGHT_MODE;
+        ctl->flags[id] ^= INTERSECTION_TOGGLE;
+        duration = phase_duration_ms[NIGHT_MODE];
+    }
+    else
+    {
+        // VERDE -> AMARELO -> VERMELHO -> VERDE (A PREEMPÇÃO TERMINA NO VERDE)
+        ctl->phase[id] = ctl->phase[id] >= NIGHT_MODE ? GREEN_LIGHT : (ctl->phase[id] + 1) % NIGHT_MODE;
+        duration = phase_duration_ms[ctl->phase[id]];
+    }
+
+    ctl->deadline[id] += duration;
+    ctl->flags[id] |= INTERSECTION_CHANGED;
+}
+
+void intersections_init(intersections_t *ctl, uint32_t now_ms)
+{
+    for (uint16_t i = 0; i < WHEEL_SLOTS; i++)
+        ctl->wheel[i] = INTERSECTION_NONE;
+
+    ctl->count = 0;
+    ctl->now = now_ms;
+}
+
+int intersections_add(intersections_t *ctl, uint32_t offset_ms)
+{
+    if (ctl->count >= MAX_INTERSECTIONS)
+        return -1;
+
+    uint16_t id = ctl->count++;
+    ctl->phase[id] = GREEN_LIGHT;
+    ctl->flags[id] = INTERSECTION_ACTIVE | INTERSECTION_CHANGED;
+    ctl->deadline[id] = ctl->now + offset_ms + phase_duration_ms[GREEN_LIGHT];
+    wheel_insert(ctl, id);
+
+    return id;
+}
+
+void intersections_restore(intersections_t *ctl, uint16_t id, uint8_t phase, uint32_t remaining_ms)
+{
+    if (id >= ctl->count || phase >= NUM_PHASES)
+        return;
+
+    // UM TEMPO RESTANTE MAIOR QUE A FASE (DURAÇÃO MUDADA OU VALOR CORROMPIDO) VALE A FASE INTEIRA
+    if (remaining_ms > phase_duration_ms[phase])
+        remaining_ms = phase_duration_ms[phase];
+
+    wheel_remove(ctl, id);
+    ctl->phase[id] = phase;
+    ctl->flags[id] &= ~(INTERSECTION_NIGHT | INTERSECTION_TOGGLE);
+    if (phase == NIGHT_MODE)
+        ctl->flags[id] |= INTERSECTION_NIGHT | INTERSECTION_TOGGLE;
+    ctl->deadline[id] = ctl->now + remaining_ms;
+    ctl->flags[id] |= INTERSECTION_CHANGED;
+    wheel_insert(ctl, id);
+}
+
+void intersections_step(intersections_t *ctl, uint32_t now_ms)
+{
+    if (!time_reached(ctl->now, now_ms))
+        return;
+
+    // percorre as posições da roda entre o último instante processado e o atual (no máximo uma volta)
+    uint32_t ticks = (now_ms / WHEEL_TICK_MS) - (ctl->now / WHEEL_TICK_MS) + 1;
+    if (ticks > WHEEL_SLOTS)
+        ticks = WHEEL_SLOTS;
+
+    uint16_t slot = wheel_slot(ctl->now);
+    ctl->now = now_ms;
+
+    for (uint32_t t = 0; t < ticks; t++, slot = (slot + 1) & (WHEEL_SLOTS - 1))
+    {
+        // desencadeia a posição inteira e reinsere cada cruzamento pelo seu novo prazo
+        uint16_t id = ctl->wheel[slot];
+        ctl->wheel[slot] = INTERSECTION_NONE;
+
+        while (id != INTERSECTION_NONE)
+        {
+            uint16_t next = ctl->next[id];
+
+            // prazos de voltas futuras da roda voltam para a mesma posição
+            while (time_reached(ctl->deadline[id], now_ms))
+                advance_phase(ctl, id);
+
+            wheel_insert(ctl, id);
+            id = next;
+        }
+    }
+}
+
+// durante a preempção o modo só é registrado, e é aplicado quando ela terminar
+static bool night_held(const intersections_t *ctl, uint16_t id)
+{
+    return (ctl->flags[id] & INTERSECTION_PREEMPT) || ctl->phase[id] == PREEMPT_MODE;
+}
+
+// aplica o modo a um cruzamento fora da roda (quem chama reencadeia)
+static void night_apply(intersections_t *ctl, uint16_t id, bool night)
+{
+    if (night)
+    {
+        // o pisca começa aceso para a mudança ser percebida imediatamente
+        ctl->flags[id] |= INTERSECTION_NIGHT | INTERSECTION_TOGGLE;
+        ctl->phase[id] = NIGHT_MODE;
+    }
+    else
+    {
+        // ao sair do modo noturno o ciclo recomeça no verde
+        ctl->flags[id] &= ~(INTERSECTION_NIGHT | INTERSECTION_TOGGLE);
+        ctl->phase[id] = GREEN_LIGHT;
+    }
+
+    ctl->deadline[id] = ctl->now + phase_duration_ms[ctl->phase[id]];
+    ctl->flags[id] |= INTERSECTION_CHANGED;
+}
+
+// aplica a preempção a um cruzamento fora da roda; false se o amarelo em andamento segue até o fim
+static bool preempt_apply(intersections_t *ctl, uint16_t id)
+{
+    ctl->flags[id] |= INTERSECTION_PREEMPT;
+
+    // o amarelo em andamento é sempre cumprido até o fim
+    if (ctl->phase[id] == YELLOW_LIGHT)
+        return false;
+
+    // a troca de fase acontece agora, sem esperar o prazo atual
+    ctl->deadline[id] = ctl->now;
+    advance_phase(ctl, id);
+    return true;
+}
+
+// reencadeia todos os cruzamentos de uma vez: O(N) em vez de uma remoção por cruzamento
+static void wheel_rebuild(intersections_t *ctl)
+{
+    for (uint16_t i = 0; i < WHEEL_SLOTS; i++)
+        ctl->wheel[i] = INTERSECTION_NONE;
+    for (uint16_t id = 0; id < ctl->count; id++)
+        wheel_insert(ctl, id);
+}
+
+void intersections_set_night(intersections_t *ctl, uint16_t id, bool night)
+{
+    if (id >= ctl->count || night == !!(ctl->flags[id] & INTERSECTION_NIGHT))
+        return;
+
+    if (night_held(ctl, id))
+    {
+        ctl->flags[id] ^= INTERSECTION_NIGHT;
+        return;
+    }
+
+    wheel_remove(ctl, id);
+    night_apply(ctl, id, night);
+    wheel_insert(ctl, id);
+}
+
+void intersections_set_night_all(intersections_t *ctl, bool night)
+{
+    bool moved = false;
+
+    for (uint16_t id = 0; id < ctl->count; id++)
+    {
+        if (night == !!(ctl->flags[id] & INTERSECTION_NIGHT))
+            continue;
+        if (night_held(ctl, id))
+        {
+            ctl->flags[id] ^= INTERSECTION_NIGHT;
+            continue;
+        }
+        night_apply(ctl, id, night);
+        moved = true;
+    }
+
+    if (moved)
+        wheel_rebuild(ctl);
+}
+
+void intersections_set_preempt(intersections_t *ctl, uint16_t id, bool preempt)
+{
+    if (id >= ctl->count || preempt == !!(ctl->flags[id] & INTERSECTION_PREEMPT))
+        return;
+
+    if (!preempt)
+    {
+        ctl->flags[id] &= ~INTERSECTION_PREEMPT;
+        return;
+    }
+
+    wheel_remove(ctl, id);
+    preempt_apply(ctl, id);
+    wheel_insert(ctl, id);
+}
+
+void intersections_set_preempt_all(intersections_t *ctl, bool preempt)
+{
+    bool moved = false;
+
+    for (uint16_t id = 0; id < ctl->count; id++)
+    {
+        if (preempt == !!(ctl->flags[id] & INTERSECTION_PREEMPT))
+            continue;
+        if (!preempt)
+            ctl->flags[id] &= ~INTERSECTION_PREEMPT;
+        else
+            moved |= preempt_apply(ctl, id);
+    }
+
+    if (moved)
+        wheel_rebuild(ctl);
+}
+
+uint32_t intersections_next_deadline(const intersections_t *ctl)
+{
+    uint32_t next = ctl->now + WHEEL_SLOTS * WHEEL_TICK_MS;
+
+    for (uint16_t i = 0; i < ctl->count; i++)
+    {
+        if ((int32_t)(ctl->deadline[i] - next) < 0)
+            next = ctl->deadline[i];
+    }
+    return next;
+}
+
+uint32_t intersections_cycle_length(void)
+{
+    return phase_duration_ms[GREEN_LIGHT] + phase_duration_ms[YELLOW_LIGHT] + phase_duration_ms[RED_LIGHT];
+}
+
+uint32_t intersections_cycle_position(const intersections_t *ctl, uint16_t id)
+{
+    uint8_t phase = ctl->phase[id];
+    if (phase >= NIGHT_MODE)
+        return 0;
+
+    // soma as fases já concluídas e o tempo decorrido na fase atual
+    uint32_t position = 0;
+    for (uint8_t p = GREEN_LIGHT; p < phase; p++)
+        position += phase_duration_ms[p];
+
+    int32_t remaining = (int32_t)(ctl->deadline[id] - ctl->now);
+    if (remaining < 0)
+        remaining = 0;
+    if ((uint32_t)remaining > phase_duration_ms[phase])
+        remaining = phase_duration_ms[phase];
+
+    return position + phase_duration_ms[phase] - remaining;
+}
+
+uint32_t intersections_remaining(const intersections_t *ctl, uint16_t id, uint32_t now_ms)
+{
+    int32_t remaining = (int32_t)(ctl->deadline[id] - now_ms);
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+void intersections_shift(intersections_t *ctl, uint16_t id, int32_t delta_ms)
+{
+    if (id >= ctl->count || delta_ms == 0)
+        return;
+
+    wheel_remove(ctl, id);
+    ctl->deadline[id] += delta_ms;
+
+    // UM PRAZO ANTES DO ÚLTIMO INSTANTE PROCESSADO CAIRIA NUMA POSIÇÃO DA RODA QUE JÁ PASSOU E SÓ
+    // SERIA VISTO NA VOLTA SEGUINTE DA RODA: VENCE NO PRÓXIMO intersections_step
+    if (!time_reached(ctl->now, ctl->deadline[id]))
+        ctl->deadline[id] = ctl->now;
+    wheel_insert(ctl, id);
+}
+
+bool intersections_take_changed(intersections_t *ctl, uint16_t id)
+{
+    bool changed = ctl->flags[id] & INTERSECTION_CHANGED;
+    ctl->flags[id] &= ~INTERSECTION_CHANGED;
+    return changed;
+}
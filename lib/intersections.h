@@ -0,0 +1,99 @@
+#ifndef INTERSECTIONS_H
+#define INTERSECTIONS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// quantidade maxima de cruzamentos virtuais controlados pelo mesmo núcleo
+#ifndef MAX_INTERSECTIONS
+#define MAX_INTERSECTIONS 16
+#endif
+
+#define WHEEL_TICK_MS 50           // resolução de cada posição da roda de temporização
+#define WHEEL_SLOTS 64             // quantidade de posições da roda (potência de 2)
+#define INTERSECTION_NONE 0xFFFF   // fim da lista encadeada de uma posição da roda
+
+// flags de cada cruzamento
+#define INTERSECTION_ACTIVE (1 << 0)  // cruzamento em uso
+#define INTERSECTION_NIGHT (1 << 1)   // modo noturno habilitado
+#define INTERSECTION_TOGGLE (1 << 2)  // estado do pisca no modo noturno
+#define INTERSECTION_CHANGED (1 << 3) // fase mudou desde a última leitura
+#define INTERSECTION_PREEMPT (1 << 4) // preempção por veículo de emergência solicitada
+
+#define PREEMPT_CLEARANCE_MS 1000 // vermelho de segurança antes de entrar na preempção
+
+// controle do modo do semáforo
+typedef enum
+{
+    GREEN_LIGHT,
+    YELLOW_LIGHT,
+    RED_LIGHT,
+    NIGHT_MODE,
+    PREEMPT_MODE,
+    NUM_PHASES
+} traffic_light_state;
+
+/*
+    estado de todos os cruzamentos organizado como struct-of-arrays
+    cada cruzamento é apenas um índice nos vetores abaixo (8 bytes por cruzamento)
+    e fica encadeado na posição da roda correspondente ao seu prazo
+*/
+typedef struct
+{
+    uint8_t phase[MAX_INTERSECTIONS];     // fase atual (traffic_light_state)
+    uint8_t flags[MAX_INTERSECTIONS];     // flags INTERSECTION_*
+    uint32_t deadline[MAX_INTERSECTIONS]; // instante (ms) da próxima troca de fase
+    uint16_t next[MAX_INTERSECTIONS];     // próximo cruzamento na mesma posição da roda
+    uint16_t wheel[WHEEL_SLOTS];          // primeiro cruzamento de cada posição da roda
+    uint16_t count;                       // quantidade de cruzamentos em uso
+    uint32_t now;                         // último instante processado (ms)
+} intersections_t;
+
+// duração de cada fase em ms (no modo noturno é o período do pisca e na preempção o tempo mínimo retido)
+extern uint32_t phase_duration_ms[NUM_PHASES];
+
+// inicializa o controlador sem nenhum cruzamento
+void intersections_init(intersections_t *ctl, uint32_t now_ms);
+
+// adiciona um cruzamento começando no verde, defasado de offset_ms; retorna o índice ou -1
+int intersections_add(intersections_t *ctl, uint32_t offset_ms);
+
+// retoma um cruzamento na fase e no tempo restante salvos antes de um reset (o pisca volta aceso)
+void intersections_restore(intersections_t *ctl, uint16_t id, uint8_t phase, uint32_t remaining_ms);
+
+// avança todos os cruzamentos cujo prazo venceu até now_ms
+void intersections_step(intersections_t *ctl, uint32_t now_ms);
+
+// liga ou desliga o modo noturno de um cruzamento
+void intersections_set_night(intersections_t *ctl, uint16_t id, bool night);
+
+// o mesmo em todos os cruzamentos, reencadeando a roda uma vez só (O(N) em vez de O(N²))
+void intersections_set_night_all(intersections_t *ctl, bool night);
+
+/*
+    liga ou desliga a preempção de um cruzamento
+    ao ligar: verde/noturno -> amarelo -> vermelho de segurança -> PREEMPT_MODE; vermelho -> PREEMPT_MODE
+    ao desligar: a fase PREEMPT_MODE termina no próximo prazo e o ciclo recomeça no verde
+*/
+void intersections_set_preempt(intersections_t *ctl, uint16_t id, bool preempt);
+void intersections_set_preempt_all(intersections_t *ctl, bool preempt);
+
+// posição (ms) do cruzamento dentro do ciclo verde-amarelo-vermelho, contada do início do verde
+uint32_t intersections_cycle_position(const intersections_t *ctl, uint16_t id);
+
+// tempo (ms) até a próxima troca de fase do cruzamento, 0 se o prazo já venceu
+uint32_t intersections_remaining(const intersections_t *ctl, uint16_t id, uint32_t now_ms);
+
+// prazo (ms) mais próximo entre todos os cruzamentos, para o controlador dormir até ele
+uint32_t intersections_next_deadline(const intersections_t *ctl);
+
+// duração total de um ciclo verde-amarelo-vermelho em ms
+uint32_t intersections_cycle_length(void);
+
+// adianta (delta_ms < 0) ou atrasa (delta_ms > 0) o prazo da fase atual do cruzamento (no máximo até o último instante processado)
+void intersections_shift(intersections_t *ctl, uint16_t id, int32_t delta_ms);
+
+// retorna true (e limpa a flag) se a fase do cruzamento mudou desde a última chamada
+bool intersections_take_changed(intersections_t *ctl, uint16_t id);
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef LED_FRAME_HPP
+#define LED_FRAME_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    gerador de quadros da matriz WS2812 em tempo de compilação
+
+    tudo aqui é constexpr: os quadros são montados pelo compilador e o firmware só guarda
+    as palavras GRB prontas para a PIO, sem nenhum cálculo em float em tempo de execução
+
+    - color / encode: cor + intensidade -> palavra GRB (mesmo resultado de matrix_rgb)
+    - level / encode_level: cor + intensidade -> brilho com fração (8.8) para o pontilhamento temporal
+    - layout: posição (x, y) -> índice do LED na fita, com ligação em zigue-zague (serpentina)
+    - canvas / layer: desenho em coordenadas (x, y) e composição de camadas com transparência
+    - wire: converte o canvas na ordem dos LEDs na fita
+*/
+namespace led_frame
+{
+
+    struct color
+    {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+    };
+
+    constexpr color black{0, 0, 0};
+    constexpr color red{255, 0, 0};
+    constexpr color yellow{255, 255, 0};
+    constexpr color green{0, 255, 0};
+    constexpr color gray{55, 55, 55};
+
+    // mesma conta de matrix_rgb (lib/leds.c): o canal é multiplicado em float e truncado
+    constexpr uint32_t encode(color c, float intensity)
+    {
+        uint32_t r = static_cast<uint8_t>(c.red * intensity);
+        uint32_t g = static_cast<uint8_t>(c.green * intensity);
+        uint32_t b = static_cast<uint8_t>(c.blue * intensity);
+        return (g << 24) | (r << 16) | (b << 8);
+    }
+
+    // brilho de cada canal em ponto fixo 8.8 (parte inteira = nível de 0 a 255)
+    struct level
+    {
+        uint16_t green;
+        uint16_t red;
+        uint16_t blue;
+    };
+
+    constexpr bool operator==(level a, level b)
+    {
+        return a.green == b.green && a.red == b.red && a.blue == b.blue;
+    }
+
+    constexpr bool operator!=(level a, level b)
+    {
+        return !(a == b);
+    }
+
+    // sem truncar: a fração que o matrix_rgb perdia é mantida em 1/256 de nível
+    constexpr uint16_t channel_level(uint8_t value, float intensity)
+    {
+        float scaled = value * intensity * 256.0f + 0.5f;
+        return scaled >= 0xFF00 ? 0xFF00 : static_cast<uint16_t>(scaled);
+    }
+
+    constexpr level encode_level(color c, float intensity)
+    {
+        return {channel_level(c.green, intensity), channel_level(c.red, intensity), channel_level(c.blue, intensity)};
+    }
+
+    /*
+        ordem dos LEDs na fita para um painel W x H
+
+        a linha 0 é a primeira da fita; com serpentine as linhas ímpares são percorridas
+        da direita para a esquerda, como nas matrizes ligadas em zigue-zague
+    */
+    template <std::size_t W, std::size_t H, bool Serpentine>
+    struct layout
+    {
+        static constexpr std::size_t width = W;
+        static constexpr std::size_t height = H;
+        static constexpr std::size_t size = W * H;
+
+        static constexpr std::size_t index(std::size_t x, std::size_t y)
+        {
+            return y * W + ((Serpentine && (y & 1)) ? W - 1 - x : x);
+        }
+    };
+
+    // imagem em coordenadas (x, y), linha a linha; o pixel é uma palavra GRB ou um level
+    template <std::size_t W, std::size_t H, typename Pixel = uint32_t>
+    struct canvas
+    {
+        std::array<Pixel, W * H> pixels{};
+
+        constexpr void set(std::size_t x, std::size_t y, Pixel value)
+        {
+            pixels[y * W + x] = value;
+        }
+
+        constexpr Pixel get(std::size_t x, std::size_t y) const
+        {
+            return pixels[y * W + x];
+        }
+    };
+
+    // camada para composição: só os pixels marcados em mask são desenhados
+    template <std::size_t W, std::size_t H, typename Pixel = uint32_t>
+    struct layer
+    {
+        canvas<W, H, Pixel> image{};
+        std::array<bool, W * H> mask{};
+
+        constexpr void set(std::size_t x, std::size_t y, Pixel value)
+        {
+            image.set(x, y, value);
+            mask[y * W + x] = true;
+        }
+    };
+
+    // desenha a camada sobre o canvas, mantendo os pixels transparentes da camada
+    template <std::size_t W, std::size_t H, typename Pixel>
+    constexpr canvas<W, H, Pixel> overlay(canvas<W, H, Pixel> base, const layer<W, H, Pixel> &top)
+    {
+        for (std::size_t i = 0; i < W * H; i++)
+        {
+            if (top.mask[i])
+                base.pixels[i] = top.image.pixels[i];
+        }
+        return base;
+    }
+
+    // converte o canvas para a ordem de envio dos LEDs
+    template <typename Layout, typename Pixel>
+    constexpr std::array<Pixel, Layout::size> wire(const canvas<Layout::width, Layout::height, Pixel> &image)
+    {
+        std::array<Pixel, Layout::size> out{};
+        for (std::size_t y = 0; y < Layout::height; y++)
+        {
+            for (std::size_t x = 0; x < Layout::width; x++)
+                out[Layout::index(x, y)] = image.get(x, y);
+        }
+        return out;
+    }
+
+    // comparação em tempo de compilação (std::array::operator== só é constexpr no C++20)
+    template <typename Pixel, std::size_t N>
+    constexpr bool equal(const std::array<Pixel, N> &a, const std::array<Pixel, N> &b)
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            if (a[i] != b[i])
+                return false;
+        }
+        return true;
+    }
+
+}
+
+#endif
@@ -0,0 +1,240 @@
+#include <string.h>
+#include "hardware/dma.h"
+#include "hardware/clocks.h"
+#include "led_panel.h"
+#include "pio_matrix.pio.h"
+
+// palavras da DMA por posição na fita com várias fitas (24 tempos de bit de 1 byte)
+#define PARALLEL_WORDS 6
+
+void led_panel_init(led_panel_t *panel, PIO pio, uint pin_base, uint8_t strings, uint16_t width, uint16_t height,
+                    bool serpentine, uint8_t *framebuffer, uint32_t *dma_buffer)
+{
+    // cada fita cobre o mesmo número de linhas
+    hard_assert(strings >= 1 && strings <= LED_PANEL_MAX_STRINGS && height % strings == 0);
+
+    panel->pio = pio;
+    panel->width = width;
+    panel->height = height;
+    panel->strings = strings;
+    panel->serpentine = serpentine;
+    panel->string_length = width * (height / strings);
+    panel->framebuffer = framebuffer;
+    panel->dma_buffer = dma_buffer;
+    panel->frame_end_us = time_us_32();
+
+    // uma fita usa o mesmo programa da matriz da placa; várias usam o programa paralelo
+    panel->sm = pio_claim_unused_sm(pio, true);
+    if (strings == 1)
+    {
+        panel->program_offset = pio_add_program(pio, &pio_matrix_program);
+        pio_matrix_program_init(pio, panel->sm, panel->program_offset, pin_base);
+    }
+    else
+    {
+        panel->program_offset = pio_add_program(pio, &pio_matrix_parallel_program);
+        pio_matrix_parallel_program_init(pio, panel->sm, panel->program_offset, pin_base, strings);
+    }
+
+    // DMA da memória para o FIFO da PIO, no ritmo do DREQ da state machine
+    panel->dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(panel->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, panel->sm, true));
+    dma_channel_configure(panel->dma_channel, &config, &pio->txf[panel->sm], dma_buffer, 0, false);
+
+    led_panel_fill(panel, 0, 0, 0);
+}
+
+void led_panel_deinit(led_panel_t *panel)
+{
+    led_panel_wait(panel);
+
+    pio_sm_set_enabled(panel->pio, panel->sm, false);
+    pio_remove_program(panel->pio, panel->strings == 1 ? &pio_matrix_program : &pio_matrix_parallel_program,
+                       panel->program_offset);
+    pio_sm_unclaim(panel->pio, panel->sm);
+    dma_channel_unclaim(panel->dma_channel);
+}
+
+// fita e posição na fita de um pixel
+static uint16_t led_panel_position(const led_panel_t *panel, uint16_t x, uint16_t y)
+{
+    uint16_t rows = panel->height / panel->strings;
+    uint16_t row = y % rows;
+    uint16_t column = (panel->serpentine && (row & 1)) ? panel->width - 1 - x : x;
+    return row * panel->width + column;
+}
+
+// pixel de uma fita em uma posição (inverso de led_panel_position)
+static const uint8_t *led_panel_pixel(const led_panel_t *panel, uint8_t string, uint16_t position)
+{
+    uint16_t rows = panel->height / panel->strings;
+    uint16_t row = position / panel->width;
+    uint16_t column = position % panel->width;
+    uint16_t x = (panel->serpentine && (row & 1)) ? panel->width - 1 - column : column;
+    uint16_t y = string * rows + row;
+    return &panel->framebuffer[(y * panel->width + x) * 3];
+}
+
+static void led_panel_mark(led_panel_t *panel, uint16_t position)
+{
+    if (!panel->dirty)
+    {
+        panel->dirty = true;
+        panel->dirty_first = panel->dirty_last = position;
+    }
+    else if (position < panel->dirty_first)
+        panel->dirty_first = position;
+    else if (position > panel->dirty_last)
+        panel->dirty_last = position;
+}
+
+void led_panel_set(led_panel_t *panel, int x, int y, uint8_t r, uint8_t g, uint8_t b)
+{
+    if (x < 0 || y < 0 || x >= panel->width || y >= panel->height)
+        return;
+
+    uint8_t *pixel = &panel->framebuffer[(y * panel->width + x) * 3];
+    if (pixel[0] == g && pixel[1] == r && pixel[2] == b)
+        return; // nada mudou, a posição não precisa ser enviada
+
+    pixel[0] = g;
+    pixel[1] = r;
+    pixel[2] = b;
+    led_panel_mark(panel, led_panel_position(panel, x, y));
+}
+
+void led_panel_fill_rect(led_panel_t *panel, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b)
+{
+    // recorta a região nos limites do painel
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > panel->width ? panel->width : x + w;
+    int y1 = y + h > panel->height ? panel->height : y + h;
+
+    for (int j = y0; j < y1; j++)
+    {
+        for (int i = x0; i < x1; i++)
+            led_panel_set(panel, i, j, r, g, b);
+    }
+}
+
+void led_panel_fill(led_panel_t *panel, uint8_t r, uint8_t g, uint8_t b)
+{
+    for (uint32_t i = 0; i < (uint32_t)panel->width * panel->height; i++)
+    {
+        panel->framebuffer[i * 3] = g;
+        panel->framebuffer[i * 3 + 1] = r;
+        panel->framebuffer[i * 3 + 2] = b;
+    }
+
+    // o painel inteiro é reenviado
+    panel->dirty = true;
+    panel->dirty_first = 0;
+    panel->dirty_last = panel->string_length - 1;
+}
+
+// codifica as posições first a last no formato da PIO
+static void led_panel_encode(led_panel_t *panel, uint16_t first, uint16_t last)
+{
+    if (panel->strings == 1)
+    {
+        // uma palavra por LED, GRB nos 24 bits de cima (mesmo formato de matrix_rgb)
+        for (uint16_t p = first; p <= last; p++)
+        {
+            const uint8_t *pixel = led_panel_pixel(panel, 0, p);
+            panel->dma_buffer[p] = (pixel[0] << 24) | (pixel[1] << 16) | (pixel[2] << 8);
+        }
+        return;
+    }
+
+    // um byte por tempo de bit, com o bit n vindo da fita n (MSB de G primeiro)
+    for (uint16_t p = first; p <= last; p++)
+    {
+        uint8_t *slots = (uint8_t *)&panel->dma_buffer[p * PARALLEL_WORDS];
+        memset(slots, 0, PARALLEL_WORDS * 4);
+
+        for (uint8_t s = 0; s < panel->strings; s++)
+        {
+            const uint8_t *pixel = led_panel_pixel(panel, s, p);
+            for (uint8_t k = 0; k < 3; k++)
+            {
+                for (uint8_t bit = 0; bit < 8; bit++)
+                {
+                    if (pixel[k] & (0x80 >> bit))
+                        slots[k * 8 + bit] |= 1 << s;
+                }
+            }
+        }
+    }
+}
+
+bool led_panel_busy(led_panel_t *panel)
+{
+    return dma_channel_is_busy(panel->dma_channel) || (int32_t)(time_us_32() - panel->frame_end_us) < 0;
+}
+
+void led_panel_wait(led_panel_t *panel)
+{
+    dma_channel_wait_for_finish_blocking(panel->dma_channel);
+
+    // o FIFO ainda esvazia depois da DMA; o fim previsto já inclui o reset
+    int32_t remaining = (int32_t)(panel->frame_end_us - time_us_32());
+    if (remaining > 0)
+        sleep_us(remaining);
+}
+
+bool led_panel_show(led_panel_t *panel)
+{
+    if (!panel->dirty)
+        return false;
+
+    // o buffer da DMA só pode mudar depois do envio anterior
+    led_panel_wait(panel);
+
+    led_panel_encode(panel, panel->dirty_first, panel->dirty_last);
+
+    // envia até a última posição alterada
+    uint32_t positions = panel->dirty_last + 1;
+    uint32_t words = panel->strings == 1 ? positions : positions * PARALLEL_WORDS;
+    dma_channel_transfer_from_buffer_now(panel->dma_channel, panel->dma_buffer, words);
+
+    panel->frame_end_us = time_us_32() + positions * 24 * LED_PANEL_BIT_NS / 1000 + LED_PANEL_RESET_US;
+    panel->dirty = false;
+    return true;
+}
+
+void led_panel_benchmark(led_panel_t *panel, led_panel_bench_t *result)
+{
+    led_panel_wait(panel);
+
+    result->leds = (uint32_t)panel->width * panel->height;
+
+    uint32_t start = time_us_32();
+    led_panel_encode(panel, 0, panel->string_length - 1);
+    result->encode_us = time_us_32() - start;
+
+    // O ENVIO É MEDIDO ATÉ A STATE MACHINE PARAR POR FALTA DE DADOS (TXSTALL), E NÃO PELA PREVISÃO COM
+    // LED_PANEL_BIT_NS DE led_panel_wait: ASSIM O TEMPO DE BIT QUE SAI É O DO DIVISOR DE CLOCK DE VERDADE
+    uint32_t words = panel->strings == 1 ? panel->string_length : panel->string_length * PARALLEL_WORDS;
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + panel->sm);
+    start = time_us_32();
+    dma_channel_transfer_from_buffer_now(panel->dma_channel, panel->dma_buffer, words);
+    dma_channel_wait_for_finish_blocking(panel->dma_channel);
+
+    // COM A DMA NO FIM O FIFO AINDA TEM DADOS: O PRÓXIMO TXSTALL É O FIM DO ÚLTIMO BIT
+    panel->pio->fdebug = stall;
+    while (!(panel->pio->fdebug & stall))
+        tight_loop_contents();
+    result->send_us = time_us_32() - start;
+
+    panel->frame_end_us = time_us_32() + LED_PANEL_RESET_US;
+    panel->dirty = false;
+
+    result->bit_ns = (uint64_t)result->send_us * 1000 / ((uint32_t)panel->string_length * 24);
+    result->frame_us = result->encode_us + result->send_us + LED_PANEL_RESET_US;
+    result->refresh_hz = 1000000 / result->frame_us;
+}
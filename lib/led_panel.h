@@ -0,0 +1,87 @@
+#ifndef LED_PANEL_H
+#define LED_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+/*
+    painel de LEDs WS2812 de qualquer tamanho
+
+    o painel tem width x height pixels, dividido em strings fitas ligadas em pinos
+    consecutivos (1 a 8); cada fita cobre height / strings linhas encadeadas, em
+    zigue-zague se serpentine for true
+
+    o framebuffer guarda 3 bytes (G, R, B) por pixel; led_panel_show codifica só as
+    posições alteradas e a DMA envia o quadro para a PIO sem usar a CPU. como cada LED
+    repassa adiante o que não é seu, o envio para na última posição alterada: os LEDs
+    depois dela mantêm a cor anterior
+
+    os buffers são de quem chama (normalmente static), com os tamanhos das macros abaixo
+*/
+
+#define LED_PANEL_MAX_STRINGS 8
+#define LED_PANEL_BIT_NS 1250  // 10 ciclos a 8MHz por bit (divisor fracionário da PIO: 15,625 a 125MHz)
+#define LED_PANEL_RESET_US 300 // tempo em nível baixo para os LEDs aplicarem o quadro (WS2812B-V5 pede 280us)
+
+// bytes do framebuffer de um painel w x h
+#define LED_PANEL_FRAMEBUFFER_BYTES(w, h) ((w) * (h) * 3)
+
+// palavras do buffer da DMA: uma por LED com uma fita; com várias fitas, 24 bytes (um por tempo de bit) por posição
+#define LED_PANEL_DMA_WORDS(w, h, strings) ((strings) == 1 ? (w) * (h) : (w) * (h) / (strings) * 6)
+
+typedef struct
+{
+    PIO pio;
+    uint sm;
+    uint program_offset;
+    uint dma_channel;
+    uint16_t width;
+    uint16_t height;
+    uint8_t strings;          // fitas em paralelo
+    bool serpentine;          // linhas ímpares de cada fita ligadas ao contrário
+    uint16_t string_length;   // LEDs em cada fita
+    uint8_t *framebuffer;     // 3 bytes (G, R, B) por pixel, linha a linha
+    uint32_t *dma_buffer;     // quadro codificado no formato da PIO
+    bool dirty;               // há posições alteradas desde o último envio
+    uint16_t dirty_first;     // primeira posição alterada (em todas as fitas)
+    uint16_t dirty_last;      // última posição alterada
+    uint32_t frame_end_us;    // fim previsto do envio atual, já com o reset
+} led_panel_t;
+
+typedef struct
+{
+    uint32_t leds;
+    uint32_t encode_us;       // CPU para codificar o quadro inteiro
+    uint32_t send_us;         // envio medido: do início da DMA até a PIO parar sem dados
+    uint32_t bit_ns;          // tempo de bit medido (send_us / bits de uma fita)
+    uint32_t frame_us;        // codificação + envio + reset
+    uint32_t refresh_hz;      // quadros completos por segundo
+} led_panel_bench_t;
+
+// inicializa a PIO (programa de 1 fita ou paralelo), a DMA e limpa o painel
+void led_panel_init(led_panel_t *panel, PIO pio, uint pin_base, uint8_t strings, uint16_t width, uint16_t height,
+                    bool serpentine, uint8_t *framebuffer, uint32_t *dma_buffer);
+
+// espera o último quadro e devolve a state machine, o programa da PIO e o canal de DMA
+void led_panel_deinit(led_panel_t *panel);
+
+// desenho no framebuffer (coordenadas fora do painel são ignoradas)
+void led_panel_set(led_panel_t *panel, int x, int y, uint8_t r, uint8_t g, uint8_t b);
+void led_panel_fill_rect(led_panel_t *panel, int x, int y, int w, int h, uint8_t r, uint8_t g, uint8_t b);
+void led_panel_fill(led_panel_t *panel, uint8_t r, uint8_t g, uint8_t b);
+
+// envia as posições alteradas; retorna false se não havia nada para enviar
+bool led_panel_show(led_panel_t *panel);
+
+// true enquanto o quadro anterior ainda está sendo enviado ou aplicado
+bool led_panel_busy(led_panel_t *panel);
+
+// espera o fim do envio e do reset do quadro anterior
+void led_panel_wait(led_panel_t *panel);
+
+// mede no hardware a codificação e o envio de um quadro completo (usado pelo comando "painel" do semafaro-bench)
+void led_panel_benchmark(led_panel_t *panel, led_panel_bench_t *result);
+
+#endif
@@ -19,6 +19,15 @@ void draw_pio(pixel *draw, PIO pio, uint sm)
     }
 }
 
+// Rotina para acionar a matriz de LEDs com um quadro pré-codificado
+void draw_pio_words(const uint32_t *words, PIO pio, uint sm)
+{
+    for (int16_t i = 0; i < PIXELS; i++)
+    {
+        pio_sm_put_blocking(pio, sm, words[i]);
+    }
+}
+
 // testa a matriz de leds
 void test_matrix(PIO pio, uint sm)
 {
@@ -124,45 +133,34 @@ pixel handle_color(color_options color, float intensity)
 */
 void draw_traffic_light(PIO pio, uint sm, color_options color, bool night_mode)
 {
-
-    pixel pixel_color = handle_color(color, 1);
-    pixel black = handle_color(BLACK, 1);
-    pixel gray = handle_color(GRAY, 0.05f);
-    pixel red = handle_color(RED, 0.01f);
-    pixel green = handle_color(GREEN, 0.01f);
-    pixel yellow = handle_color(YELLOW, 0.01f);
-
-    frame matrix = {
-        black, gray, gray, gray, black,
-        black, gray, green, gray, black,
-        black, gray, yellow, gray, black,
-        black, gray, red, gray, black,
-        black, gray, gray, gray, black};
-
-    if (night_mode)
-    { // se estiver no modo noturno mantem o led vermelho e verde apagado
-        matrix[17].intensity = 0;
-        matrix[7].intensity = 0;
-    }
+    // os quadros são montados em tempo de compilação (lib/traffic_frames.cpp), com a intensidade de cada LED aplicada
+    const traffic_frame_t *matrix = &traffic_frame_off;
 
     if (color == RED)
     {
-        matrix[17].intensity = 1;
+        matrix = &traffic_frame_red;
     }
     else if (color == GREEN)
     {
-        matrix[7].intensity = 1;
+        matrix = &traffic_frame_green;
     }
     else if (color == YELLOW)
     {
-        matrix[12].intensity = 1;
-    }
-    else if (color == BLACK)
-    {
-        matrix[17] = black;
-        matrix[7] = black;
-        matrix[12] = black;
+        // se estiver no modo noturno mantem o led vermelho e verde apagado
+        matrix = night_mode ? &traffic_frame_night : &traffic_frame_yellow;
     }
 
-    draw_pio(matrix, pio, sm);
-}
\ No newline at end of file
+    draw_pio_words(matrix->words, pio, sm);
+}
+
+const traffic_levels_t *traffic_light_levels(color_options color, bool night_mode)
+{
+    if (color == RED)
+        return &traffic_levels_red;
+    if (color == GREEN)
+        return &traffic_levels_green;
+    if (color == YELLOW)
+        return night_mode ? &traffic_levels_night : &traffic_levels_yellow;
+
+    return &traffic_levels_off;
+}
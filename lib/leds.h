@@ -4,9 +4,16 @@
 #include <stdint.h>
 #include "hardware/pio.h"
 #include "pico/stdlib.h"
+#include "asset.h"
+#include "traffic_frames.h"
 
+// matriz 5x5 da placa; painéis maiores usam lib/led_panel.h
+#ifndef PIXELS
 #define PIXELS 25
+#endif
+#ifndef LED_PIN
 #define LED_PIN 7
+#endif
 
 typedef struct
 {
@@ -51,9 +58,15 @@ uint32_t matrix_rgb(uint r, uint g, uint b, float intensity);
 // Função para acionar a matriz de LEDs WS2812B
 void draw_pio(pixel *draw, PIO pio, uint sm);
 
+// envia um quadro já codificado em GRB (montado em tempo de compilação)
+void draw_pio_words(const uint32_t *words, PIO pio, uint sm);
+
 void test_matrix(PIO pio, uint sm);
 
 // desenha um semáfaro com a cor indicada
 void draw_traffic_light(PIO pio, uint sm, color_options color, bool night_mode);
 
+// o mesmo quadro do semáforo em níveis 8.8, para o pontilhamento temporal (matrix_dither_show)
+const traffic_levels_t *traffic_light_levels(color_options color, bool night_mode);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef LWIPOPTS_H
+#define LWIPOPTS_H
+
+// lwIP com o FreeRTOS (pico_cyw43_arch_lwip_sys_freertos), usado só pela telemetria (TELEMETRY=ON)
+
+#define NO_SYS                          0
+#define LWIP_SOCKET                     0
+#define LWIP_NETCONN                    0
+#define LWIP_TCPIP_CORE_LOCKING_INPUT   1
+#define LWIP_TIMEVAL_PRIVATE            0
+
+// thread do lwIP na menor prioridade: a rede nunca disputa o núcleo com o semáforo
+#define TCPIP_THREAD_PRIO               1
+#define TCPIP_THREAD_STACKSIZE          1024
+#define DEFAULT_THREAD_STACKSIZE        1024
+#define TCPIP_MBOX_SIZE                 8
+#define DEFAULT_RAW_RECVMBOX_SIZE       8
+#define DEFAULT_UDP_RECVMBOX_SIZE       8
+#define DEFAULT_TCP_RECVMBOX_SIZE       8
+#define DEFAULT_ACCEPTMBOX_SIZE         8
+
+// memória
+#define MEM_LIBC_MALLOC                 0
+#define MEM_ALIGNMENT                   4
+#define MEM_SIZE                        8000
+#define MEMP_NUM_TCP_SEG                32
+#define MEMP_NUM_ARP_QUEUE              10
+#define MEMP_NUM_SYS_TIMEOUT            (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1) // + keep-alive do MQTT
+#define PBUF_POOL_SIZE                  16
+
+// protocolos
+#define LWIP_ARP                        1
+#define LWIP_ETHERNET                   1
+#define LWIP_IPV4                       1
+#define LWIP_ICMP                       1
+#define LWIP_RAW                        1
+#define LWIP_TCP                        1
+#define LWIP_UDP                        1
+#define LWIP_DNS                        1
+#define LWIP_DHCP                       1
+#define DHCP_DOES_ARP_CHECK             0
+#define LWIP_DHCP_DOES_ACD_CHECK        0
+#define LWIP_TCP_KEEPALIVE              1
+#define TCP_MSS                         1460
+#define TCP_WND                         (4 * TCP_MSS)
+#define TCP_SND_BUF                     (4 * TCP_MSS)
+#define TCP_SND_QUEUELEN                ((4 * (TCP_SND_BUF) + (TCP_MSS - 1)) / (TCP_MSS))
+#define LWIP_CHKSUM_ALGORITHM           3
+
+// interface do cyw43
+#define LWIP_NETIF_STATUS_CALLBACK      1
+#define LWIP_NETIF_LINK_CALLBACK        1
+#define LWIP_NETIF_HOSTNAME             1
+#define LWIP_NETIF_TX_SINGLE_PBUF       1
+
+// MQTT: o buffer de saída limita os lotes pendentes (cheio = lote descartado)
+#define MQTT_OUTPUT_RINGBUF_SIZE        1024
+#define MQTT_REQ_MAX_IN_FLIGHT          4
+
+// sem estatísticas nem depuração do lwIP
+#define LWIP_STATS                      0
+#define LWIP_DEBUG                      0
+
+#endif
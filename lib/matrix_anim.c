@@ -0,0 +1,138 @@
+#include "matrix_anim.h"
+
+// (1 - cos(pi * t)) / 2 em Q16, t = i / 64
+static const uint16_t ease_in_out_lut[ANIM_LUT_STEPS + 1] = {
+        0,    39,   158,   355,   630,   982,  1411,  1915,
+     2494,  3146,  3869,  4662,  5522,  6448,  7438,  8488,
+     9597, 10762, 11980, 13248, 14563, 15922, 17321, 18758,
+    20228, 21728, 23256, 24806, 26375, 27960, 29556, 31160,
+    32767, 34375, 35979, 37575, 39160, 40729, 42279, 43807,
+    45307, 46777, 48214, 49613, 50972, 52287, 53555, 54773,
+    55938, 57047, 58097, 59087, 60013, 60873, 61666, 62389,
+    63041, 63620, 64124, 64553, 64905, 65180, 65377, 65496,
+    65535};
+
+// 1 - (1 - t)^2 em Q16, t = i / 64
+static const uint16_t ease_out_lut[ANIM_LUT_STEPS + 1] = {
+        0,  2032,  4032,  6000,  7936,  9840, 11712, 13552,
+    15360, 17136, 18880, 20592, 22272, 23920, 25536, 27120,
+    28672, 30192, 31680, 33135, 34559, 35951, 37311, 38639,
+    39935, 41199, 42431, 43631, 44799, 45935, 47039, 48111,
+    49151, 50159, 51135, 52079, 52991, 53871, 54719, 55535,
+    56319, 57071, 57791, 58479, 59135, 59759, 60351, 60911,
+    61439, 61935, 62399, 62831, 63231, 63599, 63935, 64239,
+    64511, 64751, 64959, 65135, 65279, 65391, 65471, 65519,
+    65535};
+
+uint16_t anim_ease(anim_easing_t easing, uint16_t t)
+{
+    const uint16_t *lut;
+
+    switch (easing)
+    {
+    case ANIM_EASE_IN_OUT:
+        lut = ease_in_out_lut;
+        break;
+    case ANIM_EASE_OUT:
+        lut = ease_out_lut;
+        break;
+    default:
+        return t;
+    }
+
+    // interpola entre as duas posições vizinhas da tabela (10 bits de fração)
+    uint32_t position = (uint32_t)t * ANIM_LUT_STEPS;
+    uint32_t index = position >> 16;
+    uint32_t fraction = (position & 0xFFFF) >> 6;
+    if (index >= ANIM_LUT_STEPS)
+        return lut[ANIM_LUT_STEPS];
+
+    int32_t delta = lut[index + 1] - lut[index];
+    return lut[index] + ((delta * (int32_t)fraction) >> 10);
+}
+
+uint16_t anim_track_value(const anim_track_t *track, uint32_t time_ms)
+{
+    if (track->count == 0)
+        return 0;
+    if (track->length_ms)
+        time_ms %= track->length_ms;
+
+    // último ponto que já passou
+    uint8_t k = 0;
+    while (k + 1 < track->count && track->keys[k + 1].time_ms <= time_ms)
+        k++;
+
+    const anim_key_t *key = &track->keys[k];
+    if (k + 1 == track->count || time_ms <= key->time_ms)
+        return key->value;
+
+    const anim_key_t *next = &track->keys[k + 1];
+    uint32_t t = (time_ms - key->time_ms) * ANIM_ONE / (next->time_ms - key->time_ms);
+    int32_t weight = anim_ease(key->easing, t);
+    return key->value + (((int32_t)next->value - key->value) * weight) / ANIM_ONE;
+}
+
+// a + (b - a) * weight, por canal
+static uint16_t blend(uint16_t a, uint16_t b, uint16_t weight)
+{
+    return a + (((int32_t)b - a) * weight) / ANIM_ONE;
+}
+
+void matrix_anim_init(matrix_anim_t *anim, const dither_level_t *target, uint32_t now_ms)
+{
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+        anim->from[i] = anim->out[i] = target[i];
+    anim->target = target;
+    anim->fade_start_ms = now_ms - ANIM_FADE_MS;
+}
+
+void matrix_anim_set_target(matrix_anim_t *anim, const dither_level_t *target, uint32_t now_ms)
+{
+    if (target == anim->target)
+        return;
+
+    // a transição parte do que está aceso agora, mesmo no meio de outra transição
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+        anim->from[i] = anim->out[i];
+    anim->target = target;
+    anim->fade_start_ms = now_ms;
+}
+
+void matrix_anim_render(matrix_anim_t *anim, uint32_t now_ms)
+{
+    uint32_t elapsed = now_ms - anim->fade_start_ms;
+    uint16_t weight = elapsed >= ANIM_FADE_MS ? ANIM_ONE : anim_ease(ANIM_EASE_IN_OUT, elapsed * ANIM_ONE / ANIM_FADE_MS);
+
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+    {
+        anim->out[i].green = blend(anim->from[i].green, anim->target[i].green, weight);
+        anim->out[i].red = blend(anim->from[i].red, anim->target[i].red, weight);
+        anim->out[i].blue = blend(anim->from[i].blue, anim->target[i].blue, weight);
+    }
+}
+
+void matrix_anim_bar(matrix_anim_t *anim, const uint8_t *pixels, uint8_t length, uint16_t fraction, dither_level_t color)
+{
+    // comprimento aceso em Q16 de LEDs: os inteiros acendem por completo e o último recebe a fração
+    uint32_t lit = (uint32_t)fraction * length;
+
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint32_t fill = lit >= ANIM_ONE ? ANIM_ONE : lit;
+        lit -= fill;
+
+        dither_level_t *pixel = &anim->out[pixels[i]];
+        pixel->green = blend(pixel->green, color.green, fill);
+        pixel->red = blend(pixel->red, color.red, fill);
+        pixel->blue = blend(pixel->blue, color.blue, fill);
+    }
+}
+
+void matrix_anim_scale(matrix_anim_t *anim, uint8_t pixel, uint16_t weight)
+{
+    dither_level_t *level = &anim->out[pixel];
+    level->green = blend(0, level->green, weight);
+    level->red = blend(0, level->red, weight);
+    level->blue = blend(0, level->blue, weight);
+}
@@ -0,0 +1,76 @@
+#ifndef MATRIX_ANIM_H
+#define MATRIX_ANIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix_dither.h"
+
+/*
+    animações da matriz de LEDs
+
+    tudo em inteiros: pesos em Q16 (65535 = 1) e curvas de suavização em tabelas
+    pré-calculadas na flash, interpoladas entre as 64 posições. um quadro é uma mistura
+    de dois quadros de níveis + a barra de contagem regressiva + a escala de um pixel,
+    barato o bastante para rodar a 50 fps no mesmo núcleo do controlador
+*/
+
+#define ANIM_FPS 50
+#define ANIM_FRAME_MS (1000 / ANIM_FPS)
+#define ANIM_FADE_MS 300     // duração da transição entre lâmpadas
+#define ANIM_LUT_STEPS 64    // posições das tabelas de suavização
+#define ANIM_ONE 65535       // peso 1 em Q16
+
+typedef enum
+{
+    ANIM_EASE_LINEAR,
+    ANIM_EASE_IN_OUT, // senoidal: começa e termina devagar
+    ANIM_EASE_OUT,    // quadrática: começa rápido e desacelera
+    NUM_EASINGS
+} anim_easing_t;
+
+// ponto de uma trilha: valor (Q16) no instante time_ms; easing vale até o próximo ponto
+typedef struct
+{
+    uint16_t time_ms;
+    uint16_t value;
+    uint8_t easing;
+} anim_key_t;
+
+// trilha de pontos em ordem de tempo, repetida a cada length_ms
+typedef struct
+{
+    const anim_key_t *keys;
+    uint8_t count;
+    uint16_t length_ms;
+} anim_track_t;
+
+typedef struct
+{
+    dither_level_t from[DITHER_PIXELS]; // quadro exibido quando a transição começou
+    dither_level_t out[DITHER_PIXELS];  // quadro renderizado
+    const dither_level_t *target;       // quadro de destino
+    uint32_t fade_start_ms;
+} matrix_anim_t;
+
+// aplica a curva de suavização a t (Q16)
+uint16_t anim_ease(anim_easing_t easing, uint16_t t);
+
+// valor da trilha (Q16) no instante time_ms
+uint16_t anim_track_value(const anim_track_t *track, uint32_t time_ms);
+
+// inicia sem transição, exibindo target
+void matrix_anim_init(matrix_anim_t *anim, const dither_level_t *target, uint32_t now_ms);
+
+// troca o quadro de destino com uma transição a partir do quadro exibido agora
+void matrix_anim_set_target(matrix_anim_t *anim, const dither_level_t *target, uint32_t now_ms);
+
+// renderiza a transição em anim->out
+void matrix_anim_render(matrix_anim_t *anim, uint32_t now_ms);
+
+// barra de contagem regressiva: pixels[0] embaixo; fraction (Q16) acende a barra de baixo para cima
+void matrix_anim_bar(matrix_anim_t *anim, const uint8_t *pixels, uint8_t length, uint16_t fraction, dither_level_t color);
+
+// multiplica o brilho de um pixel por weight (Q16)
+void matrix_anim_scale(matrix_anim_t *anim, uint8_t pixel, uint16_t weight);
+
+#endif
@@ -0,0 +1,124 @@
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include "matrix_dither.h"
+
+// ordem de bits invertidos de 3 bits: o subquadro k recebe +1 se bit_reverse[k] < n
+static const uint8_t bit_reverse[DITHER_SUBFRAMES] = {0, 4, 2, 6, 1, 5, 3, 7};
+
+// três buffers: o que a DMA lê, o último publicado e o que está sendo escrito
+static uint32_t buffers[3][DITHER_SUBFRAMES][DITHER_PIXELS];
+static volatile int8_t front = 0;  // lido pela DMA
+static volatile int8_t ready = -1; // publicado, aguardando o início do ciclo
+static uint8_t subframe;
+static bool running;                // timer dos subquadros ligado
+static uint32_t hold_frame[DITHER_PIXELS]; // quadro estático de matrix_dither_hold
+
+static uint dma_channel;
+static repeating_timer_t timer;
+static spin_lock_t *lock;
+
+uint8_t matrix_dither_channel(uint16_t level, uint8_t subframe)
+{
+    uint8_t integer = level >> 8;
+    // subquadros com +1 para a fração, arredondando para o 1/8 mais próximo
+    uint8_t extra = ((level & 0xFF) + (256 / DITHER_SUBFRAMES / 2)) / (256 / DITHER_SUBFRAMES);
+
+    if (bit_reverse[subframe] < extra && integer < 255)
+        integer++;
+    return integer;
+}
+
+// dispara o próximo subquadro; no início do ciclo troca para o último quadro publicado
+static bool matrix_dither_tick(repeating_timer_t *rt)
+{
+    (void)rt;
+
+    if (subframe == 0)
+    {
+        uint32_t save = spin_lock_blocking(lock);
+        if (ready >= 0)
+        {
+            front = ready;
+            ready = -1;
+        }
+        spin_unlock(lock, save);
+    }
+
+    dma_channel_transfer_from_buffer_now(dma_channel, buffers[front][subframe], DITHER_PIXELS);
+    subframe = (subframe + 1) % DITHER_SUBFRAMES;
+    return true;
+}
+
+void matrix_dither_init(PIO pio, uint sm)
+{
+    lock = spin_lock_instance(spin_lock_claim_unused(true));
+
+    // DMA da memória para o FIFO da PIO, no ritmo do DREQ da state machine
+    dma_channel = dma_claim_unused_channel(true);
+    dma_channel_config config = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_32);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dma_channel, &config, &pio->txf[sm], buffers[0][0], 0, false);
+
+    // o timer só começa no primeiro matrix_dither_show, mantendo o quadro enviado no boot
+    running = false;
+}
+
+void matrix_dither_show(const dither_level_t *levels)
+{
+    // escolhe o buffer que não está na DMA nem publicado
+    uint32_t save = spin_lock_blocking(lock);
+    int8_t back = 0;
+    while (back == front || back == ready)
+        back++;
+    spin_unlock(lock, save);
+
+    for (uint8_t k = 0; k < DITHER_SUBFRAMES; k++)
+    {
+        for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+        {
+            uint32_t g = matrix_dither_channel(levels[i].green, k);
+            uint32_t r = matrix_dither_channel(levels[i].red, k);
+            uint32_t b = matrix_dither_channel(levels[i].blue, k);
+            buffers[back][k][i] = (g << 24) | (r << 16) | (b << 8);
+        }
+    }
+
+    save = spin_lock_blocking(lock);
+    ready = back;
+    spin_unlock(lock, save);
+
+    // PRIMEIRO QUADRO OU SAINDO DE UM QUADRO ESTÁTICO: O CICLO RECOMEÇA PELO QUADRO PUBLICADO
+    // (um subquadro de 25 LEDs leva 750us + reset, abaixo do período de 1250us)
+    if (!running)
+    {
+        subframe = 0;
+        add_repeating_timer_us(-1000000 / DITHER_RATE_HZ, matrix_dither_tick, NULL, &timer);
+        running = true;
+    }
+}
+
+void matrix_dither_hold(const dither_level_t *levels)
+{
+    if (running)
+    {
+        cancel_repeating_timer(&timer);
+        running = false;
+    }
+
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+    {
+        // arredonda para o nível inteiro mais próximo (0xFF80 em diante fica em 255)
+        uint32_t g = levels[i].green >= 0xFF80 ? 255 : (levels[i].green + 0x80) >> 8;
+        uint32_t r = levels[i].red >= 0xFF80 ? 255 : (levels[i].red + 0x80) >> 8;
+        uint32_t b = levels[i].blue >= 0xFF80 ? 255 : (levels[i].blue + 0x80) >> 8;
+        hold_frame[i] = (g << 24) | (r << 16) | (b << 8);
+    }
+
+    // o subquadro em andamento termina (e os LEDs aplicam o reset) antes do quadro estático
+    dma_channel_wait_for_finish_blocking(dma_channel);
+    sleep_us(1000000 / DITHER_RATE_HZ);
+    dma_channel_transfer_from_buffer_now(dma_channel, hold_frame, DITHER_PIXELS);
+}
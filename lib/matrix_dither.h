@@ -0,0 +1,50 @@
+#ifndef MATRIX_DITHER_H
+#define MATRIX_DITHER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+/*
+    pontilhamento temporal da matriz WS2812
+
+    o brilho de cada canal tem fração (ponto fixo 8.8): o quadro vira DITHER_SUBFRAMES
+    subquadros de 8 bits, com o nível arredondado para cima em parte deles, de forma que
+    a média no tempo seja o nível pedido. a ordem dos subquadros arredondados é a ordem
+    de bits invertidos, que espalha o acréscimo e deixa a oscilação na maior frequência
+
+    um timer de hardware dispara cada subquadro e a DMA o envia para a PIO, então a CPU
+    só reprograma a DMA a cada subquadro; matrix_dither_show troca o quadro no início
+    do próximo ciclo (três buffers, quem desenha nunca espera)
+*/
+
+#define DITHER_PIXELS 25       // matriz 5x5 da placa
+#define DITHER_SUBFRAMES 8     // resolução da fração: 1/8 de nível
+#define DITHER_RATE_HZ 800     // subquadros por segundo (ciclo completo a 100 Hz)
+
+// brilho de um LED em ponto fixo 8.8 por canal
+typedef struct
+{
+    uint16_t green;
+    uint16_t red;
+    uint16_t blue;
+} dither_level_t;
+
+// assume a state machine da matriz (programa pio_matrix já carregado); a atualização começa no primeiro matrix_dither_show
+void matrix_dither_init(PIO pio, uint sm);
+
+// publica um novo quadro; ele passa a ser exibido no início do próximo ciclo
+void matrix_dither_show(const dither_level_t *levels);
+
+/*
+    envia o quadro uma única vez, com cada nível arredondado para o inteiro mais próximo,
+    e para o timer: os LEDs mantêm a última cor sozinhos e o núcleo pode dormir entre
+    quadros estáticos. o próximo matrix_dither_show volta a atualizar
+*/
+void matrix_dither_hold(const dither_level_t *levels);
+
+// nível de 8 bits de um canal no subquadro indicado (exposto para conferir a média)
+uint8_t matrix_dither_channel(uint16_t level, uint8_t subframe);
+
+#endif
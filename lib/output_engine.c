@@ -0,0 +1,54 @@
+#include "output_engine.h"
+#include "sched_stats.h"
+#include "supervisor.h"
+
+void vOutputEngineTask(void *pvParameters)
+{
+    output_engine_t *engine = pvParameters;
+    output_engine_run(engine->renderers, engine->count, engine->supervisor_id);
+}
+
+void output_engine_run(output_renderer_t *renderers, uint8_t count, uint8_t supervisor_id)
+{
+    // a primeira passagem desenha todas as saídas
+    bool event = true;
+
+    while (1)
+    {
+        uint32_t now = pdTICKS_TO_MS(xTaskGetTickCount());
+        supervisor_checkin(supervisor_id, now);
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            output_renderer_t *renderer = &renderers[i];
+            if (!event && (renderer->waiting || (int32_t)(now - renderer->due_ms) < 0))
+                continue;
+
+            sched_stats_job_begin(renderer->sched_id);
+            uint32_t wait_ms = renderer->render(now);
+            sched_stats_job_end(renderer->sched_id);
+
+            renderer->renders++;
+            renderer->waiting = wait_ms == OUTPUT_WAIT_EVENT;
+            renderer->due_ms = now + wait_ms;
+        }
+
+        // DORME ATÉ O MENOR PRAZO ENTRE OS RENDERIZADORES (OU ATÉ O CONTROLADOR AVISAR UMA MUDANÇA)
+        now = pdTICKS_TO_MS(xTaskGetTickCount());
+        TickType_t timeout = portMAX_DELAY;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (renderers[i].waiting)
+                continue;
+            int32_t until = (int32_t)(renderers[i].due_ms - now);
+            TickType_t ticks = until > 0 ? pdMS_TO_TICKS(until) : 0;
+            if (ticks < timeout)
+                timeout = ticks;
+        }
+
+        // SEM PRAZO NENHUM A TASK SÓ ESPERA O CONTROLADOR: NÃO É TRAVAMENTO
+        if (timeout == portMAX_DELAY)
+            supervisor_idle(supervisor_id);
+        event = ulTaskNotifyTake(pdTRUE, timeout) > 0;
+    }
+}
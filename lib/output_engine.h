@@ -0,0 +1,52 @@
+#ifndef OUTPUT_ENGINE_H
+#define OUTPUT_ENGINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+    motor de saídas cooperativo
+
+    cada saída (LED RGB, matriz, display) é um renderizador: uma função que desenha o
+    estado atual, detecta sozinha o que mudou e retorna em quantos ms precisa rodar de
+    novo, ou OUTPUT_WAIT_EVENT se só precisa rodar na próxima mudança de estado
+
+    output_engine_run atende uma lista de renderizadores em uma única task: acorda no
+    menor prazo entre eles ou na notificação do controlador (mudança de estado, que roda
+    todos) e chama só os que venceram, na ordem da lista. com um único renderizador é o
+    laço de uma task de saída comum. a task avisa o supervisor (lib/supervisor.c) a cada
+    volta e se declara parada quando todos os renderizadores esperam uma mudança
+*/
+
+#define OUTPUT_WAIT_EVENT UINT32_MAX
+
+// desenha a saída no instante now_ms; retorna os ms até a próxima chamada ou OUTPUT_WAIT_EVENT
+typedef uint32_t (*output_render_t)(uint32_t now_ms);
+
+typedef struct
+{
+    const char *name;
+    output_render_t render;
+    uint8_t sched_id;   // índice em sched_stats: cada renderizador é medido como um job próprio
+    bool waiting;       // esperando só a próxima mudança de estado
+    uint32_t due_ms;    // instante da próxima chamada
+    uint32_t renders;   // chamadas feitas
+} output_renderer_t;
+
+// parâmetro da task: lista de renderizadores atendidos por ela
+typedef struct
+{
+    output_renderer_t *renderers;
+    uint8_t count;
+    uint8_t supervisor_id; // índice da task no supervisor
+} output_engine_t;
+
+// task de saída: pvParameters é um output_engine_t
+void vOutputEngineTask(void *pvParameters);
+
+// laço da task (não retorna)
+void output_engine_run(output_renderer_t *renderers, uint8_t count, uint8_t supervisor_id);
+
+#endif
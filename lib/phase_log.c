@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <string.h>
+#include "hardware/sync.h"
+#include "phase_log.h"
+
+#define PHASE_LOG_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define PHASE_LOG_PAGES (PHASE_LOG_SECTORS * PHASE_LOG_PAGES_PER_SECTOR)
+#define PHASE_LOG_DATA (FLASH_PAGE_SIZE - sizeof(phase_log_header_t))
+#define PHASE_LOG_RECORD_MAX 6 // tipo + varint de 32 bits
+#define PHASE_LOG_US_PER_TICK (1000000 / configTICK_RATE_HZ)
+
+volatile phase_log_stats_t phase_log_stats;
+
+// evento na fila, ainda sem codificar
+typedef struct
+{
+    uint32_t ms;
+    uint8_t type;
+    uint8_t value;
+} phase_log_event_t;
+
+static QueueHandle_t log_queue;
+static phase_log_listener_t log_listeners[PHASE_LOG_LISTENERS];
+
+// nomes dos eventos, na ordem de phase_log_type_t
+static const char *const type_names[] = {"fase", "modo", "botao", "mudo", "preempcao", "detector"};
+static const char *const value_names[][5] = {
+    {"verde", "amarelo", "vermelho", "noturno", "emergencia"},
+    {"normal", "noturno"},
+    {"A", "B"},
+    {"nao", "sim"},
+    {"inativa", "ativa"},
+    {"principal_livre", "principal_ocupada", "transversal_livre", "transversal_ocupada"}};
+
+// página em montagem: bytes não usados ficam em 0xFF, como a flash apagada
+static uint8_t page[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+static phase_log_header_t *const header = (phase_log_header_t *)page;
+static uint32_t last_ms;    // instante do último registro da página
+static uint32_t opened_ms;  // instante em que a página recebeu o primeiro registro
+
+static uint32_t next_page;  // próxima página do anel a gravar
+static uint32_t next_seq;
+static uint16_t boot_count;
+
+static phase_log_window_t erase_window;
+static int32_t erased_sector = -1; // próximo setor do anel, já apagado na janela (-1: nenhum)
+
+// CRC-16/CCITT (polinômio 0x1021, início 0xFFFF), o mesmo de tools/phase_log.py
+static uint16_t crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    while (len--)
+    {
+        crc ^= (uint16_t)*data++ << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static uint16_t page_crc(const uint8_t *data)
+{
+    const phase_log_header_t *head = (const phase_log_header_t *)data;
+    uint16_t crc = crc16(0xFFFF, data, offsetof(phase_log_header_t, crc));
+    return crc16(crc, data + sizeof(phase_log_header_t), head->used);
+}
+
+// página do anel lida direto da flash pelo XIP
+static const uint8_t *flash_page(uint32_t index)
+{
+    return (const uint8_t *)(XIP_BASE + PHASE_LOG_OFFSET + index * FLASH_PAGE_SIZE);
+}
+
+static bool page_valid(const uint8_t *data)
+{
+    const phase_log_header_t *head = (const phase_log_header_t *)data;
+    return head->magic == PHASE_LOG_MAGIC && head->used <= PHASE_LOG_DATA && head->crc == page_crc(data);
+}
+
+static bool page_blank(const uint8_t *data)
+{
+    for (uint i = 0; i < FLASH_PAGE_SIZE; i++)
+    {
+        if (data[i] != 0xFF)
+            return false;
+    }
+    return true;
+}
+
+static void page_reset(void)
+{
+    memset(page, 0xFF, sizeof(page));
+    header->used = 0;
+}
+
+/*
+    apaga um setor ou grava uma página
+
+    com o XIP desligado nenhum código da flash pode rodar, então esta função roda da RAM
+    e as interrupções ficam desligadas durante a operação (~0,5ms por página, ~45ms e no
+    máximo PHASE_LOG_ERASE_MAX_MS por setor). os ticks perdidos nesse tempo são devolvidos
+    ao FreeRTOS depois (o SysTick pendente já conta um)
+*/
+static void __not_in_flash_func(flash_write)(uint32_t offset, const uint8_t *data)
+{
+    uint64_t start = time_us_64();
+
+    vTaskSuspendAll();
+    uint32_t save = save_and_disable_interrupts();
+    if (data)
+        flash_range_program(offset, data, FLASH_PAGE_SIZE);
+    else
+        flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    restore_interrupts(save);
+    xTaskResumeAll();
+
+    uint32_t stall = time_us_64() - start;
+    if (stall > phase_log_stats.longest_stall_us)
+        phase_log_stats.longest_stall_us = stall;
+
+    TickType_t lost = stall / PHASE_LOG_US_PER_TICK;
+    if (lost > 1)
+        xTaskCatchUpTicks(lost - 1);
+}
+
+// setor que o anel vai usar depois do atual (o da própria next_page se ela começa um setor)
+static uint32_t next_sector(void)
+{
+    uint32_t sector = next_page / PHASE_LOG_PAGES_PER_SECTOR;
+    return next_page % PHASE_LOG_PAGES_PER_SECTOR == 0 ? sector : (sector + 1) % PHASE_LOG_SECTORS;
+}
+
+static bool sector_blank(uint32_t sector)
+{
+    for (uint32_t i = 0; i < PHASE_LOG_PAGES_PER_SECTOR; i++)
+    {
+        if (!page_blank(flash_page(sector * PHASE_LOG_PAGES_PER_SECTOR + i)))
+            return false;
+    }
+    return true;
+}
+
+// apaga o próximo setor do anel antes de ser preciso, se a janela aguentar a pausa no pior caso
+static void phase_log_erase_ahead(void)
+{
+    uint32_t sector = next_sector();
+    if (erased_sector == (int32_t)sector || (erase_window && !erase_window(PHASE_LOG_ERASE_MAX_MS)))
+        return;
+
+    flash_write(PHASE_LOG_OFFSET + sector * FLASH_SECTOR_SIZE, NULL);
+    phase_log_stats.erases++;
+    erased_sector = sector;
+}
+
+// grava a página em montagem na próxima posição do anel
+static void phase_log_flush(void)
+{
+    if (header->used == 0)
+        return;
+
+    // NO INÍCIO DE CADA SETOR USA O SETOR APAGADO NA JANELA, OU APAGA NA HORA SE A JANELA NÃO VEIO
+    // (OS DADOS MAIS ANTIGOS DO ANEL); NO MEIO DE UM SETOR PULA AS PÁGINAS QUE NÃO ESTÃO APAGADAS
+    // (GRAVAÇÃO INTERROMPIDA)
+    while (next_page % PHASE_LOG_PAGES_PER_SECTOR != 0 && !page_blank(flash_page(next_page)))
+        next_page = (next_page + 1) % PHASE_LOG_PAGES;
+    if (next_page % PHASE_LOG_PAGES_PER_SECTOR == 0)
+    {
+        if (erased_sector != (int32_t)(next_page / PHASE_LOG_PAGES_PER_SECTOR))
+        {
+            flash_write(PHASE_LOG_OFFSET + next_page * FLASH_PAGE_SIZE, NULL);
+            phase_log_stats.erases++;
+            phase_log_stats.late_erases++;
+        }
+        erased_sector = -1;
+    }
+
+    header->magic = PHASE_LOG_MAGIC;
+    header->boot = boot_count;
+    header->seq = next_seq++;
+    header->crc = page_crc(page);
+
+    flash_write(PHASE_LOG_OFFSET + next_page * FLASH_PAGE_SIZE, page);
+    phase_log_stats.pages++;
+
+    next_page = (next_page + 1) % PHASE_LOG_PAGES;
+    page_reset();
+}
+
+// codifica o evento na página, gravando a página antes se ele não couber
+static void phase_log_encode(const phase_log_event_t *event)
+{
+    if ((size_t)header->used + PHASE_LOG_RECORD_MAX > PHASE_LOG_DATA)
+        phase_log_flush();
+
+    if (header->used == 0)
+    {
+        header->base_ms = event->ms;
+        last_ms = event->ms;
+        opened_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+    }
+
+    uint8_t *out = page + sizeof(phase_log_header_t) + header->used;
+    *out++ = (event->type << 4) | (event->value & 0x0F);
+
+    // EVENTOS DE TASKS DIFERENTES PODEM CHEGAR FORA DE ORDEM POR ALGUNS ms
+    uint32_t step = (int32_t)(event->ms - last_ms) > 0 ? event->ms - last_ms : 0;
+    uint32_t delta = step;
+    do
+    {
+        *out = delta & 0x7F;
+        delta >>= 7;
+        if (delta)
+            *out |= 0x80;
+        out++;
+    } while (delta);
+
+    header->used = out - (page + sizeof(phase_log_header_t));
+    last_ms += step;
+    phase_log_stats.records++;
+}
+
+void phase_log_init(phase_log_window_t window)
+{
+    erase_window = window;
+    log_queue = xQueueCreate(PHASE_LOG_QUEUE_LENGTH, sizeof(phase_log_event_t));
+    page_reset();
+
+    // O FIM DO ANEL É A PÁGINA VÁLIDA COM O MAIOR SEQ
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint32_t i = 0; i < PHASE_LOG_PAGES; i++)
+    {
+        const uint8_t *data = flash_page(i);
+        if (!page_valid(data))
+        {
+            if (((const phase_log_header_t *)data)->magic == PHASE_LOG_MAGIC)
+                phase_log_stats.torn_pages++;
+            continue;
+        }
+
+        const phase_log_header_t *head = (const phase_log_header_t *)data;
+        if (!found || (int32_t)(head->seq - next_seq) >= 0)
+        {
+            found = true;
+            newest = i;
+            next_seq = head->seq;
+            boot_count = head->boot;
+        }
+    }
+
+    if (found)
+    {
+        next_page = (newest + 1) % PHASE_LOG_PAGES;
+        next_seq++;
+        boot_count++;
+    }
+
+    // O PRÓXIMO SETOR JÁ APAGADO (FLASH NOVA, OU APAGADO NA JANELA ANTES DO RESET) NÃO É APAGADO DE NOVO
+    erased_sector = sector_blank(next_sector()) ? (int32_t)next_sector() : -1;
+}
+
+void phase_log_append(phase_log_type_t type, uint8_t value)
+{
+    phase_log_event_t event = {pdTICKS_TO_MS(xTaskGetTickCount()), type, value};
+    if (xQueueSend(log_queue, &event, 0) != pdTRUE)
+        phase_log_stats.dropped++;
+
+    for (uint i = 0; i < PHASE_LOG_LISTENERS; i++)
+    {
+        phase_log_listener_t listener = log_listeners[i];
+        if (listener)
+            listener(type, value, event.ms);
+    }
+}
+
+bool phase_log_listen(phase_log_listener_t listener, bool on)
+{
+    for (uint i = 0; i < PHASE_LOG_LISTENERS; i++)
+    {
+        if (log_listeners[i] == listener)
+            log_listeners[i] = NULL;
+    }
+    if (!on)
+        return true;
+
+    for (uint i = 0; i < PHASE_LOG_LISTENERS; i++)
+    {
+        if (!log_listeners[i])
+        {
+            log_listeners[i] = listener;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *phase_log_type_name(phase_log_type_t type)
+{
+    return type < count_of(type_names) ? type_names[type] : "?";
+}
+
+const char *phase_log_value_name(phase_log_type_t type, uint8_t value)
+{
+    if (type >= count_of(value_names) || value >= count_of(value_names[0]) || !value_names[type][value])
+        return "?";
+    return value_names[type][value];
+}
+
+void vPhaseLogTask(void *pvParameters)
+{
+    (void)pvParameters;
+    phase_log_event_t event;
+
+    while (1)
+    {
+        // SEM PÁGINA ABERTA ESPERA O PRÓXIMO EVENTO; COM PÁGINA ABERTA, NO MÁXIMO ATÉ O PRAZO DE GRAVAÇÃO
+        TickType_t wait = portMAX_DELAY;
+        if (header->used)
+        {
+            int32_t until = (int32_t)(opened_ms + PHASE_LOG_FLUSH_MS - pdTICKS_TO_MS(xTaskGetTickCount()));
+            wait = until > 0 ? pdMS_TO_TICKS(until) : 0;
+        }
+
+        // COM O PRÓXIMO SETOR AINDA SEM APAGAR, ACORDA DE VEZ EM QUANDO PARA PERGUNTAR PELA JANELA
+        if (erased_sector != (int32_t)next_sector() && wait > pdMS_TO_TICKS(PHASE_LOG_WINDOW_POLL_MS))
+            wait = pdMS_TO_TICKS(PHASE_LOG_WINDOW_POLL_MS);
+
+        if (xQueueReceive(log_queue, &event, wait) == pdTRUE)
+            phase_log_encode(&event);
+        else if (header->used && (int32_t)(pdTICKS_TO_MS(xTaskGetTickCount()) - opened_ms) >= PHASE_LOG_FLUSH_MS)
+            phase_log_flush();
+
+        phase_log_erase_ahead();
+    }
+}
+
+uint32_t phase_log_export(phase_log_sink_t sink, void *ctx)
+{
+    uint32_t sent = 0;
+
+    // DA PÁGINA MAIS ANTIGA (A PRÓXIMA A SER SOBRESCRITA) ATÉ A MAIS NOVA, SEM CÓPIA;
+    // UMA PÁGINA REGRAVADA DURANTE A EXPORTAÇÃO APARECE COM O CRC ERRADO E O DECODIFICADOR A DESCARTA
+    uint32_t start = next_page;
+    for (uint32_t i = 0; i < PHASE_LOG_PAGES; i++)
+    {
+        const uint8_t *data = flash_page((start + i) % PHASE_LOG_PAGES);
+        if (page_valid(data))
+        {
+            sink(data, FLASH_PAGE_SIZE, ctx);
+            sent++;
+        }
+    }
+
+    // PÁGINA AINDA NA RAM, COPIADA COM A TASK DO REGISTRO PARADA
+    uint8_t pending[FLASH_PAGE_SIZE] __attribute__((aligned(4)));
+    vTaskSuspendAll();
+    memcpy(pending, page, sizeof(pending));
+    uint32_t seq = next_seq;
+    xTaskResumeAll();
+
+    phase_log_header_t *head = (phase_log_header_t *)pending;
+    if (head->used)
+    {
+        head->magic = PHASE_LOG_MAGIC;
+        head->boot = boot_count;
+        head->seq = seq;
+        head->crc = page_crc(pending);
+        sink(pending, sizeof(pending), ctx);
+        sent++;
+    }
+
+    return sent;
+}
+
+size_t phase_log_report(char *buf, size_t len)
+{
+    size_t used = snprintf(buf, len, "registro: %lu eventos, %lu descartados\npaginas: %lu (boot %u, seq %lu)\nsetores apagados: %lu (%lu sem janela)\npaginas corrompidas: %lu\nmaior pausa da flash: %lu us\n",
+                           (unsigned long)phase_log_stats.records, (unsigned long)phase_log_stats.dropped,
+                           (unsigned long)phase_log_stats.pages, (unsigned)boot_count, (unsigned long)next_seq,
+                           (unsigned long)phase_log_stats.erases, (unsigned long)phase_log_stats.late_erases,
+                           (unsigned long)phase_log_stats.torn_pages,
+                           (unsigned long)phase_log_stats.longest_stall_us);
+
+    return used < len ? used : len - 1;
+}
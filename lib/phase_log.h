@@ -0,0 +1,116 @@
+#ifndef PHASE_LOG_H
+#define PHASE_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/*
+    registro das fases em anel na flash, para auditoria
+
+    as tasks chamam phase_log_append, que só coloca o evento em uma fila (nunca espera
+    a flash); a task do registro junta os eventos em uma página de 256 bytes na RAM e
+    grava a página quando ela enche ou PHASE_LOG_FLUSH_MS depois do primeiro evento
+
+    cada página: cabeçalho (PHASE_LOG_MAGIC, boot, seq, base_ms, used, crc) + registros
+    cada registro: 1 byte (tipo << 4 | valor) + os ms desde o registro anterior em
+    varint (7 bits por byte, o bit 7 indica que há mais bytes); o primeiro registro
+    da página conta a partir de base_ms. o CRC-16/CCITT cobre o cabeçalho e os registros
+
+    as páginas são gravadas em sequência pela região inteira, como um anel: cada setor
+    só é apagado quando o anel está para voltar a ele, então todos os setores se desgastam
+    igual. no boot a página válida com o maior seq indica onde o anel continua
+
+    apagar um setor desliga as interrupções por ~45ms (até PHASE_LOG_ERASE_MAX_MS), então
+    o próximo setor do anel é apagado antes de ser preciso, pela task do registro, só
+    quando a janela do firmware diz que a placa aguenta a pausa (a fase atual ainda dura
+    mais que ela). a gravação de uma página (~0,5ms) continua na hora
+
+    a região fica no fim da flash, fora do binário; tools/phase_log.py decodifica a
+    exportação (ou uma imagem da região) e tools/phase_log_host.c roda este arquivo no
+    computador com a flash em um arquivo
+*/
+
+#ifndef PHASE_LOG_SECTORS
+#define PHASE_LOG_SECTORS 64 // 256 KB no fim da flash (~2 dias de ciclo normal)
+#endif
+#define PHASE_LOG_SIZE (PHASE_LOG_SECTORS * FLASH_SECTOR_SIZE)
+#define PHASE_LOG_OFFSET (PICO_FLASH_SIZE_BYTES - PHASE_LOG_SIZE)
+#define PHASE_LOG_MAGIC 0x4C50        // "PL"
+#define PHASE_LOG_FLUSH_MS 300000     // página parcial gravada no máximo 5 min depois do primeiro evento
+#define PHASE_LOG_QUEUE_LENGTH 16     // eventos pendentes antes de descartar
+#define PHASE_LOG_LISTENERS 2         // ouvintes dos eventos ao vivo (terminal e telemetria)
+#define PHASE_LOG_ERASE_MAX_MS 400    // apagamento de um setor no pior caso (datasheet da W25Q16JV)
+#define PHASE_LOG_WINDOW_POLL_MS 1000 // com um setor para apagar, pergunta pela janela a cada tanto
+
+// tipos de evento (4 bits)
+typedef enum
+{
+    PHASE_LOG_PHASE,   // troca de fase do cruzamento principal (valor = traffic_light_state)
+    PHASE_LOG_MODE,    // modo aplicado (valor 1 = noturno)
+    PHASE_LOG_BUTTON,  // botão pressionado (valor 0 = A, 1 = B)
+    PHASE_LOG_MUTE,    // buzzer (valor 1 = mudo)
+    PHASE_LOG_PREEMPT, // detector de emergência (valor 1 = ativo)
+    PHASE_LOG_DETECTOR // detector de demanda (valor = canal << 1 | ocupado)
+} phase_log_type_t;
+
+typedef struct
+{
+    uint16_t magic;    // PHASE_LOG_MAGIC
+    uint16_t boot;     // contador de boots
+    uint32_t seq;      // ordem da página no anel (só cresce)
+    uint32_t base_ms;  // instante do primeiro registro (ms desde o boot)
+    uint16_t used;     // bytes de registros
+    uint16_t crc;      // CRC-16/CCITT dos campos acima e dos registros
+} phase_log_header_t;
+
+typedef struct
+{
+    uint32_t records;          // eventos codificados nas páginas
+    uint32_t dropped;          // eventos descartados com a fila cheia
+    uint32_t pages;            // páginas gravadas
+    uint32_t erases;           // setores apagados
+    uint32_t late_erases;      // setores apagados na hora de gravar, sem esperar a janela
+    uint32_t torn_pages;       // páginas com CRC inválido encontradas no boot
+    uint32_t longest_stall_us; // maior tempo com as interrupções desligadas pela flash
+} phase_log_stats_t;
+
+extern volatile phase_log_stats_t phase_log_stats;
+
+// recebe cada evento no contexto de quem registrou (não pode bloquear)
+typedef void (*phase_log_listener_t)(phase_log_type_t type, uint8_t value, uint32_t ms);
+
+// diz se a placa aguenta agora stall_ms com as interrupções desligadas (chamada pela task do registro)
+typedef bool (*phase_log_window_t)(uint32_t stall_ms);
+
+// recebe os dados da exportação (páginas inteiras, da mais antiga para a mais nova)
+typedef void (*phase_log_sink_t)(const uint8_t *data, size_t len, void *ctx);
+
+// procura o fim do anel e cria a fila (chamar antes do escalonador); window decide quando
+// apagar o próximo setor (NULL: a qualquer momento)
+void phase_log_init(phase_log_window_t window);
+
+// registra um evento sem bloquear; descarta (e conta) se a fila estiver cheia
+void phase_log_append(phase_log_type_t type, uint8_t value);
+
+// liga ou desliga um ouvinte dos eventos ao vivo; false se não houver lugar
+bool phase_log_listen(phase_log_listener_t listener, bool on);
+
+// nomes do tipo e do valor de um evento (os mesmos de tools/phase_log.py)
+const char *phase_log_type_name(phase_log_type_t type);
+const char *phase_log_value_name(phase_log_type_t type, uint8_t value);
+
+// task do registro: junta os eventos e grava as páginas (prioridade mais baixa)
+void vPhaseLogTask(void *pvParameters);
+
+// envia para sink as páginas válidas, direto da flash, e a página ainda na RAM; retorna as páginas enviadas
+uint32_t phase_log_export(phase_log_sink_t sink, void *ctx);
+
+// escreve o relatório do registro em buf; retorna a quantidade de caracteres escritos
+size_t phase_log_report(char *buf, size_t len);
+
+#endif
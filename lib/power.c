@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "hardware/structs/systick.h"
+#include "task.h"
+#include "power.h"
+
+#define POWER_US_PER_TICK (1000000 / configTICK_RATE_HZ)
+
+volatile power_stats_t power_stats;
+
+static uint wake_alarm;
+static uint32_t carry_us; // fração de tick dormida que ainda não entrou no contador (sempre menos de um tick)
+
+// o alarme só precisa tirar o núcleo do WFI
+static void power_alarm(uint alarm)
+{
+}
+
+void power_init(void)
+{
+    wake_alarm = hardware_alarm_claim_unused(true);
+    hardware_alarm_set_callback(wake_alarm, power_alarm);
+    power_stats.start_us = time_us_64();
+}
+
+void vApplicationSleep(TickType_t expected_idle)
+{
+    // COM AS INTERRUPÇÕES DESLIGADAS O WFI AINDA ACORDA COM QUALQUER INTERRUPÇÃO PENDENTE
+    uint32_t save = save_and_disable_interrupts();
+
+    // UMA INTERRUPÇÃO PODE TER ACORDADO ALGUMA TASK ENTRE A DECISÃO DO FREERTOS E AQUI
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep)
+    {
+        restore_interrupts(save);
+        return;
+    }
+
+    // PARA O SYSTICK E GUARDA A PARTE DO TICK ATUAL QUE JÁ PASSOU
+    systick_hw->csr &= ~M0PLUS_SYST_CSR_ENABLE_BITS;
+    uint32_t partial_us = (systick_hw->rvr - systick_hw->cvr) * POWER_US_PER_TICK / (systick_hw->rvr + 1);
+
+    // O PRAZO CONTA DO ÚLTIMO TICK CONTADO: DESCONTA A PARTE DO TICK ATUAL E A FRAÇÃO QUE SOBROU DO SONO
+    // ANTERIOR (AS DUAS MENORES QUE UM TICK, E O FREERTOS SÓ DORME COM PELO MENOS 2 TICKS DE PRAZO)
+    uint64_t start = time_us_64();
+    uint64_t target = start + (uint64_t)expected_idle * POWER_US_PER_TICK - partial_us - carry_us;
+    hardware_alarm_set_target(wake_alarm, from_us_since_boot(target));
+
+    __dsb();
+    __wfi();
+
+    uint64_t slept = time_us_64() - start;
+    hardware_alarm_cancel(wake_alarm);
+
+    // TICKS INTEIROS DORMIDOS; SÓ A FRAÇÃO DE TICK FICA PARA O PRÓXIMO SONO
+    uint64_t total = carry_us + partial_us + slept;
+    TickType_t ticks = total / POWER_US_PER_TICK;
+    carry_us = total - (uint64_t)ticks * POWER_US_PER_TICK;
+
+    // vTaskStepTick SÓ CHEGA ATÉ O PRÓXIMO PRAZO. OS TICKS ALÉM DELE (ACORDOU ATRASADO) ENTRAM COMO SE O
+    // SYSTICK TIVESSE DISPARADO COM O ESCALONADOR SUSPENSO: FICAM PENDENTES ATÉ O xTaskResumeAll DO IDLE
+    TickType_t stepped = ticks > expected_idle ? expected_idle : ticks;
+    vTaskStepTick(stepped);
+    for (; stepped < ticks; stepped++)
+        xTaskIncrementTick();
+
+    // RELIGA O SYSTICK COM UM PERÍODO INTEIRO (ESCREVER NO CVR ZERA A CONTAGEM)
+    systick_hw->cvr = 0;
+    systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    power_stats.sleeps++;
+    power_stats.slept_us += slept;
+    if (slept > power_stats.longest_us)
+        power_stats.longest_us = slept;
+
+    restore_interrupts(save);
+}
+
+uint32_t power_sleep_permille(void)
+{
+    uint64_t elapsed = time_us_64() - power_stats.start_us;
+    return elapsed ? (uint32_t)(power_stats.slept_us * 1000 / elapsed) : 0;
+}
+
+float power_estimated_ma(void)
+{
+    float sleeping = power_sleep_permille() / 1000.0f;
+    return sleeping * POWER_SLEEP_MA + (1.0f - sleeping) * POWER_RUN_MA;
+}
+
+size_t power_report(char *buf, size_t len)
+{
+    uint32_t permille = power_sleep_permille();
+    uint32_t deci_ma = power_estimated_ma() * 10;
+
+    size_t used = snprintf(buf, len, "dormindo: %lu.%lu%%\nsonos: %lu (maior %lu us)\ncorrente estimada: %lu.%lu mA\n",
+                           (unsigned long)(permille / 10), (unsigned long)(permille % 10),
+                           (unsigned long)power_stats.sleeps, (unsigned long)power_stats.longest_us,
+                           (unsigned long)(deci_ma / 10), (unsigned long)(deci_ma % 10));
+
+    return used < len ? used : len - 1;
+}
@@ -0,0 +1,54 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FreeRTOS.h"
+
+/*
+    idle sem tick (tickless) no timer de 1us do RP2040
+
+    quando todas as tasks estão bloqueadas, o FreeRTOS chama vApplicationSleep com a
+    quantidade de ticks até o próximo prazo: o SysTick é parado, um alarme do timer é
+    armado para esse instante e o núcleo dorme em WFI até o alarme ou qualquer outra
+    interrupção (detector, botões, UART, DMA). ao acordar, o tempo dormido (medido no
+    timer, que não para) é somado ao contador de ticks
+
+    o modo dormant não é usado: ele desliga os osciladores, parando o timer, a PIO, o
+    PWM do buzzer e o I2C que as saídas precisam durante o pisca
+*/
+
+// corrente estimada da placa (sem os LEDs) para o relatório; recalibrar com medições de bancada
+#ifndef POWER_RUN_MA
+#define POWER_RUN_MA 24.0f   // executando a 125MHz a partir da flash
+#endif
+#ifndef POWER_SLEEP_MA
+#define POWER_SLEEP_MA 9.0f  // núcleo em WFI, periféricos com clock
+#endif
+
+typedef struct
+{
+    uint32_t sleeps;        // vezes que o núcleo dormiu
+    uint32_t longest_us;    // maior sono
+    uint64_t slept_us;      // tempo total dormindo
+    uint64_t start_us;      // início da medição
+} power_stats_t;
+
+extern volatile power_stats_t power_stats;
+
+// reserva o alarme do timer usado para acordar (chamar antes do escalonador)
+void power_init(void);
+
+// portSUPPRESS_TICKS_AND_SLEEP: dorme até expected_idle ticks, chamado pelo FreeRTOS com o escalonador suspenso
+void vApplicationSleep(TickType_t expected_idle);
+
+// percentual do tempo dormindo desde power_init, em décimos de %
+uint32_t power_sleep_permille(void);
+
+// corrente média estimada pela fração do tempo dormindo, em mA
+float power_estimated_ma(void);
+
+// escreve o relatório de consumo em buf; retorna a quantidade de caracteres escritos
+size_t power_report(char *buf, size_t len);
+
+#endif
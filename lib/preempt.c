@@ -0,0 +1,103 @@
+#include "hardware/sync.h"
+#include "preempt.h"
+#include "input_record.h"
+
+volatile preempt_stats_t preempt_stats;
+
+static uint preempt_pin;
+static TaskHandle_t preempt_controller;
+static preempt_filter_t filter;            // escrito na interrupção e no controlador com as interrupções desligadas
+static volatile uint32_t detector_edge_us; // início do nível ativo que virou a preempção
+static volatile bool measuring;
+
+// interrupção do detector: entrega o nível ao filtro e acorda o controlador quando abre uma decisão
+// (da RAM: uma borda durante a gravação do registro é atendida logo depois, sem esperar o XIP)
+static void __not_in_flash_func(preempt_gpio_irq)(uint gpio, uint32_t events)
+{
+    if (gpio != preempt_pin)
+        return;
+
+    bool level = !gpio_get(preempt_pin);
+    if (level == filter.level)
+        return;
+
+    // CADA ATIVAÇÃO AINDA NÃO CONFIRMADA RECOMEÇA A MEDIÇÃO: UM REPIQUE NÃO A ADIANTA
+    uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCountFromISR());
+    if (level && !filter.active)
+        detector_edge_us = time_us_32();
+    input_record_detector_from_isr(level, now_ms);
+
+    if (!preempt_filter_edge(&filter, level, now_ms))
+        return;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(preempt_controller, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void preempt_init(uint pin, TaskHandle_t controller)
+{
+    preempt_pin = pin;
+    preempt_controller = controller;
+
+    gpio_init(pin);
+    gpio_set_dir(pin, GPIO_IN);
+    gpio_pull_up(pin);
+
+    preempt_filter_init(&filter, !gpio_get(pin), pdTICKS_TO_MS(xTaskGetTickCount()));
+    detector_edge_us = time_us_32();
+    gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, preempt_gpio_irq);
+}
+
+bool preempt_update(uint32_t now_ms)
+{
+    uint32_t save = save_and_disable_interrupts();
+    bool was_active = filter.active;
+    bool active = preempt_filter_update(&filter, now_ms);
+    restore_interrupts(save);
+
+    // A PREEMPÇÃO ACABOU SEM NENHUMA SAÍDA MUDAR (JÁ NO VERMELHO E COM O BUZZER MUDO): NÃO HÁ LATÊNCIA
+    if (was_active && !active && measuring)
+    {
+        measuring = false;
+        preempt_stats.unchanged++;
+    }
+    return active;
+}
+
+uint32_t preempt_wait_ms(uint32_t now_ms)
+{
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t wait = preempt_filter_wait_ms(&filter, now_ms);
+    restore_interrupts(save);
+    return wait;
+}
+
+bool preempt_requested(void)
+{
+    return filter.active;
+}
+
+const preempt_filter_t *preempt_filter_state(void)
+{
+    return &filter;
+}
+
+void preempt_mark_applied(void)
+{
+    measuring = true;
+}
+
+void preempt_mark_output(void)
+{
+    if (!measuring)
+        return;
+
+    measuring = false;
+
+    uint32_t latency = time_us_32() - detector_edge_us;
+    preempt_stats.requests++;
+    preempt_stats.last_latency_us = latency;
+    if (latency > preempt_stats.max_latency_us)
+        preempt_stats.max_latency_us = latency;
+}
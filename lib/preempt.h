@@ -0,0 +1,47 @@
+#ifndef PREEMPT_H
+#define PREEMPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "preempt_filter.h"
+
+// medições de latência da preempção (início do nível ativo no detector -> primeira saída alterada)
+typedef struct
+{
+    uint32_t requests;        // quantidade de preempções atendidas
+    uint32_t last_latency_us; // latência da última preempção
+    uint32_t max_latency_us;  // pior latência observada (inclui os PREEMPT_SETTLE_MS do filtro)
+    uint32_t unchanged;       // preempções que terminaram sem nenhuma saída mudar
+} preempt_stats_t;
+
+extern volatile preempt_stats_t preempt_stats;
+
+/*
+    configura o pino do detector (ativo em nível baixo, com pull-up) e a interrupção
+    que entrega cada mudança de nível ao filtro (lib/preempt_filter.c); o controlador
+    só é acordado quando o nível fica diferente da saída do filtro
+*/
+void preempt_init(uint pin, TaskHandle_t controller);
+
+// controlador, uma vez por volta: saída do filtro em now_ms (true = preempção pedida)
+bool preempt_update(uint32_t now_ms);
+
+// controlador: ms até o filtro poder decidir (0 = nada pendente), para acordar a tempo
+uint32_t preempt_wait_ms(uint32_t now_ms);
+
+// saída do filtro na última volta do controlador
+bool preempt_requested(void);
+
+// estado do filtro, para o retrato da gravação (ler com as interrupções desligadas)
+const preempt_filter_t *preempt_filter_state(void);
+
+// chamada pelo controlador ao aplicar a preempção: inicia a medição de latência
+void preempt_mark_applied(void);
+
+// chamada por uma saída que realmente mudou (LED ou sirene): encerra a medição de latência
+void preempt_mark_output(void);
+
+#endif
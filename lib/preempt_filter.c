@@ -0,0 +1,51 @@
+#include "preempt_filter.h"
+
+void preempt_filter_init(preempt_filter_t *filter, bool level, uint32_t now_ms)
+{
+    *filter = (preempt_filter_t){.level = level, .level_ms = now_ms};
+}
+
+bool preempt_filter_edge(preempt_filter_t *filter, bool level, uint32_t now_ms)
+{
+    if (level == filter->level)
+        return false;
+
+    // CADA BORDA RECOMEÇA A CONTAGEM DO NÍVEL ESTÁVEL; SÓ A PRIMEIRA DIFERENÇA PRECISA ACORDAR O CONTROLADOR
+    bool pending = filter->level != filter->active;
+    filter->level = level;
+    filter->level_ms = now_ms;
+    return !pending && level != filter->active;
+}
+
+bool preempt_filter_update(preempt_filter_t *filter, uint32_t now_ms)
+{
+    if (filter->level == filter->active || now_ms - filter->level_ms < PREEMPT_SETTLE_MS)
+        return filter->active;
+
+    if (filter->level)
+    {
+        filter->active = true;
+        filter->active_ms = now_ms;
+    }
+    else if (now_ms - filter->active_ms >= PREEMPT_MIN_ACTIVE_MS)
+    {
+        filter->active = false;
+    }
+    return filter->active;
+}
+
+uint32_t preempt_filter_wait_ms(const preempt_filter_t *filter, uint32_t now_ms)
+{
+    if (filter->level == filter->active)
+        return 0;
+
+    uint32_t stable = now_ms - filter->level_ms;
+    uint32_t wait = stable < PREEMPT_SETTLE_MS ? PREEMPT_SETTLE_MS - stable : 0;
+
+    // A SOLTURA TAMBÉM ESPERA A DURAÇÃO MÍNIMA DA PREEMPÇÃO
+    uint32_t held = now_ms - filter->active_ms;
+    if (filter->active && held < PREEMPT_MIN_ACTIVE_MS && PREEMPT_MIN_ACTIVE_MS - held > wait)
+        wait = PREEMPT_MIN_ACTIVE_MS - held;
+
+    return wait > 0 ? wait : 1;
+}
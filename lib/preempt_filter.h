@@ -0,0 +1,40 @@
+#ifndef PREEMPT_FILTER_H
+#define PREEMPT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    filtro do detector de emergência (sem dependência do SDK)
+
+    o nível lido na interrupção só passa para o controlador depois de ficar estável por
+    PREEMPT_SETTLE_MS: repiques e pulsos curtos não viram preempção. uma preempção
+    confirmada dura pelo menos PREEMPT_MIN_ACTIVE_MS, então um detector que oscila não
+    liga e desliga a preempção a cada volta da roda. lib/preempt.c usa o filtro na placa
+    e tools/replay_host.c o reaplica sobre os níveis gravados
+*/
+
+#define PREEMPT_SETTLE_MS 30       // nível estável antes de mudar a saída do filtro
+#define PREEMPT_MIN_ACTIVE_MS 3000 // duração mínima de uma preempção confirmada
+
+typedef struct
+{
+    bool level;         // último nível do detector (true = veículo de emergência presente)
+    uint32_t level_ms;  // instante da última mudança de nível
+    bool active;        // saída do filtro: preempção pedida
+    uint32_t active_ms; // instante em que a preempção foi confirmada
+} preempt_filter_t;
+
+// nível no boot: um detector já ativo também espera PREEMPT_SETTLE_MS
+void preempt_filter_init(preempt_filter_t *filter, bool level, uint32_t now_ms);
+
+// interrupção: novo nível do detector; true se abriu uma decisão pendente (acordar o controlador)
+bool preempt_filter_edge(preempt_filter_t *filter, bool level, uint32_t now_ms);
+
+// controlador: aplica o que já assentou até now_ms e retorna a saída do filtro
+bool preempt_filter_update(preempt_filter_t *filter, uint32_t now_ms);
+
+// ms até a saída poder mudar sem outra borda (0 = nada pendente)
+uint32_t preempt_filter_wait_ms(const preempt_filter_t *filter, uint32_t now_ms);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "recovery.h"
+
+volatile recovery_stats_t recovery_stats = {.last_failed = SUPERVISOR_NONE, .failed = SUPERVISOR_NONE};
+
+// último estado salvo, reempacotado quando o supervisor muda a falha ou a contagem de resets
+static supervisor_state_t saved = {.failed = SUPERVISOR_NONE};
+
+static void scratch_write(void)
+{
+    uint32_t words[SUPERVISOR_SCRATCH_WORDS];
+
+    // O CONTROLADOR E O SUPERVISOR SALVAM EM TASKS DIFERENTES: AS QUATRO PALAVRAS MUDAM JUNTAS
+    taskENTER_CRITICAL();
+    saved.failed = recovery_stats.failed;
+    saved.resets = recovery_stats.resets;
+    saved.ignored = recovery_stats.ignored;
+    supervisor_pack(&saved, words);
+    for (uint i = 0; i < SUPERVISOR_SCRATCH_WORDS; i++)
+        watchdog_hw->scratch[i] = words[i];
+    taskEXIT_CRITICAL();
+}
+
+bool recovery_restore(supervisor_state_t *state)
+{
+    uint32_t words[SUPERVISOR_SCRATCH_WORDS];
+    for (uint i = 0; i < SUPERVISOR_SCRATCH_WORDS; i++)
+        words[i] = watchdog_hw->scratch[i];
+
+    bool resume = supervisor_resume(words, watchdog_caused_reboot(), state);
+
+    recovery_stats.resumed = resume;
+    recovery_stats.resets = state->resets;
+    recovery_stats.last_failed = state->failed;
+    recovery_stats.ignored = state->ignored;
+    return resume;
+}
+
+void recovery_save(const supervisor_state_t *state)
+{
+    saved.phase = state->phase;
+    saved.night = state->night;
+    saved.muted = state->muted;
+    saved.remaining_ms = state->remaining_ms;
+    scratch_write();
+}
+
+void vSupervisorTask(void *pvParameters)
+{
+    for (uint8_t i = 0; i < SUPERVISOR_MAX_TASKS; i++)
+    {
+        if (recovery_stats.ignored & (1u << i))
+            supervisor_ignore(i);
+    }
+
+    // O WATCHDOG PARA JUNTO COM O DEPURADOR
+    watchdog_enable(RECOVERY_WATCHDOG_MS, true);
+
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t healthy_since = pdTICKS_TO_MS(wake);
+
+    while (1)
+    {
+        uint32_t now = pdTICKS_TO_MS(xTaskGetTickCount());
+        uint8_t late = supervisor_check(now);
+
+        if (recovery_stats.failed == SUPERVISOR_NONE && late == SUPERVISOR_NONE)
+        {
+            watchdog_update();
+            recovery_stats.feeds++;
+
+            if (recovery_stats.resets && now - healthy_since >= RECOVERY_STABLE_MS)
+            {
+                recovery_stats.resets = 0;
+                scratch_write();
+            }
+        }
+        else if (recovery_stats.failed == SUPERVISOR_NONE)
+        {
+            // PARA DE ALIMENTAR DE VEZ: O WATCHDOG REINICIA A PLACA EM ATÉ RECOVERY_WATCHDOG_MS
+            recovery_stats.failed = late;
+            scratch_write();
+        }
+
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RECOVERY_PERIOD_MS));
+    }
+}
+
+size_t recovery_report(char *buf, size_t len)
+{
+    size_t used = snprintf(buf, len, "task,prazo_ms,atraso_ms,avisos,vigiada\n");
+    uint32_t now = pdTICKS_TO_MS(xTaskGetTickCount());
+
+    for (uint8_t i = 0; i < supervisor_task_count && used < len; i++)
+    {
+        const supervisor_task_t *task = &supervisor_tasks[i];
+        int32_t late = task->idle ? 0 : (int32_t)(now - task->deadline_ms);
+        used += snprintf(buf + used, len - used, "%s,%lu,%ld,%lu,%s\n", task->name, (unsigned long)task->timeout_ms,
+                         (long)(late > 0 ? late : 0), (unsigned long)task->checkins, task->ignored ? "nao" : "sim");
+    }
+
+    if (used < len)
+    {
+        uint8_t last = recovery_stats.last_failed;
+        used += snprintf(buf + used, len - used, "retomado %s, resets seguidos %u, ultima falha %s\n",
+                         recovery_stats.resumed ? "sim" : "nao", recovery_stats.resets,
+                         last < supervisor_task_count ? supervisor_tasks[last].name : "nenhuma");
+    }
+
+    return used < len ? used : len - 1;
+}
@@ -0,0 +1,55 @@
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "supervisor.h"
+
+/*
+    recuperação rápida pelo watchdog do RP2040
+
+    a task do supervisor alimenta o watchdog a cada RECOVERY_PERIOD_MS só enquanto
+    todas as tasks registradas em lib/supervisor.c estão em dia. com uma task atrasada
+    ela para de alimentar para sempre e o watchdog reinicia a placa em até
+    RECOVERY_WATCHDOG_MS. a task roda acima de todas as outras para conseguir anotar
+    qual task travou mesmo com uma task de prioridade alta presa em espera ocupada
+
+    o controlador salva a fase, o tempo restante, o modo e o buzzer nos registradores de
+    rascunho 0 a 3 do watchdog (que sobrevivem ao reset dele; o SDK só usa os de 4 a 7).
+    no boot seguinte o semáforo continua na mesma fase em vez de recomeçar no verde. depois
+    de SUPERVISOR_MAX_RESETS resets seguidos o boot volta a ser frio (supervisor_resume), e a
+    contagem zera depois de RECOVERY_STABLE_MS sem falhas
+*/
+
+#define RECOVERY_WATCHDOG_MS 2000   // sem alimentação por esse tempo o watchdog reinicia a placa
+#define RECOVERY_PERIOD_MS 500      // verificação das tasks e alimentação do watchdog
+#define RECOVERY_STABLE_MS 60000    // tempo sem falhas que zera a contagem de resets
+
+typedef struct
+{
+    bool resumed;        // o boot continuou o estado salvo
+    uint8_t resets;      // resets seguidos pelo watchdog
+    uint8_t last_failed; // task que causou o último reset (SUPERVISOR_NONE = nenhuma)
+    uint8_t failed;      // task atrasada neste boot (SUPERVISOR_NONE = nenhuma)
+    uint8_t ignored;     // bit de cada task fora da verificação por causar resets seguidos
+    uint32_t feeds;      // vezes que o watchdog foi alimentado
+} recovery_stats_t;
+
+extern volatile recovery_stats_t recovery_stats;
+
+// lê o rascunho no boot; true (com o estado em state) se o boot deve continuar o estado salvo
+bool recovery_restore(supervisor_state_t *state);
+
+// salva o estado atual (phase, night, muted e remaining_ms) no rascunho do watchdog
+void recovery_save(const supervisor_state_t *state);
+
+// task do supervisor: verifica as tasks e alimenta o watchdog
+void vSupervisorTask(void *pvParameters);
+
+// escreve o relatório do supervisor em buf; retorna a quantidade de caracteres escritos
+size_t recovery_report(char *buf, size_t len);
+
+#endif
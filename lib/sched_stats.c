@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "sched_stats.h"
+
+sched_task_t sched_tasks[SCHED_MAX_TASKS];
+uint8_t sched_task_count;
+SemaphoreHandle_t sched_resources[SCHED_MAX_RESOURCES];
+uint8_t sched_resource_count;
+volatile uint32_t sched_context_switches;
+
+// quantidade maxima de iterações da equação de tempo de resposta
+#define SCHED_MAX_ITERATIONS 32
+
+uint8_t sched_stats_register(const char *name, uint32_t period_ms, UBaseType_t priority)
+{
+    configASSERT(sched_task_count < SCHED_MAX_TASKS);
+
+    sched_task_t *task = &sched_tasks[sched_task_count];
+    task->name = name;
+    task->period_ms = period_ms;
+    task->priority = priority;
+
+    return sched_task_count++;
+}
+
+void sched_stats_job_begin(uint8_t id)
+{
+    sched_tasks[id].job_start = ulTaskGetRunTimeCounter(xTaskGetCurrentTaskHandle());
+}
+
+void sched_stats_job_end(uint8_t id)
+{
+    sched_task_t *task = &sched_tasks[id];
+    uint32_t elapsed = ulTaskGetRunTimeCounter(xTaskGetCurrentTaskHandle()) - task->job_start;
+
+    if (elapsed > task->wcet_us)
+        task->wcet_us = elapsed;
+    task->jobs++;
+}
+
+// índice do mutex em sched_resources (registrado no primeiro uso, já com o mutex na mão)
+static uint8_t resource_index(SemaphoreHandle_t mutex)
+{
+    for (uint8_t r = 0; r < sched_resource_count; r++)
+    {
+        if (sched_resources[r] == mutex)
+            return r;
+    }
+
+    configASSERT(sched_resource_count < SCHED_MAX_RESOURCES);
+    taskENTER_CRITICAL();
+    uint8_t r = sched_resource_count;
+    sched_resources[r] = mutex;
+    sched_resource_count++;
+    taskEXIT_CRITICAL();
+    return r;
+}
+
+void sched_stats_lock(uint8_t id, SemaphoreHandle_t mutex)
+{
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    sched_task_t *task = &sched_tasks[id];
+    task->cs_resource = resource_index(mutex);
+    task->resources |= 1u << task->cs_resource;
+    task->cs_start = time_us_32();
+}
+
+void sched_stats_unlock(uint8_t id, SemaphoreHandle_t mutex)
+{
+    sched_task_t *task = &sched_tasks[id];
+    uint32_t elapsed = time_us_32() - task->cs_start;
+
+    if (elapsed > task->cs_us[task->cs_resource])
+        task->cs_us[task->cs_resource] = elapsed;
+    xSemaphoreGive(mutex);
+}
+
+// bloqueio da task i: mutexes com teto >= prioridade dela, pegos por tasks de menor prioridade
+static uint32_t blocking_us(uint8_t i)
+{
+    const sched_task_t *task = &sched_tasks[i];
+    uint32_t by_task = 0, by_resource = 0;
+    UBaseType_t ceiling[SCHED_MAX_RESOURCES] = {0};
+
+    for (uint8_t j = 0; j < sched_task_count; j++)
+    {
+        for (uint8_t r = 0; r < sched_resource_count; r++)
+        {
+            if ((sched_tasks[j].resources >> r & 1) && sched_tasks[j].priority > ceiling[r])
+                ceiling[r] = sched_tasks[j].priority;
+        }
+    }
+
+    // CADA TASK MENOR BLOQUEIA UMA VEZ, COM A SUA MAIOR SEÇÃO CRÍTICA NOS MUTEXES QUE ALCANÇAM A TASK
+    for (uint8_t j = 0; j < sched_task_count; j++)
+    {
+        const sched_task_t *low = &sched_tasks[j];
+        uint32_t longest = 0;
+        if (low->priority >= task->priority)
+            continue;
+        for (uint8_t r = 0; r < sched_resource_count; r++)
+        {
+            if ((low->resources >> r & 1) && ceiling[r] >= task->priority && low->cs_us[r] > longest)
+                longest = low->cs_us[r];
+        }
+        by_task += longest;
+    }
+
+    // CADA MUTEX BLOQUEIA UMA VEZ, COM A MAIOR SEÇÃO CRÍTICA DE UMA TASK MENOR NELE
+    for (uint8_t r = 0; r < sched_resource_count; r++)
+    {
+        uint32_t longest = 0;
+        if (ceiling[r] < task->priority)
+            continue;
+        for (uint8_t j = 0; j < sched_task_count; j++)
+        {
+            const sched_task_t *low = &sched_tasks[j];
+            if (low->priority < task->priority && (low->resources >> r & 1) && low->cs_us[r] > longest)
+                longest = low->cs_us[r];
+        }
+        by_resource += longest;
+    }
+
+    return by_task < by_resource ? by_task : by_resource;
+}
+
+bool sched_stats_analyze(void)
+{
+    bool all = true;
+
+    for (uint8_t i = 0; i < sched_task_count; i++)
+    {
+        sched_task_t *task = &sched_tasks[i];
+
+        // bloqueio: só pelos mutexes que a task divide com tasks de menor prioridade
+        uint32_t blocking = blocking_us(i);
+        task->blocking_us = blocking;
+
+        // iteração de ponto fixo da equação de tempo de resposta
+        uint64_t response = task->wcet_us + blocking;
+        uint64_t deadline = (uint64_t)task->period_ms * 1000;
+
+        for (int n = 0; n < SCHED_MAX_ITERATIONS && response <= deadline; n++)
+        {
+            uint64_t next = task->wcet_us + blocking;
+            for (uint8_t j = 0; j < sched_task_count; j++)
+            {
+                const sched_task_t *hp = &sched_tasks[j];
+                // tasks de prioridade igual também interferem (fatiamento de tempo)
+                if (j == i || hp->priority < task->priority)
+                    continue;
+                uint64_t period_us = (uint64_t)hp->period_ms * 1000;
+                next += ((response + period_us - 1) / period_us) * hp->wcet_us;
+            }
+
+            if (next == response)
+                break;
+            response = next;
+        }
+
+        task->response_us = response > UINT32_MAX ? UINT32_MAX : (uint32_t)response;
+        task->schedulable = response <= deadline;
+        all = all && task->schedulable;
+    }
+
+    return all;
+}
+
+size_t sched_stats_report(char *buf, size_t len)
+{
+    bool all = sched_stats_analyze();
+    size_t used = snprintf(buf, len, "task,prio,T_ms,C_us,CS_us,B_us,R_us,jobs,ok\n");
+
+    for (uint8_t i = 0; i < sched_task_count && used < len; i++)
+    {
+        const sched_task_t *task = &sched_tasks[i];
+
+        // MAIOR SEÇÃO CRÍTICA DA PRÓPRIA TASK EM QUALQUER MUTEX
+        uint32_t cs = 0;
+        for (uint8_t r = 0; r < sched_resource_count; r++)
+            cs = task->cs_us[r] > cs ? task->cs_us[r] : cs;
+
+        used += snprintf(buf + used, len - used, "%s,%u,%lu,%lu,%lu,%lu,%lu,%lu,%s\n",
+                         task->name, (unsigned)task->priority,
+                         (unsigned long)task->period_ms, (unsigned long)task->wcet_us,
+                         (unsigned long)cs, (unsigned long)task->blocking_us, (unsigned long)task->response_us,
+                         (unsigned long)task->jobs, task->schedulable ? "sim" : "NAO");
+    }
+
+    if (used < len)
+        used += snprintf(buf + used, len - used, "escalonavel: %s\n", all ? "sim" : "NAO");
+
+    // TROCAS DE CONTEXTO POR SEGUNDO DESDE O BOOT
+    uint32_t seconds = pdTICKS_TO_MS(xTaskGetTickCount()) / 1000;
+    if (used < len)
+        used += snprintf(buf + used, len - used, "trocas de contexto: %lu (%lu/s)\n",
+                         (unsigned long)sched_context_switches,
+                         (unsigned long)(seconds ? sched_context_switches / seconds : 0));
+
+    return used < len ? used : len - 1;
+}
@@ -0,0 +1,77 @@
+#ifndef SCHED_STATS_H
+#define SCHED_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#define SCHED_MAX_TASKS 8
+#define SCHED_MAX_RESOURCES 4 // mutexes medidos por sched_stats_lock
+
+/*
+    dados de escalonamento de cada task
+
+    o tempo de execução de cada ativação (job) vem do contador de run-time do FreeRTOS,
+    que só avança enquanto a própria task está executando; bloqueios e preempções
+    ficam fora da medição
+*/
+typedef struct
+{
+    const char *name;
+    uint32_t period_ms;     // período (ou intervalo mínimo entre ativações)
+    UBaseType_t priority;   // prioridade atribuída
+    uint32_t wcet_us;       // maior tempo de execução medido de um job
+    uint32_t cs_us[SCHED_MAX_RESOURCES]; // maior tempo segurando cada mutex (índice em sched_resources)
+    uint8_t resources;      // mutexes que a task já pegou (bit = índice em sched_resources)
+    uint32_t jobs;          // quantidade de jobs medidos
+    uint32_t blocking_us;   // bloqueio calculado pela análise
+    uint32_t response_us;   // tempo de resposta calculado pela análise
+    bool schedulable;       // response_us <= period_ms
+    uint32_t job_start;     // contador de run-time no início do job atual
+    uint32_t cs_start;      // instante em que o mutex foi obtido
+    uint8_t cs_resource;    // mutex da seção crítica atual
+} sched_task_t;
+
+extern sched_task_t sched_tasks[SCHED_MAX_TASKS];
+extern uint8_t sched_task_count;
+
+// mutexes na ordem em que foram pegos pela primeira vez
+extern SemaphoreHandle_t sched_resources[SCHED_MAX_RESOURCES];
+extern uint8_t sched_resource_count;
+
+// trocas de contexto desde o boot (traceTASK_SWITCHED_IN em FreeRTOSConfig.h)
+extern volatile uint32_t sched_context_switches;
+
+// registra uma task e retorna o seu índice na tabela
+uint8_t sched_stats_register(const char *name, uint32_t period_ms, UBaseType_t priority);
+
+// marca o início e o fim de um job da task atual
+void sched_stats_job_begin(uint8_t id);
+void sched_stats_job_end(uint8_t id);
+
+// pega e devolve um mutex medindo o tempo da seção crítica
+void sched_stats_lock(uint8_t id, SemaphoreHandle_t mutex);
+void sched_stats_unlock(uint8_t id, SemaphoreHandle_t mutex);
+
+/*
+    análise de tempo de resposta (rate-monotonic com bloqueio por herança de prioridade)
+
+    R = C + B + soma(teto(R / Tj) * Cj) para as tasks j de maior prioridade
+
+    o teto de um mutex é a maior prioridade entre as tasks que o pegam; só um mutex com
+    teto >= prioridade da task a bloqueia (direto ou por uma task menor herdando a
+    prioridade). cada task de menor prioridade bloqueia no máximo uma vez, com a sua
+    maior seção crítica nesses mutexes, e cada mutex no máximo uma vez: B é o menor dos
+    dois somatórios. um mutex com um só usuário nunca bloqueia ninguém
+
+    retorna true se todas as tasks cumprem o seu período
+*/
+bool sched_stats_analyze(void);
+
+// escreve o relatório da análise em buf; retorna a quantidade de caracteres escritos
+size_t sched_stats_report(char *buf, size_t len);
+
+#endif
@@ -0,0 +1,180 @@
+#include <string.h>
+#include "shell.h"
+
+void shell_init(shell_t *sh, const shell_command_t *commands, uint8_t count, shell_write_t write)
+{
+    memset(sh, 0, sizeof(*sh));
+    sh->commands = commands;
+    sh->count = count;
+    sh->write = write;
+}
+
+void shell_flush(shell_t *sh)
+{
+    if (sh->used)
+    {
+        sh->write(sh->out, sh->used);
+        sh->used = 0;
+    }
+}
+
+void shell_write(shell_t *sh, const char *data, size_t len)
+{
+    // TEXTO GRANDE: ENVIA O QUE ESTÁ PENDENTE E DEPOIS O TEXTO DIRETO DE ONDE ELE ESTÁ
+    if (len >= SHELL_OUT_MAX / 2)
+    {
+        shell_flush(sh);
+        sh->write(data, len);
+        return;
+    }
+
+    if (sh->used + len > SHELL_OUT_MAX)
+        shell_flush(sh);
+    memcpy(sh->out + sh->used, data, len);
+    sh->used += len;
+}
+
+void shell_puts(shell_t *sh, const char *text)
+{
+    shell_write(sh, text, strlen(text));
+}
+
+void shell_u32(shell_t *sh, uint32_t value)
+{
+    char digits[10];
+    int n = 0;
+    do
+    {
+        digits[sizeof(digits) - 1 - n++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    shell_write(sh, digits + sizeof(digits) - n, n);
+}
+
+void shell_i32(shell_t *sh, int32_t value)
+{
+    if (value < 0)
+    {
+        shell_write(sh, "-", 1);
+        shell_u32(sh, -(uint32_t)value);
+    }
+    else
+        shell_u32(sh, value);
+}
+
+bool shell_parse_u32(const char *text, uint32_t *value)
+{
+    uint32_t result = 0;
+    if (!*text)
+        return false;
+
+    for (; *text; text++)
+    {
+        if (*text < '0' || *text > '9' || result > (UINT32_MAX - 9) / 10)
+            return false;
+        result = result * 10 + (*text - '0');
+    }
+
+    *value = result;
+    return true;
+}
+
+int shell_match(const char *text, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(text, names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+bool shell_help(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    for (uint8_t i = 0; i < sh->count; i++)
+    {
+        shell_puts(sh, sh->commands[i].usage);
+        shell_write(sh, "\n", 1);
+    }
+    return true;
+}
+
+// separa a linha em palavras no próprio buffer e executa o comando
+static void shell_execute(shell_t *sh)
+{
+    char *argv[SHELL_ARGS_MAX];
+    int argc = 0;
+
+    char *c = sh->line;
+    while (*c)
+    {
+        while (*c == ' ')
+            *c++ = '\0';
+        if (!*c)
+            break;
+        if (argc == SHELL_ARGS_MAX)
+        {
+            shell_puts(sh, "erro: palavras demais\n");
+            return;
+        }
+        argv[argc++] = c;
+        while (*c && *c != ' ')
+            c++;
+    }
+
+    if (argc == 0)
+        return;
+
+    for (uint8_t i = 0; i < sh->count; i++)
+    {
+        const shell_command_t *command = &sh->commands[i];
+        if (strcmp(argv[0], command->name) != 0)
+            continue;
+
+        if (command->run(sh, argc, argv))
+            shell_puts(sh, "ok\n");
+        else
+        {
+            shell_puts(sh, "erro: ");
+            shell_puts(sh, command->usage);
+            shell_write(sh, "\n", 1);
+        }
+        return;
+    }
+
+    shell_puts(sh, "erro: comando desconhecido (ajuda)\n");
+}
+
+void shell_input(shell_t *sh, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        char c = data[i];
+
+        if (c == '\r' || c == '\n')
+        {
+            if (sh->overflow)
+                shell_puts(sh, "erro: linha longa demais\n");
+            else
+            {
+                sh->line[sh->length] = '\0';
+                shell_execute(sh);
+            }
+            sh->length = 0;
+            sh->overflow = false;
+            shell_flush(sh);
+        }
+        else if (c == '\b' || c == 0x7F)
+        {
+            if (sh->length)
+                sh->length--;
+        }
+        else if (sh->length < SHELL_LINE_MAX)
+            sh->line[sh->length++] = c == '\t' ? ' ' : c;
+        else
+            sh->overflow = true;
+    }
+}
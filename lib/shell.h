@@ -0,0 +1,75 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    terminal de comandos em texto (sem dependência do SDK nem do FreeRTOS)
+
+    os bytes recebidos vão para shell_input; cada linha é separada em palavras no
+    próprio buffer da linha (os espaços viram '\0', sem cópia) e o comando com o nome
+    da primeira palavra é executado. a resposta termina com "ok" ou "erro: <uso>"
+
+    a saída é montada no buffer de saída e enviada por write de uma vez; textos prontos
+    grandes (relatórios, páginas do registro) vão direto para write, sem cópia. os
+    números são convertidos por shell_u32/shell_i32, sem printf
+
+    a mesma parte roda no computador: tools/shell_host.c atende o terminal em um
+    pseudo-terminal para testar comandos e respostas com tools/shell.py
+*/
+
+#define SHELL_LINE_MAX 64   // caracteres por linha de comando
+#define SHELL_ARGS_MAX 4    // palavras por linha
+#define SHELL_OUT_MAX 128   // buffer de saída (textos maiores que a metade vão direto)
+
+typedef struct shell shell_t;
+
+// envia bytes para o terminal
+typedef void (*shell_write_t)(const char *data, size_t len);
+
+// executa um comando; retorna false para responder com o uso do comando
+typedef bool (*shell_handler_t)(shell_t *sh, int argc, char **argv);
+
+typedef struct
+{
+    const char *name;
+    const char *usage;
+    shell_handler_t run;
+} shell_command_t;
+
+struct shell
+{
+    const shell_command_t *commands;
+    uint8_t count;
+    shell_write_t write;
+    char line[SHELL_LINE_MAX + 1];
+    uint8_t length;
+    bool overflow;          // linha maior que SHELL_LINE_MAX: descartada inteira
+    char out[SHELL_OUT_MAX];
+    uint16_t used;
+};
+
+void shell_init(shell_t *sh, const shell_command_t *commands, uint8_t count, shell_write_t write);
+
+// trata os bytes recebidos, executando cada linha completa ('\r' ou '\n')
+void shell_input(shell_t *sh, const char *data, size_t len);
+
+// saída da resposta
+void shell_write(shell_t *sh, const char *data, size_t len);
+void shell_puts(shell_t *sh, const char *text);
+void shell_u32(shell_t *sh, uint32_t value);
+void shell_i32(shell_t *sh, int32_t value);
+void shell_flush(shell_t *sh);
+
+// lista os comandos com o uso de cada um
+bool shell_help(shell_t *sh, int argc, char **argv);
+
+// converte um número decimal sem sinal; false se o texto não for um número
+bool shell_parse_u32(const char *text, uint32_t *value);
+
+// índice de text em names (count nomes), ou -1
+int shell_match(const char *text, const char *const *names, int count);
+
+#endif
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "ssd1306.h"
 #include "font.h"
 
@@ -9,38 +10,35 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
     ssd->address = address;
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    // OS BYTES ANTES DO RAM_BUFFER RECEBEM A JANELA DO ENVIO DO QUADRO INTEIRO
+    ssd->ram_buffer = (uint8_t *)calloc(SSD1306_WINDOW_SIZE + ssd->bufsize, sizeof(uint8_t)) + SSD1306_WINDOW_SIZE;
     ssd->ram_buffer[0] = 0x40;
     ssd->port_buffer[0] = 0x80;
+    ssd->effect = SSD1306_EFFECT_NONE;
 }
 
+// sequência de inicialização enviada em uma única transação I2C
+static const uint8_t ssd1306_init_sequence[] = {
+    SET_DISP | 0x00,
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, HEIGHT - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, 0x14,
+    SET_DISP | 0x01};
+
 void ssd1306_config(ssd1306_t *ssd)
 {
-    ssd1306_command(ssd, SET_DISP | 0x00);
-    ssd1306_command(ssd, SET_MEM_ADDR);
-    ssd1306_command(ssd, 0x01);
-    ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-    ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-    ssd1306_command(ssd, SET_MUX_RATIO);
-    ssd1306_command(ssd, HEIGHT - 1);
-    ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-    ssd1306_command(ssd, SET_DISP_OFFSET);
-    ssd1306_command(ssd, 0x00);
-    ssd1306_command(ssd, SET_COM_PIN_CFG);
-    ssd1306_command(ssd, 0x12);
-    ssd1306_command(ssd, SET_DISP_CLK_DIV);
-    ssd1306_command(ssd, 0x80);
-    ssd1306_command(ssd, SET_PRECHARGE);
-    ssd1306_command(ssd, 0xF1);
-    ssd1306_command(ssd, SET_VCOM_DESEL);
-    ssd1306_command(ssd, 0x30);
-    ssd1306_command(ssd, SET_CONTRAST);
-    ssd1306_command(ssd, 0xFF);
-    ssd1306_command(ssd, SET_ENTIRE_ON);
-    ssd1306_command(ssd, SET_NORM_INV);
-    ssd1306_command(ssd, SET_CHARGE_PUMP);
-    ssd1306_command(ssd, 0x14);
-    ssd1306_command(ssd, SET_DISP | 0x01);
+    ssd1306_command_list(ssd, ssd1306_init_sequence, sizeof(ssd1306_init_sequence));
 }
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command)
@@ -54,25 +52,86 @@ void ssd1306_command(ssd1306_t *ssd, uint8_t command)
         false);
 }
 
-void ssd1306_send_data(ssd1306_t *ssd)
+// envia uma sequência de comandos com um único byte de controle por transação
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len)
 {
-    ssd1306_command(ssd, SET_COL_ADDR);
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->width - 1);
-    ssd1306_command(ssd, SET_PAGE_ADDR);
-    ssd1306_command(ssd, 0);
-    ssd1306_command(ssd, ssd->pages - 1);
-    i2c_write_blocking(
+    uint8_t buffer[SSD1306_MAX_COMMANDS + 1];
+    buffer[0] = 0x00; // Co = 0, D/C = 0: todos os bytes seguintes são comandos
+
+    while (len > 0)
+    {
+        size_t chunk = len < SSD1306_MAX_COMMANDS ? len : SSD1306_MAX_COMMANDS;
+        memcpy(&buffer[1], commands, chunk);
+        i2c_write_blocking(
+            ssd->i2c_port,
+            ssd->address,
+            buffer,
+            chunk + 1,
+            false);
+        commands += chunk;
+        len -= chunk;
+    }
+}
+
+bool ssd1306_send_data(ssd1306_t *ssd)
+{
+    return ssd1306_send_columns(ssd, 0, ssd->width - 1);
+}
+
+// no modo de endereçamento vertical as colunas x0 a x1 são um trecho contínuo do ram_buffer:
+// os bytes antes do trecho viram a janela e o byte de controle durante o envio, sem cópia
+bool ssd1306_send_columns(ssd1306_t *ssd, uint8_t x0, uint8_t x1)
+{
+    // FAIXA VAZIA OU FORA DA TELA: A JANELA E O TAMANHO DO ENVIO SAIRIAM DO RAM_BUFFER
+    if (x0 >= ssd->width || x0 > x1)
+        return false;
+    if (x1 >= ssd->width)
+        x1 = ssd->width - 1;
+
+    const uint8_t window[SSD1306_WINDOW_SIZE + 1] = {
+        0x80, SET_COL_ADDR, 0x80, x0, 0x80, x1,
+        0x80, SET_PAGE_ADDR, 0x80, 0, 0x80, ssd->pages - 1,
+        0x40};
+
+    uint8_t *start = &ssd->ram_buffer[x0 * ssd->pages] - SSD1306_WINDOW_SIZE;
+    uint8_t saved[sizeof(window)];
+    memcpy(saved, start, sizeof(window));
+    memcpy(start, window, sizeof(window));
+
+    size_t len = sizeof(window) + (size_t)(x1 - x0 + 1) * ssd->pages;
+    int written = i2c_write_blocking(
         ssd->i2c_port,
         ssd->address,
-        ssd->ram_buffer,
-        ssd->bufsize,
+        start,
+        len,
         false);
+
+    memcpy(start, saved, sizeof(window));
+
+    // ESCRITA CURTA: O CONTROLADOR PODE TER FICADO NO MEIO DE UM COMANDO DA JANELA, ESPERANDO ARGUMENTOS;
+    // DOIS NOPS COMPLETAM QUALQUER UM DELES PARA O PRÓXIMO ENVIO COMEÇAR DO ZERO
+    if (written != (int)len)
+    {
+        static const uint8_t flush[] = {SET_NOP, SET_NOP};
+        ssd1306_command_list(ssd, flush, sizeof(flush));
+        return false;
+    }
+    return true;
+}
+
+// o framebuffer como imagem do blit (o primeiro byte do ram_buffer é o byte de controle do I2C)
+static blit_surface_t ssd1306_surface(ssd1306_t *ssd)
+{
+    return (blit_surface_t){&ssd->ram_buffer[1], ssd->width, ssd->height, ssd->pages};
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value)
+void ssd1306_pixel(ssd1306_t *ssd, int x, int y, bool value)
 {
-    uint16_t index = (y >> 3) + (x << 3) + 1;
+    // FORA DA TELA O ÍNDICE CAIRIA EM OUTRA COLUNA OU FORA DO RAM_BUFFER
+    if (x < 0 || y < 0 || x >= ssd->width || y >= ssd->height)
+        return;
+
+    uint16_t index = (y >> 3) + x * ssd->pages + 1;
     uint8_t pixel = (y & 0b111);
     if (value)
         ssd->ram_buffer[index] |= (1 << pixel);
@@ -89,43 +148,34 @@ void ssd1306_fill(ssd1306_t *ssd, bool value) {
 
 void ssd1306_fill(ssd1306_t *ssd, bool value)
 {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y)
-    {
-        for (uint8_t x = 0; x < ssd->width; ++x)
-        {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+    blit_surface_t fb = ssd1306_surface(ssd);
+    blit_fill(&fb, 0, 0, ssd->width, ssd->height, value, BLIT_COPY);
 }
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill)
+void ssd1306_rect(ssd1306_t *ssd, int top, int left, int width, int height, bool value, bool fill)
 {
-    for (uint8_t x = left; x < left + width; ++x)
-    {
-        ssd1306_pixel(ssd, x, top, value);
-        ssd1306_pixel(ssd, x, top + height - 1, value);
-    }
-    for (uint8_t y = top; y < top + height; ++y)
-    {
-        ssd1306_pixel(ssd, left, y, value);
-        ssd1306_pixel(ssd, left + width - 1, y, value);
-    }
+    blit_surface_t fb = ssd1306_surface(ssd);
 
     if (fill)
     {
-        for (uint8_t x = left + 1; x < left + width - 1; ++x)
-        {
-            for (uint8_t y = top + 1; y < top + height - 1; ++y)
-            {
-                ssd1306_pixel(ssd, x, y, value);
-            }
-        }
+        blit_fill(&fb, left, top, width, height, value, BLIT_COPY);
+        return;
     }
+
+    // Contorno: duas linhas horizontais e duas verticais
+    blit_fill(&fb, left, top, width, 1, value, BLIT_COPY);
+    blit_fill(&fb, left, top + height - 1, width, 1, value, BLIT_COPY);
+    blit_fill(&fb, left, top, 1, height, value, BLIT_COPY);
+    blit_fill(&fb, left + width - 1, top, 1, height, value, BLIT_COPY);
 }
 
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value)
+void ssd1306_line(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value)
 {
+    // As duas pontas do mesmo lado fora da tela: nada a desenhar
+    if ((x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0) || (x0 >= ssd->width && x1 >= ssd->width) ||
+        (y0 >= ssd->height && y1 >= ssd->height))
+        return;
+
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
 
@@ -157,64 +207,172 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
     }
 }
 
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value)
+void ssd1306_hline(ssd1306_t *ssd, int x0, int x1, int y, bool value)
 {
-    for (uint8_t x = x0; x <= x1; ++x)
-        ssd1306_pixel(ssd, x, y, value);
+    blit_surface_t fb = ssd1306_surface(ssd);
+    blit_fill(&fb, x0, y, x1 - x0 + 1, 1, value, BLIT_COPY);
 }
 
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value)
+void ssd1306_vline(ssd1306_t *ssd, int x, int y0, int y1, bool value)
 {
-    for (uint8_t y = y0; y <= y1; ++y)
-        ssd1306_pixel(ssd, x, y, value);
+    blit_surface_t fb = ssd1306_surface(ssd);
+    blit_fill(&fb, x, y0, 1, y1 - y0 + 1, value, BLIT_COPY);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// retorna as 8 colunas do glifo de um código Unicode (espaço se não existir na fonte)
+static const uint8_t *ssd1306_glyph(uint32_t codepoint)
+{
+    if (codepoint >= ' ' && codepoint <= '~')
+        return &font[(codepoint - ' ') * 8];
+
+    // busca binária nas letras acentuadas
+    int low = 0, high = font_latin1_count - 1;
+    while (low <= high)
+    {
+        int mid = (low + high) / 2;
+        if (font_latin1[mid].codepoint == codepoint)
+            return font_latin1[mid].glyph;
+        if (font_latin1[mid].codepoint < codepoint)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+
+    // Caractere inválido, desenha um espaço
+    return &font[0];
+}
+
+// decodifica o próximo caractere UTF-8 e avança o ponteiro; sequências inválidas viram 0xFFFD
+static uint32_t utf8_next(const char **str)
 {
-    uint16_t index = 0;
+    const uint8_t *s = (const uint8_t *)*str;
+    uint32_t codepoint;
+    uint8_t extra;
 
-    // Verifica o caractere e calcula o índice correspondente na fonte
-    if (c >= ' ' && c <= '~') // Verifica se o caractere está na faixa ASCII válida
+    if (s[0] < 0x80)
     {
-        index = (c - ' ') * 8; // Calcula o índice baseado na posição do caractere na tabela ASCII
+        *str += 1;
+        return s[0];
+    }
+    else if ((s[0] & 0xE0) == 0xC0)
+    {
+        codepoint = s[0] & 0x1F;
+        extra = 1;
+    }
+    else if ((s[0] & 0xF0) == 0xE0)
+    {
+        codepoint = s[0] & 0x0F;
+        extra = 2;
+    }
+    else if ((s[0] & 0xF8) == 0xF0)
+    {
+        codepoint = s[0] & 0x07;
+        extra = 3;
     }
     else
     {
-        // Caractere inválido, desenha um espaço (ou pode ser tratado de outra forma)
-        index = 0; // Índice 0 corresponde ao caractere "nada" (espaço)
+        *str += 1;
+        return 0xFFFD;
     }
 
-    // Desenha o caractere na tela
-    for (uint8_t i = 0; i < 8; ++i)
+    for (uint8_t i = 1; i <= extra; i++)
     {
-        uint8_t line = font[index + i]; // Acessa a linha correspondente do caractere na fonte
-        for (uint8_t j = 0; j < 8; ++j)
+        if ((s[i] & 0xC0) != 0x80)
         {
-            ssd1306_pixel(ssd, x + i, y + j, line & (1 << j)); // Desenha cada pixel do caractere
+            // sequência truncada: consome só os bytes já lidos
+            *str += i;
+            return 0xFFFD;
         }
+        codepoint = (codepoint << 6) | (s[i] & 0x3F);
     }
+
+    *str += extra + 1;
+    return codepoint;
 }
 
-// Função para desenhar uma string
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+// desenha um glifo ampliado scale vezes em cada direção
+static void ssd1306_draw_glyph(ssd1306_t *ssd, const uint8_t *glyph, uint8_t columns, int x, int y, uint8_t scale)
 {
+    blit_surface_t fb = ssd1306_surface(ssd);
+
+    // Sem ampliação o glifo já está no formato do framebuffer: uma cópia de 8 linhas
+    if (scale == 1)
+    {
+        blit_source_t src = {glyph, columns, 8, 1};
+        blit(&fb, x, y, &src, 0, 0, columns, 8, BLIT_COPY);
+        return;
+    }
+
+    for (uint8_t i = 0; i < columns; ++i)
+    {
+        uint8_t line = glyph[i]; // Acessa a coluna correspondente do caractere na fonte
+        for (uint8_t j = 0; j < 8; ++j)
+            blit_fill(&fb, x + i * scale, y + j * scale, scale, scale, line & (1 << j), BLIT_COPY); // Cada pixel vira um quadrado
+    }
+}
+
+// largura útil do glifo, sem as colunas vazias dos dois lados (usada na fonte proporcional); first é a primeira coluna
+static uint8_t ssd1306_glyph_width(const uint8_t *glyph, uint8_t *first)
+{
+    uint8_t start = 0, end = 8;
+    while (start < end && glyph[start] == 0)
+        start++;
+    while (end > start && glyph[end - 1] == 0)
+        end--;
+    *first = start == end ? 0 : start;
+    return start == end ? 3 : end - start; // o espaço ocupa 3 colunas
+}
+
+// Função para desenhar um caractere
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+{
+    ssd1306_draw_glyph(ssd, ssd1306_glyph((uint8_t)c), 8, x, y, 1);
+}
+
+// Função para desenhar uma string UTF-8 com largura fixa de 8 * scale pixels por caractere
+void ssd1306_draw_string_scaled(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y, uint8_t scale)
+{
+    uint8_t size = 8 * scale;
+
     while (*str)
     {
-        ssd1306_draw_char(ssd, *str++, x, y);
-        x += 8;
-        if (x + 8 >= ssd->width)
+        ssd1306_draw_glyph(ssd, ssd1306_glyph(utf8_next(&str)), 8, x, y, scale);
+        x += size;
+        if (x + size >= ssd->width)
         {
             x = 0;
-            y += 8;
+            y += size;
         }
-        if (y + 8 >= ssd->height)
+        if (y + size >= ssd->height)
         {
             break;
         }
     }
 }
 
+// Função para desenhar uma string UTF-8
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+    ssd1306_draw_string_scaled(ssd, str, x, y, 1);
+}
+
+// desenha uma string UTF-8 com largura proporcional de cada letra; retorna a coluna final
+uint8_t ssd1306_draw_string_prop(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+{
+    while (*str)
+    {
+        const uint8_t *glyph = ssd1306_glyph(utf8_next(&str));
+        uint8_t first;
+        uint8_t width = ssd1306_glyph_width(glyph, &first);
+
+        if (x + width > ssd->width)
+            break;
+        ssd1306_draw_glyph(ssd, glyph + first, width, x, y, 1);
+        x += width + 1;
+    }
+    return x;
+}
+
 #include <math.h>
 
 // desenha um retangulo que pode ser rotacionado em uma certa angulação
@@ -252,3 +410,138 @@ void ssd1306_rotated_rect_angle(ssd1306_t *ssd, int cx, int cy, int w, int h, do
     ssd1306_line(ssd, rx2, ry2, rx3, ry3, value);
     ssd1306_line(ssd, rx3, ry3, rx0, ry0, value);
 }
+
+// desenha um bitmap 1bpp coluna a coluna, com ceil(h / 8) bytes por coluna (bit 0 = linha de cima),
+// o mesmo formato do ram_buffer
+void ssd1306_bitmap(ssd1306_t *ssd, const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h)
+{
+    ssd1306_blit(ssd, bitmap, x, y, w, h, BLIT_COPY);
+}
+
+// combina o bitmap com o framebuffer pela operação rop (BLIT_OR desenha só os pixels acesos)
+void ssd1306_blit(ssd1306_t *ssd, const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h, blit_rop_t rop)
+{
+    blit_surface_t fb = ssd1306_surface(ssd);
+    blit_source_t src = {bitmap, w, h, (h + 7) / 8};
+    blit(&fb, x, y, &src, 0, 0, w, h, rop);
+}
+
+// alterna entre imagem normal e invertida sem alterar o framebuffer
+void ssd1306_invert(ssd1306_t *ssd, bool invert)
+{
+    ssd1306_command(ssd, SET_NORM_INV | (invert ? 0x01 : 0x00));
+}
+
+// ajusta o brilho do painel (0 a 255)
+void ssd1306_set_contrast(ssd1306_t *ssd, uint8_t contrast)
+{
+    const uint8_t commands[] = {SET_CONTRAST, contrast};
+    ssd1306_command_list(ssd, commands, sizeof(commands));
+}
+
+// liga ou desliga o painel mantendo o conteúdo da RAM do controlador
+void ssd1306_power(ssd1306_t *ssd, bool on)
+{
+    ssd1306_command(ssd, SET_DISP | (on ? 0x01 : 0x00));
+}
+
+// rolagem horizontal contínua das páginas start_page a end_page feita pelo controlador
+// interval é o código de intervalo entre passos do datasheet (0 a 7)
+void ssd1306_scroll(ssd1306_t *ssd, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval)
+{
+    const uint8_t commands[] = {
+        SET_SCROLL_OFF,
+        left ? SET_SCROLL_LEFT : SET_SCROLL_RIGHT, 0x00,
+        start_page, interval & 0x07, end_page,
+        0x00, 0xFF,
+        SET_SCROLL_ON};
+    ssd1306_command_list(ssd, commands, sizeof(commands));
+}
+
+// para a rolagem; a RAM do controlador fica deslocada, então o próximo quadro deve ser reenviado
+void ssd1306_scroll_stop(ssd1306_t *ssd)
+{
+    ssd1306_command(ssd, SET_SCROLL_OFF);
+}
+
+// inicia um efeito periódico; o primeiro meio período começa com o efeito ativo
+void ssd1306_effect_start(ssd1306_t *ssd, ssd1306_effect_t effect, uint16_t period_ms, uint32_t now_ms)
+{
+    ssd1306_effect_stop(ssd);
+
+    ssd->effect = effect;
+    ssd->effect_period_ms = period_ms;
+    ssd->effect_start_ms = now_ms;
+    ssd->effect_level = 0xFF;
+    ssd1306_effect_update(ssd, now_ms);
+}
+
+// tempo (ms) até o efeito precisar de um novo comando; UINT32_MAX sem efeito em andamento
+uint32_t ssd1306_effect_next_ms(const ssd1306_t *ssd, uint32_t now_ms)
+{
+    if (ssd->effect == SSD1306_EFFECT_NONE || ssd->effect_period_ms == 0)
+        return UINT32_MAX;
+
+    // o fade muda de degrau 32 vezes por período, BLINK e INVERT uma vez
+    uint32_t step = ssd->effect == SSD1306_EFFECT_FADE ? ssd->effect_period_ms / 32 : ssd->effect_period_ms;
+    if (step == 0)
+        step = 1;
+    return step - (now_ms - ssd->effect_start_ms) % step;
+}
+
+// calcula o estado do efeito e só envia comando quando ele muda
+void ssd1306_effect_update(ssd1306_t *ssd, uint32_t now_ms)
+{
+    if (ssd->effect == SSD1306_EFFECT_NONE || ssd->effect_period_ms == 0)
+        return;
+
+    uint32_t elapsed = now_ms - ssd->effect_start_ms;
+    uint8_t level;
+
+    if (ssd->effect == SSD1306_EFFECT_FADE)
+    {
+        // onda triangular de contraste em 16 degraus para limitar o tráfego no barramento
+        uint32_t half = ssd->effect_period_ms / 2;
+        uint32_t position = elapsed % ssd->effect_period_ms;
+        uint32_t contrast = position < half ? 255 - position * 255 / half : (position - half) * 255 / half;
+        level = (contrast >> 4) * 17;
+    }
+    else
+    {
+        // BLINK e INVERT alternam a cada período
+        level = ((elapsed / ssd->effect_period_ms) & 1) == 0;
+    }
+
+    if (level == ssd->effect_level)
+        return;
+    ssd->effect_level = level;
+
+    switch (ssd->effect)
+    {
+    case SSD1306_EFFECT_BLINK:
+        ssd1306_power(ssd, !level);
+        break;
+    case SSD1306_EFFECT_INVERT:
+        ssd1306_invert(ssd, level);
+        break;
+    case SSD1306_EFFECT_FADE:
+        ssd1306_set_contrast(ssd, level);
+        break;
+    default:
+        break;
+    }
+}
+
+// encerra o efeito e devolve o painel ao estado normal
+void ssd1306_effect_stop(ssd1306_t *ssd)
+{
+    if (ssd->effect == SSD1306_EFFECT_NONE)
+        return;
+
+    const uint8_t commands[] = {
+        SET_DISP | 0x01,
+        SET_NORM_INV,
+        SET_CONTRAST, 0xFF};
+    ssd1306_command_list(ssd, commands, sizeof(commands));
+    ssd->effect = SSD1306_EFFECT_NONE;
+}
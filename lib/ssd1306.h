@@ -1,9 +1,15 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "blit.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_MAX_COMMANDS 32 // comandos por transação em ssd1306_command_list
+#define SSD1306_WINDOW_SIZE 12  // janela de endereços no início de cada envio (6 comandos com Co = 1)
 
 typedef enum
 {
@@ -23,30 +29,77 @@ typedef enum
     SET_DISP_CLK_DIV = 0xD5,
     SET_PRECHARGE = 0xD9,
     SET_VCOM_DESEL = 0xDB,
-    SET_CHARGE_PUMP = 0x8D
+    SET_CHARGE_PUMP = 0x8D,
+    SET_SCROLL_RIGHT = 0x26,
+    SET_SCROLL_LEFT = 0x27,
+    SET_SCROLL_OFF = 0x2E,
+    SET_SCROLL_ON = 0x2F,
+    SET_NOP = 0xE3
 } ssd1306_command_t;
 
+// efeitos feitos pelo próprio controlador, sem alterar nem reenviar o framebuffer
+typedef enum
+{
+    SSD1306_EFFECT_NONE,
+    SSD1306_EFFECT_BLINK,  // liga e desliga o painel (SET_DISP)
+    SSD1306_EFFECT_INVERT, // alterna entre imagem normal e invertida (SET_NORM_INV)
+    SSD1306_EFFECT_FADE    // apaga e acende suavemente pelo contraste (SET_CONTRAST)
+} ssd1306_effect_t;
+
 typedef struct
 {
     uint8_t width, height, pages, address;
     i2c_inst_t *i2c_port;
     bool external_vcc;
-    uint8_t *ram_buffer;
+    uint8_t *ram_buffer; // byte de controle + imagem, com SSD1306_WINDOW_SIZE bytes livres antes
     size_t bufsize;
     uint8_t port_buffer[2];
+    uint8_t effect;            // efeito em andamento (ssd1306_effect_t)
+    uint8_t effect_level;      // último valor enviado pelo efeito
+    uint16_t effect_period_ms; // período do efeito
+    uint32_t effect_start_ms;  // instante em que o efeito começou
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
-void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_command_list(ssd1306_t *ssd, const uint8_t *commands, size_t len);
+
+/*
+    envio do framebuffer: a janela de endereços (comandos com Co = 1) e a imagem (0x40)
+    seguem na mesma transação I2C, então nenhum estado da janela fica guardado entre
+    envios e um envio interrompido não estraga o próximo. retornam false se o I2C não
+    aceitou todos os bytes (o próximo envio do quadro inteiro corrige a tela)
+*/
+bool ssd1306_send_data(ssd1306_t *ssd);
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+// só as colunas x0 a x1 (todas as páginas); x1 é limitado à tela. false sem enviar nada se x0 passa da tela ou de x1
+bool ssd1306_send_columns(ssd1306_t *ssd, uint8_t x0, uint8_t x1);
+
+// as funções de desenho recortam pela tela: coordenadas negativas ou fora dela desenham só a parte visível
+void ssd1306_pixel(ssd1306_t *ssd, int x, int y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
+void ssd1306_rect(ssd1306_t *ssd, int top, int left, int width, int height, bool value, bool fill);
+void ssd1306_line(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value);
+void ssd1306_hline(ssd1306_t *ssd, int x0, int x1, int y, bool value);
+void ssd1306_vline(ssd1306_t *ssd, int x, int y0, int y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
-void ssd1306_rotated_rect_angle(ssd1306_t *ssd, int cx, int cy, int w, int h, double angle_deg, bool value);
\ No newline at end of file
+void ssd1306_draw_string_scaled(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y, uint8_t scale);
+uint8_t ssd1306_draw_string_prop(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+void ssd1306_rotated_rect_angle(ssd1306_t *ssd, int cx, int cy, int w, int h, double angle_deg, bool value);
+
+void ssd1306_bitmap(ssd1306_t *ssd, const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h);
+void ssd1306_blit(ssd1306_t *ssd, const uint8_t *bitmap, int x, int y, uint8_t w, uint8_t h, blit_rop_t rop);
+
+void ssd1306_invert(ssd1306_t *ssd, bool invert);
+void ssd1306_set_contrast(ssd1306_t *ssd, uint8_t contrast);
+void ssd1306_power(ssd1306_t *ssd, bool on);
+void ssd1306_scroll(ssd1306_t *ssd, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval);
+void ssd1306_scroll_stop(ssd1306_t *ssd);
+void ssd1306_effect_start(ssd1306_t *ssd, ssd1306_effect_t effect, uint16_t period_ms, uint32_t now_ms);
+void ssd1306_effect_update(ssd1306_t *ssd, uint32_t now_ms);
+uint32_t ssd1306_effect_next_ms(const ssd1306_t *ssd, uint32_t now_ms);
+void ssd1306_effect_stop(ssd1306_t *ssd);
+
+#endif // SSD1306_H
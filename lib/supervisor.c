@@ -0,0 +1,109 @@
+#include "supervisor.h"
+
+supervisor_task_t supervisor_tasks[SUPERVISOR_MAX_TASKS];
+uint8_t supervisor_task_count;
+
+// verificação das palavras: o rascunho zerado pela energia ou com lixo não é aceito
+static uint32_t state_check(const uint32_t *words)
+{
+    return ~(words[0] ^ words[1] ^ (words[2] << 16 | words[2] >> 16));
+}
+
+void supervisor_init(void)
+{
+    supervisor_task_count = 0;
+}
+
+uint8_t supervisor_register(const char *name, uint32_t timeout_ms, uint32_t now_ms)
+{
+    if (supervisor_task_count >= SUPERVISOR_MAX_TASKS)
+        return SUPERVISOR_NONE;
+
+    supervisor_task_t *task = &supervisor_tasks[supervisor_task_count];
+    task->name = name;
+    task->timeout_ms = timeout_ms;
+    task->deadline_ms = now_ms + timeout_ms;
+    task->idle = false;
+    task->ignored = false;
+    task->checkins = 0;
+    return supervisor_task_count++;
+}
+
+void supervisor_checkin(uint8_t id, uint32_t now_ms)
+{
+    if (id >= supervisor_task_count)
+        return;
+
+    // O PRAZO NOVO É ESCRITO ANTES DE SAIR DA ESPERA: O SUPERVISOR NUNCA VÊ O PRAZO ANTIGO ATIVO
+    supervisor_tasks[id].deadline_ms = now_ms + supervisor_tasks[id].timeout_ms;
+    supervisor_tasks[id].idle = false;
+    supervisor_tasks[id].checkins++;
+}
+
+void supervisor_idle(uint8_t id)
+{
+    if (id < supervisor_task_count)
+        supervisor_tasks[id].idle = true;
+}
+
+void supervisor_ignore(uint8_t id)
+{
+    if (id < supervisor_task_count)
+        supervisor_tasks[id].ignored = true;
+}
+
+uint8_t supervisor_check(uint32_t now_ms)
+{
+    for (uint8_t i = 0; i < supervisor_task_count; i++)
+    {
+        if (!supervisor_tasks[i].idle && !supervisor_tasks[i].ignored && (int32_t)(now_ms - supervisor_tasks[i].deadline_ms) > 0)
+            return i;
+    }
+    return SUPERVISOR_NONE;
+}
+
+void supervisor_pack(const supervisor_state_t *state, uint32_t words[SUPERVISOR_SCRATCH_WORDS])
+{
+    words[0] = SUPERVISOR_MAGIC;
+    words[1] = state->phase | (uint32_t)state->night << 8 | (uint32_t)state->muted << 9 |
+               (uint32_t)state->failed << 16 | (uint32_t)state->resets << 24;
+    words[2] = state->remaining_ms | (uint32_t)state->ignored << 16;
+    words[3] = state_check(words);
+}
+
+bool supervisor_unpack(const uint32_t words[SUPERVISOR_SCRATCH_WORDS], supervisor_state_t *state)
+{
+    if (words[0] != SUPERVISOR_MAGIC || words[3] != state_check(words))
+        return false;
+
+    state->phase = words[1] & 0xFF;
+    state->night = words[1] >> 8 & 1;
+    state->muted = words[1] >> 9 & 1;
+    state->failed = words[1] >> 16 & 0xFF;
+    state->resets = words[1] >> 24;
+    state->remaining_ms = words[2] & 0xFFFF;
+    state->ignored = words[2] >> 16 & 0xFF;
+    return true;
+}
+
+bool supervisor_resume(const uint32_t words[SUPERVISOR_SCRATCH_WORDS], bool watchdog_reset, supervisor_state_t *state)
+{
+    // LIGAR A PLACA OU O PINO RUN É SEMPRE UM BOOT FRIO
+    if (!watchdog_reset || !supervisor_unpack(words, state))
+    {
+        *state = (supervisor_state_t){.failed = SUPERVISOR_NONE};
+        return false;
+    }
+
+    if (state->resets < UINT8_MAX)
+        state->resets++;
+
+    // RESETS EM SEQUÊNCIA: O ESTADO SALVO OU A TASK PODEM SER A CAUSA, ENTÃO COMEÇA DO ZERO SEM ELA
+    if (state->resets > SUPERVISOR_MAX_RESETS)
+    {
+        if (state->failed < SUPERVISOR_MAX_TASKS)
+            state->ignored |= 1u << state->failed;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    supervisor de vida das tasks críticas (sem dependência do SDK)
+
+    cada task registrada avisa que está viva (supervisor_checkin) a cada volta do seu
+    laço e precisa avisar de novo antes de timeout_ms. antes de bloquear sem prazo,
+    esperando só um evento, a task se declara parada (supervisor_idle) e sai da
+    verificação até o próximo aviso: bloquear na fila do display cheia ou ficar presa
+    em um i2c_write_blocking não é parada, e o prazo vence
+
+    o estado que precisa sobreviver ao reset (fase, tempo restante, modo e buzzer)
+    é empacotado em SUPERVISOR_SCRATCH_WORDS palavras com verificação, no formato dos
+    registradores de rascunho do watchdog do RP2040 (lib/recovery.c). no boot,
+    supervisor_resume decide se o estado salvo é continuado: depois de
+    SUPERVISOR_MAX_RESETS resets seguidos o boot é frio e a task que causou o último
+    deixa de ser vigiada até a placa ser desligada (um display travado, e a task de saída
+    presa na fila dele, não deixam a placa reiniciando sem parar)
+
+    tools/supervisor_host.c usa este módulo e o controlador de cruzamentos para
+    simular travamentos e resets no computador
+*/
+
+#define SUPERVISOR_MAX_TASKS 8
+#define SUPERVISOR_NONE 0xFF          // nenhuma task atrasada
+#define SUPERVISOR_SCRATCH_WORDS 4
+#define SUPERVISOR_MAGIC 0x53454D41   // "SEMA"
+#define SUPERVISOR_MAX_RESETS 3       // resets seguidos continuando o estado antes do boot frio
+
+typedef struct
+{
+    const char *name;
+    uint32_t timeout_ms;           // maior intervalo aceito entre dois avisos
+    volatile uint32_t deadline_ms; // prazo do próximo aviso
+    volatile bool idle;            // bloqueada esperando um evento, fora da verificação
+    bool ignored;                  // fora da verificação até o próximo boot frio
+    uint32_t checkins;             // avisos recebidos
+} supervisor_task_t;
+
+extern supervisor_task_t supervisor_tasks[SUPERVISOR_MAX_TASKS];
+extern uint8_t supervisor_task_count;
+
+// estado preservado entre resets
+typedef struct
+{
+    uint8_t phase;         // traffic_light_state do cruzamento principal
+    bool night;            // modo noturno pedido
+    bool muted;            // buzzer desligado pelo botão B
+    uint8_t failed;        // task que causou o último reset (SUPERVISOR_NONE = nenhuma)
+    uint8_t resets;        // resets seguidos pelo watchdog
+    uint8_t ignored;       // bit de cada task fora da verificação
+    uint16_t remaining_ms; // tempo restante da fase (as fases duram no máximo 60s)
+} supervisor_state_t;
+
+// esquece todas as tasks (entre as simulações no computador; no firmware a tabela já começa vazia)
+void supervisor_init(void);
+
+// registra uma task com o primeiro prazo em now_ms + timeout_ms; retorna o índice
+uint8_t supervisor_register(const char *name, uint32_t timeout_ms, uint32_t now_ms);
+
+// a task está viva: próximo aviso até now_ms + timeout_ms
+void supervisor_checkin(uint8_t id, uint32_t now_ms);
+
+// a task vai bloquear sem prazo esperando um evento
+void supervisor_idle(uint8_t id);
+
+// tira a task da verificação (causa de resets seguidos, bit em supervisor_state_t.ignored)
+void supervisor_ignore(uint8_t id);
+
+// primeira task com o prazo vencido em now_ms, ou SUPERVISOR_NONE
+uint8_t supervisor_check(uint32_t now_ms);
+
+// empacota e desempacota o estado; unpack retorna false se as palavras não forem válidas
+void supervisor_pack(const supervisor_state_t *state, uint32_t words[SUPERVISOR_SCRATCH_WORDS]);
+bool supervisor_unpack(const uint32_t words[SUPERVISOR_SCRATCH_WORDS], supervisor_state_t *state);
+
+/*
+    decide o boot a partir das palavras lidas: true se o estado salvo deve ser continuado.
+    state sempre recebe os resets seguidos (já contando este), a task que causou o reset
+    e as tasks que deixam de ser vigiadas
+*/
+bool supervisor_resume(const uint32_t words[SUPERVISOR_SCRATCH_WORDS], bool watchdog_reset, supervisor_state_t *state);
+
+#endif
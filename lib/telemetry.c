@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcp.h"
+#include "lwip/ip_addr.h"
+#include "lwip/apps/mqtt.h"
+#include "queue.h"
+#include "telemetry.h"
+#include "telemetry_batch.h"
+#include "phase_log.h"
+#include "preempt.h"
+#include "display_server.h"
+#include "green_wave.h"
+#include "power.h"
+
+volatile telemetry_stats_t telemetry_stats;
+
+// evento na fila, ainda sem codificar
+typedef struct
+{
+    uint32_t ms;
+    uint8_t type;
+    uint8_t value;
+} telemetry_event_t;
+
+static QueueHandle_t telemetry_queue;
+static uint16_t telemetry_node;
+static mqtt_client_t *mqtt;
+static ip_addr_t broker;
+
+/*
+    dois buffers de lote: o HTTP envia o último lote fechado direto do buffer (o lwIP
+    só guarda a referência até o ACK), enquanto o próximo lote é montado no outro.
+    os índices só mudam com a trava do lwIP (cyw43_arch_lwip_begin)
+*/
+static uint8_t batch_buf[2][TELEMETRY_BATCH_SIZE];
+static uint8_t filling;        // buffer do lote em montagem
+static int8_t latest = -1;     // último lote fechado (-1 = nenhum)
+static size_t latest_len;
+static int8_t serving = -1;    // buffer em envio pelo HTTP até o ACK
+static struct tcp_pcb *serving_pcb;
+static uint32_t serving_pending;
+
+// ouvinte do registro: roda no contexto de quem registrou, então só tenta enfileirar
+static void telemetry_listener(phase_log_type_t type, uint8_t value, uint32_t ms)
+{
+    telemetry_event_t event = {ms, type, value};
+    if (xQueueSend(telemetry_queue, &event, 0) != pdTRUE)
+        telemetry_stats.dropped_events++;
+}
+
+static void http_done(struct tcp_pcb *pcb)
+{
+    if (pcb == serving_pcb)
+    {
+        serving = -1;
+        serving_pcb = NULL;
+    }
+}
+
+// fecha a conexão; sem memória para o FIN aborta (depois disso o lwIP não chama mais nenhum callback)
+static err_t http_close(struct tcp_pcb *pcb)
+{
+    http_done(pcb);
+    if (tcp_close(pcb) == ERR_OK)
+        return ERR_OK;
+    tcp_abort(pcb);
+    return ERR_ABRT;
+}
+
+static void http_error(void *arg, err_t err)
+{
+    // O PCB JÁ FOI LIBERADO PELO lwIP
+    http_done(arg);
+}
+
+static err_t http_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    if (pcb != serving_pcb)
+        return ERR_OK;
+
+    serving_pending = serving_pending > len ? serving_pending - len : 0;
+    if (serving_pending == 0)
+        return http_close(pcb);
+    return ERR_OK;
+}
+
+static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    if (!p)
+        return http_close(pcb);
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    // OUTRO SEGMENTO DA CONEXÃO JÁ SERVIDA (PEDIDO DIVIDIDO): A RESPOSTA JÁ ESTÁ A CAMINHO E
+    // http_sent FECHA A CONEXÃO NO ACK
+    if (pcb == serving_pcb)
+        return ERR_OK;
+
+    // UM ENVIO POR VEZ: O BUFFER SERVIDO NÃO PODE SER REUSADO ATÉ O ACK
+    if (serving >= 0 || latest < 0)
+    {
+        static const char busy[] = "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n";
+        tcp_sent(pcb, NULL);
+        tcp_write(pcb, busy, sizeof(busy) - 1, 0);
+        tcp_output(pcb);
+        return http_close(pcb);
+    }
+
+    char header[96];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.0 200 OK\r\nContent-Type: application/cbor\r\nContent-Length: %u\r\n\r\n",
+                       (unsigned)latest_len);
+
+    // CABEÇALHO COPIADO (ESTÁ NA PILHA); CORPO ENVIADO DIRETO DO BUFFER DO LOTE
+    if (tcp_write(pcb, header, len, TCP_WRITE_FLAG_COPY | TCP_WRITE_FLAG_MORE) != ERR_OK ||
+        tcp_write(pcb, batch_buf[latest], latest_len, 0) != ERR_OK)
+    {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    serving = latest;
+    serving_pcb = pcb;
+    serving_pending = len + latest_len;
+    telemetry_stats.http_requests++;
+    tcp_output(pcb);
+    return ERR_OK;
+}
+
+static err_t http_accept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    if (err != ERR_OK || !pcb)
+        return ERR_VAL;
+
+    tcp_arg(pcb, pcb);
+    tcp_recv(pcb, http_recv);
+    tcp_sent(pcb, http_sent);
+    tcp_err(pcb, http_error);
+    return ERR_OK;
+}
+
+static void http_start(void)
+{
+    struct tcp_pcb *pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if (!pcb || tcp_bind(pcb, IP_ANY_TYPE, TELEMETRY_HTTP_PORT) != ERR_OK)
+        return;
+    pcb = tcp_listen(pcb);
+    tcp_accept(pcb, http_accept);
+}
+
+static void mqtt_connection(mqtt_client_t *client, void *arg, mqtt_connection_status_t status)
+{
+}
+
+static void mqtt_start(void)
+{
+    static const struct mqtt_connect_client_info_t info = {
+        .client_id = "semaforo",
+        .keep_alive = 60};
+    mqtt_client_connect(mqtt, &broker, TELEMETRY_BROKER_PORT, mqtt_connection, NULL, &info);
+}
+
+// fecha o lote com os contadores, publica e troca de buffer
+static void telemetry_publish(telemetry_batch_t *batch, uint32_t now)
+{
+    uint32_t counters[TELEMETRY_COUNTERS] = {
+        [TELEMETRY_CNT_DROPPED_EVENTS] = telemetry_stats.dropped_events,
+        [TELEMETRY_CNT_DROPPED_BATCHES] = telemetry_stats.dropped_batches,
+        [TELEMETRY_CNT_LOG_RECORDS] = phase_log_stats.records,
+        [TELEMETRY_CNT_PREEMPTS] = preempt_stats.requests,
+        [TELEMETRY_CNT_PREEMPT_MAX_US] = preempt_stats.max_latency_us,
+        [TELEMETRY_CNT_DISPLAY_FRAMES] = display_stats.frames,
+        [TELEMETRY_CNT_WAVE_OK] = green_wave_stats.frames_ok,
+        [TELEMETRY_CNT_WAVE_BAD] = green_wave_stats.frames_bad,
+        [TELEMETRY_CNT_SLEEP_PERMILLE] = power_sleep_permille()};
+    size_t len = telemetry_batch_finish(batch, now, counters, TELEMETRY_COUNTERS);
+
+    cyw43_arch_lwip_begin();
+
+    // SEM CONEXÃO OU COM O BUFFER DO MQTT CHEIO O LOTE É DESCARTADO (NUNCA ESPERA A REDE)
+    if (!mqtt_client_is_connected(mqtt))
+    {
+        telemetry_stats.dropped_batches++;
+        mqtt_start();
+    }
+    else if (mqtt_publish(mqtt, TELEMETRY_TOPIC, batch->buf, len, 0, 0, NULL, NULL) != ERR_OK)
+        telemetry_stats.dropped_batches++;
+    else
+    {
+        telemetry_stats.batches++;
+        telemetry_stats.events += batch->events;
+        telemetry_stats.bytes += len;
+    }
+
+    // O PRÓXIMO LOTE VAI PARA O OUTRO BUFFER; SE ELE AINDA ESTÁ NO HTTP, REUSA ESTE
+    latest = filling;
+    latest_len = len;
+    if (serving == (filling ^ 1))
+        latest = -1;
+    else
+        filling ^= 1;
+
+    cyw43_arch_lwip_end();
+}
+
+void telemetry_init(uint16_t node)
+{
+    telemetry_node = node;
+    telemetry_queue = xQueueCreate(TELEMETRY_QUEUE_LENGTH, sizeof(telemetry_event_t));
+    phase_log_listen(telemetry_listener, true);
+}
+
+void vTelemetryTask(void *pvParameters)
+{
+    // O RÁDIO SÓ PODE SER INICIALIZADO COM O ESCALONADOR RODANDO
+    if (cyw43_arch_init())
+    {
+        phase_log_listen(telemetry_listener, false);
+        vTaskDelete(NULL);
+    }
+    cyw43_arch_enable_sta_mode();
+    while (cyw43_arch_wifi_connect_timeout_ms(TELEMETRY_WIFI_SSID, TELEMETRY_WIFI_PASSWORD,
+                                              CYW43_AUTH_WPA2_AES_PSK, TELEMETRY_RETRY_MS))
+        vTaskDelay(pdMS_TO_TICKS(TELEMETRY_RETRY_MS));
+
+    ipaddr_aton(TELEMETRY_BROKER, &broker);
+    cyw43_arch_lwip_begin();
+    http_start();
+    mqtt = mqtt_client_new();
+    mqtt_start();
+    cyw43_arch_lwip_end();
+
+    uint32_t seq = 0;
+    uint32_t now = pdTICKS_TO_MS(xTaskGetTickCount());
+    uint32_t deadline = now + TELEMETRY_PERIOD_MS;
+    telemetry_batch_t batch;
+    telemetry_batch_begin(&batch, batch_buf[filling], TELEMETRY_BATCH_SIZE, TELEMETRY_COUNTERS, telemetry_node, seq++, now);
+
+    while (1)
+    {
+        telemetry_event_t event;
+        int32_t until = (int32_t)(deadline - pdTICKS_TO_MS(xTaskGetTickCount()));
+        bool received = until > 0 && xQueueReceive(telemetry_queue, &event, pdMS_TO_TICKS(until)) == pdTRUE;
+
+        // O EVENTO VAI DIRETO PARA O LOTE; SÓ PUBLICA NO PRAZO OU COM O LOTE CHEIO
+        if (received && telemetry_batch_event(&batch, event.ms, event.type, event.value))
+            continue;
+
+        now = pdTICKS_TO_MS(xTaskGetTickCount());
+        telemetry_publish(&batch, now);
+        telemetry_batch_begin(&batch, batch_buf[filling], TELEMETRY_BATCH_SIZE, TELEMETRY_COUNTERS, telemetry_node, seq++, now);
+        if (received && !telemetry_batch_event(&batch, event.ms, event.type, event.value))
+            telemetry_stats.dropped_events++;
+        if ((int32_t)(now - deadline) >= 0)
+            deadline = now + TELEMETRY_PERIOD_MS;
+    }
+}
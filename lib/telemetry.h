@@ -0,0 +1,72 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+    telemetria pela Wi-Fi do Pico W (lwIP com FreeRTOS)
+
+    os eventos do registro de fases (phase_log) chegam por uma fila e são escritos
+    direto no lote CBOR (lib/telemetry_batch.c); a cada TELEMETRY_PERIOD_MS, ou quando
+    o lote enche, o lote recebe os contadores e é publicado no broker MQTT. o último
+    lote também fica disponível em HTTP (GET em qualquer caminho da porta 80), enviado
+    direto do buffer, sem cópia
+
+    a telemetria nunca atrasa o semáforo: quem registra só tenta colocar o evento na
+    fila (cheia = evento descartado), a task e as threads da rede rodam na menor
+    prioridade e um lote sem conexão ou sem espaço no buffer do MQTT é descartado
+*/
+
+#ifndef TELEMETRY_WIFI_SSID
+#define TELEMETRY_WIFI_SSID ""
+#endif
+#ifndef TELEMETRY_WIFI_PASSWORD
+#define TELEMETRY_WIFI_PASSWORD ""
+#endif
+#ifndef TELEMETRY_BROKER
+#define TELEMETRY_BROKER "192.168.0.10" // endereço IPv4 do broker MQTT
+#endif
+#define TELEMETRY_BROKER_PORT 1883
+#define TELEMETRY_TOPIC "semaforo/telemetria"
+#define TELEMETRY_HTTP_PORT 80
+#define TELEMETRY_PERIOD_MS 10000   // um lote a cada 10s, mesmo sem eventos (contadores)
+#define TELEMETRY_RETRY_MS 30000    // nova tentativa de conectar na Wi-Fi
+#define TELEMETRY_BATCH_SIZE 512    // bytes de um lote (~50 eventos)
+#define TELEMETRY_QUEUE_LENGTH 16   // eventos pendentes antes de descartar
+
+// contadores no fim de cada lote ("cnt"), nessa ordem
+enum
+{
+    TELEMETRY_CNT_DROPPED_EVENTS,
+    TELEMETRY_CNT_DROPPED_BATCHES,
+    TELEMETRY_CNT_LOG_RECORDS,
+    TELEMETRY_CNT_PREEMPTS,
+    TELEMETRY_CNT_PREEMPT_MAX_US,
+    TELEMETRY_CNT_DISPLAY_FRAMES,
+    TELEMETRY_CNT_WAVE_OK,
+    TELEMETRY_CNT_WAVE_BAD,
+    TELEMETRY_CNT_SLEEP_PERMILLE,
+    TELEMETRY_COUNTERS
+};
+
+typedef struct
+{
+    uint32_t batches;         // lotes publicados
+    uint32_t events;          // eventos publicados
+    uint32_t bytes;           // bytes publicados
+    uint32_t dropped_events;  // eventos descartados com a fila ou o lote cheio
+    uint32_t dropped_batches; // lotes descartados (sem conexão ou buffer do MQTT cheio)
+    uint32_t http_requests;   // pedidos atendidos pelo HTTP
+} telemetry_stats_t;
+
+extern volatile telemetry_stats_t telemetry_stats;
+
+// cria a fila e passa a ouvir o registro de fases (chamar antes do escalonador)
+void telemetry_init(uint16_t node);
+
+// task da telemetria: conecta na Wi-Fi, monta e publica os lotes
+void vTelemetryTask(void *pvParameters);
+
+#endif
@@ -0,0 +1,107 @@
+#include <string.h>
+#include "telemetry_batch.h"
+
+// tipos principais do CBOR
+#define CBOR_UINT 0
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_ARRAY_INDEFINITE 0x9F
+#define CBOR_BREAK 0xFF
+
+// cabeçalho de um item: tipo + valor no menor tamanho possível
+static void cbor_head(telemetry_batch_t *batch, uint8_t major, uint32_t value)
+{
+    uint8_t *out = batch->buf + batch->used;
+    major <<= 5;
+
+    if (value < 24)
+    {
+        out[0] = major | value;
+        batch->used += 1;
+    }
+    else if (value <= 0xFF)
+    {
+        out[0] = major | 24;
+        out[1] = value;
+        batch->used += 2;
+    }
+    else if (value <= 0xFFFF)
+    {
+        out[0] = major | 25;
+        out[1] = value >> 8;
+        out[2] = value;
+        batch->used += 3;
+    }
+    else
+    {
+        out[0] = major | 26;
+        out[1] = value >> 24;
+        out[2] = value >> 16;
+        out[3] = value >> 8;
+        out[4] = value;
+        batch->used += 5;
+    }
+}
+
+static void cbor_key(telemetry_batch_t *batch, const char *key)
+{
+    size_t len = strlen(key);
+    cbor_head(batch, CBOR_TEXT, len);
+    memcpy(batch->buf + batch->used, key, len);
+    batch->used += len;
+}
+
+void telemetry_batch_begin(telemetry_batch_t *batch, uint8_t *buf, size_t size, uint8_t counters,
+                           uint16_t node, uint32_t seq, uint32_t now_ms)
+{
+    batch->buf = buf;
+    batch->size = size;
+    batch->used = 0;
+    batch->counters = counters;
+    batch->events = 0;
+    batch->last_ms = now_ms;
+
+    cbor_head(batch, CBOR_MAP, 6);
+    cbor_key(batch, "no");
+    cbor_head(batch, CBOR_UINT, node);
+    cbor_key(batch, "lote");
+    cbor_head(batch, CBOR_UINT, seq);
+    cbor_key(batch, "t0");
+    cbor_head(batch, CBOR_UINT, now_ms);
+    cbor_key(batch, "ev");
+    batch->buf[batch->used++] = CBOR_ARRAY_INDEFINITE;
+}
+
+bool telemetry_batch_event(telemetry_batch_t *batch, uint32_t ms, uint8_t type, uint8_t value)
+{
+    if (batch->used + TELEMETRY_EVENT_MAX + TELEMETRY_TAIL_MAX(batch->counters) > batch->size)
+        return false;
+
+    // EVENTOS FORA DE ORDEM POR ALGUNS ms CONTAM COMO SIMULTÂNEOS
+    uint32_t delta = (int32_t)(ms - batch->last_ms) > 0 ? ms - batch->last_ms : 0;
+    batch->last_ms += delta;
+
+    cbor_head(batch, CBOR_ARRAY, 3);
+    cbor_head(batch, CBOR_UINT, delta);
+    cbor_head(batch, CBOR_UINT, type);
+    cbor_head(batch, CBOR_UINT, value);
+    batch->events++;
+    return true;
+}
+
+size_t telemetry_batch_finish(telemetry_batch_t *batch, uint32_t now_ms, const uint32_t *counters, uint8_t count)
+{
+    if (count > batch->counters)
+        count = batch->counters;
+
+    batch->buf[batch->used++] = CBOR_BREAK;
+    cbor_key(batch, "t");
+    cbor_head(batch, CBOR_UINT, now_ms);
+    cbor_key(batch, "cnt");
+    cbor_head(batch, CBOR_ARRAY, count);
+    for (uint8_t i = 0; i < count; i++)
+        cbor_head(batch, CBOR_UINT, counters[i]);
+
+    return batch->used;
+}
@@ -0,0 +1,44 @@
+#ifndef TELEMETRY_BATCH_H
+#define TELEMETRY_BATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    lote de telemetria em CBOR (RFC 8949), escrito direto no buffer que vai para a rede
+
+    {"no": placa, "lote": número do lote, "t0": ms do início,
+     "ev": [[ms desde o evento anterior, tipo, valor], ...],
+     "t": ms do fim, "cnt": [contadores]}
+
+    a lista de eventos é de tamanho indefinido (0x9F ... 0xFF), então cada evento é
+    escrito assim que chega, sem montar o lote em outro lugar antes. os tipos e valores
+    são os de phase_log_type_t. sem dependência do SDK: o mesmo código roda no computador
+    (tools/telemetry_host.c)
+*/
+
+#define TELEMETRY_EVENT_MAX 8 // bytes de um evento no pior caso
+#define TELEMETRY_TAIL_MAX(counters) (16 + 5 * (counters)) // "t", "cnt" e o fim da lista de eventos
+
+typedef struct
+{
+    uint8_t *buf;
+    size_t size;
+    size_t used;
+    uint8_t counters;   // contadores reservados para o fim do lote
+    uint16_t events;
+    uint32_t last_ms;
+} telemetry_batch_t;
+
+// começa um lote em buf, reservando o espaço do fim com counters contadores
+void telemetry_batch_begin(telemetry_batch_t *batch, uint8_t *buf, size_t size, uint8_t counters,
+                           uint16_t node, uint32_t seq, uint32_t now_ms);
+
+// acrescenta um evento; false se o lote estiver cheio
+bool telemetry_batch_event(telemetry_batch_t *batch, uint32_t ms, uint8_t type, uint8_t value);
+
+// fecha o lote com os contadores (no máximo os reservados); retorna o tamanho em bytes
+size_t telemetry_batch_finish(telemetry_batch_t *batch, uint32_t now_ms, const uint32_t *counters, uint8_t count);
+
+#endif
@@ -0,0 +1,200 @@
+#include "traffic_frames.h"
+#include "led_frame.hpp"
+
+/*
+    quadros do semáforo na matriz 5x5
+
+    cada quadro é a moldura cinza com as três lâmpadas (verde em cima, vermelho embaixo),
+    as apagadas com brilho baixo e a do estado atual com brilho máximo; o compilador
+    monta tudo e o static_assert confere as palavras enviadas para a fita
+
+    os mesmos quadros também saem em níveis 8.8 para o pontilhamento temporal (lib/matrix_dither.h)
+*/
+namespace
+{
+    using namespace led_frame;
+
+    constexpr std::size_t W = 5;
+    constexpr std::size_t H = 5;
+
+    // a ordem da fita é a mesma dos quadros de frame em lib/leds.h
+    using matrix_layout = layout<W, H, true>;
+
+    static_assert(matrix_layout::size == TRAFFIC_FRAME_PIXELS, "a matriz da placa tem 25 LEDs");
+
+    // posição das lâmpadas na coluna central
+    constexpr std::size_t LAMP_X = 2;
+    constexpr std::size_t GREEN_Y = 1;
+    constexpr std::size_t YELLOW_Y = 2;
+    constexpr std::size_t RED_Y = 3;
+
+    constexpr float FRAME_INTENSITY = 0.05f; // moldura
+    constexpr float DIM_INTENSITY = 0.01f;   // lâmpadas apagadas
+    constexpr float LIT_INTENSITY = 1.0f;    // lâmpada do estado atual
+
+    // brilho das lâmpadas apagadas no quadro com pontilhamento: níveis fracionários diferentes
+    // para cada cor, que o quadro de 8 bits não consegue representar (todas caíam no nível 2)
+    constexpr float GREEN_GHOST = 0.008f;  // 2,04 níveis
+    constexpr float YELLOW_GHOST = 0.006f; // 1,53 níveis em cada canal
+    constexpr float RED_GHOST = 0.012f;    // 3,06 níveis
+
+    // cor de um pixel no formato do quadro: palavra GRB de 8 bits ou nível 8.8
+    template <typename Pixel>
+    constexpr Pixel paint(color c, float intensity);
+
+    template <>
+    constexpr uint32_t paint<uint32_t>(color c, float intensity)
+    {
+        return encode(c, intensity);
+    }
+
+    template <>
+    constexpr level paint<level>(color c, float intensity)
+    {
+        return encode_level(c, intensity);
+    }
+
+    // moldura: colunas 1 a 3, com a coluna central vazia entre a primeira e a última linha
+    template <typename Pixel>
+    constexpr canvas<W, H, Pixel> housing()
+    {
+        canvas<W, H, Pixel> image{};
+        for (std::size_t y = 0; y < H; y++)
+        {
+            for (std::size_t x = 1; x < W - 1; x++)
+            {
+                if (x != LAMP_X || y == 0 || y == H - 1)
+                    image.set(x, y, paint<Pixel>(gray, FRAME_INTENSITY));
+            }
+        }
+        return image;
+    }
+
+    template <typename Pixel>
+    constexpr layer<W, H, Pixel> lamp(std::size_t y, color c, float intensity)
+    {
+        layer<W, H, Pixel> top{};
+        top.set(LAMP_X, y, paint<Pixel>(c, intensity));
+        return top;
+    }
+
+    template <typename Pixel>
+    constexpr canvas<W, H, Pixel> dim_lamps(float green_ghost, float yellow_ghost, float red_ghost)
+    {
+        return overlay(overlay(overlay(housing<Pixel>(),
+                                       lamp<Pixel>(GREEN_Y, green, green_ghost)),
+                               lamp<Pixel>(YELLOW_Y, yellow, yellow_ghost)),
+                       lamp<Pixel>(RED_Y, red, red_ghost));
+    }
+
+    // quadro com a lâmpada y acesa sobre as apagadas
+    template <typename Pixel>
+    constexpr canvas<W, H, Pixel> signal(std::size_t y, color c, float green_ghost, float yellow_ghost, float red_ghost)
+    {
+        return overlay(dim_lamps<Pixel>(green_ghost, yellow_ghost, red_ghost), lamp<Pixel>(y, c, LIT_INTENSITY));
+    }
+
+    constexpr traffic_frame_t to_frame(const std::array<uint32_t, TRAFFIC_FRAME_PIXELS> &words)
+    {
+        traffic_frame_t frame{};
+        for (std::size_t i = 0; i < TRAFFIC_FRAME_PIXELS; i++)
+            frame.words[i] = words[i];
+        return frame;
+    }
+
+    constexpr auto green_wire = wire<matrix_layout>(signal<uint32_t>(GREEN_Y, green, DIM_INTENSITY, DIM_INTENSITY, DIM_INTENSITY));
+    constexpr auto yellow_wire = wire<matrix_layout>(signal<uint32_t>(YELLOW_Y, yellow, DIM_INTENSITY, DIM_INTENSITY, DIM_INTENSITY));
+    constexpr auto red_wire = wire<matrix_layout>(signal<uint32_t>(RED_Y, red, DIM_INTENSITY, DIM_INTENSITY, DIM_INTENSITY));
+    constexpr auto night_wire = wire<matrix_layout>(overlay(housing<uint32_t>(), lamp<uint32_t>(YELLOW_Y, yellow, LIT_INTENSITY)));
+    constexpr auto off_wire = wire<matrix_layout>(housing<uint32_t>());
+
+    constexpr auto green_levels = wire<matrix_layout>(signal<level>(GREEN_Y, green, GREEN_GHOST, YELLOW_GHOST, RED_GHOST));
+    constexpr auto yellow_levels = wire<matrix_layout>(signal<level>(YELLOW_Y, yellow, GREEN_GHOST, YELLOW_GHOST, RED_GHOST));
+    constexpr auto red_levels = wire<matrix_layout>(signal<level>(RED_Y, red, GREEN_GHOST, YELLOW_GHOST, RED_GHOST));
+    constexpr auto night_levels = wire<matrix_layout>(overlay(housing<level>(), lamp<level>(YELLOW_Y, yellow, LIT_INTENSITY)));
+    constexpr auto off_levels = wire<matrix_layout>(housing<level>());
+
+    // coluna livre da direita, de baixo para cima
+    constexpr std::size_t BAR_X = W - 1;
+
+    static_assert(TRAFFIC_BAR_LENGTH == H, "a barra ocupa a coluna inteira");
+
+    constexpr traffic_levels_t to_levels(const std::array<level, TRAFFIC_FRAME_PIXELS> &pixels)
+    {
+        traffic_levels_t frame{};
+        for (std::size_t i = 0; i < TRAFFIC_FRAME_PIXELS; i++)
+            frame.levels[i] = {pixels[i].green, pixels[i].red, pixels[i].blue};
+        return frame;
+    }
+
+    // palavras esperadas na fita (valores que draw_traffic_light enviava calculando em float)
+    constexpr uint32_t o = 0x00000000; // apagado
+    constexpr uint32_t f = 0x02020200; // moldura
+    constexpr uint32_t g = 0x02000000; // verde fraco
+    constexpr uint32_t y = 0x02020000; // amarelo fraco
+    constexpr uint32_t r = 0x00020000; // vermelho fraco
+
+    static_assert(equal(green_wire, {o, f, f, f, o,
+                                     o, f, 0xFF000000, f, o,
+                                     o, f, y, f, o,
+                                     o, f, r, f, o,
+                                     o, f, f, f, o}),
+                  "quadro do sinal verde");
+    static_assert(equal(yellow_wire, {o, f, f, f, o,
+                                      o, f, g, f, o,
+                                      o, f, 0xFFFF0000, f, o,
+                                      o, f, r, f, o,
+                                      o, f, f, f, o}),
+                  "quadro do sinal amarelo");
+    static_assert(equal(red_wire, {o, f, f, f, o,
+                                   o, f, g, f, o,
+                                   o, f, y, f, o,
+                                   o, f, 0x00FF0000, f, o,
+                                   o, f, f, f, o}),
+                  "quadro do sinal vermelho");
+    static_assert(equal(night_wire, {o, f, f, f, o,
+                                     o, f, o, f, o,
+                                     o, f, 0xFFFF0000, f, o,
+                                     o, f, o, f, o,
+                                     o, f, f, f, o}),
+                  "quadro do modo noturno");
+    static_assert(equal(off_wire, {o, f, f, f, o,
+                                   o, f, o, f, o,
+                                   o, f, o, f, o,
+                                   o, f, o, f, o,
+                                   o, f, f, f, o}),
+                  "quadro apagado");
+
+    // níveis 8.8: a moldura mantém a fração (2,75) e cada lâmpada apagada tem o seu nível
+    static_assert(off_levels[1] == level{704, 704, 704}, "moldura com fração");
+    static_assert(green_levels[7] == level{65280, 0, 0} && green_levels[17] == level{0, 783, 0}, "verde aceso, vermelho apagado");
+    static_assert(red_levels[7] == level{522, 0, 0} && red_levels[12] == level{392, 392, 0}, "verde e amarelo apagados");
+    static_assert(night_levels[7] == level{0, 0, 0} && night_levels[12] == level{65280, 65280, 0}, "modo noturno");
+
+    // serpentina: a segunda linha é percorrida ao contrário
+    static_assert(matrix_layout::index(0, 1) == 9 && matrix_layout::index(4, 1) == 5, "ligação em zigue-zague");
+}
+
+extern "C"
+{
+    const traffic_frame_t traffic_frame_green = to_frame(green_wire);
+    const traffic_frame_t traffic_frame_yellow = to_frame(yellow_wire);
+    const traffic_frame_t traffic_frame_red = to_frame(red_wire);
+    const traffic_frame_t traffic_frame_night = to_frame(night_wire);
+    const traffic_frame_t traffic_frame_off = to_frame(off_wire);
+
+    const traffic_levels_t traffic_levels_green = to_levels(green_levels);
+    const traffic_levels_t traffic_levels_yellow = to_levels(yellow_levels);
+    const traffic_levels_t traffic_levels_red = to_levels(red_levels);
+    const traffic_levels_t traffic_levels_night = to_levels(night_levels);
+    const traffic_levels_t traffic_levels_off = to_levels(off_levels);
+
+    const uint8_t traffic_bar_pixels[TRAFFIC_BAR_LENGTH] = {
+        matrix_layout::index(BAR_X, 4),
+        matrix_layout::index(BAR_X, 3),
+        matrix_layout::index(BAR_X, 2),
+        matrix_layout::index(BAR_X, 1),
+        matrix_layout::index(BAR_X, 0)};
+
+    const uint8_t traffic_yellow_pixel = matrix_layout::index(LAMP_X, YELLOW_Y);
+}
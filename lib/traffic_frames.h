@@ -0,0 +1,50 @@
+#ifndef TRAFFIC_FRAMES_H
+#define TRAFFIC_FRAMES_H
+
+#include <stdint.h>
+#include "matrix_dither.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TRAFFIC_FRAME_PIXELS 25 // matriz 5x5 da placa
+
+// quadro pronto para a PIO: uma palavra GRB por LED, na ordem da fita
+typedef struct
+{
+    uint32_t words[TRAFFIC_FRAME_PIXELS];
+} traffic_frame_t;
+
+// quadros do semáforo montados em tempo de compilação por lib/traffic_frames.cpp (ficam na flash)
+extern const traffic_frame_t traffic_frame_green;
+extern const traffic_frame_t traffic_frame_yellow;
+extern const traffic_frame_t traffic_frame_red;
+extern const traffic_frame_t traffic_frame_night; // só o amarelo aceso
+extern const traffic_frame_t traffic_frame_off;   // só a moldura
+
+// os mesmos quadros em níveis 8.8 para o pontilhamento, com brilhos fracionários diferentes nas lâmpadas apagadas
+typedef struct
+{
+    dither_level_t levels[TRAFFIC_FRAME_PIXELS];
+} traffic_levels_t;
+
+extern const traffic_levels_t traffic_levels_green;
+extern const traffic_levels_t traffic_levels_yellow;
+extern const traffic_levels_t traffic_levels_red;
+extern const traffic_levels_t traffic_levels_night;
+extern const traffic_levels_t traffic_levels_off;
+
+// barra de contagem regressiva na coluna da direita, índices na fita de baixo para cima
+#define TRAFFIC_BAR_LENGTH 5
+extern const uint8_t traffic_bar_pixels[TRAFFIC_BAR_LENGTH];
+
+// lâmpada amarela (pulso do modo noturno)
+extern const uint8_t traffic_yellow_pixel;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,18 +1,40 @@
 
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 #include "FreeRTOSConfig.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
 #include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 
 #include "pio_matrix.pio.h"
 #include "lib/buzzer.h"
 #include "lib/leds.h"
 #include "lib/ssd1306.h"
-#include "lib/font.h"
+#include "lib/intersections.h"
+#include "lib/control.h"
+#include "lib/input_record.h"
+#include "lib/green_wave.h"
+#include "lib/preempt.h"
+#include "lib/sched_stats.h"
+#include "lib/display_server.h"
+#include "lib/matrix_dither.h"
+#include "lib/matrix_anim.h"
+#include "lib/power.h"
+#include "lib/boot.h"
+#include "lib/output_engine.h"
+#include "lib/phase_log.h"
+#include "lib/shell.h"
+#include "lib/telemetry.h"
+#include "lib/supervisor.h"
+#include "lib/recovery.h"
+#include "lib/detector.h"
+#include "assets.h"
 
 #define ledR 13               // pino do led vermelho
 #define ledG 11               // pino do led verde
@@ -20,6 +42,7 @@
 #define BUTTON_A 5            // BOTÃO B para mudar o modo do semáforo
 #define BUTTON_B 6            // BOTÃO A para desligar o beep
 #define DEBOUNCE_MS 200       // intervalo minimo de 200ms para o debounce
+#define BUTTON_SETTLE_MS 20   // ESPERA DO REPIQUE ANTES DE CONFERIR O NÍVEL DO BOTÃO
 #define BUZZER_A 10           // PORTA DO BUZZER A
 #define BUZZER_B 21           // PORTA DO BUZZER B
 #define BUZZER_FREQUENCY 1500 // FREQUENCIA DO BUZZER
@@ -27,15 +50,71 @@
 #define I2C_SDA 14            // PINO DO SDA
 #define I2C_SCL 15            // PINO DO SCL
 #define endereco 0x3C         // ENDEREÇO
-
-// controle do modo do semáforo
-typedef enum
+#define MAIN_INTERSECTION 0   // CRUZAMENTO EXIBIDO PELOS PERIFÉRICOS DA PLACA
+#define WAVE_UART uart0       // UART DA ONDA VERDE
+#define WAVE_TX 0             // PINO TX DA ONDA VERDE
+#define WAVE_RX 1             // PINO RX DA ONDA VERDE
+#define WAVE_NODE 0           // POSIÇÃO DESTA PLACA NA ONDA VERDE (0 = MESTRE)
+#define PREEMPT_PIN 22        // DETECTOR DO VEÍCULO DE EMERGÊNCIA (BOTÃO DO JOYSTICK)
+#define PEDESTRIAN_X 54       // POSIÇÃO DO SPRITE DO PEDESTRE NO DISPLAY
+#define PEDESTRIAN_Y 10
+#define COUNTDOWN_X 78        // CONTAGEM REGRESSIVA EM DÍGITOS GRANDES NO DISPLAY
+#define COUNTDOWN_Y 24
+#define COUNTDOWN_SCALE 3     // DÍGITOS DE 24x24 PIXELS
+#define COUNTDOWN_W (2 * 8 * COUNTDOWN_SCALE)
+
+// PRIORIDADES ATRIBUÍDAS PELO PERÍODO (RATE-MONOTONIC) E PELA CRITICIDADE
+#define SUPERVISOR_PRIORITY (tskIDLE_PRIORITY + 8) // 500ms, ALGUNS us: PRECISA RODAR MESMO COM UMA TASK PRESA
+#define CONTROLLER_PRIORITY (tskIDLE_PRIORITY + 7) // 50ms, CAMINHO DA PREEMPÇÃO
+#define BUTTON_PRIORITY (tskIDLE_PRIORITY + 6)     // INTERRUPÇÃO, NO MÍNIMO 200ms ENTRE TOQUES
+#define LED_PRIORITY (tskIDLE_PRIORITY + 5)        // 500ms, MAS É A PRIMEIRA SAÍDA DA PREEMPÇÃO
+#define MATRIX_PRIORITY (tskIDLE_PRIORITY + 4)     // 20ms (ANIMAÇÃO A 50 fps)
+#define DETECTOR_PRIORITY (tskIDLE_PRIORITY + 4)   // 64ms, ENTRE A MATRIZ E O DISPLAY
+#define DISPLAY_PRIORITY (tskIDLE_PRIORITY + 3)    // 100ms (ANIMAÇÃO E SERVIDOR DO DISPLAY)
+#define BUZZER_PRIORITY (tskIDLE_PRIORITY + 2)     // 250ms NOS TOQUES REPETIDOS
+#define LOG_PRIORITY (tskIDLE_PRIORITY + 1)        // GRAVAÇÃO DO REGISTRO NA FLASH, SEM PRAZO
+#define SHELL_PRIORITY (tskIDLE_PRIORITY + 1)      // TERMINAL USB, SEM PRAZO
+#define TELEMETRY_PRIORITY (tskIDLE_PRIORITY + 1)  // TELEMETRIA PELA WI-FI, SEM PRAZO
+
+// PRAZO DE CADA TASK CRÍTICA NO SUPERVISOR (MAIOR INTERVALO ENTRE DOIS AVISOS)
+#define CONTROLLER_WATCH_MS 2000 // O PISCA DO MODO NOTURNO ACORDA O CONTROLADOR SÓ A CADA 1s
+#define OUTPUT_WATCH_MS 2000     // MAIOR ESPERA DE UM RENDERIZADOR: 1s DA CONTAGEM REGRESSIVA
+#define BUZZER_WATCH_MS 3000     // O TOQUE DO VERMELHO BLOQUEIA A TASK POR 1,6s
+#define BUTTON_WATCH_MS 1000     // REPIQUE + DEBOUNCE
+#define DISPLAY_WATCH_MS 2000    // INICIALIZAÇÃO DO SSD1306 OU UM QUADRO PELO I2C
+
+// SHELL_USB=1 (opção do CMake) liga o stdio pela USB e o terminal de comandos
+#ifndef SHELL_USB
+#define SHELL_USB 0
+#endif
+// TELEMETRY=1 (opção do CMake) publica os eventos e contadores pela Wi-Fi
+#ifndef TELEMETRY
+#define TELEMETRY 0
+#endif
+// DETECTORS=1 (opção do CMake) lê os detectores de demanda pelo ADC e atua no verde
+#ifndef DETECTORS
+#define DETECTORS 0
+#endif
+
+// OUTPUT_ENGINE=1 (opção do CMake) junta LED, matriz e display em uma única task cooperativa
+#ifndef OUTPUT_ENGINE
+#define OUTPUT_ENGINE 0
+#endif
+#define OUTPUT_ENGINE_PRIORITY LED_PRIORITY // O LED CONTINUA NO CAMINHO DA PREEMPÇÃO
+
+// índices das tasks na tabela de escalonamento (registradas nessa ordem no main)
+enum
 {
-    GREEN_LIGHT,
-    YELLOW_LIGHT,
-    RED_LIGHT,
-    NIGHT_MODE
-} traffic_light_state;
+    SCHED_CONTROLLER,
+    SCHED_BUTTON,
+    SCHED_LED,
+    SCHED_DISPLAY,
+    SCHED_BUZZER,
+    SCHED_MATRIX,
+    SCHED_DISPLAY_SERVER,
+    SCHED_DETECTOR
+};
+
 // estado do semáforo
 volatile traffic_light_state light_state = GREEN_LIGHT;
 // controla se o buzzer já tocou após mudar
@@ -44,67 +123,205 @@ volatile bool buzzer_already_played = false;
 volatile bool buzzer_active = true;
 // controla a luz amarela piscando
 volatile bool night_toggle = false;
+// instante (ms) do fim da fase atual, publicado pelo controlador a cada posição da roda
+volatile uint32_t phase_deadline_ms = 0;
+// a fase atual tem contagem regressiva (verde, amarelo e vermelho fora da preempção)
+volatile bool phase_countdown = false;
+// modo noturno solicitado pelo botão A
+volatile bool night_mode_requested = false;
+
+// estado de todos os cruzamentos controlados pela placa
+intersections_t intersections;
+// atraso do verde de cada placa em relação ao mestre (onda verde)
+const uint16_t wave_offsets_ms[] = {0, 2000, 4000};
+
+// task controladora, acordada pela interrupção do detector de emergência
+TaskHandle_t controller_task;
+// tasks de saída, acordadas pelo controlador sempre que o estado muda (LED, matriz, display e buzzer;
+// com o motor de saídas a primeira atende as três primeiras e as duas seguintes ficam vazias)
+TaskHandle_t output_tasks[4];
+// task dos botões, acordada pela interrupção das bordas
+TaskHandle_t button_task;
+
+// índices das tasks críticas no supervisor (as tasks de saída guardam o seu no output_engine_t)
+static uint8_t controller_watch, buzzer_watch, button_watch, display_watch;
+// estado salvo antes de um reset pelo watchdog, continuado pelo controlador
+static supervisor_state_t resume_state;
+static bool resumed;
 
 // variaveis relacionadas a matriz de led
 PIO pio;
 uint sm;
-// variavel do display
-ssd1306_t ssd; // Inicializa a estrutura do display
+// mutex com herança de prioridade para a PIO (o I2C pertence só ao servidor do display)
+SemaphoreHandle_t pio_mutex;
 
 // inicializacao da PIO
 void PIO_setup(PIO *pio, uint *sm);
-// inicializa o display
-void ssd_setup();
+// estado seguro (vermelho) no LED RGB e na matriz logo no início do boot
+void safe_output_setup(void);
+
+// tempo (ms) até o fim da fase publicada pelo controlador
+static uint32_t phase_remaining_ms(uint32_t now_ms)
+{
+    int32_t remaining = (int32_t)(phase_deadline_ms - now_ms);
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+// janela para apagar um setor do registro: sem preempção e com a fase atual durando mais que a pausa
+static bool phase_log_window(uint32_t stall_ms)
+{
+    return !preempt_requested() && phase_remaining_ms(pdTICKS_TO_MS(xTaskGetTickCount())) > stall_ms;
+}
 
 // controla a cor do semáforo
-void vTrafficLightControllerTask(void *pvParameters)
+/*
+avança as fases de todos os cruzamentos a cada posição da roda de temporização
+e publica a fase do cruzamento principal no estado global light_state
+
+roda da RAM, como a interrupção do detector: depois de cada operação da flash o cache do
+XIP está vazio, e a volta que vem logo depois não espera a leitura da flash
+*/
+void __not_in_flash_func(vTrafficLightControllerTask)(void *pvParameters)
 {
     // Marca o tempo atual para controle do atraso periódico
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    TickType_t xNextWakeTime = xTaskGetTickCount();
+
+    boot_mark("escalonador");
+
+    intersections_init(&intersections, pdTICKS_TO_MS(xNextWakeTime));
+    intersections_add(&intersections, 0);
+
+    // A DEMANDA DOS DETECTORES SÓ ATUA NO MESTRE DA ONDA: NOS SEGUIDORES A CORREÇÃO DA ONDA DESFARIA O AJUSTE
+    control_t control = {.ctl = &intersections, .main = MAIN_INTERSECTION, .actuated = DETECTORS && WAVE_NODE == 0};
+
+    // DEPOIS DE UM RESET PELO WATCHDOG CONTINUA A FASE SALVA EM VEZ DE RECOMEÇAR NO VERDE
+    if (resumed)
+        intersections_restore(&intersections, MAIN_INTERSECTION, resume_state.phase, resume_state.remaining_ms);
+
+    // ÚLTIMOS VALORES REGISTRADOS NO LOG DE AUDITORIA
+    uint8_t logged_phase = NUM_PHASES;
+    bool logged_night = false;
+    bool logged_preempt = false;
 
     while (1)
     {
-        // Se estiver no modo noturno, alterna o estado da variável de piscar luzes
-        if (light_state == NIGHT_MODE)
+        sched_stats_job_begin(SCHED_CONTROLLER);
+
+        // O RELÓGIO E AS ENTRADAS SÃO LIDOS UMA VEZ POR VOLTA: É EXATAMENTE O QUE A GRAVAÇÃO GUARDA
+        uint32_t now_ms = pdTICKS_TO_MS(xTaskGetTickCount());
+        supervisor_checkin(controller_watch, now_ms);
+        input_record_prepare(&control, WAVE_NODE, !buzzer_active, preempt_filter_state());
+
+        control_inputs_t inputs = {.night = night_mode_requested};
+#if DETECTORS
+        uint32_t occupied = detector_occupied();
+        inputs.demand = (occupied >> DETECTOR_MAIN & 1 ? CONTROL_DEMAND_MAIN : 0) |
+                        (occupied >> DETECTOR_CROSS & 1 ? CONTROL_DEMAND_CROSS : 0);
+#endif
+
+        // O FILTRO DO DETECTOR E A GRAVAÇÃO SEM UMA BORDA NO MEIO: A REPRODUÇÃO VÊ A MESMA ORDEM
+        uint32_t save = save_and_disable_interrupts();
+        inputs.preempt = preempt_update(now_ms);
+        input_record_inputs(&control, &inputs, now_ms);
+        restore_interrupts(save);
+
+        if (inputs.night != logged_night)
         {
-            night_toggle = !night_toggle;
-
-            // AGUARDA 1s para piscar o led
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000));
-            continue;
+            phase_log_append(PHASE_LOG_MODE, inputs.night);
+            logged_night = inputs.night;
+        }
+        if (inputs.preempt && !(intersections.flags[MAIN_INTERSECTION] & INTERSECTION_PREEMPT))
+            preempt_mark_applied();
+        if (inputs.preempt != logged_preempt)
+        {
+            phase_log_append(PHASE_LOG_PREEMPT, inputs.preempt);
+            logged_preempt = inputs.preempt;
         }
 
-        // MUDA O VALOR DO ESTADO DO semáforo
-        // SEMPRE QUE MUDAR O ESTADO O BUZZER É LIBERADO PARA TOCAR
-        light_state = GREEN_LIGHT;
-        buzzer_already_played = false;
-
-        // SINAL VERDE POR 3s(APENAS DISPLAY, LED E MATRIZ DE LEDS)
-        for (int i = 0; i < 12 && light_state != NIGHT_MODE; i++)
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(250));
-
-        // CHECA SE O VALOR DO ESTADO MUDOU
-        if (light_state == NIGHT_MODE)
-            continue;
+        // MODO, PREEMPÇÃO E DEMANDA EM TODOS OS CRUZAMENTOS E A RODA ATÉ AGORA (lib/control.c)
+        bool changed = control_step(&control, &inputs, now_ms);
 
-        // MUDA O VALOR DO ESTADO DO semáforo
-        light_state = YELLOW_LIGHT;
-        buzzer_already_played = false;
+        // SEMPRE QUE MUDAR O ESTADO O BUZZER É LIBERADO PARA TOCAR
+        if (changed)
+        {
+            night_toggle = intersections.flags[MAIN_INTERSECTION] & INTERSECTION_TOGGLE;
+            light_state = intersections.phase[MAIN_INTERSECTION];
+            buzzer_already_played = false;
+            input_record_phase(light_state, night_toggle, now_ms);
 
-        // SINAL AMARELO POR 1.5s(APENAS DISPLAY, LED E MATRIZ DE LEDS)
-        for (int i = 0; i < 6 && light_state != NIGHT_MODE; i++)
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(250));
+            // O PISCA DO MODO NOTURNO NÃO É TROCA DE FASE: SÓ AS FASES VÃO PARA O REGISTRO
+            if (light_state != logged_phase)
+            {
+                phase_log_append(PHASE_LOG_PHASE, light_state);
+                logged_phase = light_state;
+            }
 
-        if (light_state == NIGHT_MODE)
-            continue;
+            // ACORDA AS SAÍDAS PARA A MUDANÇA APARECER SEM ESPERAR O PERÍODO DELAS
+            for (uint i = 0; i < count_of(output_tasks); i++)
+            {
+                if (output_tasks[i] != NULL)
+                    xTaskNotifyGive(output_tasks[i]);
+            }
+        }
 
-        // MUDA O VALOR DO ESTADO DO semáforo
-        light_state = RED_LIGHT;
-        buzzer_already_played = false;
+        // SINCRONIZA A FASE COM AS PLACAS VIZINHAS (A CORREÇÃO VEM DA UART: TAMBÉM É UMA ENTRADA GRAVADA)
+        uint32_t deadline = intersections.deadline[MAIN_INTERSECTION];
+        green_wave_update(&intersections, MAIN_INTERSECTION, changed);
+        if (intersections.deadline[MAIN_INTERSECTION] != deadline)
+            input_record_shift(intersections.deadline[MAIN_INTERSECTION] - deadline, now_ms);
+
+        // PUBLICA O FIM DA FASE (DEPOIS DA CORREÇÃO DA ONDA VERDE) PARA AS CONTAGENS REGRESSIVAS; UM PRAZO
+        // MOVIDO NO MEIO DA FASE (DEMANDA OU ONDA VERDE) ACORDA A SAÍDA DO DISPLAY, QUE ESPERAVA A TROCA
+        // DE DÍGITO PELO PRAZO ANTIGO (COM O MOTOR DE SAÍDAS ELA É A TASK ÚNICA)
+        TaskHandle_t display_output = output_tasks[OUTPUT_ENGINE ? 0 : 2];
+        if (!changed && phase_deadline_ms != intersections.deadline[MAIN_INTERSECTION] && display_output != NULL)
+            xTaskNotifyGive(display_output);
+        phase_deadline_ms = intersections.deadline[MAIN_INTERSECTION];
+        phase_countdown = intersections.phase[MAIN_INTERSECTION] <= RED_LIGHT &&
+                          !(intersections.flags[MAIN_INTERSECTION] & INTERSECTION_PREEMPT);
+
+        // SALVA O ESTADO NO RASCUNHO DO WATCHDOG A CADA VOLTA (QUATRO ESCRITAS DE REGISTRADOR)
+        uint32_t remaining = intersections_remaining(&intersections, MAIN_INTERSECTION, now_ms);
+        supervisor_state_t state = {
+            .phase = light_state,
+            .night = inputs.night,
+            .muted = !buzzer_active,
+            .remaining_ms = remaining < UINT16_MAX ? remaining : UINT16_MAX};
+        recovery_save(&state);
+
+        sched_stats_job_end(SCHED_CONTROLLER);
+
+        // AGUARDA A PRÓXIMA POSIÇÃO DA RODA OU A INTERRUPÇÃO DO DETECTOR
+        TickType_t now = xTaskGetTickCount();
+        while ((int32_t)(now - xNextWakeTime) >= 0)
+            xNextWakeTime += pdMS_TO_TICKS(WHEEL_TICK_MS);
+
+        // COM TODOS OS CRUZAMENTOS NO MODO NOTURNO NÃO HÁ ONDA VERDE NEM CONTAGEM: DORME ATÉ O PRÓXIMO PISCA
+        // (O DETECTOR E O BOTÃO A ACORDAM O CONTROLADOR ANTES)
+        bool night = true;
+        for (uint16_t i = 0; i < intersections.count; i++)
+            night = night && intersections.phase[i] == NIGHT_MODE;
+        if (night)
+        {
+            int32_t until = (int32_t)(intersections_next_deadline(&intersections) - pdTICKS_TO_MS(now));
+            xNextWakeTime = now + pdMS_TO_TICKS(until > 0 ? until : 1);
+        }
 
-        // SINAL VERMELHO POR 4s(APENAS DISPLAY, LED E MATRIZ DE LEDS)
-        for (int i = 0; i < 16 && light_state != NIGHT_MODE; i++)
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(250));
+        // DETECTOR AINDA ASSENTANDO: ACORDA QUANDO O FILTRO PUDER DECIDIR (AS BORDAS SEGUINTES NÃO ACORDAM)
+        uint32_t settle = preempt_wait_ms(pdTICKS_TO_MS(now));
+        if (settle && (int32_t)(now + pdMS_TO_TICKS(settle) - xNextWakeTime) < 0)
+            xNextWakeTime = now + pdMS_TO_TICKS(settle);
+
+        // O PRAZO DO CRUZAMENTO PRINCIPAL FORA DA GRADE DA RODA (ONDA VERDE, RETOMADA DEPOIS DE UM RESET) ACORDA
+        // NELE MESMO, E NÃO NA POSIÇÃO SEGUINTE: A FASE TERMINA JUNTO COM AS CONTAGENS REGRESSIVAS. A GRADE
+        // DA RODA CONTINUA EM xNextWakeTime
+        TickType_t wake = xNextWakeTime;
+        int32_t until = (int32_t)(intersections.deadline[MAIN_INTERSECTION] - pdTICKS_TO_MS(now));
+        TickType_t phase_end = now + pdMS_TO_TICKS(until > 0 ? until : 1);
+        if ((int32_t)(phase_end - wake) < 0)
+            wake = phase_end;
+
+        ulTaskNotifyTake(pdTRUE, wake - now);
     }
 }
 
@@ -115,98 +332,145 @@ GREEN_LIGHT -> led verde aceso
 YELLOW_LIGHT -> led verde e vermelho aceso
 RED_LIGHT -> led vermelho aceso
 NIGHT_MODE -> led verde e vermelho aceso quando o estado global night_toggle mudar para true
+PREEMPT_MODE -> led vermelho aceso
+os pinos já foram inicializados no estado seguro (safe_output_setup); o LED só muda com o estado
 */
-void vLedTask(void *pvParameters)
+static uint32_t led_render(uint32_t now_ms)
 {
-    // INICIALIZA OS PINOS DO LED RBG
-    gpio_init(ledR);
-    gpio_init(ledG);
-    gpio_set_dir(ledR, GPIO_OUT);
-    gpio_set_dir(ledG, GPIO_OUT);
-
-    // Marca o tempo atual para controle do atraso periódico
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    static bool first = true;
+    static bool shown_red = true, shown_green = false; // ESTADO SEGURO DO BOOT
+    bool red, green;
 
-    while (1)
+    // CHAVEAMENTO DA COR EXIBIDA DO LED BASEADO NO ESTADO DO semáforo
+    switch (light_state)
     {
+    case GREEN_LIGHT:
+        red = false;
+        green = true;
+        break;
+
+    case YELLOW_LIGHT:
+        red = true;
+        green = true;
+        break;
+
+    case RED_LIGHT:
+    case PREEMPT_MODE:
+        red = true;
+        green = false;
+        break;
+
+    case NIGHT_MODE:
+        red = night_toggle;
+        green = night_toggle;
+        break;
+
+    default:
+        red = false;
+        green = false;
+        break;
+    }
 
-        // CHAVEAMENTO DA COR EXIBIDA DO LED BASEADO NO ESTADO DO semáforo
-        switch (light_state)
-        {
-        case GREEN_LIGHT:
-            gpio_put(ledR, false);
-            gpio_put(ledG, true);
-            break;
-
-        case YELLOW_LIGHT:
-            gpio_put(ledR, true);
-            gpio_put(ledG, true);
-            break;
-
-        case RED_LIGHT:
-            gpio_put(ledR, true);
-            gpio_put(ledG, false);
-            break;
-
-        case NIGHT_MODE:
-            gpio_put(ledR, night_toggle);
-            gpio_put(ledG, night_toggle);
-            break;
+    gpio_put(ledR, red);
+    gpio_put(ledG, green);
 
-        default:
-            gpio_put(ledR, false);
-            gpio_put(ledG, false);
-            break;
-        }
+    // SÓ UMA MUDANÇA DE COR FECHA A MEDIÇÃO DA PREEMPÇÃO (DO VERMELHO PARA A EMERGÊNCIA QUEM FECHA É A SIRENE)
+    if (red != shown_red || green != shown_green)
+    {
+        preempt_mark_output();
+        shown_red = red;
+        shown_green = green;
+    }
 
-        // EVITA USO EXCESSIVO DE CPU
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(500));
+    if (first)
+    {
+        boot_mark("led na fase");
+        first = false;
     }
+
+    return OUTPUT_WAIT_EVENT;
 }
 
 // desenho do semáforo na matriz de leds
 /*
-muda a cor do led baseado no valor do estado global light_state
-GREEN_LIGHT -> animação de sinal verde
-YELLOW_LIGHT -> animação de sinal amarelo
-RED_LIGHT -> animação de sinal vermelho
-NIGHT_MODE -> animação do modo noturno
+anima a matriz a 50 fps baseado no valor do estado global light_state
+GREEN_LIGHT -> sinal verde e barra verde com o tempo restante da fase
+YELLOW_LIGHT -> sinal amarelo e barra amarela com o tempo restante da fase
+RED_LIGHT -> sinal vermelho e barra vermelha com o tempo restante da fase
+NIGHT_MODE -> amarelo acendendo e apagando junto com o pisca
+PREEMPT_MODE -> sinal vermelho
+as trocas de lâmpada são transições suaves de ANIM_FADE_MS; sem transição nem barra o quadro
+fica estático na matriz até a próxima mudança de estado
 */
-void vTrafficLightTask(void *pvParameters)
+// a animação parte do vermelho do estado seguro enviado no boot (iniciada no main)
+static matrix_anim_t matrix_anim;
+
+static uint32_t matrix_render(uint32_t now)
 {
-    // Marca o tempo atual para controle do atraso periódico
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    // BARRA DE CONTAGEM REGRESSIVA COM A COR DE CADA FASE, EM BRILHO BAIXO
+    static const dither_level_t bar_colors[] = {
+        [GREEN_LIGHT] = {0x0400, 0, 0},
+        [YELLOW_LIGHT] = {0x0300, 0x0300, 0},
+        [RED_LIGHT] = {0, 0x0400, 0}};
 
-    while (1)
+    traffic_light_state state = light_state;
+
+    // CHAVEAMENTO DO QUADRO DE DESTINO DA TRANSIÇÃO BASEADO NO ESTADO DO semáforo
+    switch (state)
     {
-        // CHAVEAMENTO DA ANIMACÃO DO semáforo EXIBIDA NA MATRIZ DE LEDS BASEADO NO ESTADO DO semáforo
-        switch (light_state)
-        {
-        case GREEN_LIGHT:
-            vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(50));
-            draw_traffic_light(pio, sm, GREEN, false);
+    case GREEN_LIGHT:
+        matrix_anim_set_target(&matrix_anim, traffic_light_levels(GREEN, false)->levels, now);
+        break;
+
+    case YELLOW_LIGHT:
+        matrix_anim_set_target(&matrix_anim, traffic_light_levels(YELLOW, false)->levels, now);
+        break;
+
+    case RED_LIGHT:
+    case PREEMPT_MODE:
+        matrix_anim_set_target(&matrix_anim, traffic_light_levels(RED, false)->levels, now);
+        break;
+
+    case NIGHT_MODE:
+        // O PISCA É UMA TRANSIÇÃO PARA O AMARELO ACESO OU PARA A MOLDURA APAGADA A CADA BORDA
+        matrix_anim_set_target(&matrix_anim, traffic_light_levels(night_toggle ? YELLOW : BLACK, true)->levels, now);
+        break;
+
+    default:
+        matrix_anim_set_target(&matrix_anim, traffic_light_levels(BLACK, false)->levels, now);
+        break;
+    }
 
-            break;
+    matrix_anim_render(&matrix_anim, now);
+    bool animating = now - matrix_anim.fade_start_ms < ANIM_FADE_MS;
 
-        case YELLOW_LIGHT:
-            draw_traffic_light(pio, sm, YELLOW, false);
-            break;
+    if (phase_countdown && state <= RED_LIGHT)
+    {
+        // FRAÇÃO RESTANTE DA FASE ACENDE A BARRA DE BAIXO PARA CIMA
+        uint32_t remaining = phase_remaining_ms(now);
+        uint32_t duration = phase_duration_ms[state];
+        uint32_t fraction = remaining >= duration ? ANIM_ONE : remaining * ANIM_ONE / duration;
+        matrix_anim_bar(&matrix_anim, traffic_bar_pixels, TRAFFIC_BAR_LENGTH, fraction, bar_colors[state]);
+        animating = true;
+    }
 
-        case RED_LIGHT:
-            draw_traffic_light(pio, sm, RED, false);
-            break;
+    // QUADRO PARADO: ENVIA UMA VEZ E DESLIGA O TIMER DO PONTILHAMENTO PARA O NÚCLEO PODER DORMIR
+    sched_stats_lock(SCHED_MATRIX, pio_mutex);
+    if (animating)
+        matrix_dither_show(matrix_anim.out);
+    else
+        matrix_dither_hold(matrix_anim.out);
+    sched_stats_unlock(SCHED_MATRIX, pio_mutex);
 
-        case NIGHT_MODE:
-            draw_traffic_light(pio, sm, night_toggle ? YELLOW : BLACK, true);
-            break;
+    // PRÓXIMO QUADRO DA ANIMAÇÃO, OU SÓ NA PRÓXIMA MUDANÇA DE ESTADO COM O QUADRO PARADO
+    return animating ? ANIM_FRAME_MS : OUTPUT_WAIT_EVENT;
+}
 
-        default:
-            draw_traffic_light(pio, sm, BLACK, false);
-            break;
-        }
-        // EVITA USO EXCESSIVO DE CPU
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(500));
-    }
+// toque no buzzer A, gravado com a fase em que tocou (a reprodução confere um toque por fase)
+static void beep(uint16_t duration_ms)
+{
+    input_record_beep(light_state);
+    buzzer_pwm(BUZZER_A, BUZZER_FREQUENCY, duration_ms);
 }
 
 // task para o aviso sonoro
@@ -215,7 +479,9 @@ feedback sonoro controlado pelo estado global light_state e pela flag buzzer_alr
 GREEN_LIGHT -> toque por 1s
 YELLOW_LIGHT -> toque intermitente
 RED_LIGHT -> toque por 0.5s
-NIGHT_MODE -> toque longo a cada 2s
+NIGHT_MODE -> toque longo na metade acesa de cada pisca (a cada 2s)
+PREEMPT_MODE -> toques curtos e rápidos enquanto durar a preempção
+fora dos toques repetidos a task só acorda quando o estado muda ou o botão B é apertado
 */
 void vBuzzerTask(void *pvParameters)
 {
@@ -224,24 +490,26 @@ void vBuzzerTask(void *pvParameters)
 
     while (1)
     {
-        if (buzzer_active)
-        {
+        supervisor_checkin(buzzer_watch, pdTICKS_TO_MS(xTaskGetTickCount()));
+        sched_stats_job_begin(SCHED_BUZZER);
 
-            // TOCA UM BEEP A CADA 2s
-            if (light_state == NIGHT_MODE)
-            {
-                buzzer_pwm(BUZZER_A, BUZZER_FREQUENCY, 1000); // 1000ms
-                vTaskDelay(pdMS_TO_TICKS(1000));              // 2s total
-                continue;
-            }
+        bool repeat = false; // O ESTADO ATUAL TOCA DE NOVO SEM ESPERAR OUTRA MUDANÇA
 
+        if (buzzer_active)
+        {
             switch (light_state)
             {
+            case NIGHT_MODE:
+                // TOCA UM BEEP QUANDO O PISCA ACENDE (O CONTROLADOR ACORDA A TASK A CADA BORDA)
+                if (night_toggle)
+                    beep(1000); // 1000ms
+                break;
+
             case GREEN_LIGHT:
                 // TOCA UM BEEP DE 1s PARA INDICAR SINAL VERDE
                 if (!buzzer_already_played)
                 {
-                    buzzer_pwm(BUZZER_A, BUZZER_FREQUENCY, 1000); // 1s
+                    beep(1000); // 1s
                     buzzer_already_played = true;
                 }
                 break;
@@ -252,10 +520,19 @@ void vBuzzerTask(void *pvParameters)
                 {
                     // Aguarda 100ms para garantir que a luz amarela já esteja visível
                     vTaskDelay(pdMS_TO_TICKS(200));
-                    buzzer_pwm(BUZZER_A, BUZZER_FREQUENCY, 50);
+                    beep(50);
                     vTaskDelay(pdMS_TO_TICKS(100));
                     buzzer_already_played = false;
                 }
+                repeat = true;
+                break;
+
+            case PREEMPT_MODE:
+                // SIRENE DE AVISO DO VEÍCULO DE EMERGÊNCIA (O PRIMEIRO TOQUE É UMA SAÍDA ALTERADA)
+                preempt_mark_output();
+                beep(100);
+                vTaskDelay(pdMS_TO_TICKS(100));
+                repeat = true;
                 break;
 
             case RED_LIGHT:
@@ -263,7 +540,7 @@ void vBuzzerTask(void *pvParameters)
                 if (!buzzer_already_played)
                 {
                     vTaskDelay(pdMS_TO_TICKS(100));
-                    buzzer_pwm(BUZZER_A, BUZZER_FREQUENCY, 500);
+                    beep(500);
                     vTaskDelay(pdMS_TO_TICKS(1500));
                     buzzer_already_played = true;
                 }
@@ -272,19 +549,53 @@ void vBuzzerTask(void *pvParameters)
             default:
                 break;
             }
-
-            // ECONOMIA DE CPU
-            vTaskDelay(pdMS_TO_TICKS(250));
         }
+
+        sched_stats_job_end(SCHED_BUZZER);
+
+        // TOQUES REPETIDOS A CADA 250ms; NOS OUTROS CASOS DORME ATÉ A PRÓXIMA MUDANÇA (OU O BOTÃO B)
+        if (!repeat)
+            supervisor_idle(buzzer_watch);
+        ulTaskNotifyTake(pdTRUE, repeat ? pdMS_TO_TICKS(250) : portMAX_DELAY);
     }
 }
 
-// task em pooling para leitura do botão
+// bits de cada botão na notificação da task dos botões
+#define BUTTON_A_BIT (1u << 0)
+#define BUTTON_B_BIT (1u << 1)
+
+// interrupção dos botões: só registra a borda de descida e acorda a task (o debounce fica na task)
+static void button_irq(void)
+{
+    uint32_t pressed = 0;
+
+    if (gpio_get_irq_event_mask(BUTTON_A) & GPIO_IRQ_EDGE_FALL)
+    {
+        gpio_acknowledge_irq(BUTTON_A, GPIO_IRQ_EDGE_FALL);
+        input_record_edge_from_isr(0);
+        pressed |= BUTTON_A_BIT;
+    }
+    if (gpio_get_irq_event_mask(BUTTON_B) & GPIO_IRQ_EDGE_FALL)
+    {
+        gpio_acknowledge_irq(BUTTON_B, GPIO_IRQ_EDGE_FALL);
+        input_record_edge_from_isr(1);
+        pressed |= BUTTON_B_BIT;
+    }
+
+    if (pressed)
+    {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(button_task, pressed, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// task dos botões acordada pela interrupção
 /*
-polling de leitura com debounce de 200ms dos botoes A e B
+leitura por borda de descida com debounce de 200ms dos botoes A e B
 Botão A -> muda a configuração do modo
 Botão B -> desabilita o som do buzzer
-
+sem polling: entre os toques a task fica bloqueada e o núcleo pode dormir
 */
 void vButtonTask(void *pvParameters)
 {
@@ -297,142 +608,646 @@ void vButtonTask(void *pvParameters)
     gpio_set_dir(BUTTON_B, GPIO_IN);
     gpio_pull_up(BUTTON_B);
 
-    bool last_button_a_state = true;
-    bool last_button_b_state = true;
+    // handler próprio dos dois pinos, ao lado do callback do detector de emergência
+    gpio_add_raw_irq_handler_masked((1u << BUTTON_A) | (1u << BUTTON_B), button_irq);
+    gpio_set_irq_enabled(BUTTON_A, GPIO_IRQ_EDGE_FALL, true);
+    gpio_set_irq_enabled(BUTTON_B, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
 
     while (1)
     {
-        bool current_a_state = gpio_get(BUTTON_A);
-        bool current_b_state = gpio_get(BUTTON_B);
-
-        // Botão A PRESSIONADO MODIFICA O MODO DO semáforo
-        if (!current_a_state && last_button_a_state)
+        uint32_t pressed = 0;
+        supervisor_idle(button_watch);
+        xTaskNotifyWait(0, UINT32_MAX, &pressed, portMAX_DELAY);
+        supervisor_checkin(button_watch, pdTICKS_TO_MS(xTaskGetTickCount()));
+
+        // ESPERA O REPIQUE: SÓ VALE O BOTÃO QUE CONTINUA PRESSIONADO (DESCARTA AS BORDAS DA SOLTURA)
+        vTaskDelay(pdMS_TO_TICKS(BUTTON_SETTLE_MS));
+
+        sched_stats_job_begin(SCHED_BUTTON);
+
+        // NÍVEIS LIDOS DEPOIS DO REPIQUE, GRAVADOS ANTES DE MUDAR O ESTADO (O CONTROLADOR PODE RODAR LOGO EM SEGUIDA)
+        bool a_down = (pressed & BUTTON_A_BIT) && !gpio_get(BUTTON_A);
+        bool b_down = (pressed & BUTTON_B_BIT) && !gpio_get(BUTTON_B);
+        if (pressed & BUTTON_A_BIT)
+            input_record_level(0, a_down);
+        if (pressed & BUTTON_B_BIT)
+            input_record_level(1, b_down);
+
+        // Botão A PRESSIONADO MODIFICA O MODO DO semáforo (O CONTROLADOR APLICA NA HORA)
+        if (a_down)
         {
-            if (light_state == NIGHT_MODE)
-            {
-                light_state = GREEN_LIGHT;
-            }
-            else
-            {
-                light_state = NIGHT_MODE;
-            }
-
-            vTaskDelay(pdMS_TO_TICKS(200)); // debounce
+            phase_log_append(PHASE_LOG_BUTTON, 0);
+            night_mode_requested = !night_mode_requested;
+            xTaskNotifyGive(controller_task);
         }
 
         // Botão B pressionado
-        if (!current_b_state && last_button_b_state)
+        if (b_down)
         {
+            phase_log_append(PHASE_LOG_BUTTON, 1);
             buzzer_active = !buzzer_active;
-            vTaskDelay(pdMS_TO_TICKS(200)); // debounce
+            input_record_mute(!buzzer_active);
+            phase_log_append(PHASE_LOG_MUTE, !buzzer_active);
+            xTaskNotifyGive(output_tasks[3]);
         }
 
-        last_button_a_state = current_a_state;
-        last_button_b_state = current_b_state;
+        sched_stats_job_end(SCHED_BUTTON);
 
-        vTaskDelay(pdMS_TO_TICKS(10)); // polling rápido
+        // debounce: descarta as bordas que chegaram durante o intervalo
+        vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_MS));
+        xTaskNotifyWait(0, UINT32_MAX, NULL, 0);
     }
 }
 
-// Task para desenhar no display para o pedestre
+// desenho no display para o pedestre
 // feedback visual controlado pelo estado global light_state
 // GREEN_LIGHT -> animação do pedestre andando e a mensagem para andar
 // YELLOW_LIGHT -> animação do pedestre parado e a mensagem para ter anteção
 // RED_LIGHT -> animação do pedestre parado e a mensagem para esperar
-// NIGHT_MODE -> mensagem de atenção e display piscando
+// NIGHT_MODE -> mensagem de atenção e display piscando pela inversão do controlador do display
+// PREEMPT_MODE -> animação do pedestre parado e a mensagem de emergência
 
-void vDisplayAnimationTask(void *pvParameters)
+// apaga a área da contagem e desenha os segundos restantes alinhados à direita (seconds < 0 só apaga)
+static void draw_countdown(int seconds)
 {
-    float arm_rotate = 0; // CONTROLA A ROTAÇÃO DOS BRAÇOS NA ANIMAÇÃO
-    float leg_rotate = 0; // CONTROLA A ROTAÇÃO DAS PERNAS NA ANIMAÇÃO
-    int arm_factor = 4;   // FATOR QUE ALTERA A ROTAÇÃO
-    int leg_factor = 6;   // FATOR QUE ALTERA A ROTAÇÃO
+    display_rect(COUNTDOWN_X, COUNTDOWN_Y, COUNTDOWN_W, 8 * COUNTDOWN_SCALE, false, true);
+    if (seconds < 0)
+        return;
+
+    char digits[4];
+    snprintf(digits, sizeof(digits), "%d", seconds > 99 ? 99 : seconds);
+    uint8_t width = strlen(digits) * 8 * COUNTDOWN_SCALE;
+    display_text_scaled(digits, COUNTDOWN_X + COUNTDOWN_W - width, COUNTDOWN_Y, COUNTDOWN_SCALE);
+}
 
-    // Marca o tempo atual para controle do atraso periódico
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+static uint32_t display_render(uint32_t now)
+{
+    static uint32_t walk_start;                          // INÍCIO DA ANIMAÇÃO DE CAMINHADA
+    static traffic_light_state shown_state = NUM_PHASES; // ESTADO DO ÚLTIMO QUADRO ENVIADO
+    static const uint8_t *shown_pedestrian = NULL;       // QUADRO DO BONECO NA TELA
+    static int shown_seconds = -1;                       // SEGUNDOS NA TELA (-1 = SEM CONTAGEM)
 
-    while (1)
+    traffic_light_state state = light_state;
+
+    // A CAMINHADA RECOMEÇA DO PRIMEIRO QUADRO A CADA VERDE
+    if (state != GREEN_LIGHT || shown_state != GREEN_LIGHT)
+        walk_start = now;
+
+    // Boneco: caminhando no verde, parado nos outros estados
+    const asset_sprite_frame_t *pedestrian = &pedestrian_stand.frames[0];
+    if (state == GREEN_LIGHT)
+        pedestrian = asset_sprite_frame(&pedestrian_walk, now - walk_start);
+
+    // SEGUNDOS RESTANTES ARREDONDADOS PARA CIMA: O DÍGITO TROCA NO INSTANTE EXATO DE CADA SEGUNDO
+    uint32_t remaining = phase_remaining_ms(now);
+    int seconds = phase_countdown ? (int)((remaining + 999) / 1000) : -1;
+
+    // O QUADRO INTEIRO DESTA TASK CHEGA JUNTO AO SERVIDOR, SEM COMANDOS DE OUTRAS TASKS NO MEIO
+    display_begin();
+    if (state != shown_state)
     {
-        ssd1306_fill(&ssd, false); // LIMPA O DISPLAY
-
-        // Desenha o boneco
-        ssd1306_rect(&ssd, 10, (WIDTH - 10) / 2, 10, 10, true, true);                              // cabeça
-        ssd1306_rect(&ssd, 20, (WIDTH - 10) / 2 + 2, 6, 20, true, true);                           // tronco
-        ssd1306_rotated_rect_angle(&ssd, (WIDTH - 10) / 2 + 10, 26, 10, 5, 45 + arm_rotate, true); // braço 1
-        ssd1306_rotated_rect_angle(&ssd, (WIDTH - 10) / 2, 26, 10, 5, 135 - arm_rotate, true);     // braço 2
-        ssd1306_rotated_rect_angle(&ssd, (WIDTH - 10) / 2 + 3, 40, 15, 5, 90 + leg_rotate, true);  // perna 1
-        ssd1306_rotated_rect_angle(&ssd, (WIDTH - 10) / 2 + 6, 40, 15, 5, 90 - leg_rotate, true);  // perna 2
-
-        // NO MODO NORTURNO PISCA A TELA A CADA 1s
-        if (light_state == NIGHT_MODE && night_toggle)
-        {
-            ssd1306_fill(&ssd, true);
-        }
+        display_clear(); // LIMPA O DISPLAY
+
+        display_sprite(pedestrian->bitmap, PEDESTRIAN_X, PEDESTRIAN_Y, pedestrian_walk.width, pedestrian_walk.height);
 
         // CONTROLA AS MENSAGENS DE AVISO NO DISPLAY
-        switch (light_state)
+        switch (state)
         {
         case GREEN_LIGHT:
-            ssd1306_draw_string(&ssd, "PODE SEGUIR!", 0, 0);
+            display_text("PODE SEGUIR!", 0, 0);
             break;
 
         case YELLOW_LIGHT:
-            ssd1306_draw_string(&ssd, "ATENCAO!", 0, 0);
+            display_text("ATENÇÃO!", 0, 0);
             break;
 
         case RED_LIGHT:
-            ssd1306_draw_string(&ssd, "ESPERE!", 0, 0);
+            display_text("ESPERE!", 0, 0);
             break;
 
         case NIGHT_MODE:
-            ssd1306_draw_string(&ssd, "ATENCAO!", 0, 0);
+            display_text("ATENÇÃO!", 0, 0);
+            break;
+
+        case PREEMPT_MODE:
+            display_text("EMERGÊNCIA!", 0, 0);
             break;
 
         default:
-            ssd1306_draw_string(&ssd, "---", 0, 0);
+            display_text("---", 0, 0);
             break;
         }
 
-        ssd1306_send_data(&ssd); // ATUALIZA A TELA
+        draw_countdown(seconds);
 
-        // Atualiza animação só no modo verde
-        if (light_state == GREEN_LIGHT)
+        // ATUALIZA A TELA E LIGA O PISCA POR INVERSÃO SÓ NO MODO NOTURNO
+        display_flush();
+        if (state == NIGHT_MODE)
+            display_effect(SSD1306_EFFECT_INVERT, phase_duration_ms[NIGHT_MODE]);
+        else if (shown_state == NIGHT_MODE)
+            display_effect(SSD1306_EFFECT_NONE, 0);
+
+        shown_state = state;
+        shown_pedestrian = pedestrian->bitmap;
+        shown_seconds = seconds;
+    }
+    else
+    {
+        // MESMO ESTADO: SÓ AS COLUNAS DO QUE MUDOU SÃO REENVIADAS
+        if (pedestrian->bitmap != shown_pedestrian)
         {
-            arm_rotate += arm_factor;
-            leg_rotate += leg_factor;
+            display_sprite(pedestrian->bitmap, PEDESTRIAN_X, PEDESTRIAN_Y, pedestrian_walk.width, pedestrian_walk.height);
+            display_flush_region(PEDESTRIAN_X, pedestrian_walk.width);
+            shown_pedestrian = pedestrian->bitmap;
+        }
 
-            if (arm_rotate >= 45 || arm_rotate <= 0)
-                arm_factor *= -1;
-            if (leg_rotate >= 45 || leg_rotate <= 0)
-                leg_factor *= -1;
+        if (seconds != shown_seconds)
+        {
+            draw_countdown(seconds);
+            display_flush_region(COUNTDOWN_X, COUNTDOWN_W);
+            shown_seconds = seconds;
         }
+    }
+    display_end();
+
+    // PRÓXIMA TROCA DE DÍGITO OU PRÓXIMO QUADRO DA CAMINHADA; SEM NENHUM DOS DOIS
+    // (NOTURNO E EMERGÊNCIA) SÓ NA PRÓXIMA MUDANÇA DE ESTADO
+    uint32_t wait_ms = state == GREEN_LIGHT ? 100 : OUTPUT_WAIT_EVENT;
+    if (seconds > 0 && remaining - (seconds - 1) * 1000 < wait_ms)
+        wait_ms = remaining - (seconds - 1) * 1000 + 1;
+    return wait_ms;
+}
+
+// saídas atendidas pelo motor de saídas (lib/output_engine.c), na ordem de atendimento:
+// o LED primeiro, por ser a saída medida na latência da preempção
+static output_renderer_t output_renderers[] = {
+    {.name = "led", .render = led_render, .sched_id = SCHED_LED},
+    {.name = "matriz", .render = matrix_render, .sched_id = SCHED_MATRIX},
+    {.name = "display", .render = display_render, .sched_id = SCHED_DISPLAY}};
+
+#if OUTPUT_ENGINE
+// UMA ÚNICA TASK COOPERATIVA PARA AS TRÊS SAÍDAS
+static output_engine_t output_engine = {output_renderers, count_of(output_renderers), SUPERVISOR_NONE};
+#else
+// UMA TASK POR SAÍDA, CADA UMA COM O SEU RENDERIZADOR
+static output_engine_t output_engines[] = {
+    {&output_renderers[0], 1, SUPERVISOR_NONE},
+    {&output_renderers[1], 1, SUPERVISOR_NONE},
+    {&output_renderers[2], 1, SUPERVISOR_NONE}};
+#endif
+
+#if SHELL_USB
+// terminal de comandos pela USB (CDC)
+/*
+consulta o estado, as estatísticas e as pilhas, muda a duração das fases e os modos e
+acompanha os eventos ao vivo; a task tem a menor prioridade e só acorda quando chegam
+bytes pela USB ou eventos com o acompanhamento ligado
+*/
+#define SHELL_EVENTS_LENGTH 8
+
+typedef struct
+{
+    uint32_t ms;
+    uint8_t type;
+    uint8_t value;
+} shell_event_t;
+
+static shell_t shell;
+static TaskHandle_t shell_task;
+static QueueHandle_t shell_events;
+static char shell_report[768]; // relatórios montados pelos módulos (fora do caminho dos eventos)
+
+static const char *const phase_names[] = {"verde", "amarelo", "vermelho", "noturno", "emergencia"};
+static const char *const on_off[] = {"nao", "sim"};
+
+static void shell_usb_write(const char *data, size_t len)
+{
+    stdio_put_string(data, len, false, true);
+}
+
+static void shell_line(shell_t *sh, const char *name, uint32_t value)
+{
+    shell_puts(sh, name);
+    shell_write(sh, " ", 1);
+    shell_u32(sh, value);
+    shell_write(sh, "\n", 1);
+}
+
+static void shell_text(shell_t *sh, const char *name, const char *value)
+{
+    shell_puts(sh, name);
+    shell_write(sh, " ", 1);
+    shell_puts(sh, value);
+    shell_write(sh, "\n", 1);
+}
+
+static bool shell_state(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    shell_text(sh, "fase", phase_names[light_state]);
+    shell_text(sh, "modo", night_mode_requested ? "noturno" : "normal");
+    shell_line(sh, "restante_ms", phase_remaining_ms(pdTICKS_TO_MS(xTaskGetTickCount())));
+    shell_text(sh, "mudo", on_off[!buzzer_active]);
+    shell_text(sh, "preempcao", on_off[preempt_requested()]);
+    return true;
+}
 
-        // EVITA USO EXCESSIVO DA CPU
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(100));
+// duração das fases do ciclo normal, aplicada a partir da próxima troca
+static bool shell_phase(shell_t *sh, int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        for (int i = GREEN_LIGHT; i <= RED_LIGHT; i++)
+            shell_line(sh, phase_names[i], phase_duration_ms[i]);
+        return true;
     }
+
+    int phase = shell_match(argv[1], phase_names, RED_LIGHT + 1);
+    uint32_t ms;
+    if (phase < 0 || argc != 3 || !shell_parse_u32(argv[2], &ms) || ms < 500 || ms > 60000)
+        return false;
+
+    input_record_set_duration(phase, ms);
+    return true;
 }
 
+static bool shell_mode(shell_t *sh, int argc, char **argv)
+{
+    (void)sh;
+
+    static const char *const modes[] = {"normal", "noturno"};
+    int mode = argc == 2 ? shell_match(argv[1], modes, 2) : -1;
+    if (mode < 0)
+        return false;
+
+    night_mode_requested = mode;
+    xTaskNotifyGive(controller_task);
+    return true;
+}
+
+static bool shell_mute(shell_t *sh, int argc, char **argv)
+{
+    (void)sh;
+
+    int mute = argc == 2 ? shell_match(argv[1], on_off, 2) : -1;
+    if (mute < 0)
+        return false;
+
+    if (buzzer_active == (bool)mute)
+    {
+        buzzer_active = !mute;
+        input_record_mute(mute);
+        phase_log_append(PHASE_LOG_MUTE, mute);
+        xTaskNotifyGive(output_tasks[3]);
+    }
+    return true;
+}
+
+// pilha livre de cada task (a menor folga desde o início)
+static bool shell_stacks(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    static TaskStatus_t tasks[12];
+    UBaseType_t count = uxTaskGetSystemState(tasks, count_of(tasks), NULL);
+
+    for (UBaseType_t i = 0; i < count; i++)
+        shell_line(sh, tasks[i].pcTaskName, tasks[i].usStackHighWaterMark * sizeof(StackType_t));
+    return true;
+}
+
+static bool shell_stats(shell_t *sh, int argc, char **argv)
+{
+    static const char *const groups[] = {"escalonamento", "energia", "registro", "boot", "vigia", "detector", "saidas"};
+    int group = argc == 2 ? shell_match(argv[1], groups, count_of(groups)) : -1;
+    if (group < 0)
+        return false;
+
+    size_t used = 0;
+    switch (group)
+    {
+    case 0:
+        used = sched_stats_report(shell_report, sizeof(shell_report));
+        break;
+    case 1:
+        used = power_report(shell_report, sizeof(shell_report));
+        break;
+    case 2:
+        used = phase_log_report(shell_report, sizeof(shell_report));
+        break;
+    case 3:
+        used = boot_report(shell_report, sizeof(shell_report));
+        break;
+    case 4:
+        used = recovery_report(shell_report, sizeof(shell_report));
+        break;
+    case 5:
+#if DETECTORS
+        used = detector_report(shell_report, sizeof(shell_report));
+#else
+        shell_puts(sh, "detectores desligados (opcao DETECTORS)\n");
+#endif
+        break;
+    default:
+        shell_line(sh, "preempcoes", preempt_stats.requests);
+        shell_line(sh, "preempcao_max_us", preempt_stats.max_latency_us);
+        shell_line(sh, "preempcoes_sem_saida", preempt_stats.unchanged);
+        shell_line(sh, "display_quadros", display_stats.frames);
+        shell_line(sh, "display_parciais", display_stats.partial_frames);
+        shell_line(sh, "display_max_us", display_stats.max_latency_us);
+        shell_line(sh, "display_erros", display_stats.errors);
+        shell_line(sh, "onda_quadros", green_wave_stats.frames_ok);
+        shell_line(sh, "onda_descartados", green_wave_stats.frames_bad);
+        shell_puts(sh, "onda_erro_max_ms ");
+        shell_i32(sh, green_wave_stats.max_error_ms);
+        shell_write(sh, "\n", 1);
+        break;
+    }
+
+    shell_write(sh, shell_report, used);
+    return true;
+}
+
+// página do registro (ou a gravação das entradas) em hexadecimal, em linhas de até 32 bytes
+static void shell_log_sink(const uint8_t *data, size_t len, void *ctx)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[2 * 32 + 1];
+
+    for (size_t i = 0; i < len; i += 32)
+    {
+        size_t n = len - i < 32 ? len - i : 32;
+        for (size_t j = 0; j < n; j++)
+        {
+            line[2 * j] = hex[data[i + j] >> 4];
+            line[2 * j + 1] = hex[data[i + j] & 0x0F];
+        }
+        line[2 * n] = '\n';
+        shell_write(ctx, line, 2 * n + 1);
+    }
+}
+
+static bool shell_log(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    shell_line(sh, "paginas", phase_log_export(shell_log_sink, sh));
+    return true;
+}
+
+// gravação das entradas para tools/replay_host.c: começa na próxima volta do controlador
+static bool shell_record(shell_t *sh, int argc, char **argv)
+{
+    int on = argc == 2 ? shell_match(argv[1], on_off, 2) : -1;
+    if (argc == 2 && on < 0)
+        return false;
+
+    if (on == 1)
+        input_record_start();
+    else if (on == 0)
+        input_record_stop();
+
+    size_t used = input_record_report(shell_report, sizeof(shell_report));
+    shell_write(sh, shell_report, used);
+    return true;
+}
+
+// para a gravação e exporta em hexadecimal (entrada de tools/replay_host.c)
+static bool shell_inputs(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    size_t len;
+    const uint8_t *data = input_record_data(&len);
+    shell_log_sink(data, len, sh);
+    shell_line(sh, "bytes", len);
+    return true;
+}
+
+#if DETECTORS
+// último bloco do ADC, uma linha por instante com as amostras dos canais (entrada de tools/detector_host.c)
+static bool shell_samples(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    static uint16_t samples[DETECTOR_CHANNELS * DETECTOR_BLOCK_SAMPLES];
+    detector_last_block(samples);
+
+    for (uint i = 0; i < count_of(samples); i++)
+    {
+        shell_u32(sh, samples[i] & DETECTOR_ADC_MASK);
+        shell_write(sh, (i + 1) % DETECTOR_CHANNELS ? "," : "\n", 1);
+    }
+    return true;
+}
+#endif
+
+// eventos ao vivo: o registro chama no contexto de quem registrou, então só enfileira
+static void shell_listener(phase_log_type_t type, uint8_t value, uint32_t ms)
+{
+    shell_event_t event = {ms, type, value};
+    if (xQueueSend(shell_events, &event, 0) == pdTRUE)
+        xTaskNotifyGive(shell_task);
+}
+
+static bool shell_follow(shell_t *sh, int argc, char **argv)
+{
+    (void)sh;
+
+    int follow = argc == 2 ? shell_match(argv[1], on_off, 2) : -1;
+    if (follow < 0)
+        return false;
+
+    return phase_log_listen(shell_listener, follow);
+}
+
+static const shell_command_t shell_commands[] = {
+    {"ajuda", "ajuda", shell_help},
+    {"estado", "estado", shell_state},
+    {"fase", "fase [verde|amarelo|vermelho <500-60000 ms>]", shell_phase},
+    {"modo", "modo normal|noturno", shell_mode},
+    {"mudo", "mudo sim|nao", shell_mute},
+    {"pilhas", "pilhas", shell_stacks},
+    {"stats", "stats escalonamento|energia|registro|boot|vigia|detector|saidas", shell_stats},
+    {"registro", "registro", shell_log},
+    {"gravar", "gravar [sim|nao]", shell_record},
+    {"entradas", "entradas", shell_inputs},
+#if DETECTORS
+    {"amostras", "amostras", shell_samples},
+#endif
+    {"eventos", "eventos sim|nao", shell_follow}};
+
+// bytes chegando pela USB (interrupção da USB)
+static void shell_chars_available(void *param)
+{
+    (void)param;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(shell_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void vShellTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    shell_init(&shell, shell_commands, count_of(shell_commands), shell_usb_write);
+    stdio_set_chars_available_callback(shell_chars_available, NULL);
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // LÊ TUDO O QUE CHEGOU E EXECUTA AS LINHAS COMPLETAS
+        char input[32];
+        size_t length = 0;
+        int c;
+        while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT)
+        {
+            input[length++] = c;
+            if (length == sizeof(input))
+            {
+                shell_input(&shell, input, length);
+                length = 0;
+            }
+        }
+        shell_input(&shell, input, length);
+
+        // EVENTOS AO VIVO: "ev <ms> <tipo> <valor>"
+        shell_event_t event;
+        while (xQueueReceive(shell_events, &event, 0) == pdTRUE)
+        {
+            shell_write(&shell, "ev ", 3);
+            shell_u32(&shell, event.ms);
+            shell_write(&shell, " ", 1);
+            shell_text(&shell, phase_log_type_name(event.type), phase_log_value_name(event.type, event.value));
+        }
+        shell_flush(&shell);
+    }
+}
+#endif
+
 int main()
 {
+    boot_mark("main");
+
+    // o semáforo mostra vermelho antes de qualquer outra inicialização
+    safe_output_setup();
+    boot_mark("saida segura");
 
     stdio_init_all();
-    // inicializa a PIO
-    PIO_setup(&pio, &sm);
-    // inicializa o display
-    ssd_setup();
+    // pontilhamento da matriz (timer + DMA), parado até o primeiro quadro da animação
+    matrix_dither_init(pio, sm);
+    // fila do display; o I2C e o SSD1306 são inicializados pelo servidor depois que o escalonador começa
+    display_server_init(I2C_PORT, I2C_SDA, I2C_SCL, endereco);
+    // inicializa a sincronização da onda verde
+    green_wave_init(WAVE_UART, WAVE_TX, WAVE_RX, WAVE_NODE, wave_offsets_ms, count_of(wave_offsets_ms));
+    boot_mark("perifericos");
+
+    // MUTEX DA PIO
+    pio_mutex = xSemaphoreCreateMutex();
+
+    // registro de auditoria: continua o anel da flash de onde o último boot parou
+    phase_log_init(phase_log_window);
+
+    // depois de um reset pelo watchdog o modo e o buzzer voltam agora e a fase no controlador
+    resumed = recovery_restore(&resume_state);
+    if (resumed)
+    {
+        night_mode_requested = resume_state.night;
+        buzzer_active = !resume_state.muted;
+    }
+
+    // TASKS CRÍTICAS VIGIADAS PELO SUPERVISOR (O PRIMEIRO PRAZO CONTA DO INÍCIO DO ESCALONADOR)
+    controller_watch = supervisor_register("controlador", CONTROLLER_WATCH_MS, 0);
+#if OUTPUT_ENGINE
+    output_engine.supervisor_id = supervisor_register("saidas", OUTPUT_WATCH_MS, 0);
+#else
+    for (uint i = 0; i < count_of(output_engines); i++)
+        output_engines[i].supervisor_id = supervisor_register(output_renderers[i].name, OUTPUT_WATCH_MS, 0);
+#endif
+    buzzer_watch = supervisor_register("buzzer", BUZZER_WATCH_MS, 0);
+    button_watch = supervisor_register("botoes", BUTTON_WATCH_MS, 0);
+    display_watch = supervisor_register("servidor display", DISPLAY_WATCH_MS, 0);
+
+    // a animação da matriz parte do vermelho do estado seguro
+    matrix_anim_init(&matrix_anim, traffic_levels_red.levels, 0);
+
+    // TABELA DE ESCALONAMENTO (MESMA ORDEM DOS ÍNDICES SCHED_*)
+    // COM O MOTOR DE SAÍDAS, LED, DISPLAY E MATRIZ SÃO JOBS DA MESMA TASK, NA PRIORIDADE DELA
+    sched_stats_register("controlador", WHEEL_TICK_MS, CONTROLLER_PRIORITY);
+    sched_stats_register("botoes", DEBOUNCE_MS, BUTTON_PRIORITY);
+    sched_stats_register("led", 500, OUTPUT_ENGINE ? OUTPUT_ENGINE_PRIORITY : LED_PRIORITY);
+    sched_stats_register("display", 100, OUTPUT_ENGINE ? OUTPUT_ENGINE_PRIORITY : DISPLAY_PRIORITY);
+    sched_stats_register("buzzer", 250, BUZZER_PRIORITY);
+    sched_stats_register("matriz", ANIM_FRAME_MS, OUTPUT_ENGINE ? OUTPUT_ENGINE_PRIORITY : MATRIX_PRIORITY);
+    sched_stats_register("servidor display", 100, DISPLAY_PRIORITY);
+#if DETECTORS
+    sched_stats_register("detectores", DETECTOR_BLOCK_SAMPLES * 1000 / DETECTOR_SAMPLE_HZ, DETECTOR_PRIORITY);
+#endif
 
     // REGISTRO DAS TASKS
-    xTaskCreate(vTrafficLightControllerTask, "Task de gerenciamento do estado global", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(vLedTask, "Task do LED RGB", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(vBuzzerTask, "Task de Buzzer", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(vTrafficLightTask, "Task do Semafaro com a matrix de led", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(vButtonTask, "Leitura Botão", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
-    xTaskCreate(vDisplayAnimationTask, "Desenha no display", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL);
+    xTaskCreate(vTrafficLightControllerTask, "Task de gerenciamento do estado global", configMINIMAL_STACK_SIZE, NULL, CONTROLLER_PRIORITY, &controller_task);
+#if OUTPUT_ENGINE
+    xTaskCreate(vOutputEngineTask, "Motor de saidas", configMINIMAL_STACK_SIZE, &output_engine, OUTPUT_ENGINE_PRIORITY, &output_tasks[0]);
+#else
+    xTaskCreate(vOutputEngineTask, "Task do LED RGB", configMINIMAL_STACK_SIZE, &output_engines[0], LED_PRIORITY, &output_tasks[0]);
+    xTaskCreate(vOutputEngineTask, "Task do Semafaro com a matrix de led", configMINIMAL_STACK_SIZE, &output_engines[1], MATRIX_PRIORITY, &output_tasks[1]);
+    xTaskCreate(vOutputEngineTask, "Desenha no display", configMINIMAL_STACK_SIZE, &output_engines[2], DISPLAY_PRIORITY, &output_tasks[2]);
+#endif
+    xTaskCreate(vBuzzerTask, "Task de Buzzer", configMINIMAL_STACK_SIZE, NULL, BUZZER_PRIORITY, &output_tasks[3]);
+    xTaskCreate(vButtonTask, "Leitura Botão", configMINIMAL_STACK_SIZE, NULL, BUTTON_PRIORITY, &button_task);
+    xTaskCreate(vDisplayServerTask, "Servidor do display", configMINIMAL_STACK_SIZE, (void *)(uintptr_t)display_watch, DISPLAY_PRIORITY, NULL);
+    xTaskCreate(vPhaseLogTask, "Registro na flash", configMINIMAL_STACK_SIZE, NULL, LOG_PRIORITY, NULL);
+    xTaskCreate(vSupervisorTask, "Supervisor", configMINIMAL_STACK_SIZE, NULL, SUPERVISOR_PRIORITY, NULL);
+#if DETECTORS
+    xTaskCreate(vDetectorTask, "Detectores", configMINIMAL_STACK_SIZE, NULL, DETECTOR_PRIORITY, NULL);
+#endif
+#if SHELL_USB
+    shell_events = xQueueCreate(SHELL_EVENTS_LENGTH, sizeof(shell_event_t));
+    xTaskCreate(vShellTask, "Terminal USB", configMINIMAL_STACK_SIZE, NULL, SHELL_PRIORITY, &shell_task);
+#endif
+#if TELEMETRY
+    telemetry_init(WAVE_NODE);
+    xTaskCreate(vTelemetryTask, "Telemetria", 2 * configMINIMAL_STACK_SIZE, NULL, TELEMETRY_PRIORITY, NULL);
+#endif
+
+    // detector de emergência: a interrupção acorda diretamente o controlador
+    preempt_init(PREEMPT_PIN, controller_task);
+#if DETECTORS
+    // detectores de demanda: o DMA entrega os blocos do ADC e cada mudança acorda o controlador
+    detector_init(controller_task, SCHED_DETECTOR);
+#endif
+
+    // alarme do timer que acorda o núcleo do idle sem tick
+    power_init();
+    boot_mark("tasks criadas");
 
     vTaskStartScheduler();
     panic_unsupported();
 }
 
+void safe_output_setup(void)
+{
+    // LED RGB em vermelho
+    gpio_init(ledR);
+    gpio_init(ledG);
+    gpio_set_dir(ledR, GPIO_OUT);
+    gpio_set_dir(ledG, GPIO_OUT);
+    gpio_put(ledR, true);
+
+    // quadro vermelho pronto na flash, enviado direto para a PIO (25 LEDs em ~750us)
+    PIO_setup(&pio, &sm);
+    draw_pio_words(traffic_frame_red.words, pio, sm);
+}
+
 void PIO_setup(PIO *pio, uint *sm)
 {
     // configurações da PIO
@@ -441,21 +1256,3 @@ void PIO_setup(PIO *pio, uint *sm)
     *sm = pio_claim_unused_sm(*pio, true);
     pio_matrix_program_init(*pio, *sm, offset, LED_PIN);
 }
-
-void ssd_setup()
-{
-    // I2C Initialisation. Using it at 400Khz.
-    i2c_init(I2C_PORT, 400 * 1000);
-
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);                    // Set the GPIO pin function to I2C
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);                    // Set the GPIO pin function to I2C
-    gpio_pull_up(I2C_SDA);                                        // Pull up the data line
-    gpio_pull_up(I2C_SCL);                                        // Pull up the clock line
-    ssd1306_init(&ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT); // Inicializa o display
-    ssd1306_config(&ssd);                                         // Configura o display
-    ssd1306_send_data(&ssd);                                      // Envia os dados para o display
-
-    // Limpa o display. O display inicia com todos os pixels apagados.
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
-}
\ No newline at end of file
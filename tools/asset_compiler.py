@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""
+Compilador de assets do semáforo.
+
+Converte as imagens de assets/*.txt em dados const (flash) prontos para o firmware:
+
+    sprite <nome> <L>x<A>     imagem 1bpp do display OLED, coluna a coluna, com
+                              ceil(A / 8) bytes por coluna (formato de ssd1306_bitmap)
+    matrix <nome> <L>x<A> [zigue-zague|linhas]
+                              quadro da matriz WS2812, uma palavra GRB por pixel
+                              (mesmo valor de matrix_rgb, já com a intensidade aplicada)
+                              na ordem da fita: em zigue-zague (padrão, a ligação da placa,
+                              layout<W, H, true> de lib/traffic_frames.cpp) as linhas
+                              ímpares são percorridas da direita para a esquerda
+    palette <c> <r> <g> <b> <intensidade>
+                              cor de um caractere nos quadros da matriz
+    frame <ms>                inicia um quadro com a sua duração (0 = sem animação)
+
+As linhas de cada quadro vêm logo depois de "frame". Nos sprites "#" é pixel aceso e
+qualquer outro caractere é apagado. Um quadro também pode vir de um PNG com
+"frame <ms> <arquivo.png>" (precisa do Pillow; pixels claros ficam acesos).
+
+Uso: asset_compiler.py -o <diretório de saída> assets/*.txt
+Gera assets.h e assets.c no diretório de saída.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+
+class AssetError(Exception):
+    pass
+
+
+def float32(value):
+    # o firmware calcula a intensidade em float, então o arredondamento tem que ser o mesmo
+    return struct.unpack("f", struct.pack("f", value))[0]
+
+
+def matrix_rgb(r, g, b, intensity):
+    # mesmo cálculo de matrix_rgb em lib/leds.c
+    intensity = float32(intensity)
+    red = int(float32(r * intensity)) & 0xFF
+    green = int(float32(g * intensity)) & 0xFF
+    blue = int(float32(b * intensity)) & 0xFF
+    return (green << 24) | (red << 16) | (blue << 8)
+
+
+def load_png(path, width, height):
+    try:
+        from PIL import Image
+    except ImportError:
+        raise AssetError("%s: o Pillow é necessário para ler PNG" % path)
+
+    image = Image.open(path).convert("L")
+    if image.size != (width, height):
+        raise AssetError("%s: esperado %dx%d, encontrado %dx%d" % ((path, width, height) + image.size))
+    return ["".join("#" if image.getpixel((x, y)) >= 128 else "." for x in range(width)) for y in range(height)]
+
+
+LAYOUTS = ("zigue-zague", "linhas")
+
+
+class Asset:
+    def __init__(self, kind, name, width, height, where, layout=LAYOUTS[0]):
+        self.kind = kind
+        self.name = name
+        self.width = width
+        self.height = height
+        self.where = where
+        self.layout = layout
+        self.frames = []  # (duração, linhas)
+
+
+def strip_comment(words, count):
+    # o comentário no fim de um comando começa com um "#" isolado depois dos argumentos
+    if len(words) > count and words[count] == "#":
+        return words[:count]
+    return words
+
+
+def parse(path, palette):
+    assets = []
+    asset = None
+    rows = None
+    base = os.path.dirname(path)
+
+    with open(path, encoding="utf-8") as source:
+        for number, line in enumerate(source, 1):
+            where = "%s:%d" % (path, number)
+            words = line.split()
+
+            # linha de pixels: uma única palavra dentro de um quadro (pode começar com "#")
+            if rows is not None and len(words) == 1 and words[0] not in ("palette", "sprite", "matrix", "frame"):
+                rows.append(words[0])
+                continue
+
+            # linha vazia ou comentário ("# texto")
+            if not words or words[0] == "#":
+                continue
+
+            if words[0] == "palette":
+                words = strip_comment(words, 6)
+                if len(words) != 6 or len(words[1]) != 1:
+                    raise AssetError("%s: palette <c> <r> <g> <b> <intensidade>" % where)
+                palette[words[1]] = matrix_rgb(int(words[2]), int(words[3]), int(words[4]), float(words[5]))
+
+            elif words[0] == "sprite":
+                words = strip_comment(words, 3)
+                size = re.fullmatch(r"(\d+)x(\d+)", words[2]) if len(words) == 3 else None
+                if not size:
+                    raise AssetError("%s: sprite <nome> <L>x<A>" % where)
+                asset = Asset(words[0], words[1], int(size.group(1)), int(size.group(2)), where)
+                assets.append(asset)
+                rows = None
+
+            elif words[0] == "matrix":
+                words = strip_comment(strip_comment(words, 3), 4)
+                size = re.fullmatch(r"(\d+)x(\d+)", words[2]) if len(words) in (3, 4) else None
+                if not size or (len(words) == 4 and words[3] not in LAYOUTS):
+                    raise AssetError("%s: matrix <nome> <L>x<A> [%s]" % (where, "|".join(LAYOUTS)))
+                layout = words[3] if len(words) == 4 else LAYOUTS[0]
+                asset = Asset(words[0], words[1], int(size.group(1)), int(size.group(2)), where, layout)
+                assets.append(asset)
+                rows = None
+
+            elif words[0] == "frame":
+                words = strip_comment(strip_comment(words, 2), 3)
+                if asset is None or len(words) not in (2, 3):
+                    raise AssetError("%s: frame <ms> [arquivo.png] dentro de um sprite ou matrix" % where)
+                if len(words) == 3:
+                    # quadro completo vindo do PNG, sem linhas de pixels depois
+                    asset.frames.append((int(words[1]), load_png(os.path.join(base, words[2]), asset.width, asset.height)))
+                    rows = None
+                else:
+                    rows = []
+                    asset.frames.append((int(words[1]), rows))
+
+            else:
+                raise AssetError("%s: comando desconhecido '%s'" % (where, words[0]))
+
+    return assets
+
+
+def check(asset):
+    if not asset.frames:
+        raise AssetError("%s: %s sem quadros" % (asset.where, asset.name))
+    if len(asset.frames) > 255:
+        raise AssetError("%s: %s tem mais de 255 quadros" % (asset.where, asset.name))
+    for index, (_, rows) in enumerate(asset.frames):
+        if len(rows) != asset.height or any(len(row) != asset.width for row in rows):
+            raise AssetError("%s: quadro %d de %s não tem %dx%d pixels" %
+                             (asset.where, index, asset.name, asset.width, asset.height))
+
+
+def encode_sprite(asset, rows):
+    # coluna a coluna, bit 0 = linha de cima de cada página (formato do ram_buffer do SSD1306)
+    pages = (asset.height + 7) // 8
+    data = []
+    for x in range(asset.width):
+        for page in range(pages):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < asset.height and rows[y][x] == "#":
+                    byte |= 1 << bit
+            data.append(byte)
+    return data
+
+
+def encode_matrix(asset, rows, palette):
+    # na ordem da fita: em zigue-zague a linha ímpar começa pela coluna da direita
+    data = []
+    for y, row in enumerate(rows):
+        columns = range(asset.width)
+        if asset.layout == "zigue-zague" and y % 2:
+            columns = reversed(columns)
+        for x in columns:
+            if row[x] not in palette:
+                raise AssetError("%s: cor '%s' de %s (%d, %d) fora da paleta" % (asset.where, row[x], asset.name, x, y))
+            data.append(palette[row[x]])
+    return data
+
+
+def format_array(ctype, name, values, per_line, fmt):
+    lines = ["static const %s %s[] = {" % (ctype, name)]
+    for start in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(fmt % v for v in values[start:start + per_line]) + ",")
+    lines.append("};")
+    return lines
+
+
+def generate(assets, palette, output):
+    header = [
+        "// gerado por tools/asset_compiler.py a partir de assets/*.txt, não edite",
+        "#ifndef ASSETS_H",
+        "#define ASSETS_H",
+        "",
+        '#include "asset.h"',
+        "",
+    ]
+    source = [
+        "// gerado por tools/asset_compiler.py a partir de assets/*.txt, não edite",
+        '#include "assets.h"',
+    ]
+
+    for asset in assets:
+        check(asset)
+        frames = []
+        for index, (duration, rows) in enumerate(asset.frames):
+            data_name = "%s_%d" % (asset.name, index)
+            source.append("")
+            if asset.kind == "sprite":
+                source += format_array("uint8_t", data_name, encode_sprite(asset, rows), 16, "0x%02X")
+            else:
+                source += format_array("uint32_t", data_name, encode_matrix(asset, rows, palette), 5, "0x%08X")
+            frames.append("{%s, %d}" % (data_name, duration))
+
+        ctype = "asset_sprite" if asset.kind == "sprite" else "asset_matrix"
+        source.append("")
+        source.append("static const %s_frame_t %s_frames[] = {%s};" % (ctype, asset.name, ", ".join(frames)))
+        source.append("const %s_t %s = {%d, %d, %d, %s_frames};" %
+                      (ctype, asset.name, asset.width, asset.height, len(frames), asset.name))
+        header.append("extern const %s_t %s;" % (ctype, asset.name))
+
+    header += ["", "#endif", ""]
+    source.append("")
+
+    os.makedirs(output, exist_ok=True)
+    write_if_changed(os.path.join(output, "assets.h"), "\n".join(header))
+    write_if_changed(os.path.join(output, "assets.c"), "\n".join(source))
+
+
+def write_if_changed(path, text):
+    # evita recompilar quem inclui assets.h quando nada mudou
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as old:
+            if old.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as new:
+        new.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gera os assets do semáforo")
+    parser.add_argument("-o", "--output", required=True, help="diretório de saída")
+    parser.add_argument("sources", nargs="+", help="arquivos de assets (.txt)")
+    args = parser.parse_args()
+
+    palette = {}
+    assets = []
+    try:
+        for path in args.sources:
+            assets += parse(path, palette)
+        names = [asset.name for asset in assets]
+        duplicated = {name for name in names if names.count(name) > 1}
+        if duplicated:
+            raise AssetError("assets repetidos: %s" % ", ".join(sorted(duplicated)))
+        generate(assets, palette, args.output)
+    except (AssetError, OSError, ValueError) as error:
+        print("asset_compiler: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
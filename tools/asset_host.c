@@ -0,0 +1,339 @@
+/*
+    imagens de referência (golden) dos sprites de assets/ no computador
+
+    cada quadro dos sprites gerados por tools/asset_compiler.py é desenhado com ssd1306_bitmap
+    na posição do firmware (PEDESTRIAN_X, PEDESTRIAN_Y: y fora do limite da página, passando
+    pelo shift do blit) em um framebuffer limpo. a área do sprite é comparada com a imagem
+    de referência em assets/golden/<sprite>.pbm (PBM texto, os quadros lado a lado) e o resto
+    da tela tem que continuar apagado. também confere o quadro que asset_sprite_frame escolhe
+    no meio de cada quadro e no fim da volta da animação
+
+    os quadros da matriz (assets/golden/matrix_arrow.txt, a mesma seta nas duas ordens da fita)
+    são levados da ordem da fita de volta à posição na tela, com a ligação da placa
+    (layout<5, 5, true> de lib/traffic_frames.cpp: linhas ímpares da direita para a esquerda)
+    ou linha a linha, e comparados com assets/golden/<matriz>.ppm (PPM texto, os quadros lado
+    a lado). a arte não é simétrica: uma ordem trocada aparece como diferença
+
+    com diferença, a imagem desenhada é gravada em <nome>.atual.pbm (ou .ppm) no diretório
+    atual para comparar; "atualizar" regrava as referências depois de uma mudança proposital na arte
+
+    tools/asset_compiler.py -o build assets/pedestrian.txt assets/golden/matrix_arrow.txt
+    tools/font_compiler.py -o build assets/font.txt
+    cc -O2 -Ibench/host -Ilib -Ibuild -o asset_host tools/asset_host.c lib/asset.c lib/ssd1306.c lib/blit.c \
+       build/assets.c build/font.c -lm
+    ./asset_host [assets/golden] [atualizar]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "assets.h"
+#include "host_stubs.h"
+
+#define SPRITE_X 54 // PEDESTRIAN_X do firmware
+#define SPRITE_Y 10 // PEDESTRIAN_Y do firmware
+#define MAX_PIXELS (WIDTH * HEIGHT * 16)
+
+typedef struct
+{
+    const char *name;
+    const asset_sprite_t *sprite;
+} golden_case_t;
+
+static const golden_case_t cases[] = {
+    {"pedestrian_stand", &pedestrian_stand},
+    {"pedestrian_walk", &pedestrian_walk},
+};
+
+typedef struct
+{
+    const char *name;
+    const asset_matrix_t *matrix;
+    bool serpentine; // ligação em zigue-zague da placa
+} matrix_case_t;
+
+static const matrix_case_t matrix_cases[] = {
+    {"matrix_arrow", &matrix_arrow, true},
+    {"matrix_arrow_rows", &matrix_arrow_rows, false},
+};
+
+static ssd1306_t ssd;
+
+static bool lit(int x, int y)
+{
+    return ssd.ram_buffer[1 + x * ssd.pages + y / 8] >> (y % 8) & 1;
+}
+
+// PBM texto (P1): 1 = pixel aceso; comentários com "#"
+static bool pbm_read(const char *path, int *width, int *height, uint8_t *pixels)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char magic[3] = "";
+    int values[2], count = 0, c;
+    bool ok = fscanf(file, "%2s", magic) == 1 && strcmp(magic, "P1") == 0;
+    while (ok && count < 2 && (c = fgetc(file)) != EOF)
+    {
+        if (c == '#')
+            while ((c = fgetc(file)) != EOF && c != '\n')
+                ;
+        else if (c >= '0' && c <= '9')
+        {
+            ungetc(c, file);
+            ok = fscanf(file, "%d", &values[count++]) == 1;
+        }
+    }
+    ok = ok && count == 2 && values[0] > 0 && values[1] > 0 && values[0] * values[1] <= MAX_PIXELS;
+
+    for (int i = 0; ok && i < values[0] * values[1];)
+    {
+        c = fgetc(file);
+        if (c == EOF)
+            ok = false;
+        else if (c == '0' || c == '1')
+            pixels[i++] = c == '1';
+    }
+    fclose(file);
+
+    *width = values[0];
+    *height = values[1];
+    return ok;
+}
+
+static bool pbm_write(const char *path, const char *comment, int width, int height, const uint8_t *pixels)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "P1\n# %s\n%d %d\n", comment, width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+            fputc(pixels[y * width + x] ? '1' : '0', file);
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+// PPM texto (P3): r g b de 0 a 255 por pixel; comentários com "#"
+static bool ppm_read(const char *path, int *width, int *height, uint8_t *pixels)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char magic[3] = "";
+    int values[3], count = 0, c;
+    bool ok = fscanf(file, "%2s", magic) == 1 && strcmp(magic, "P3") == 0;
+    while (ok && count < 3 && (c = fgetc(file)) != EOF)
+    {
+        if (c == '#')
+            while ((c = fgetc(file)) != EOF && c != '\n')
+                ;
+        else if (c >= '0' && c <= '9')
+        {
+            ungetc(c, file);
+            ok = fscanf(file, "%d", &values[count++]) == 1;
+        }
+    }
+    ok = ok && count == 3 && values[0] > 0 && values[1] > 0 && values[0] * values[1] <= MAX_PIXELS / 3 &&
+         values[2] == 255;
+
+    for (int i = 0; ok && i < values[0] * values[1] * 3; i++)
+    {
+        int value;
+        ok = fscanf(file, "%d", &value) == 1 && value >= 0 && value <= 255;
+        pixels[i] = value;
+    }
+    fclose(file);
+
+    *width = values[0];
+    *height = values[1];
+    return ok;
+}
+
+static bool ppm_write(const char *path, const char *comment, int width, int height, const uint8_t *pixels)
+{
+    FILE *file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "P3\n# %s\n%d %d\n255\n", comment, width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const uint8_t *rgb = &pixels[(y * width + x) * 3];
+            fprintf(file, "%s%d %d %d", x ? "  " : "", rgb[0], rgb[1], rgb[2]);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) == 0;
+}
+
+// posição na fita do pixel (x, y); em zigue-zague a linha ímpar começa pela direita
+static int wire_index(const matrix_case_t *test, int x, int y)
+{
+    int width = test->matrix->width;
+    return y * width + (test->serpentine && (y & 1) ? width - 1 - x : x);
+}
+
+// leva cada quadro da ordem da fita para a tela, lado a lado, em r g b
+static void render_matrix(const matrix_case_t *test, uint8_t *strip)
+{
+    const asset_matrix_t *matrix = test->matrix;
+    int width = matrix->width * matrix->frame_count;
+
+    for (uint8_t f = 0; f < matrix->frame_count; f++)
+    {
+        for (int y = 0; y < matrix->height; y++)
+        {
+            for (int x = 0; x < matrix->width; x++)
+            {
+                // PALAVRA GRB DO WS2812: VERDE NO BYTE MAIS ALTO
+                uint32_t word = matrix->frames[f].pixels[wire_index(test, x, y)];
+                uint8_t *rgb = &strip[(y * width + f * matrix->width + x) * 3];
+                rgb[0] = word >> 16 & 0xFF;
+                rgb[1] = word >> 24;
+                rgb[2] = word >> 8 & 0xFF;
+            }
+        }
+    }
+}
+
+// desenha cada quadro e monta a faixa com os quadros lado a lado; retorna os pixels fora do sprite
+static int render(const asset_sprite_t *sprite, uint8_t *strip)
+{
+    int stray = 0;
+    int width = sprite->width * sprite->frame_count;
+
+    for (uint8_t f = 0; f < sprite->frame_count; f++)
+    {
+        ssd1306_fill(&ssd, false);
+        ssd1306_bitmap(&ssd, sprite->frames[f].bitmap, SPRITE_X, SPRITE_Y, sprite->width, sprite->height);
+
+        for (int y = 0; y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+            {
+                bool inside = x >= SPRITE_X && x < SPRITE_X + sprite->width && y >= SPRITE_Y &&
+                              y < SPRITE_Y + sprite->height;
+                if (inside)
+                    strip[(y - SPRITE_Y) * width + f * sprite->width + x - SPRITE_X] = lit(x, y);
+                else
+                    stray += lit(x, y);
+            }
+        }
+    }
+    return stray;
+}
+
+// quadro escolhido no meio de cada quadro e logo depois da volta completa
+static bool timing_ok(const asset_sprite_t *sprite)
+{
+    uint32_t start = 0;
+    for (uint8_t f = 0; f < sprite->frame_count; f++)
+    {
+        uint32_t middle = start + sprite->frames[f].duration_ms / 2;
+        if (asset_sprite_frame(sprite, middle) != &sprite->frames[sprite->frames[f].duration_ms ? f : 0])
+            return false;
+        start += sprite->frames[f].duration_ms;
+    }
+    return asset_sprite_frame(sprite, start) == &sprite->frames[0];
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = argc >= 2 ? argv[1] : "assets/golden";
+    bool update = argc >= 3 && strcmp(argv[2], "atualizar") == 0;
+    static uint8_t strip[MAX_PIXELS], golden[MAX_PIXELS];
+    int failures = 0;
+
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    printf("sprite,quadros,largura,altura,pixels_acesos,diferentes,fora_do_sprite,tempo_ok,ok\n");
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const asset_sprite_t *sprite = cases[i].sprite;
+        int width = sprite->width * sprite->frame_count, height = sprite->height;
+        char path[256], comment[96];
+        snprintf(path, sizeof(path), "%s/%s.pbm", dir, cases[i].name);
+        snprintf(comment, sizeof(comment), "%s: %u quadros %ux%u lado a lado", cases[i].name, sprite->frame_count,
+                 sprite->width, sprite->height);
+
+        int stray = render(sprite, strip);
+        if (update && !pbm_write(path, comment, width, height, strip))
+        {
+            perror(path);
+            return 2;
+        }
+
+        int golden_width = 0, golden_height = 0, lit_count = 0, diff = 0;
+        bool loaded = pbm_read(path, &golden_width, &golden_height, golden);
+        for (int p = 0; p < width * height; p++)
+        {
+            lit_count += strip[p];
+            diff += !loaded || strip[p] != golden[p];
+        }
+        if (golden_width != width || golden_height != height)
+            diff = width * height;
+
+        bool timing = timing_ok(sprite);
+        bool ok = loaded && diff == 0 && stray == 0 && timing;
+        printf("%s,%u,%u,%u,%d,%d,%d,%s,%s\n", cases[i].name, sprite->frame_count, sprite->width, sprite->height,
+               lit_count, diff, stray, timing ? "sim" : "NAO", ok ? "sim" : "NAO");
+
+        if (!ok)
+        {
+            snprintf(path, sizeof(path), "%s.atual.pbm", cases[i].name);
+            if (pbm_write(path, comment, width, height, strip))
+                fprintf(stderr, "%s: imagem desenhada em %s\n", cases[i].name, path);
+            failures++;
+        }
+    }
+
+    printf("\nmatriz,quadros,largura,altura,pixels_acesos,diferentes,ok\n");
+    for (unsigned i = 0; i < sizeof(matrix_cases) / sizeof(matrix_cases[0]); i++)
+    {
+        const asset_matrix_t *matrix = matrix_cases[i].matrix;
+        int width = matrix->width * matrix->frame_count, height = matrix->height;
+        char path[256], comment[128];
+        snprintf(path, sizeof(path), "%s/%s.ppm", dir, matrix_cases[i].name);
+        snprintf(comment, sizeof(comment), "%s: %u quadros %ux%u lado a lado, na posição da tela", matrix_cases[i].name,
+                 matrix->frame_count, matrix->width, matrix->height);
+
+        render_matrix(&matrix_cases[i], strip);
+        if (update && !ppm_write(path, comment, width, height, strip))
+        {
+            perror(path);
+            return 2;
+        }
+
+        int golden_width = 0, golden_height = 0, lit_count = 0, diff = 0;
+        bool loaded = ppm_read(path, &golden_width, &golden_height, golden);
+        for (int p = 0; p < width * height; p++)
+        {
+            lit_count += strip[p * 3] || strip[p * 3 + 1] || strip[p * 3 + 2];
+            diff += !loaded || memcmp(&strip[p * 3], &golden[p * 3], 3) != 0;
+        }
+        if (golden_width != width || golden_height != height)
+            diff = width * height;
+
+        bool ok = loaded && diff == 0;
+        printf("%s,%u,%u,%u,%d,%d,%s\n", matrix_cases[i].name, matrix->frame_count, matrix->width, matrix->height,
+               lit_count, diff, ok ? "sim" : "NAO");
+
+        if (!ok)
+        {
+            snprintf(path, sizeof(path), "%s.atual.ppm", matrix_cases[i].name);
+            if (ppm_write(path, comment, width, height, strip))
+                fprintf(stderr, "%s: imagem desenhada em %s\n", matrix_cases[i].name, path);
+            failures++;
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""
+Compara duas saídas CSV do semafaro-bench (placa ou bench/bench_host.c).
+
+Mostra a mediana de cada caso nas duas execuções e a variação. Retorna 1 quando algum
+caso ficou mais lento que o limite (em %), para rodar depois de cada mudança nos
+caminhos quentes. Só compara execuções da mesma plataforma: no computador os "ciclos"
+são nanossegundos.
+
+Uso: bench_compare.py antes.csv depois.csv [--limite 10] [--coluna mediana_ciclos]
+"""
+
+import argparse
+import csv
+import sys
+
+
+def load(path):
+    platform = None
+    rows = []
+    with open(path, newline="") as f:
+        for line in f:
+            if line.startswith("#"):
+                for field in line[1:].split():
+                    if field.startswith("plataforma="):
+                        platform = field.split("=", 1)[1]
+                continue
+            rows.append(line)
+    return platform, {row["caso"]: row for row in csv.DictReader(rows)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--limite", type=float, default=10.0, help="piora máxima aceita em %% (padrão 10)")
+    parser.add_argument("--coluna", default="mediana_ciclos")
+    args = parser.parse_args()
+
+    before_platform, before = load(args.before)
+    after_platform, after = load(args.after)
+    if before_platform != after_platform:
+        sys.exit(f"plataformas diferentes: {before_platform} e {after_platform}")
+
+    worse = []
+    print(f"{'caso':<28} {'antes':>10} {'depois':>10} {'variacao':>9}")
+    for name in list(before) + [name for name in after if name not in before]:
+        if name not in before or name not in after:
+            print(f"{name:<28} {'só em ' + (args.before if name in before else args.after)}")
+            continue
+        old = int(before[name][args.coluna])
+        new = int(after[name][args.coluna])
+        change = (new - old) * 100.0 / old if old else 0.0
+        mark = ""
+        if change > args.limite:
+            worse.append(name)
+            mark = "  <- mais lento"
+        print(f"{name:<28} {old:>10} {new:>10} {change:>+8.1f}%{mark}")
+
+    if worse:
+        print(f"\n{len(worse)} caso(s) mais de {args.limite:g}% mais lento(s): {', '.join(sorted(worse))}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,264 @@
+/*
+    testes aleatórios e medição do blit (lib/blit.c) no computador
+
+    fuzz compara blit e blit_fill com uma cópia pixel a pixel em imagens, retângulos,
+    deslocamentos e operações aleatórios. as imagens ficam entre bytes de guarda que
+    não podem mudar, e o resultado precisa ser igual byte a byte. bench mede o sprite
+    do pedestre, um glifo e a tela inteira contra o desenho pixel a pixel antigo
+
+    cc -O2 -fsanitize=address,undefined -Ibench/host -Ilib -o blit_host tools/blit_host.c lib/blit.c
+    ./blit_host fuzz 200000 [semente]
+    cc -O2 -Ibench/host -Ilib -o blit_host tools/blit_host.c lib/blit.c && ./blit_host bench
+*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "blit.h"
+#include "host_rng.h"
+
+#define GUARD 64          // bytes de guarda antes e depois de cada imagem
+#define GUARD_BYTE 0xA5
+#define MAX_WIDTH 150
+#define MAX_PAGES 12
+
+static const char *const rop_names[] = {"copy", "or", "and", "xor"};
+
+typedef struct
+{
+    uint8_t memory[GUARD + MAX_WIDTH * MAX_PAGES + GUARD];
+    blit_surface_t surface;
+} image_t;
+
+static void image_random(image_t *image)
+{
+    memset(image->memory, GUARD_BYTE, sizeof(image->memory));
+
+    // altura qualquer e às vezes bytes sobrando por coluna, como um sprite dentro de outra imagem
+    uint16_t height = rng_range(1, MAX_PAGES * 8 - 8);
+    uint8_t pages = (height + 7) / 8 + rng_range(0, 1);
+    uint16_t width = rng_range(1, MAX_WIDTH);
+
+    image->surface = (blit_surface_t){&image->memory[GUARD], width, height, pages};
+    for (int i = 0; i < width * pages; i++)
+        image->surface.bits[i] = rng();
+}
+
+static bool guards_intact(const image_t *image)
+{
+    size_t used = GUARD + image->surface.width * image->surface.pages;
+    for (size_t i = 0; i < sizeof(image->memory); i++)
+    {
+        if ((i < GUARD || i >= used) && image->memory[i] != GUARD_BYTE)
+            return false;
+    }
+    return true;
+}
+
+static bool pixel_get(const uint8_t *bits, int pages, int x, int y)
+{
+    return bits[x * pages + (y >> 3)] >> (y & 7) & 1;
+}
+
+static void pixel_set(uint8_t *bits, int pages, int x, int y, bool value)
+{
+    if (value)
+        bits[x * pages + (y >> 3)] |= 1 << (y & 7);
+    else
+        bits[x * pages + (y >> 3)] &= ~(1 << (y & 7));
+}
+
+static bool rop_apply(blit_rop_t rop, bool d, bool s)
+{
+    switch (rop)
+    {
+    case BLIT_COPY:
+        return s;
+    case BLIT_OR:
+        return d | s;
+    case BLIT_AND:
+        return d & s;
+    default:
+        return d ^ s;
+    }
+}
+
+// referência: pixel a pixel, testando cada ponto contra as duas imagens (src NULL = constante value)
+static void reference_blit(const blit_surface_t *dst, int dx, int dy, const blit_surface_t *src, int sx, int sy,
+                           int w, int h, bool value, blit_rop_t rop)
+{
+    // PERCORRE O DESTINO INTEIRO: W E H PODEM SER ENORMES
+    for (long x = 0; x < dst->width; x++)
+    {
+        for (long y = 0; y < dst->height; y++)
+        {
+            long i = x - dx, j = y - dy;
+            if (i < 0 || j < 0 || i >= w || j >= h)
+                continue;
+
+            bool s = value;
+            if (src)
+            {
+                long u = sx + i, v = sy + j;
+                if (u < 0 || v < 0 || u >= src->width || v >= src->height)
+                    continue;
+                s = pixel_get(src->bits, src->pages, u, v);
+            }
+            pixel_set(dst->bits, dst->pages, x, y, rop_apply(rop, pixel_get(dst->bits, dst->pages, x, y), s));
+        }
+    }
+}
+
+// coordenada perto da imagem na maioria das vezes, às vezes nos extremos do int
+static int random_coord(int size)
+{
+    switch (rng_range(0, 15))
+    {
+    case 0:
+        return rng_range(0, 1) ? 2147483647 - rng_range(0, 100) : -2147483647 - 1 + rng_range(0, 100);
+    case 1:
+        return rng_range(-100000, 100000);
+    default:
+        return rng_range(-size - 40, size + 40);
+    }
+}
+
+static int fuzz(long iterations, uint32_t seed)
+{
+    static image_t dst, expected, src;
+    rng_seed(seed);
+
+    for (long n = 0; n < iterations; n++)
+    {
+        image_random(&dst);
+        image_random(&src);
+        memcpy(&expected, &dst, sizeof(dst));
+        expected.surface.bits = &expected.memory[GUARD];
+
+        bool filling = rng_range(0, 3) == 0;
+        blit_rop_t rop = rng_range(BLIT_COPY, BLIT_XOR);
+        bool value = rng_range(0, 1);
+        int dx = random_coord(dst.surface.width), dy = random_coord(dst.surface.height);
+        int sx = random_coord(src.surface.width), sy = random_coord(src.surface.height);
+        int w = rng_range(0, 7) == 0 ? rng_range(-20, 0) : rng_range(1, MAX_WIDTH + 20);
+        int h = rng_range(0, 7) == 0 ? rng_range(-20, 0) : rng_range(1, MAX_PAGES * 8 + 20);
+        if (rng_range(0, 15) == 0)
+            w = 2147483647 - rng_range(0, 100);
+
+        blit_source_t source = {src.surface.bits, src.surface.width, src.surface.height, src.surface.pages};
+        if (filling)
+        {
+            blit_fill(&dst.surface, dx, dy, w, h, value, rop);
+            reference_blit(&expected.surface, dx, dy, NULL, 0, 0, w, h, value, rop);
+        }
+        else
+        {
+            blit(&dst.surface, dx, dy, &source, sx, sy, w, h, rop);
+            reference_blit(&expected.surface, dx, dy, &src.surface, sx, sy, w, h, value, rop);
+        }
+
+        if (!guards_intact(&dst) || memcmp(dst.memory, expected.memory, sizeof(dst.memory)) != 0)
+        {
+            printf("falha no caso %ld (semente %u): %s %s destino %ux%u/%u em (%d, %d), origem %ux%u/%u em (%d, %d), %dx%d%s\n",
+                   n, seed, filling ? "fill" : "blit", rop_names[rop], dst.surface.width, dst.surface.height,
+                   dst.surface.pages, dx, dy, src.surface.width, src.surface.height, src.surface.pages, sx, sy, w, h,
+                   guards_intact(&dst) ? "" : ", escreveu fora da imagem");
+            return 1;
+        }
+    }
+
+    printf("%ld casos ok (semente %u)\n", iterations, seed);
+    return 0;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// o desenho antigo do driver: ssd1306_pixel em cada ponto, sem recorte
+static void old_bitmap(uint8_t *fb, const uint8_t *bitmap, int x, int y, int w, int h)
+{
+    int pages = (h + 7) / 8;
+    for (int i = 0; i < w; ++i)
+        for (int j = 0; j < h; ++j)
+            pixel_set(fb, 8, x + i, y + j, bitmap[i * pages + (j >> 3)] & (1 << (j & 7)));
+}
+
+static void old_fill(uint8_t *fb, bool value)
+{
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 128; ++x)
+            pixel_set(fb, 8, x, y, value);
+}
+
+typedef struct
+{
+    const char *name;
+    int w, h;
+    bool fill;
+} bench_case_t;
+
+static int bench(void)
+{
+    static uint8_t fb[128 * 8];
+    static uint8_t sprite[20 * 5]; // pedestre: 20 x 40 no formato dos assets
+    static const bench_case_t cases[] = {
+        {"sprite 20x40", 20, 40, false},
+        {"glifo 8x8", 8, 8, false},
+        {"tela 128x64", 128, 64, true},
+    };
+    blit_surface_t surface = {fb, 128, 64, 8};
+    const long rounds = 200000;
+    volatile uint8_t sink = 0;
+
+    for (size_t i = 0; i < sizeof(sprite); i++)
+        sprite[i] = rng();
+
+    printf("%-14s %12s %12s %8s\n", "caso", "pixel (ns)", "blit (ns)", "ganho");
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        const bench_case_t *bc = &cases[c];
+        blit_source_t src = {sprite, bc->w, bc->h, (bc->h + 7) / 8};
+
+        // Y DESALINHADO COM AS PÁGINAS: O CASO COM DESLOCAMENTO ENTRE AS PALAVRAS
+        double start = now_ns();
+        for (long r = 0; r < rounds; r++)
+        {
+            if (bc->fill)
+                old_fill(fb, r & 1);
+            else
+                old_bitmap(fb, sprite, r % 90, 3 + r % 5, bc->w, bc->h);
+            sink ^= fb[r % sizeof(fb)];
+        }
+        double pixel = (now_ns() - start) / rounds;
+
+        start = now_ns();
+        for (long r = 0; r < rounds; r++)
+        {
+            if (bc->fill)
+                blit_fill(&surface, 0, 0, 128, 64, r & 1, BLIT_COPY);
+            else
+                blit(&surface, r % 90, 3 + r % 5, &src, 0, 0, bc->w, bc->h, BLIT_COPY);
+            sink ^= fb[r % sizeof(fb)];
+        }
+        double word = (now_ns() - start) / rounds;
+
+        printf("%-14s %12.1f %12.1f %7.1fx\n", bc->name, pixel, word, pixel / word);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "fuzz") == 0)
+        return fuzz(argc >= 3 ? atol(argv[2]) : 100000, argc >= 4 ? strtoul(argv[3], NULL, 0) : 1);
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0)
+        return bench();
+
+    fprintf(stderr, "uso: %s fuzz [casos] [semente] | bench\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,143 @@
+/*
+    relatório das etapas do boot (lib/boot.c) no computador
+
+    repete a sequência de main e das tasks com as bibliotecas de verdade e um relógio
+    simulado: time_us_32 devolve o tempo dos barramentos que o boot ocupa, e cada etapa é
+    marcada com boot_mark como no firmware. só os barramentos contam (o trabalho da CPU e
+    a inicialização do SDK ficam em 0, e o tempo começa na entrada de main):
+
+    - PIO: cada palavra do WS2812 leva WS2812_WORD_US na fita; pio_sm_put_blocking só
+      espera quando a FIFO juntada (8 palavras) e o registrador de saída estão cheios;
+    - I2C a 400 kHz: 9 bits por byte, mais o endereço e o START/STOP de cada transação.
+
+    escreve o CSV de boot_report e depois as verificações: o quadro vermelho entregue à PIO
+    e terminado na fita em até SAFE_OUTPUT_MAX_US, todas as etapas marcadas, e o display
+    (dezenas de ms de I2C) só depois do escalonador. termina com erro em qualquer falha
+
+    tools/font_compiler.py -o build assets/font.txt
+    cc -O2 -Ibench/host -Ilib -Ibuild -o boot_host tools/boot_host.c lib/boot.c lib/leds.c lib/ssd1306.c \
+       lib/blit.c build/font.c -x c++ lib/traffic_frames.cpp -x none -lm -lstdc++
+    ./boot_host
+*/
+#include <stdio.h>
+#include <string.h>
+#include "boot.h"
+#include "leds.h"
+#include "ssd1306.h"
+#include "traffic_frames.h"
+
+#define WS2812_WORD_US 30       // 24 bits de 1,25us
+#define PIO_QUEUE_WORDS 9       // FIFO TX juntada (8) mais o registrador de saída
+#define I2C_BYTE_NS 22500       // 9 bits a 400 kHz
+#define I2C_FRAMING_NS 5000     // START, STOP e o tempo livre entre transações
+#define SAFE_OUTPUT_MAX_US 1000 // o vermelho tem que aparecer em até 1 ms depois de main
+
+static uint32_t now_ns;
+static uint32_t pio_done_ns; // fim da última palavra enviada para a fita
+static struct bench_pio pio;
+
+uint32_t time_us_32(void)
+{
+    return now_ns / 1000;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    (void)pio;
+    (void)sm;
+    (void)data;
+
+    // ESPERA ATÉ A FILA TER LUGAR PARA MAIS UMA PALAVRA
+    if ((int32_t)(pio_done_ns - now_ns) > PIO_QUEUE_WORDS * WS2812_WORD_US * 1000)
+        now_ns = pio_done_ns - PIO_QUEUE_WORDS * WS2812_WORD_US * 1000;
+
+    uint32_t start = (int32_t)(pio_done_ns - now_ns) > 0 ? pio_done_ns : now_ns;
+    pio_done_ns = start + WS2812_WORD_US * 1000;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+
+    // O ENDEREÇO É MAIS UM BYTE NO BARRAMENTO
+    now_ns += (len + 1) * I2C_BYTE_NS + I2C_FRAMING_NS;
+    return len;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    now_ns += ms * 1000000;
+}
+
+static bool stage_ok(const char *name)
+{
+    for (uint8_t i = 0; i < boot_stage_count; i++)
+    {
+        if (strcmp(boot_stages[i].name, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+int main(void)
+{
+    static ssd1306_t ssd;
+    static char report[512];
+    int failures = 0;
+
+    // MAIN: A SAÍDA SEGURA ANTES DE QUALQUER OUTRA INICIALIZAÇÃO (safe_output_setup)
+    boot_mark("main");
+    draw_pio_words(traffic_frame_red.words, &pio, 0);
+    boot_mark("saida segura");
+    uint32_t red_on_strip_us = pio_done_ns / 1000;
+
+    // STDIO, PONTILHAMENTO PARADO, FILA DO DISPLAY E ONDA VERDE: NENHUM BARRAMENTO
+    boot_mark("perifericos");
+    boot_mark("tasks criadas");
+
+    // ESCALONADOR: O CONTROLADOR PUBLICA A FASE E O LED DE SAÍDA A MOSTRA
+    boot_mark("escalonador");
+    boot_mark("led na fase");
+
+    // SERVIDOR DO DISPLAY (vDisplayServerTask): CONFIGURAÇÃO, TELA LIMPA E O PRIMEIRO QUADRO DA FILA
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+    ssd1306_fill(&ssd, false);
+    ssd1306_send_data(&ssd);
+    boot_mark("display pronto");
+
+    ssd1306_draw_string(&ssd, "VERMELHO", 0, 0);
+    ssd1306_send_data(&ssd);
+    boot_mark("primeiro quadro do display");
+
+    boot_report(report, sizeof(report));
+    fputs(report, stdout);
+
+    const char *stages[] = {"main", "saida segura", "perifericos", "tasks criadas", "escalonador", "led na fase",
+                            "display pronto", "primeiro quadro do display"};
+    bool marked = boot_stage_count == count_of(stages);
+    for (unsigned i = 0; i < count_of(stages); i++)
+        marked = marked && stage_ok(stages[i]);
+
+    uint32_t safe_us = boot_stage_us("saida segura");
+    uint32_t display_us = boot_stage_us("display pronto");
+    bool display_after = display_us > boot_stage_us("escalonador");
+
+    printf("\nteste,us,limite_us,ok\n");
+    printf("saida_segura,%lu,%d,%s\n", (unsigned long)safe_us, SAFE_OUTPUT_MAX_US,
+           safe_us <= SAFE_OUTPUT_MAX_US ? "sim" : "NAO");
+    printf("vermelho_na_fita,%lu,%d,%s\n", (unsigned long)red_on_strip_us, SAFE_OUTPUT_MAX_US,
+           red_on_strip_us <= SAFE_OUTPUT_MAX_US ? "sim" : "NAO");
+    printf("display_depois_do_escalonador,%lu,-,%s\n", (unsigned long)display_us, display_after ? "sim" : "NAO");
+    printf("etapas_marcadas,%u,%u,%s\n", boot_stage_count, (unsigned)count_of(stages), marked ? "sim" : "NAO");
+
+    failures += safe_us > SAFE_OUTPUT_MAX_US;
+    failures += red_on_strip_us > SAFE_OUTPUT_MAX_US;
+    failures += !display_after;
+    failures += !marked;
+
+    return failures ? 1 : 0;
+}
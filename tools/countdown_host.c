@@ -0,0 +1,183 @@
+/*
+    contagem regressiva das fases (display e matriz) contra o fim de verdade da fase, no computador
+
+    roda o controlador de lib/control.c como o firmware, com relógio de 1 ms: uma volta a
+    cada WHEEL_TICK_MS e, como vTrafficLightControllerTask, também no prazo do cruzamento
+    principal. a demanda dos detectores é sorteada (extensão do verde e fim antecipado) e,
+    a cada quadro do mestre (1,5 a 4 s), o prazo é deslocado como a correção da onda verde
+    (até GREEN_WAVE_MAX_SLEW_MS para qualquer lado). depois de cada volta o prazo é
+    publicado como em phase_deadline_ms, e as saídas leem intersections_remaining:
+
+    - a matriz desenha um quadro a cada FRAME_MS (ANIM_FRAME_MS); o fim previsto em cada
+      quadro é o instante do quadro mais o tempo restante;
+    - o display redesenha o dígito (segundos arredondados para cima) quando acorda, com a
+      regra de espera de display_render: 1 ms depois de cada troca de dígito, a cada 100 ms
+      no verde, e na hora a cada mudança de fase ou do prazo publicado.
+
+    o fim de verdade é a volta em que a fase muda. como a demanda e a onda verde movem o
+    prazo no meio da fase, só contam os quadros depois do último ajuste do prazo (os ajustes
+    são contados à parte). a matriz tem que prever o fim com erro de no máximo um quadro, e
+    o dígito do display tem que ser o dos segundos que faltam de verdade, menos a um quadro
+    de cada troca. saída em CSV; termina com erro em qualquer violação
+
+    cc -O2 -Ilib -o countdown_host tools/countdown_host.c lib/control.c lib/intersections.c
+    ./countdown_host [minutos] [semente]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "control.h"
+#include "green_wave_sync.h"
+
+#define FRAME_MS 20          // ANIM_FRAME_MS do firmware (matriz a 50 fps)
+#define DEMAND_EVERY_MS 2500 // em média uma mudança dos detectores a cada tanto
+#define WAVE_FRAME_MS 1500   // o mestre manda um quadro a cada troca de fase: entre 1500 e 4000 ms
+#define DISPLAY_GREEN_MS 100 // quadro da caminhada do pedestre no verde
+#define MAX_PHASE_MS 20000   // fase mais longa guardada (verde com a extensão máxima e a onda verde)
+
+static intersections_t ctl;
+static control_t control = {.ctl = &ctl, .main = 0, .actuated = true};
+
+// o que as saídas mostravam em cada ms da fase atual
+static uint32_t matrix_end[MAX_PHASE_MS / FRAME_MS]; // fim previsto em cada quadro da matriz
+static uint8_t display_digit[MAX_PHASE_MS];              // dígito do display
+
+static uint32_t rand_below(uint32_t n)
+{
+    return (uint32_t)rand() % n;
+}
+
+static bool time_after(uint32_t now, uint32_t time)
+{
+    return (int32_t)(now - time) >= 0;
+}
+
+static bool has_countdown(void)
+{
+    return ctl.phase[0] <= RED_LIGHT && !(ctl.flags[0] & INTERSECTION_PREEMPT);
+}
+
+static uint32_t seconds_left(uint32_t remaining)
+{
+    return (remaining + 999) / 1000;
+}
+
+// próxima volta do controlador: a próxima posição da roda, ou antes, o prazo do cruzamento principal
+// (no tick seguinte se a onda verde o trouxe para agora)
+static uint32_t next_turn(uint32_t now)
+{
+    uint32_t wake = (now / WHEEL_TICK_MS + 1) * WHEEL_TICK_MS;
+    int32_t until = (int32_t)(ctl.deadline[0] - now);
+    uint32_t phase_end = now + (until > 0 ? until : 1);
+    return phase_end < wake ? phase_end : wake;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t minutes = argc >= 2 ? strtoul(argv[1], NULL, 10) : 60;
+    srand(argc >= 3 ? strtoul(argv[2], NULL, 10) : 1);
+
+    uint32_t phases = 0, adjustments = 0, frames = 0, matrix_worst = 0, matrix_bad = 0;
+    uint32_t digit_ms = 0, digit_bad = 0;
+
+    intersections_init(&ctl, 0);
+    intersections_add(&ctl, 0);
+
+    control_inputs_t inputs = {0};
+    uint32_t turn = 0, phase_start = 0, adjusted_ms = 0, display_wake = 0, wave_frame = WAVE_FRAME_MS;
+    uint32_t deadline = ctl.deadline[0];
+    uint8_t shown_seconds = 0;
+    bool countdown = has_countdown();
+
+    for (uint32_t now = 0; now < minutes * 60000; now++)
+    {
+        // DETECTORES: VEÍCULO NA VIA PRINCIPAL, NA TRANSVERSAL, NAS DUAS OU EM NENHUMA, SORTEADOS
+        if (rand_below(DEMAND_EVERY_MS) == 0)
+            inputs.demand = (uint8_t)rand_below(4);
+
+        if (now == turn)
+        {
+            bool changed = control_step(&control, &inputs, now);
+
+            // CORREÇÃO DA ONDA VERDE A CADA QUADRO DO MESTRE, EM QUALQUER PONTO DA FASE LOCAL, ANTES DE
+            // PUBLICAR (COMO O FIRMWARE)
+            if (time_after(now, wave_frame))
+            {
+                int32_t error = (int32_t)rand_below(2 * GREEN_WAVE_MAX_SLEW_MS + 1) - GREEN_WAVE_MAX_SLEW_MS;
+                intersections_shift(&ctl, 0, error);
+                wave_frame = now + WAVE_FRAME_MS + rand_below(2500);
+            }
+
+            // FIM ANTECIPADO NESTA VOLTA (VIA TRANSVERSAL COM O VERDE MÍNIMO CUMPRIDO): TAMBÉM É UM AJUSTE
+            if (changed && (int32_t)(deadline - now) > 0)
+            {
+                adjustments++;
+                adjusted_ms = now;
+            }
+
+            // FIM DE VERDADE DA FASE: CONFERE O QUE AS SAÍDAS MOSTRARAM DEPOIS DO ÚLTIMO AJUSTE DO PRAZO
+            if (changed && countdown && now - phase_start < MAX_PHASE_MS)
+            {
+                phases++;
+                for (uint32_t t = adjusted_ms; t < now; t++)
+                {
+                    uint32_t left = now - t;
+                    if (t % FRAME_MS == 0)
+                    {
+                        uint32_t end = matrix_end[(t - phase_start) / FRAME_MS];
+                        uint32_t error = end > now ? end - now : now - end;
+                        matrix_worst = error > matrix_worst ? error : matrix_worst;
+                        matrix_bad += error > FRAME_MS;
+                        frames++;
+                    }
+
+                    // O DÍGITO PODE TROCAR ATÉ UM QUADRO ANTES OU DEPOIS DO SEGUNDO EXATO
+                    bool near_change = left % 1000 < FRAME_MS || left % 1000 > 1000 - FRAME_MS;
+                    digit_bad += display_digit[t - phase_start] != seconds_left(left) && !near_change;
+                    digit_ms++;
+                }
+            }
+
+            if (changed)
+            {
+                phase_start = adjusted_ms = display_wake = now;
+            }
+            else if (ctl.deadline[0] != deadline)
+            {
+                // PRAZO NOVO NO MEIO DA FASE (DEMANDA OU ONDA VERDE): O QUE FOI MOSTRADO ANTES NÃO CONTA,
+                // E O CONTROLADOR ACORDA O DISPLAY
+                adjustments++;
+                adjusted_ms = display_wake = now;
+            }
+            deadline = ctl.deadline[0];
+            countdown = has_countdown();
+            turn = next_turn(now);
+        }
+
+        // DISPLAY: O DÍGITO SÓ MUDA QUANDO A TASK ACORDA (REGRA DE ESPERA DE display_render)
+        if (now == display_wake)
+        {
+            uint32_t remaining = intersections_remaining(&ctl, 0, now);
+            shown_seconds = seconds_left(remaining);
+
+            uint32_t wait = ctl.phase[0] == GREEN_LIGHT ? DISPLAY_GREEN_MS : UINT32_MAX;
+            if (shown_seconds > 0 && remaining - (shown_seconds - 1) * 1000u < wait)
+                wait = remaining - (shown_seconds - 1) * 1000u + 1;
+            display_wake = wait == UINT32_MAX ? UINT32_MAX : now + wait;
+        }
+
+        if (now - phase_start < MAX_PHASE_MS)
+        {
+            // MATRIZ: UM QUADRO A CADA FRAME_MS, COM O FIM PREVISTO PELO TEMPO RESTANTE
+            if (now % FRAME_MS == 0)
+                matrix_end[(now - phase_start) / FRAME_MS] = now + intersections_remaining(&ctl, 0, now);
+            display_digit[now - phase_start] = shown_seconds;
+        }
+    }
+
+    bool ok = phases > 0 && matrix_bad == 0 && digit_bad == 0;
+    printf("minutos,fases,ajustes,quadros_matriz,erro_max_matriz_ms,quadros_fora,ms_display,ms_digito_errado,ok\n");
+    printf("%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\n", (unsigned long)minutes, (unsigned long)phases,
+           (unsigned long)adjustments, (unsigned long)frames, (unsigned long)matrix_worst, (unsigned long)matrix_bad,
+           (unsigned long)digit_ms, (unsigned long)digit_bad, ok ? "sim" : "NAO");
+    return ok ? 0 : 1;
+}
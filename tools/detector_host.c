@@ -0,0 +1,240 @@
+/*
+    filtro dos detectores (lib/detector_filter.c) rodando no computador
+
+    passa um registro de amostras pelo mesmo código do firmware, em blocos de
+    DETECTOR_BLOCK_SAMPLES por canal, e mostra as detecções e o custo de cada bloco.
+    o registro é um CSV com uma linha por instante e uma coluna por canal, como o
+    comando "amostras" do terminal USB; linhas com # são comentários. gerar cria um
+    registro sintético com ruído, picos isolados e veículos anotados em comentários
+    "# veiculo <canal> <inicio_ms> <fim_ms>", que a reprodução confere
+
+    cc -O2 -Ibench/host -Ilib -o detector_host tools/detector_host.c lib/detector_filter.c
+    ./detector_host gerar 120 > registro.csv
+    ./detector_host registro.csv [liga desliga shift]
+    tools/shell.py /dev/ttyACM0 amostras | ./detector_host -
+*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "detector_filter.h"
+#include "host_rng.h"
+
+#define MAX_VEHICLES 256
+#define MATCH_MS 1000 // detecção até 1s depois da chegada conta para o veículo
+
+typedef struct
+{
+    int channel;
+    uint32_t start_ms, end_ms;
+    bool detected;
+    uint32_t latency_ms;
+} vehicle_t;
+
+static vehicle_t vehicles[MAX_VEHICLES];
+static int vehicle_count;
+
+static int generate(int seconds, uint32_t seed)
+{
+    const int channels = 2;
+    uint32_t total_ms = seconds * 1000;
+    rng_seed(seed);
+    int centers[2] = {2048 + rng_range(-60, 60), 2048 + rng_range(-60, 60)};
+
+    // VEÍCULOS SEM SOBREPOSIÇÃO NO MESMO CANAL, COM PELO MENOS 1s LIVRE ENTRE ELES
+    uint32_t next_free[2] = {1000, 1000};
+    while (vehicle_count < MAX_VEHICLES)
+    {
+        int c = rng_range(0, channels - 1);
+        uint32_t start = next_free[c] + rng_range(1000, 8000);
+        uint32_t end = start + rng_range(400, 4000);
+        if (end >= total_ms)
+            break;
+        vehicles[vehicle_count++] = (vehicle_t){.channel = c, .start_ms = start, .end_ms = end};
+        next_free[c] = end;
+    }
+
+    printf("# registro sintetico: %d s, %d canais a %d Hz, semente %u\n", seconds, channels, DETECTOR_SAMPLE_HZ, seed);
+    for (int v = 0; v < vehicle_count; v++)
+        printf("# veiculo %d %u %u\n", vehicles[v].channel, vehicles[v].start_ms, vehicles[v].end_ms);
+
+    for (uint32_t i = 0; i < total_ms * DETECTOR_SAMPLE_HZ / 1000; i++)
+    {
+        uint32_t ms = i * 1000 / DETECTOR_SAMPLE_HZ;
+        for (int c = 0; c < channels; c++)
+        {
+            int value = centers[c] + rng_range(-40, 40);
+
+            // O EIXO DESLOCADO PARA UM DOS LADOS, COMO O JOYSTICK EMPURRADO
+            for (int v = 0; v < vehicle_count; v++)
+            {
+                if (vehicles[v].channel == c && ms >= vehicles[v].start_ms && ms < vehicles[v].end_ms)
+                    value += (v & 1 ? -1 : 1) * 1400;
+            }
+
+            // PICO ISOLADO (INTERFERÊNCIA): O FILTRO NÃO PODE DETECTAR
+            if (rng_range(0, 499) == 0)
+                value += rng_range(-2000, 2000);
+
+            value = value < 0 ? 0 : value > DETECTOR_ADC_MASK ? DETECTOR_ADC_MASK : value;
+            printf(c + 1 < channels ? "%d," : "%d\n", value);
+        }
+    }
+    return 0;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// anota a detecção no veículo que chegou há menos de MATCH_MS; retorna false se não houver
+static bool match_vehicle(int channel, uint32_t ms)
+{
+    for (int v = 0; v < vehicle_count; v++)
+    {
+        vehicle_t *vehicle = &vehicles[v];
+        if (vehicle->channel == channel && !vehicle->detected && ms >= vehicle->start_ms &&
+            ms <= vehicle->end_ms + MATCH_MS)
+        {
+            vehicle->detected = true;
+            vehicle->latency_ms = ms - vehicle->start_ms;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int replay(const char *path, int argc, char **argv)
+{
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in)
+    {
+        perror(path);
+        return 2;
+    }
+
+    detector_config_t config = {
+        .center = 0,
+        .on_level = argc >= 1 ? atoi(argv[0]) : DETECTOR_ON_LEVEL,
+        .off_level = argc >= 2 ? atoi(argv[1]) : DETECTOR_OFF_LEVEL,
+        .shift = argc >= 3 ? atoi(argv[2]) : DETECTOR_IIR_SHIFT};
+    detector_config_t configs[DETECTOR_MAX_CHANNELS] = {config, config, config, config};
+    detector_filter_t filter = {0};
+    uint16_t block[DETECTOR_MAX_CHANNELS * DETECTOR_BLOCK_SAMPLES];
+    int channels = 0, filled = 0, false_detections = 0;
+    uint32_t instants = 0;
+    double total_ns = 0, max_ns = 0;
+    char line[128];
+
+    while (fgets(line, sizeof(line), in))
+    {
+        if (line[0] == '#')
+        {
+            int channel;
+            unsigned start_ms, end_ms;
+            if (sscanf(line, "# veiculo %d %u %u", &channel, &start_ms, &end_ms) == 3 && vehicle_count < MAX_VEHICLES)
+                vehicles[vehicle_count++] = (vehicle_t){.channel = channel, .start_ms = start_ms, .end_ms = end_ms};
+            continue;
+        }
+
+        // A PRIMEIRA LINHA DE AMOSTRAS DEFINE OS CANAIS
+        int values[DETECTOR_MAX_CHANNELS], count = 0;
+        char *p = line, *end;
+        while (count < DETECTOR_MAX_CHANNELS)
+        {
+            long value = strtol(p, &end, 10);
+            if (end == p)
+                break;
+            values[count++] = value;
+            if (*end != ',')
+                break;
+            p = end + 1;
+        }
+        if (count == 0)
+            continue;
+        if (channels == 0)
+        {
+            channels = count;
+            detector_filter_init(&filter, configs, channels);
+        }
+        if (count != channels)
+        {
+            fprintf(stderr, "linha com %d canais, esperado %d: %s", count, channels, line);
+            return 2;
+        }
+
+        for (int c = 0; c < channels; c++)
+            block[filled * channels + c] = values[c];
+        instants++;
+        if (++filled < DETECTOR_BLOCK_SAMPLES)
+            continue;
+        filled = 0;
+
+        double start = now_ns();
+        uint32_t changed = detector_filter_block(&filter, block, DETECTOR_BLOCK_SAMPLES);
+        double cost = now_ns() - start;
+        total_ns += cost;
+        if (cost > max_ns)
+            max_ns = cost;
+
+        uint32_t ms = instants * 1000 / DETECTOR_SAMPLE_HZ;
+        for (int c = 0; c < channels; c++)
+        {
+            if (!(changed & (1u << c)))
+                continue;
+            bool occupied = filter.channels[c].occupied;
+            printf("%6u ms  canal %d %s\n", ms, c, occupied ? "ocupado" : "livre");
+            if (occupied && vehicle_count && !match_vehicle(c, ms))
+                false_detections++;
+        }
+    }
+    if (in != stdin)
+        fclose(in);
+
+    if (filter.blocks == 0)
+    {
+        fprintf(stderr, "menos de um bloco (%d amostras por canal)\n", DETECTOR_BLOCK_SAMPLES);
+        return 2;
+    }
+
+    printf("\n%lu blocos de %d amostras x %d canais: %.0f ns por bloco (max %.0f), %.1f ns por amostra\n",
+           (unsigned long)filter.blocks, DETECTOR_BLOCK_SAMPLES, channels, total_ns / filter.blocks, max_ns,
+           total_ns / filter.blocks / (DETECTOR_BLOCK_SAMPLES * channels));
+
+    if (vehicle_count == 0)
+        return 0;
+
+    int detected = 0;
+    uint32_t worst = 0, sum = 0;
+    for (int v = 0; v < vehicle_count; v++)
+    {
+        if (!vehicles[v].detected)
+        {
+            printf("veiculo perdido: canal %d de %u a %u ms\n", vehicles[v].channel, vehicles[v].start_ms, vehicles[v].end_ms);
+            continue;
+        }
+        detected++;
+        sum += vehicles[v].latency_ms;
+        if (vehicles[v].latency_ms > worst)
+            worst = vehicles[v].latency_ms;
+    }
+    printf("%d de %d veiculos detectados (atraso medio %u ms, max %u ms), %d deteccoes falsas\n", detected,
+           vehicle_count, detected ? sum / detected : 0, worst, false_detections);
+    return detected == vehicle_count && false_detections == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "gerar") == 0)
+        return generate(argc >= 3 ? atoi(argv[2]) : 60, argc >= 4 ? strtoul(argv[3], NULL, 0) : 1);
+    if (argc >= 2)
+        return replay(argv[1], argc - 2, argv + 2);
+
+    fprintf(stderr, "uso: %s gerar [segundos] [semente] > registro.csv | %s <registro.csv|-> [liga desliga shift]\n",
+            argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,259 @@
+/*
+    brilho médio do pontilhamento temporal (lib/matrix_dither.c) no computador
+
+    canal confere matrix_dither_channel em todos os 65536 níveis 8.8: a média dos
+    DITHER_SUBFRAMES subquadros tem que ficar a no máximo meio passo (1/16 de nível) do
+    nível pedido, saturando em 255. quadros roda o motor de verdade com a DMA e o timer
+    falsos daqui: cada quadro do semáforo (traffic_levels_*) é publicado, o timer dispara
+    um ciclo inteiro e a média no tempo de cada canal de cada LED, tirada das palavras que
+    a DMA enviaria, é comparada com o nível do quadro. também confere que um quadro
+    publicado no meio do ciclo só entra no início do próximo e que matrix_dither_hold
+    para o timer e envia o quadro arredondado uma vez
+
+    cc -O2 -Ibench/host -Ilib -o dither_host tools/dither_host.c lib/matrix_dither.c \
+       -x c++ lib/traffic_frames.cpp -x none -lstdc++
+    ./dither_host
+*/
+#include <stdio.h>
+#include <string.h>
+#include "matrix_dither.h"
+#include "traffic_frames.h"
+#include "hardware/dma.h"
+
+#define MAX_ERROR (256 / DITHER_SUBFRAMES / 2) // meio passo, em 1/256 de nível
+
+// o que a DMA enviaria: as palavras de cada disparo, em ordem
+static uint32_t sent[4 * DITHER_SUBFRAMES][DITHER_PIXELS];
+static unsigned sent_count;
+static repeating_timer_t *timer;
+static struct bench_pio pio;
+
+int dma_claim_unused_channel(bool required)
+{
+    (void)required;
+    return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel)
+{
+    (void)channel;
+    return (dma_channel_config){0};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    (void)c;
+    (void)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    (void)c;
+    (void)incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    (void)c;
+    (void)incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+    (void)c;
+    (void)dreq;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    (void)channel;
+    (void)config;
+    (void)write_addr;
+    (void)read_addr;
+    (void)transfer_count;
+    (void)trigger;
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+    (void)channel;
+    if (sent_count < count_of(sent) && transfer_count == DITHER_PIXELS)
+        memcpy(sent[sent_count], (const void *)read_addr, sizeof(sent[0]));
+    sent_count++;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel)
+{
+    (void)channel;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx)
+{
+    (void)pio;
+    (void)sm;
+    (void)is_tx;
+    return 0;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+    (void)pio;
+    (void)sm;
+    (void)data;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out)
+{
+    out->delay_us = delay_us;
+    out->callback = callback;
+    out->user_data = user_data;
+    timer = out;
+    return true;
+}
+
+bool cancel_repeating_timer(repeating_timer_t *rt)
+{
+    if (timer == rt)
+        timer = NULL;
+    return true;
+}
+
+void sleep_us(uint64_t us)
+{
+    (void)us;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    (void)ms;
+}
+
+static void tick(unsigned count)
+{
+    for (unsigned i = 0; i < count && timer; i++)
+        timer->callback(timer);
+}
+
+// nível pedido em 1/256, saturado no maior nível de 8 bits
+static uint32_t wanted(uint16_t level)
+{
+    return level > 255 * 256 ? 255 * 256 : level;
+}
+
+static uint32_t distance(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+// todos os níveis de um canal: devolve o maior erro da média, em 1/256 de nível
+static uint32_t check_channel(void)
+{
+    uint32_t worst = 0;
+    for (uint32_t level = 0; level <= 0xFFFF; level++)
+    {
+        uint32_t sum = 0;
+        for (uint8_t k = 0; k < DITHER_SUBFRAMES; k++)
+            sum += matrix_dither_channel(level, k);
+        uint32_t error = distance(sum * 256 / DITHER_SUBFRAMES, wanted(level));
+        worst = error > worst ? error : worst;
+    }
+    return worst;
+}
+
+// média de um canal de um LED nos subquadros [first, first + DITHER_SUBFRAMES) enviados, em 1/256
+static uint32_t average(unsigned first, uint8_t pixel, uint8_t shift)
+{
+    uint32_t sum = 0;
+    for (unsigned k = 0; k < DITHER_SUBFRAMES; k++)
+        sum += sent[first + k][pixel] >> shift & 0xFF;
+    return sum * 256 / DITHER_SUBFRAMES;
+}
+
+// maior erro da média de um ciclo enviado contra o quadro, em todos os LEDs e canais
+static uint32_t check_cycle(unsigned first, const dither_level_t *levels)
+{
+    uint32_t worst = 0;
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+    {
+        uint32_t errors[3] = {
+            distance(average(first, i, 24), wanted(levels[i].green)),
+            distance(average(first, i, 16), wanted(levels[i].red)),
+            distance(average(first, i, 8), wanted(levels[i].blue)),
+        };
+        for (int c = 0; c < 3; c++)
+            worst = errors[c] > worst ? errors[c] : worst;
+    }
+    return worst;
+}
+
+typedef struct
+{
+    const char *name;
+    const traffic_levels_t *levels;
+} frame_case_t;
+
+static const frame_case_t frames[] = {
+    {"verde", &traffic_levels_green}, {"amarelo", &traffic_levels_yellow}, {"vermelho", &traffic_levels_red},
+    {"noturno", &traffic_levels_night}, {"apagado", &traffic_levels_off},
+};
+
+int main(void)
+{
+    int failures = 0;
+
+    printf("teste,erro_max_256,limite_256,ok\n");
+
+    uint32_t error = check_channel();
+    printf("canal_65536_niveis,%lu,%d,%s\n", (unsigned long)error, MAX_ERROR, error <= MAX_ERROR ? "sim" : "NAO");
+    failures += error > MAX_ERROR;
+
+    matrix_dither_init(&pio, 0);
+    for (unsigned f = 0; f < count_of(frames); f++)
+    {
+        // O QUADRO ENTRA NO PRIMEIRO DISPARO DO CICLO SEGUINTE
+        sent_count = 0;
+        matrix_dither_show(frames[f].levels->levels);
+        tick(DITHER_SUBFRAMES);
+        error = check_cycle(0, frames[f].levels->levels);
+        bool ok = sent_count == DITHER_SUBFRAMES && error <= MAX_ERROR;
+        printf("quadro_%s,%lu,%d,%s\n", frames[f].name, (unsigned long)error, MAX_ERROR, ok ? "sim" : "NAO");
+        failures += !ok;
+    }
+
+    // PUBLICADO NO MEIO DO CICLO: O RESTO DO CICLO AINDA É O QUADRO ANTERIOR
+    sent_count = 0;
+    matrix_dither_show(traffic_levels_green.levels);
+    tick(DITHER_SUBFRAMES + 3);
+    matrix_dither_show(traffic_levels_red.levels);
+    tick(DITHER_SUBFRAMES - 3 + DITHER_SUBFRAMES);
+    uint32_t previous = check_cycle(DITHER_SUBFRAMES, traffic_levels_green.levels);
+    uint32_t next = check_cycle(2 * DITHER_SUBFRAMES, traffic_levels_red.levels);
+    error = previous > next ? previous : next;
+    bool ok = sent_count == 3 * DITHER_SUBFRAMES && error <= MAX_ERROR;
+    printf("troca_no_inicio_do_ciclo,%lu,%d,%s\n", (unsigned long)error, MAX_ERROR, ok ? "sim" : "NAO");
+    failures += !ok;
+
+    // QUADRO ESTÁTICO: UM ENVIO ARREDONDADO E O TIMER PARADO
+    sent_count = 0;
+    matrix_dither_hold(traffic_levels_yellow.levels);
+    bool held = sent_count == 1 && timer == NULL;
+    error = 0;
+    for (uint8_t i = 0; i < DITHER_PIXELS; i++)
+    {
+        const dither_level_t *level = &traffic_levels_yellow.levels[i];
+        uint32_t errors[3] = {
+            distance((sent[0][i] >> 24 & 0xFF) * 256, wanted(level->green)),
+            distance((sent[0][i] >> 16 & 0xFF) * 256, wanted(level->red)),
+            distance((sent[0][i] >> 8 & 0xFF) * 256, wanted(level->blue)),
+        };
+        for (int c = 0; c < 3; c++)
+            error = errors[c] > error ? errors[c] : error;
+    }
+    ok = held && error <= 128;
+    printf("quadro_estatico,%lu,128,%s\n", (unsigned long)error, ok ? "sim" : "NAO");
+    failures += !ok;
+
+    return failures ? 1 : 0;
+}
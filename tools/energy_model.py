@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Modelo de energia do semáforo (roda no computador, não no firmware).
+
+Soma os despertares de cada fonte do firmware em cada modo de operação e estima a
+fração do tempo em que o núcleo fica ativo, ocioso e dormindo, e a corrente média
+da placa (sem os LEDs, que dependem só da imagem exibida).
+
+Cada fonte é (nome, despertares por segundo, us de CPU por despertar). Os tempos de
+CPU padrão são estimativas; com o relatório de sched_stats_report salvo em CSV
+("task,prio,T_ms,C_us,...") os WCET medidos na placa substituem as estimativas.
+
+Uso: energy_model.py [--wcet relatorio.csv] [--run-ma 24] [--sleep-ma 9]
+"""
+
+import argparse
+import csv
+import sys
+
+CYCLE_MS = 3000 + 1500 + 4000  # verde + amarelo + vermelho (phase_duration_ms)
+WAKE_US = 15                   # entrada e saída do sono, ajuste dos ticks e troca de contexto
+I2C_BYTE_US = 25               # um byte a 400kHz, com a CPU esperando o I2C (envio bloqueante)
+
+# fração do ciclo normal em cada fase
+GREEN = 3000 / CYCLE_MS
+YELLOW = 1500 / CYCLE_MS
+CHANGES = 3 / (CYCLE_MS / 1000)  # trocas de fase por segundo
+
+# fontes de despertar: (task de sched_stats ou None, despertares/s, us de CPU por despertar)
+SCHEDULES = {
+    "antes (tick de 1ms, polling)": {
+        "normal": [
+            ("tick do FreeRTOS", None, 1000, 3),
+            ("controlador", "controlador", 20, 40),
+            ("botoes", "botoes", 100, 5),
+            ("led", "led", 2, 10),
+            ("matriz", "matriz", 50, 150),
+            ("pontilhamento", None, 800, 5),
+            ("display", "display", 10, 80),
+            ("servidor display", "servidor display", 10 * GREEN + 1, 160 * I2C_BYTE_US),
+            ("servidor display (efeitos)", None, 20, 5),
+            ("buzzer", "buzzer", 4, 10),
+        ],
+        "noturno": [
+            ("tick do FreeRTOS", None, 1000, 3),
+            ("controlador", "controlador", 20, 40),
+            ("botoes", "botoes", 100, 5),
+            ("led", "led", 2, 10),
+            ("matriz", "matriz", 50, 150),
+            ("pontilhamento", None, 800, 5),
+            ("display", "display", 10, 20),
+            ("servidor display (efeitos)", None, 20, 5),
+            ("buzzer", "buzzer", 1, 10),
+        ],
+    },
+    "agora (tickless, por eventos)": {
+        "normal": [
+            ("controlador", "controlador", 20, 40),
+            ("led", "led", CHANGES, 10),
+            ("matriz", "matriz", 50, 150),
+            ("pontilhamento", None, 800, 5),
+            ("display", "display", 10 * GREEN + 1, 80),
+            ("servidor display", "servidor display", 10 * GREEN + 1, 160 * I2C_BYTE_US),
+            ("buzzer", "buzzer", CHANGES + 4 * YELLOW, 10),
+            ("supervisor (watchdog)", None, 2, 5),
+        ],
+        # uma borda do pisca por segundo: controlador, saídas e a transição de 300ms da matriz
+        "noturno": [
+            ("controlador", "controlador", 1, 40),
+            ("led", "led", 1, 10),
+            ("matriz", "matriz", 300 / 20 + 1, 150),
+            ("pontilhamento", None, 800 * 0.3, 5),
+            ("display", "display", 1, 20),
+            ("servidor display (efeitos)", None, 1, 5),
+            ("buzzer", "buzzer", 1, 10),
+            ("supervisor (watchdog)", None, 2, 5),
+        ],
+    },
+}
+
+
+def load_wcet(path):
+    # relatório de sched_stats_report: task,prio,T_ms,C_us,CS_us,B_us,R_us,jobs,ok
+    wcet = {}
+    with open(path, encoding="utf-8") as report:
+        for row in csv.reader(report):
+            if len(row) >= 4 and row[3].isdigit():
+                wcet[row[0]] = int(row[3])
+    return wcet
+
+
+def evaluate(sources, wcet, ticking):
+    wakes = sum(rate for _, _, rate, _ in sources)
+    busy_us = sum(rate * (wcet.get(task, cpu) if task else cpu) for _, task, rate, cpu in sources)
+    active = min(1.0, (busy_us + wakes * WAKE_US) / 1e6)
+    # sem tickless a task idle gira em laço: ociosa, mas com o núcleo acordado
+    sleeping = 0.0 if ticking else 1.0 - active
+    return wakes, active, sleeping
+
+
+def main():
+    parser = argparse.ArgumentParser(description="modelo de energia dos despertares do semáforo")
+    parser.add_argument("--wcet", help="relatório de sched_stats_report em CSV")
+    parser.add_argument("--run-ma", type=float, default=24.0, help="corrente com o núcleo ativo (POWER_RUN_MA)")
+    parser.add_argument("--sleep-ma", type=float, default=9.0, help="corrente em WFI (POWER_SLEEP_MA)")
+    args = parser.parse_args()
+
+    try:
+        wcet = load_wcet(args.wcet) if args.wcet else {}
+    except OSError as error:
+        print("energy_model: %s" % error, file=sys.stderr)
+        return 1
+
+    print("%-30s %-8s %9s %7s %7s %9s %8s %10s" %
+          ("firmware", "modo", "acord/s", "ativo", "ocioso", "dormindo", "mA", "mAh/dia"))
+    for name, modes in SCHEDULES.items():
+        ticking = name.startswith("antes")
+        for mode, sources in modes.items():
+            wakes, active, sleeping = evaluate(sources, wcet, ticking)
+            current = sleeping * args.sleep_ma + (1 - sleeping) * args.run_ma
+            print("%-30s %-8s %9.0f %6.1f%% %6.1f%% %8.1f%% %8.1f %10.0f" %
+                  (name, mode, wakes, active * 100, (1 - active) * 100, sleeping * 100, current, current * 24))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+Compilador da fonte do display.
+
+Converte assets/font.txt nas tabelas const (flash) declaradas em lib/font.h, em um único
+font.c: antes elas eram static em font.h e cada arquivo que incluísse o cabeçalho levava
+uma cópia.
+
+    glyph U+XXXX              inicia um glifo pelo código Unicode; as 8 linhas seguintes
+                              têm 8 pixels cada ("#" aceso, qualquer outro caractere apagado)
+
+A faixa ASCII U+0020 a U+007E tem que vir completa e em ordem (vira font[], indexada pelo
+código); os outros glifos vêm depois, em ordem crescente de código (viram font_latin1[],
+com busca binária). O arquivo gerado informa o tamanho das tabelas e o que ocuparia com
+RLE por glifo, que em glifos de 8 bytes costuma ser maior.
+
+Uso: font_compiler.py -o <diretório de saída> assets/font.txt
+Gera font.c no diretório de saída.
+"""
+
+import argparse
+import os
+import sys
+
+ASCII_FIRST = 0x20
+ASCII_LAST = 0x7E
+GLYPH_SIZE = 8
+
+
+class FontError(Exception):
+    pass
+
+
+def parse(path):
+    glyphs = []  # (código, linhas, onde)
+    rows = None
+
+    with open(path, encoding="utf-8") as source:
+        for number, line in enumerate(source, 1):
+            where = "%s:%d" % (path, number)
+            words = line.split()
+
+            # linha de pixels: uma única palavra dentro de um glifo incompleto (pode começar com "#")
+            if rows is not None and len(rows) < GLYPH_SIZE and len(words) == 1 and words[0] != "glyph":
+                rows.append(words[0])
+                continue
+
+            # linha vazia ou comentário ("# texto")
+            if not words or words[0].startswith("#"):
+                continue
+
+            # o comentário no fim do comando começa com um "#" isolado
+            if len(words) > 2 and words[2] == "#":
+                words = words[:2]
+            if words[0] != "glyph" or len(words) != 2 or not words[1].upper().startswith("U+"):
+                raise FontError("%s: esperado glyph U+XXXX" % where)
+            try:
+                codepoint = int(words[1][2:], 16)
+            except ValueError:
+                raise FontError("%s: código inválido '%s'" % (where, words[1]))
+            rows = []
+            glyphs.append((codepoint, rows, where))
+
+    return glyphs
+
+
+def encode(codepoint, rows, where):
+    # coluna a coluna, bit 0 = linha de cima (formato de ssd1306_bitmap)
+    if len(rows) != GLYPH_SIZE or any(len(row) != GLYPH_SIZE for row in rows):
+        raise FontError("%s: o glifo U+%04X não tem %dx%d pixels" % (where, codepoint, GLYPH_SIZE, GLYPH_SIZE))
+    return [sum(1 << y for y in range(GLYPH_SIZE) if rows[y][x] == "#") for x in range(GLYPH_SIZE)]
+
+
+def label(codepoint):
+    # "\\" no fim de um comentário de linha continuaria o comentário na linha seguinte
+    return '"\\"' if codepoint == 0x5C else chr(codepoint)
+
+
+def rle_size(data):
+    # pares (repetições, byte) por glifo
+    size = 0
+    for start in range(0, len(data), GLYPH_SIZE):
+        glyph = data[start:start + GLYPH_SIZE]
+        size += 2 * (1 + sum(1 for a, b in zip(glyph, glyph[1:]) if a != b))
+    return size
+
+
+def check(glyphs):
+    ascii_count = ASCII_LAST - ASCII_FIRST + 1
+    codes = [codepoint for codepoint, _, _ in glyphs]
+    if codes[:ascii_count] != list(range(ASCII_FIRST, ASCII_LAST + 1)):
+        raise FontError("a faixa U+%04X a U+%04X tem que vir primeiro, completa e em ordem" % (ASCII_FIRST, ASCII_LAST))
+    for (previous, _, _), (codepoint, _, where) in zip(glyphs[ascii_count:], glyphs[ascii_count + 1:]):
+        if codepoint <= previous:
+            raise FontError("%s: U+%04X fora da ordem crescente (busca binária)" % (where, codepoint))
+    if any(codepoint <= ASCII_LAST for codepoint in codes[ascii_count:]):
+        raise FontError("glifo da faixa ASCII repetido depois dela")
+    if any(codepoint > 0xFFFF for codepoint in codes):
+        raise FontError("código acima de U+FFFF (font_glyph_t.codepoint é uint16_t)")
+
+
+def generate(glyphs, output, source_name):
+    check(glyphs)
+    ascii_count = ASCII_LAST - ASCII_FIRST + 1
+    ascii_glyphs = glyphs[:ascii_count]
+    other_glyphs = glyphs[ascii_count:]
+
+    data = []
+    for codepoint, rows, where in glyphs:
+        data += encode(codepoint, rows, where)
+    raw = len(data)
+    table = ascii_count * GLYPH_SIZE + len(other_glyphs) * (GLYPH_SIZE + 2)
+
+    lines = [
+        "// gerado por tools/font_compiler.py a partir de assets/%s, não edite" % source_name,
+        "// %d glifos: %d bytes de pixels (%d nas tabelas); com RLE por glifo seriam %d" %
+        (len(glyphs), raw, table, rle_size(data)),
+        '#include "font.h"',
+        "",
+        "const uint8_t font[] = {",
+    ]
+    for codepoint, rows, where in ascii_glyphs:
+        glyph = encode(codepoint, rows, where)
+        lines.append("    %s, // %s" % (", ".join("0x%02X" % b for b in glyph), label(codepoint)))
+    lines += [
+        "};",
+        "",
+        "const font_glyph_t font_latin1[] = {",
+    ]
+    for codepoint, rows, where in other_glyphs:
+        glyph = encode(codepoint, rows, where)
+        lines.append("    {0x%02X, {%s}}, // %s" % (codepoint, ", ".join("0x%02X" % b for b in glyph), chr(codepoint)))
+    lines += [
+        "};",
+        "",
+        "const uint16_t font_latin1_count = %d;" % len(other_glyphs),
+        "",
+    ]
+
+    os.makedirs(output, exist_ok=True)
+    write_if_changed(os.path.join(output, "font.c"), "\n".join(lines))
+
+
+def write_if_changed(path, text):
+    # evita recompilar quando nada mudou
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as old:
+            if old.read() == text:
+                return
+    with open(path, "w", encoding="utf-8") as new:
+        new.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="gera a fonte do display")
+    parser.add_argument("-o", "--output", required=True, help="diretório de saída")
+    parser.add_argument("source", help="arquivo da fonte (.txt)")
+    args = parser.parse_args()
+
+    try:
+        generate(parse(args.source), args.output, os.path.basename(args.source))
+    except (FontError, OSError) as error:
+        print("font_compiler: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,257 @@
+/*
+    textos do firmware desenhados com a fonte gerada (assets/font.txt -> font.c) no computador
+
+    cada texto é desenhado em (0, 0) com ssd1306_draw_string em um framebuffer limpo e
+    conferido byte a byte: a string UTF-8 é decodificada aqui, de forma independente, e
+    cada caractere tem que ocupar as suas 8 colunas da página 0 com o glifo da tabela
+    (letra sem glifo, desenhada como espaço, é erro); nenhum outro byte pode mudar. os
+    pixels acesos de cada texto também são comparados com os esperados, para uma mudança
+    na fonte aparecer aqui
+
+    ssd1306_draw_string_prop é conferido do mesmo jeito: cada glifo sem as colunas vazias dos
+    dois lados (o espaço com 3), uma coluna entre as letras, e a coluna final devolvida.
+    ssd1306_draw_string_scaled é conferido pixel a pixel na tela inteira: cada pixel do
+    glifo vira um quadrado de scale x scale
+
+    também informa a RAM economizada: as tabelas geradas têm que estar em memória só de
+    leitura (const; na placa, a flash), e a tabela ASCII antiga (static uint8_t em font.h)
+    ocupava RAM. saída em CSV; termina com erro em qualquer diferença
+
+    tools/font_compiler.py -o build assets/font.txt
+    cc -O2 -Ibench/host -Ilib -o font_host tools/font_host.c lib/ssd1306.c lib/blit.c build/font.c -lm
+    ./font_host
+*/
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "font.h"
+#include "host_stubs.h"
+
+typedef struct
+{
+    const char *text;
+    uint16_t pixels; // pixels acesos esperados
+} font_case_t;
+
+// os textos do display_render e algumas letras acentuadas soltas
+static const font_case_t cases[] = {
+    {"ATENÇÃO!", 211},
+    {"EMERGÊNCIA!", 302},
+    {"PODE SEGUIR!", 291},
+    {"ESPERE!", 178},
+    {"---", 18},
+    {"àáâãçéêíóôõú", 326},
+    {"ÀÁÂÃÇÉÊÍÓÔÕÚ", 330},
+};
+
+// letras finas com colunas vazias dos dois lados: o espaçamento tem que ser sempre de uma coluna
+static const char *const prop_cases[] = {"il i", "ATENÇÃO!", "PODE SEGUIR!", "1:07"};
+
+typedef struct
+{
+    const char *text;
+    uint8_t scale;
+} scaled_case_t;
+
+// a contagem regressiva usa os dígitos ampliados
+static const scaled_case_t scaled_cases[] = {
+    {"12", 2},
+    {"ÇÃ", 3},
+    {"90", 4},
+};
+
+#define OLD_FONT_RAM (('~' - ' ' + 1) * 8) // static uint8_t font[] do font.h antigo: ia para a RAM (.data)
+
+// só as sequências de 1 e 2 bytes, que cobrem a fonte inteira
+static uint32_t decode(const uint8_t **s)
+{
+    uint32_t c = *(*s)++;
+    if (c >= 0xC0 && c < 0xE0 && (**s & 0xC0) == 0x80)
+        c = (c & 0x1F) << 6 | (*(*s)++ & 0x3F);
+    return c;
+}
+
+// glifo pela tabela, com busca linear (NULL se não existir)
+static const uint8_t *glyph(uint32_t codepoint)
+{
+    if (codepoint >= ' ' && codepoint <= '~')
+        return &font[(codepoint - ' ') * 8];
+    for (uint16_t i = 0; i < font_latin1_count; i++)
+    {
+        if (font_latin1[i].codepoint == codepoint)
+            return font_latin1[i].glyph;
+    }
+    return NULL;
+}
+
+// o endereço está em um mapeamento sem escrita? -1 quando /proc/self/maps não existe
+static int read_only(const void *address)
+{
+    FILE *maps = fopen("/proc/self/maps", "r");
+    if (!maps)
+        return -1;
+
+    char line[512], perms[5];
+    unsigned long start, end;
+    int result = -1;
+    while (result < 0 && fgets(line, sizeof(line), maps))
+    {
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) == 3 && (uintptr_t)address >= start &&
+            (uintptr_t)address < end)
+            result = perms[1] != 'w';
+    }
+    fclose(maps);
+    return result;
+}
+
+// largura sem as colunas vazias dos dois lados, como na fonte proporcional; o espaço tem 3
+static unsigned trimmed(const uint8_t *g, unsigned *first)
+{
+    unsigned start = 0, end = 8;
+    while (start < end && !g[start])
+        start++;
+    while (end > start && !g[end - 1])
+        end--;
+    *first = start == end ? 0 : start;
+    return start == end ? 3 : end - start;
+}
+
+static bool lit(const ssd1306_t *ssd, int x, int y)
+{
+    return ssd->ram_buffer[1 + x * ssd->pages + y / 8] >> (y % 8) & 1;
+}
+
+static int bits(uint8_t byte)
+{
+    int count = 0;
+    for (; byte; byte &= byte - 1)
+        count++;
+    return count;
+}
+
+int main(void)
+{
+    static ssd1306_t ssd;
+    int failures = 0;
+
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    printf("fonte: %u glifos ASCII + %u acentuados, %u bytes na flash\n", '~' - ' ' + 1, font_latin1_count,
+           (unsigned)(('~' - ' ' + 1) * 8 + font_latin1_count * sizeof(font_glyph_t)));
+
+    // AS TABELAS SÓ SAEM DA RAM SE FOREM const: AQUI, EM MEMÓRIA SEM ESCRITA
+    int font_ro = read_only(font), latin1_ro = read_only(font_latin1);
+    bool ram_ok = font_ro != 0 && latin1_ro != 0;
+    printf("ram: %d bytes (so leitura: %s), antes %d bytes em font.h, %d economizados\n", ram_ok ? 0 : OLD_FONT_RAM,
+           font_ro < 0 || latin1_ro < 0 ? "?" : ram_ok ? "sim" : "NAO", OLD_FONT_RAM, ram_ok ? OLD_FONT_RAM : 0);
+    failures += !ram_ok;
+
+    printf("texto,bytes_utf8,caracteres,colunas,pixels,pixels_esperados,ok\n");
+
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const font_case_t *test = &cases[i];
+        bool ok = true;
+
+        ssd1306_fill(&ssd, false);
+        ssd1306_draw_string(&ssd, test->text, 0, 0);
+
+        // O QUE CADA CARACTERE TEM QUE DEIXAR NA PÁGINA 0
+        uint8_t expected[WIDTH * (HEIGHT / 8)] = {0};
+        const uint8_t *s = (const uint8_t *)test->text;
+        unsigned chars = 0;
+        while (*s)
+        {
+            const uint8_t *g = glyph(decode(&s));
+            if (!g || chars * 8 + 8 > WIDTH)
+            {
+                ok = false;
+                break;
+            }
+            for (unsigned col = 0; col < 8; col++)
+                expected[(chars * 8 + col) * ssd.pages] = g[col];
+            chars++;
+        }
+
+        int pixels = 0;
+        for (unsigned b = 0; b < sizeof(expected); b++)
+        {
+            pixels += bits(ssd.ram_buffer[1 + b]);
+            if (ssd.ram_buffer[1 + b] != expected[b])
+                ok = false;
+        }
+        if (pixels != test->pixels)
+            ok = false;
+
+        printf("\"%s\",%u,%u,%u,%d,%u,%s\n", test->text, (unsigned)strlen(test->text), chars, chars * 8, pixels,
+               test->pixels, ok ? "sim" : "NAO");
+        failures += !ok;
+    }
+
+    printf("\nproporcional,caracteres,coluna_final,coluna_esperada,ok\n");
+    for (unsigned i = 0; i < sizeof(prop_cases) / sizeof(prop_cases[0]); i++)
+    {
+        ssd1306_fill(&ssd, false);
+        uint8_t end = ssd1306_draw_string_prop(&ssd, prop_cases[i], 0, 0);
+
+        uint8_t expected[WIDTH * (HEIGHT / 8)] = {0};
+        const uint8_t *s = (const uint8_t *)prop_cases[i];
+        unsigned chars = 0, x = 0;
+        bool ok = true;
+        while (*s)
+        {
+            const uint8_t *g = glyph(decode(&s));
+            unsigned first, width = g ? trimmed(g, &first) : 0;
+            if (!g || x + width > WIDTH)
+            {
+                ok = false;
+                break;
+            }
+            for (unsigned col = 0; col < width; col++)
+                expected[(x + col) * ssd.pages] = g[first + col];
+            x += width + 1;
+            chars++;
+        }
+
+        ok = ok && end == x && memcmp(&ssd.ram_buffer[1], expected, sizeof(expected)) == 0;
+        printf("\"%s\",%u,%u,%u,%s\n", prop_cases[i], chars, end, x, ok ? "sim" : "NAO");
+        failures += !ok;
+    }
+
+    printf("\nampliado,escala,caracteres,pixels,diferentes,ok\n");
+    for (unsigned i = 0; i < sizeof(scaled_cases) / sizeof(scaled_cases[0]); i++)
+    {
+        const scaled_case_t *test = &scaled_cases[i];
+        ssd1306_fill(&ssd, false);
+        ssd1306_draw_string_scaled(&ssd, test->text, 0, 0, test->scale);
+
+        const uint8_t *glyphs[WIDTH / 8];
+        const uint8_t *s = (const uint8_t *)test->text;
+        unsigned chars = 0;
+        bool ok = true;
+        while (*s && chars < WIDTH / 8)
+        {
+            ok = ok && (glyphs[chars++] = glyph(decode(&s))) != NULL;
+        }
+        ok = ok && chars * 8 * test->scale <= WIDTH;
+
+        // CADA PIXEL DO GLIFO VIRA UM QUADRADO DE scale x scale; O RESTO DA TELA FICA APAGADO
+        int pixels = 0, diff = 0;
+        for (int y = 0; ok && y < HEIGHT; y++)
+        {
+            for (int x = 0; x < WIDTH; x++)
+            {
+                unsigned c = x / (8 * test->scale), col = x / test->scale % 8, row = y / test->scale;
+                bool want = c < chars && row < 8 && glyphs[c][col] >> row & 1;
+                pixels += lit(&ssd, x, y);
+                diff += lit(&ssd, x, y) != want;
+            }
+        }
+
+        ok = ok && diff == 0;
+        printf("\"%s\",%u,%u,%d,%d,%s\n", test->text, test->scale, chars, pixels, diff, ok ? "sim" : "NAO");
+        failures += !ok;
+    }
+
+    return failures ? 1 : 0;
+}
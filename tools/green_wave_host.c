@@ -0,0 +1,247 @@
+/*
+    onda verde (lib/green_wave_sync.c) com vários controladores no computador
+
+    cada nó tem o seu controlador de cruzamentos, o seu relógio (com deriva em ppm e fase
+    inicial sorteadas) e roda uma volta a cada WHEEL_TICK_MS do próprio relógio, como o
+    firmware. o mestre escreve cada quadro em um pipe por seguidor (o fio TX ligado em
+    todos os RX) e cada seguidor lê um byte por vez, no ritmo da linha a 115200 bps, e
+    entrega ao mesmo analisador do firmware com o instante em que o byte terminou de
+    chegar. alguns bytes são corrompidos na linha para exercitar o CRC
+
+    o erro de alinhamento é medido de fora, no mesmo instante para todos os nós: posição
+    do seguidor no ciclo menos a posição do mestre menos o offset do seguidor. a saída
+    é um CSV por seguidor depois do tempo de captura (SETTLE_S); termina com erro se
+    algum seguidor passar de MAX_ERROR_MS, não entrar em sincronia, ou se o erro máximo que
+    ele relata (max_error_ms, o onda_erro_max_ms do terminal) não for o medido de fora desde
+    a sincronia, com até REPORT_MATCH_MS de diferença
+
+    cc -O2 -Ibench/host -Ilib -o green_wave_host tools/green_wave_host.c lib/green_wave_sync.c lib/intersections.c
+    ./green_wave_host [nos] [segundos] [semente]
+*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "green_wave_sync.h"
+#include "host_rng.h"
+
+#define SETTLE_S 180      // captura (até meio ciclo a 100ms por quadro, ~2 min): o erro só conta depois disso
+#define MAX_ERROR_MS 50   // pior erro aceito depois da captura
+#define MAX_DRIFT_PPM 200 // deriva máxima dos cristais sorteada para cada nó
+#define CORRUPT_EVERY 2000 // em média um byte corrompido a cada tantos na linha
+#define REPORT_MATCH_MS 5  // max_error_ms relatado contra o medido de fora desde a sincronia (instantes diferentes)
+
+typedef struct
+{
+    intersections_t ctl;
+    green_wave_sync_t sync;
+    green_wave_stats_t stats;
+    double drift_ppm;
+    double clock_offset_us; // relógio local = offset + tempo real * (1 + deriva)
+    uint32_t next_tick_ms;  // próxima volta do controlador no relógio local
+    uint32_t start_ms;      // deslocamento inicial sorteado do ciclo
+
+    // linha do mestre para este nó
+    int pipe[2];
+    uint32_t in_flight;  // bytes no pipe ainda não entregues
+    double line_done_us; // instante (real) em que o próximo byte termina de chegar
+
+    // erro medido de fora: último instante fora do limite (captura) e, depois de SETTLE_S, média e máximo
+    double capture_us;
+    double error_sum;
+    uint32_t error_samples;
+    int32_t error_max;
+    int32_t locked_max; // maior erro medido desde que o seguidor se declarou em sincronia
+} node_t;
+
+static node_t nodes[GREEN_WAVE_MAX_NODES];
+static uint16_t offsets[GREEN_WAVE_MAX_NODES];
+static double local_us(const node_t *node, double real_us)
+{
+    return node->clock_offset_us + real_us * (1.0 + node->drift_ppm * 1e-6);
+}
+
+static double real_us(const node_t *node, double local)
+{
+    return (local - node->clock_offset_us) / (1.0 + node->drift_ppm * 1e-6);
+}
+
+// posição do nó no ciclo no instante real t, projetada a partir da última volta
+static int32_t position_at(const node_t *node, double t)
+{
+    int32_t cycle = intersections_cycle_length();
+    int32_t elapsed = (int32_t)(local_us(node, t) / 1000.0) - (int32_t)node->ctl.now;
+    return ((int32_t)intersections_cycle_position(&node->ctl, 0) + elapsed) % cycle;
+}
+
+// erro de alinhamento de cada seguidor em relação ao mestre, no instante real t
+static void measure(int count, double t, bool settled)
+{
+    int32_t cycle = intersections_cycle_length();
+    if (!green_wave_sync_active(&nodes[0].ctl, 0))
+        return;
+
+    int32_t master = position_at(&nodes[0], t);
+    for (int i = 1; i < count; i++)
+    {
+        node_t *node = &nodes[i];
+        int32_t error = (position_at(node, t) - (master - offsets[i])) % cycle;
+        if (error >= cycle / 2)
+            error -= cycle;
+        else if (error < -cycle / 2)
+            error += cycle;
+
+        if (error > MAX_ERROR_MS || -error > MAX_ERROR_MS)
+            node->capture_us = t;
+        if (green_wave_sync_locked(&node->sync) && (error < 0 ? -error : error) > node->locked_max)
+            node->locked_max = error < 0 ? -error : error;
+        if (!settled)
+            continue;
+        node->error_sum += error < 0 ? -error : error;
+        node->error_samples++;
+        if ((error < 0 ? -error : error) > node->error_max)
+            node->error_max = error < 0 ? -error : error;
+    }
+}
+
+// volta do controlador de um nó no seu relógio local (tick_ms)
+static void controller(int count, int i, double t, bool settled)
+{
+    node_t *node = &nodes[i];
+    uint32_t now_ms = node->next_tick_ms;
+
+    intersections_step(&node->ctl, now_ms);
+    bool changed = intersections_take_changed(&node->ctl, 0);
+
+    if (green_wave_sync_active(&node->ctl, 0))
+    {
+        if (i == 0 && changed)
+        {
+            // O MESTRE ESCREVE O QUADRO NO FIO DE CADA SEGUIDOR, ÀS VEZES COM UM BYTE ESTRAGADO
+            uint8_t frame[GREEN_WAVE_FRAME_SIZE(GREEN_WAVE_MAX_NODES)];
+            uint8_t len = green_wave_sync_encode(&node->sync, &node->ctl, 0, frame);
+            for (int f = 1; f < count; f++)
+            {
+                uint8_t line[sizeof(frame)];
+                memcpy(line, frame, len);
+                if (rng_range(1, CORRUPT_EVERY / len) == 1)
+                    line[rng_range(0, len - 1)] ^= 1u << rng_range(0, 7);
+                if (write(nodes[f].pipe[1], line, len) != len)
+                    perror("write");
+                if (nodes[f].in_flight == 0)
+                    nodes[f].line_done_us = t + GREEN_WAVE_BYTE_US;
+                nodes[f].in_flight += len;
+            }
+            measure(count, t, settled);
+        }
+        else if (i != 0 && node->sync.sample_pending)
+        {
+            green_wave_sample_t sample = node->sync.sample;
+            node->sync.sample_pending = false;
+            green_wave_sync_discipline(&node->sync, &node->ctl, 0, &sample, (uint32_t)local_us(node, t));
+        }
+    }
+
+    node->next_tick_ms += WHEEL_TICK_MS;
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc >= 2 ? atoi(argv[1]) : 4;
+    int seconds = argc >= 3 ? atoi(argv[2]) : 900;
+    rng_seed(argc >= 4 ? strtoul(argv[3], NULL, 0) : 1);
+    if (count < 2 || count > GREEN_WAVE_MAX_NODES || seconds <= SETTLE_S)
+    {
+        fprintf(stderr, "uso: %s [nos 2..%d] [segundos > %d] [semente]\n", argv[0], GREEN_WAVE_MAX_NODES, SETTLE_S);
+        return 2;
+    }
+
+    // OFFSETS ESPALHADOS NO CICLO, COMO UMA AVENIDA COM OS CRUZAMENTOS A 1,5s UM DO OUTRO
+    uint32_t cycle = intersections_cycle_length();
+    for (int i = 0; i < count; i++)
+        offsets[i] = i * 1500 % cycle;
+
+    for (int i = 0; i < count; i++)
+    {
+        node_t *node = &nodes[i];
+        node->drift_ppm = i == 0 ? 0 : (double)rng_range(0, 2 * MAX_DRIFT_PPM) - MAX_DRIFT_PPM;
+        node->clock_offset_us = rng_range(0, 1000000);
+        node->start_ms = rng_range(0, cycle - 1);
+
+        uint32_t boot_ms = (uint32_t)(node->clock_offset_us / 1000);
+        intersections_init(&node->ctl, boot_ms);
+        intersections_add(&node->ctl, node->start_ms);
+        node->next_tick_ms = boot_ms + WHEEL_TICK_MS;
+        green_wave_sync_init(&node->sync, i, offsets, count, &node->stats);
+
+        if (i > 0 && (pipe(node->pipe) != 0 || fcntl(node->pipe[0], F_SETFL, O_NONBLOCK) != 0))
+        {
+            perror("pipe");
+            return 2;
+        }
+    }
+
+    // SIMULAÇÃO POR EVENTOS: A PRÓXIMA VOLTA DE QUALQUER NÓ OU O PRÓXIMO BYTE NA LINHA
+    const double end_us = seconds * 1e6;
+    for (;;)
+    {
+        double next = end_us;
+        int who = -1;
+        bool byte = false;
+        for (int i = 0; i < count; i++)
+        {
+            double tick = real_us(&nodes[i], nodes[i].next_tick_ms * 1000.0);
+            if (tick < next)
+            {
+                next = tick;
+                who = i;
+                byte = false;
+            }
+            if (nodes[i].in_flight && nodes[i].line_done_us < next)
+            {
+                next = nodes[i].line_done_us;
+                who = i;
+                byte = true;
+            }
+        }
+        if (who < 0)
+            break;
+
+        node_t *node = &nodes[who];
+        if (byte)
+        {
+            uint8_t value;
+            if (read(node->pipe[0], &value, 1) == 1)
+                green_wave_sync_receive(&node->sync, value, (uint32_t)local_us(node, next));
+            node->in_flight--;
+            node->line_done_us += GREEN_WAVE_BYTE_US;
+        }
+        else
+        {
+            controller(count, who, next, next >= SETTLE_S * 1e6);
+        }
+    }
+
+    int worst = 0, wrong_reports = 0;
+    printf("no,offset_ms,deriva_ppm,inicio_ms,captura_s,quadros_ok,quadros_ruins,erro_medio_ms,erro_max_ms,"
+           "erro_max_sincronia_ms,erro_max_relatado_ms,relato_ok\n");
+    for (int i = 1; i < count; i++)
+    {
+        node_t *node = &nodes[i];
+        int32_t gap = node->stats.max_error_ms - node->locked_max;
+        bool report_ok = green_wave_sync_locked(&node->sync) && gap <= REPORT_MATCH_MS && -gap <= REPORT_MATCH_MS;
+        printf("%d,%u,%.0f,%u,%.1f,%u,%u,%.1f,%d,%d,%d,%s\n", i, offsets[i], node->drift_ppm, node->start_ms,
+               node->capture_us / 1e6, node->stats.frames_ok,
+               node->stats.frames_bad, node->error_samples ? node->error_sum / node->error_samples : 0.0,
+               node->error_max, node->locked_max, node->stats.max_error_ms, report_ok ? "sim" : "NAO");
+        wrong_reports += !report_ok;
+        if (node->error_max > worst)
+            worst = node->error_max;
+        close(node->pipe[0]);
+        close(node->pipe[1]);
+    }
+    printf("pior erro depois de %d s: %d ms (limite %d ms)\n", SETTLE_S, worst, MAX_ERROR_MS);
+    return worst <= MAX_ERROR_MS && wrong_reports == 0 ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+/*
+    custo do controlador de cruzamentos (lib/intersections.c e lib/control.c) no computador
+
+    para N cruzamentos defasados ao longo do ciclo, roda 30 minutos simulados de voltas do
+    controlador (uma a cada WHEEL_TICK_MS) e mede o tempo médio de uma volta sem mudança de
+    entrada, o de uma volta com mudança de modo (que percorre os N) e o de aplicar o modo e
+    a preempção a todos os cruzamentos em toda volta, como o controlador fazia antes. a RAM
+    é a dos vetores do struct-of-arrays (por cruzamento) mais a roda (fixa). saída em CSV
+
+    uma volta leva dezenas de ns, da ordem do próprio clock_gettime: o relógio é lido uma vez
+    por trecho de voltas e o tempo dividido pelas voltas do trecho. as voltas sem mudança são
+    os trechos entre as mudanças de modo (que ficam fora da medida), e as mudanças são medidas
+    em um percurso separado, com o modo trocando em toda volta
+
+    cc -O2 -DMAX_INTERSECTIONS=1000 -Ilib -o intersections_bench tools/intersections_bench.c lib/intersections.c lib/control.c
+    ./intersections_bench
+*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+#include "intersections.h"
+#include "control.h"
+
+#define SIM_MS (30u * 60u * 1000u)
+#define MODE_EVERY_MS 60000 // uma mudança de modo por minuto simulado
+
+static intersections_t ctl;
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void setup(control_t *control, uint16_t count)
+{
+    intersections_init(&ctl, 0);
+    for (uint16_t i = 0; i < count; i++)
+        intersections_add(&ctl, (uint32_t)i * 137 % intersections_cycle_length());
+    *control = (control_t){.ctl = &ctl, .main = 0};
+}
+
+static void run(uint16_t count)
+{
+    control_t control;
+    control_inputs_t inputs = {0};
+    double steady_ns = 0, edge_ns = 0, scan_ns = 0;
+    uint32_t steady = 0, edges = 0, changes = 0;
+
+    // VOLTAS SEM MUDANÇA: CADA TRECHO ENTRE DUAS MUDANÇAS DE MODO É MEDIDO INTEIRO
+    setup(&control, count);
+    double start = now_ns();
+    for (uint32_t t = WHEEL_TICK_MS; t <= SIM_MS; t += WHEEL_TICK_MS)
+    {
+        if (t % MODE_EVERY_MS == 0)
+        {
+            steady_ns += now_ns() - start;
+            inputs.night = !inputs.night;
+            changes += control_step(&control, &inputs, t);
+            start = now_ns();
+            continue;
+        }
+        changes += control_step(&control, &inputs, t);
+        steady++;
+    }
+    steady_ns += now_ns() - start;
+
+    // MUDANÇA DE MODO EM TODA VOLTA
+    setup(&control, count);
+    inputs.night = false;
+    start = now_ns();
+    for (uint32_t t = WHEEL_TICK_MS; t <= SIM_MS; t += WHEEL_TICK_MS)
+    {
+        inputs.night = !inputs.night;
+        control_step(&control, &inputs, t);
+        edges++;
+    }
+    edge_ns = now_ns() - start;
+
+    // O MESMO PERCURSO DO CONTROLADOR ANTIGO: MODO E PREEMPÇÃO EM TODOS OS CRUZAMENTOS A CADA VOLTA
+    setup(&control, count);
+    start = now_ns();
+    for (uint32_t t = WHEEL_TICK_MS; t <= SIM_MS; t += WHEEL_TICK_MS)
+    {
+        for (uint16_t i = 0; i < ctl.count; i++)
+            intersections_set_night(&ctl, i, false);
+        for (uint16_t i = 0; i < ctl.count; i++)
+            intersections_set_preempt(&ctl, i, false);
+        intersections_step(&ctl, t);
+    }
+    scan_ns = now_ns() - start;
+
+    size_t per = sizeof(ctl.phase[0]) + sizeof(ctl.flags[0]) + sizeof(ctl.deadline[0]) + sizeof(ctl.next[0]);
+    size_t fixed = sizeof(ctl.wheel) + sizeof(ctl.count) + sizeof(ctl.now);
+    uint32_t ticks = SIM_MS / WHEEL_TICK_MS;
+
+    printf("%u,%.0f,%.2f,%.0f,%.0f,%zu,%zu,%u\n", count, steady_ns / steady, steady_ns / steady / count,
+           edge_ns / edges, scan_ns / ticks, per, fixed + per * count, changes);
+}
+
+int main(void)
+{
+    static const uint16_t counts[] = {1, 10, 100, 250, 500, 1000};
+
+    printf("cruzamentos,ns_volta,ns_volta_por_cruzamento,ns_mudanca_modo,ns_volta_varrendo,bytes_por_cruzamento,"
+           "bytes_total,trocas_do_principal\n");
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        if (counts[i] > MAX_INTERSECTIONS)
+        {
+            fprintf(stderr, "MAX_INTERSECTIONS = %d: compile com -DMAX_INTERSECTIONS=1000 para ir até 1000\n",
+                    MAX_INTERSECTIONS);
+            break;
+        }
+        run(counts[i]);
+    }
+    return 0;
+}
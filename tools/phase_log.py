@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Registro de fases da flash (lib/phase_log.c) no computador.
+
+    decode <arquivo>          decodifica a exportação de phase_log_export (binária ou em
+                              hexadecimal) ou uma imagem da região lida da placa
+                              (picotool save -r) em CSV: boot,ms,evento,valor
+
+O anel em si é testado no computador com o lib/phase_log.c de verdade e a flash em um
+arquivo (tools/phase_log_host.c), que grava no formato lido aqui.
+
+Formato das páginas (256 bytes): cabeçalho "<HHIIHH" (magic, boot, seq, base_ms, used, crc)
+e os registros: 1 byte (tipo << 4 | valor) + ms desde o registro anterior em varint.
+
+Uso: phase_log.py decode export.bin
+"""
+
+import argparse
+import string
+import struct
+import sys
+
+PAGE_SIZE = 256
+HEADER = struct.Struct("<HHIIHH")
+DATA_SIZE = PAGE_SIZE - HEADER.size
+MAGIC = 0x4C50
+
+PHASES = ["verde", "amarelo", "vermelho", "noturno", "emergencia"]
+EVENTS = [
+    ("fase", PHASES),
+    ("modo", ["normal", "noturno"]),
+    ("botao", ["A", "B"]),
+    ("mudo", ["nao", "sim"]),
+    ("preempcao", ["inativa", "ativa"]),
+    ("detector", ["principal_livre", "principal_ocupada", "transversal_livre", "transversal_ocupada"]),
+]
+
+
+def crc16(data, crc=0xFFFF):
+    # CRC-16/CCITT, o mesmo de lib/phase_log.c
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def page_crc(page, used):
+    return crc16(page[HEADER.size:HEADER.size + used], crc16(page[:HEADER.size - 2]))
+
+
+def parse_page(page):
+    # retorna (boot, seq, base_ms, registros) ou None se a página não for válida
+    magic, boot, seq, base_ms, used, crc = HEADER.unpack_from(page)
+    if magic != MAGIC or used > DATA_SIZE or crc != page_crc(page, used):
+        return None
+
+    records = []
+    data = page[HEADER.size:HEADER.size + used]
+    ms = base_ms
+    i = 0
+    while i < len(data):
+        kind, value = data[i] >> 4, data[i] & 0x0F
+        i += 1
+        delta, shift = 0, 0
+        while True:
+            byte = data[i]
+            i += 1
+            delta |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                break
+        ms = (ms + delta) & 0xFFFFFFFF
+        records.append((ms, kind, value))
+    return boot, seq, base_ms, records
+
+
+def read_pages(data):
+    # páginas válidas em ordem de seq (a exportação já vem em ordem; a imagem da região não)
+    pages, invalid = [], 0
+    for offset in range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE):
+        page = data[offset:offset + PAGE_SIZE]
+        parsed = parse_page(page)
+        if parsed:
+            pages.append(parsed)
+        elif page != b"\xff" * PAGE_SIZE:
+            invalid += 1
+    pages.sort(key=lambda page: page[1])
+    return pages, invalid
+
+
+def event_name(kind, value):
+    if kind >= len(EVENTS):
+        return "tipo%d" % kind, str(value)
+    name, values = EVENTS[kind]
+    return name, values[value] if value < len(values) else str(value)
+
+
+def load(path):
+    with open(path, "rb") as source:
+        data = source.read()
+    # a exportação pelo terminal vem em hexadecimal, uma linha por 32 bytes (outras linhas são ignoradas)
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        return data
+    lines = [line.strip() for line in text.splitlines()]
+    return bytes.fromhex("".join(line for line in lines if line and all(c in string.hexdigits for c in line)))
+
+
+def decode(args):
+    try:
+        data = load(args.file)
+    except OSError as error:
+        print("phase_log: %s" % error, file=sys.stderr)
+        return 1
+
+    pages, invalid = read_pages(data)
+    print("boot,ms,evento,valor")
+    for boot, _, _, records in pages:
+        for ms, kind, value in records:
+            name, text = event_name(kind, value)
+            print("%d,%d,%s,%s" % (boot, ms, name, text))
+    if invalid:
+        print("phase_log: %d paginas com CRC invalido ignoradas" % invalid, file=sys.stderr)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="registro de fases da flash do semáforo")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    decoder = commands.add_parser("decode", help="decodifica a exportação ou a imagem da região em CSV")
+    decoder.add_argument("file")
+    decoder.set_defaults(run=decode)
+
+    args = parser.parse_args()
+    return args.run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
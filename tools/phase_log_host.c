@@ -0,0 +1,378 @@
+/*
+    anel do registro de fases (lib/phase_log.c) no computador, com a flash em um arquivo
+
+    compila o lib/phase_log.c de verdade contra o FreeRTOS e a flash falsos daqui (bench/host):
+    flash_range_erase e flash_range_program seguem as regras da NOR (apagar deixa 0xFF,
+    gravar só zera bits; gravar sem apagar antes conta como erro) sobre a região guardada
+    em <flash.bin>, que é mantido entre execuções: cada execução é um novo boot que continua
+    o anel de onde o anterior parou (a página que estava só na RAM se perde, como num
+    desligamento). o arquivo tem o formato de picotool save -r, para tools/phase_log.py decode
+
+    o relógio é simulado e a task do registro (vPhaseLogTask) roda de verdade: cada espera
+    na fila avança o relógio até o próximo evento do funcionamento simulado (ciclo normal,
+    detector de demanda em pontos sorteados, modo noturno de 10 min a cada hora e o buzzer
+    silenciado de vez em quando) ou até o prazo da espera. apagar um setor leva ERASE_US e
+    gravar uma página PROGRAM_US. a janela para apagar é a do firmware (fase atual durando
+    mais que a pausa no pior caso). confere:
+
+    - os eventos deste boot exportados por phase_log_export são os registrados, na ordem;
+    - as páginas exportadas vêm com o seq crescendo;
+    - nenhuma gravação sem apagar, nenhum setor apagado fora da janela nem na hora de gravar;
+    - o desgaste: os setores apagados nesta execução diferem em no máximo um apagamento
+
+    saída em CSV; termina com erro em qualquer violação
+
+    cc -O2 -Ibench/host -Ilib -o phase_log_host tools/phase_log_host.c lib/phase_log.c
+    ./phase_log_host flash.bin [horas]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include "phase_log.h"
+
+#define ERASE_US 45000 // apagamento típico de um setor
+#define PROGRAM_US 500 // gravação de uma página
+
+static const uint32_t cycle_ms[] = {3000, 1500, 4000}; // phase_duration_ms do ciclo normal
+
+typedef struct
+{
+    uint32_t ms;
+    uint8_t type;
+    uint8_t value;
+} host_event_t;
+
+uint8_t flash_host_image[PICO_FLASH_SIZE_BYTES];
+static FILE *image;
+static uint32_t erases[PHASE_LOG_SECTORS];
+static uint32_t bad_programs, outside_window;
+
+static uint64_t now_us;
+static host_event_t *events;   // funcionamento simulado
+static uint32_t event_count, next_event;
+static host_event_t *recorded; // o que phase_log_append recebeu, com o ms que ele usou
+static uint32_t recorded_count;
+static jmp_buf finished;
+
+static uint8_t *region(void)
+{
+    return flash_host_image + PHASE_LOG_OFFSET;
+}
+
+static void image_save(uint32_t offset, size_t count)
+{
+    fseek(image, offset, SEEK_SET);
+    fwrite(region() + offset, 1, count, image);
+    fflush(image);
+}
+
+static uint32_t now_ms(void)
+{
+    return now_us / 1000;
+}
+
+// ms até a próxima troca de fase do funcionamento simulado (a janela do firmware olha o mesmo)
+static uint32_t phase_remaining(void)
+{
+    for (uint32_t i = next_event; i < event_count; i++)
+    {
+        if (events[i].type == PHASE_LOG_PHASE && events[i].ms > now_ms())
+            return events[i].ms - now_ms();
+    }
+    return UINT32_MAX;
+}
+
+static bool window(uint32_t stall_ms)
+{
+    return phase_remaining() > stall_ms;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    uint32_t offset = flash_offs - PHASE_LOG_OFFSET;
+    if (flash_offs < PHASE_LOG_OFFSET || offset % FLASH_SECTOR_SIZE || offset + count > PHASE_LOG_SIZE)
+    {
+        fprintf(stderr, "apagamento fora da região: 0x%lx\n", (unsigned long)flash_offs);
+        exit(2);
+    }
+
+    // A PAUSA NO PIOR CASO TEM QUE CABER ANTES DA PRÓXIMA TROCA DE FASE
+    outside_window += !window(PHASE_LOG_ERASE_MAX_MS);
+    memset(region() + offset, 0xFF, count);
+    image_save(offset, count);
+    for (uint32_t s = offset / FLASH_SECTOR_SIZE; s < (offset + count) / FLASH_SECTOR_SIZE; s++)
+        erases[s]++;
+    now_us += ERASE_US * (count / FLASH_SECTOR_SIZE);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    uint32_t offset = flash_offs - PHASE_LOG_OFFSET;
+    if (flash_offs < PHASE_LOG_OFFSET || offset % FLASH_PAGE_SIZE || offset + count > PHASE_LOG_SIZE)
+    {
+        fprintf(stderr, "gravação fora da região: 0x%lx\n", (unsigned long)flash_offs);
+        exit(2);
+    }
+
+    // GRAVAR SÓ ZERA BITS: UM BIT QUE VOLTARIA PARA 1 É GRAVAÇÃO SEM APAGAR
+    uint8_t *out = region() + offset;
+    for (size_t i = 0; i < count; i++)
+    {
+        bad_programs += (data[i] & ~out[i]) != 0;
+        out[i] &= data[i];
+    }
+    image_save(offset, count);
+    now_us += PROGRAM_US * (count / FLASH_PAGE_SIZE);
+}
+
+struct QueueDefinition
+{
+    UBaseType_t length, item_size, head, count;
+    uint8_t *items;
+};
+
+uint64_t time_us_64(void)
+{
+    return now_us;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return now_ms();
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    return pdFALSE;
+}
+
+// o relógio daqui já andou durante a pausa
+BaseType_t xTaskCatchUpTicks(TickType_t ticks)
+{
+    (void)ticks;
+    return pdFALSE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(*queue));
+    queue->length = length;
+    queue->item_size = item_size;
+    queue->items = malloc(length * item_size);
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+    (void)wait;
+    if (queue->count == queue->length)
+        return pdFALSE;
+
+    memcpy(queue->items + (queue->head + queue->count) % queue->length * queue->item_size, item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+// a espera da task do registro: o relógio anda até o próximo evento simulado ou até o prazo
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+    while (queue->count == 0)
+    {
+        if (next_event == event_count)
+            longjmp(finished, 1);
+
+        uint64_t event_us = (uint64_t)events[next_event].ms * 1000;
+        if (wait != portMAX_DELAY && now_us + (uint64_t)wait * 1000 < event_us)
+        {
+            now_us += (uint64_t)wait * 1000;
+            return pdFALSE;
+        }
+
+        // UM EVENTO DURANTE A PAUSA DA FLASH É REGISTRADO DEPOIS DELA
+        if (event_us > now_us)
+            now_us = event_us;
+        const host_event_t *event = &events[next_event++];
+        recorded[recorded_count++] = (host_event_t){now_ms(), event->type, event->value};
+        phase_log_append(event->type, event->value);
+    }
+
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+static void emit(uint32_t ms, phase_log_type_t type, uint8_t value)
+{
+    static uint32_t capacity;
+    if (event_count == capacity)
+    {
+        capacity = capacity ? capacity * 2 : 4096;
+        events = realloc(events, capacity * sizeof(*events));
+    }
+    events[event_count++] = (host_event_t){ms, type, value};
+}
+
+// funcionamento simulado: ciclo normal com o detector de demanda, modo noturno e buzzer
+static void simulate(double hours)
+{
+    uint32_t ms = 0, end = hours * 3600000;
+    uint8_t phase = 0;
+    bool night = false;
+
+    while (ms < end)
+    {
+        uint32_t minute = ms / 60000;
+
+        // MODO NOTURNO DOS MINUTOS 50 A 59 DE CADA HORA, PELO BOTÃO A
+        if ((minute % 60 >= 50) != night)
+        {
+            night = !night;
+            emit(ms, PHASE_LOG_BUTTON, 0);
+            emit(ms + 50, PHASE_LOG_MODE, night);
+            ms += 50;
+            phase = 0;
+            emit(ms, PHASE_LOG_PHASE, night ? 3 : phase);
+        }
+
+        // BUZZER SILENCIADO (OU DE VOLTA) PELO BOTÃO B NO MINUTO 17 A CADA 2 HORAS
+        if (minute % 120 == 17 && ms % 60000 < cycle_ms[phase])
+        {
+            emit(ms, PHASE_LOG_BUTTON, 1);
+            emit(ms, PHASE_LOG_MUTE, minute % 240 < 120);
+        }
+
+        if (night)
+        {
+            ms += 60000;
+        }
+        else
+        {
+            // O DETECTOR DE DEMANDA MUDA EM UM PONTO QUALQUER DE CADA FASE
+            emit(ms + rand() % cycle_ms[phase], PHASE_LOG_DETECTOR, rand() % 4);
+            ms += cycle_ms[phase];
+            phase = (phase + 1) % count_of(cycle_ms);
+            emit(ms, PHASE_LOG_PHASE, phase);
+        }
+    }
+}
+
+static uint8_t *exported;
+static uint32_t exported_pages;
+
+static void sink(const uint8_t *data, size_t len, void *ctx)
+{
+    (void)ctx;
+    memcpy(exported + exported_pages * FLASH_PAGE_SIZE, data, len);
+    exported_pages++;
+}
+
+// registros de uma página exportada, com o instante de cada um
+static uint32_t decode(const uint8_t *data, host_event_t *out)
+{
+    const phase_log_header_t *head = (const phase_log_header_t *)data;
+    const uint8_t *in = data + sizeof(phase_log_header_t), *end = in + head->used;
+    uint32_t ms = head->base_ms, count = 0;
+
+    while (in < end)
+    {
+        uint8_t byte = *in++;
+        uint32_t delta = 0;
+        for (int shift = 0; in < end; shift += 7)
+        {
+            delta |= (uint32_t)(*in & 0x7F) << shift;
+            if (!(*in++ & 0x80))
+                break;
+        }
+        ms += delta;
+        out[count++] = (host_event_t){ms, byte >> 4, byte & 0x0F};
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "uso: %s <flash.bin> [horas]\n", argv[0]);
+        return 2;
+    }
+    double hours = argc >= 3 ? atof(argv[2]) : 24.0;
+
+    // A REGIÃO CONTINUA DO ARQUIVO; SEM ELE (OU COM OUTRO TAMANHO) A FLASH COMEÇA APAGADA
+    memset(flash_host_image, 0xFF, sizeof(flash_host_image));
+    image = fopen(argv[1], "r+b");
+    if (image && fread(region(), 1, PHASE_LOG_SIZE, image) != PHASE_LOG_SIZE)
+    {
+        fclose(image);
+        image = NULL;
+        memset(region(), 0xFF, PHASE_LOG_SIZE);
+    }
+    if (!image)
+    {
+        image = fopen(argv[1], "w+b");
+        if (!image)
+        {
+            perror(argv[1]);
+            return 2;
+        }
+        image_save(0, PHASE_LOG_SIZE);
+    }
+
+    simulate(hours);
+    recorded = malloc((event_count + 1) * sizeof(*recorded));
+    exported = malloc((PHASE_LOG_SIZE / FLASH_PAGE_SIZE + 1) * FLASH_PAGE_SIZE);
+
+    phase_log_init(window);
+    if (!setjmp(finished))
+        vPhaseLogTask(NULL);
+
+    phase_log_export(sink, NULL);
+
+    // EVENTOS DESTE BOOT NA EXPORTAÇÃO (A PÁGINA MAIS NOVA É A DESTE BOOT) E O SEQ DAS PÁGINAS
+    host_event_t *mine = malloc((recorded_count + FLASH_PAGE_SIZE) * sizeof(*mine));
+    const phase_log_header_t *newest = (const phase_log_header_t *)(exported + (exported_pages - 1) * FLASH_PAGE_SIZE);
+    uint32_t kept = 0, boot = exported_pages ? newest->boot : 0, seq = 0;
+    bool in_order = true;
+    for (uint32_t p = 0; p < exported_pages; p++)
+    {
+        const phase_log_header_t *head = (const phase_log_header_t *)(exported + p * FLASH_PAGE_SIZE);
+        in_order = in_order && (p == 0 || (int32_t)(head->seq - seq) > 0);
+        seq = head->seq;
+        if (head->boot == boot && kept <= recorded_count)
+            kept += decode((const uint8_t *)head, mine + kept);
+    }
+
+    // O ANEL PODE TER PERDIDO O COMEÇO DO BOOT: OS REGISTROS TÊM QUE SER O FIM DO QUE FOI REGISTRADO
+    uint32_t different = kept > recorded_count ? kept : 0;
+    for (uint32_t i = 0; !different && i < kept; i++)
+    {
+        const host_event_t *want = &recorded[recorded_count - kept + i];
+        different += mine[i].ms != want->ms || mine[i].type != want->type || mine[i].value != want->value;
+    }
+
+    uint32_t least = UINT32_MAX, most = 0;
+    for (uint32_t s = 0; s < PHASE_LOG_SECTORS; s++)
+    {
+        least = erases[s] < least ? erases[s] : least;
+        most = erases[s] > most ? erases[s] : most;
+    }
+
+    bool ok = kept > 0 && different == 0 && in_order && bad_programs == 0 && outside_window == 0 &&
+              phase_log_stats.late_erases == 0 && most - least <= 1;
+    printf("boot,eventos,paginas_exportadas,registros_deste_boot,diferentes,seq_em_ordem,gravacoes_sem_apagar,"
+           "apagamentos,fora_da_janela,sem_janela,desgaste_min,desgaste_max,maior_pausa_us,ok\n");
+    printf("%u,%lu,%lu,%lu,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%s\n", (unsigned)boot, (unsigned long)recorded_count,
+           (unsigned long)exported_pages, (unsigned long)kept, (unsigned long)different, in_order ? "sim" : "NAO",
+           (unsigned long)bad_programs, (unsigned long)phase_log_stats.erases, (unsigned long)outside_window,
+           (unsigned long)phase_log_stats.late_erases, (unsigned long)least, (unsigned long)most,
+           (unsigned long)phase_log_stats.longest_stall_us, ok ? "sim" : "NAO");
+
+    fclose(image);
+    return ok ? 0 : 1;
+}
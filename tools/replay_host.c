@@ -0,0 +1,733 @@
+/*
+    reprodução no computador das entradas gravadas na placa (lib/input_record.c)
+
+    recria o controlador pelo cabeçalho da gravação e passa cada entrada pelo mesmo
+    lib/control.c do firmware, no instante gravado. as fases publicadas na reprodução são
+    codificadas de novo como registros INPUT_LOG_PHASE e comparadas byte a byte com as
+    fases gravadas: qualquer diferença é uma regressão do controlador (ou uma entrada que
+    a gravação não viu). a mesma gravação mede as latências e a precisão das fases (CSV
+    metrica,amostras,media_ms,max_ms, para comparar entre versões) e confere o buzzer:
+    exatamente um toque em cada verde e cada vermelho completos com o buzzer ligado.
+    os níveis do detector de emergência passam de novo pelo filtro (lib/preempt_filter.c)
+    e a saída tem que ser a preempção gravada em cada volta; a latência da preempção vai
+    do início do nível ativo confirmado até a primeira saída alterada (cor do LED ou o
+    primeiro toque da sirene)
+
+    a entrada é a exportação em hexadecimal do comando "entradas" do terminal USB (as
+    linhas que não são hexadecimal são ignoradas). gerar cria uma gravação simulando as
+    tasks do firmware, com repiques, toques dentro do debounce, preempções com um detector
+    que repica, oscila e dá pulsos falsos, demanda dos detectores e uma mudança de duração
+    pelo terminal
+
+    cc -O2 -Ibench/host -Ilib -o replay_host tools/replay_host.c lib/input_log.c lib/control.c lib/intersections.c lib/preempt_filter.c
+    ./replay_host gerar 600 > entradas.hex
+    ./replay_host entradas.hex [-v]
+    tools/shell.py /dev/ttyACM0 entradas | ./replay_host -
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "input_log.h"
+#include "host_rng.h"
+
+// os mesmos do firmware (semafaro-inteligente-raspberry-pico-w.c)
+#define BUTTON_SETTLE_MS 20
+#define DEBOUNCE_MS 200
+#define RED_BEEP_DELAY_MS 100 // o toque do vermelho espera 100ms
+
+// detector de emergência simulado
+#define DETECTOR_BOUNCE_MS 5     // repique nas duas bordas de uma passagem
+#define DETECTOR_DROPOUT_MS 20   // quedas curtas durante a passagem (abaixo de PREEMPT_SETTLE_MS)
+#define DETECTOR_GLITCH_MS 20    // pulsos falsos com o detector livre
+
+#define MAX_PHASES 65536 // fases publicadas em uma gravação
+
+static const char *const phase_names[NUM_PHASES] = {"verde", "amarelo", "vermelho", "noturno", "emergencia"};
+
+static const char *phase_name(uint8_t phase)
+{
+    return phase < NUM_PHASES ? phase_names[phase] : "?";
+}
+
+// cor do LED RGB na fase publicada (vermelho << 1 | verde), como led_render no firmware
+static uint8_t led_color(uint8_t value)
+{
+    switch (value & 7)
+    {
+    case GREEN_LIGHT:
+        return 1;
+    case YELLOW_LIGHT:
+        return 3;
+    case RED_LIGHT:
+    case PREEMPT_MODE:
+        return 2;
+    case NIGHT_MODE:
+        return value & 8 ? 3 : 0;
+    default:
+        return 0;
+    }
+}
+
+// fase publicada: instante e valor do registro INPUT_LOG_PHASE
+typedef struct
+{
+    uint32_t ms;
+    uint8_t value;
+} phase_event_t;
+
+typedef struct
+{
+    phase_event_t events[MAX_PHASES];
+    uint32_t count;
+} timeline_t;
+
+static timeline_t recorded, replayed;
+
+typedef struct
+{
+    uint32_t samples;
+    uint64_t sum;
+    uint32_t max;
+} metric_t;
+
+static void metric_add(metric_t *metric, uint32_t value)
+{
+    metric->samples++;
+    metric->sum += value;
+    if (value > metric->max)
+        metric->max = value;
+}
+
+static void metric_print(const char *name, const metric_t *metric)
+{
+    printf("%s,%u,%.1f,%u\n", name, metric->samples, metric->samples ? (double)metric->sum / metric->samples : 0.0,
+           metric->max);
+}
+
+static void timeline_add(timeline_t *timeline, uint32_t ms, uint8_t value)
+{
+    if (timeline->count < MAX_PHASES)
+        timeline->events[timeline->count] = (phase_event_t){.ms = ms, .value = value};
+    timeline->count++;
+}
+
+// codifica a linha do tempo como a gravação (mesmo instante inicial): é o que a comparação usa
+static size_t timeline_encode(const timeline_t *timeline, uint32_t start_ms, uint8_t *buf, size_t size)
+{
+    input_log_t log = {.buf = buf, .size = size, .last_ms = start_ms};
+    uint32_t count = timeline->count < MAX_PHASES ? timeline->count : MAX_PHASES;
+
+    for (uint32_t i = 0; i < count; i++)
+        input_log_append(&log, INPUT_LOG_PHASE, timeline->events[i].value, timeline->events[i].ms, 0);
+    return log.used;
+}
+
+static void print_hex(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i += 32)
+    {
+        for (size_t j = i; j < len && j < i + 32; j++)
+            printf("%02x", data[j]);
+        printf("\n");
+    }
+    printf("bytes %zu\n", len);
+}
+
+/*
+    gravação sintética: o controlador, a task dos botões e os detectores como no firmware,
+    passo de 1ms. o controlador acorda na roda (WHEEL_TICK_MS) ou quando notificado e dorme
+    até o próximo pisca no modo noturno; os botões têm repique, toques curtos (soltos antes
+    do repique acabar) e segundos toques dentro do debounce; o detector de emergência
+    repica nas bordas, cai por alguns ms durante a passagem e dá pulsos falsos, e passa
+    pelo mesmo filtro do firmware (o controlador acorda quando o filtro pode decidir); os
+    detectores entregam a demanda a cada bloco de 64ms. o buzzer é ideal: um toque no
+    início do verde, outro 100ms depois do início do vermelho, um a cada pisca aceso e o
+    primeiro toque da sirene no início da emergência
+*/
+static int generate(int seconds, uint32_t seed)
+{
+    static uint8_t buf[1 << 20];
+    static intersections_t ctl;
+    control_t control = {.ctl = &ctl, .main = 0, .actuated = true};
+    control_inputs_t inputs = {0};
+    input_log_snapshot_t snapshot;
+    input_log_t log;
+
+    const uint32_t start = 1000, end = start + seconds * 1000u;
+    rng_seed(seed);
+
+    intersections_init(&ctl, start);
+    intersections_add(&ctl, 0);
+
+    // DETECTOR DE EMERGÊNCIA: NÍVEL NA INTERRUPÇÃO E O FILTRO DO FIRMWARE
+    preempt_filter_t filter;
+    bool detector = false;
+    preempt_filter_init(&filter, detector, start);
+
+    input_log_capture(&snapshot, &control, 0, false);
+    snapshot.detector = filter;
+    input_log_begin(&log, buf, sizeof(buf), &snapshot);
+
+    // CONTROLADOR
+    uint32_t next_wake = start + WHEEL_TICK_MS;
+    bool notified = false;
+    bool muted = false;
+
+    // BOTÕES: TOQUE ATUAL (INÍCIO, SOLTURA E BORDAS DO REPIQUE) E A TASK
+    uint32_t press_at[2], release_at[2] = {0, 0}, edges[2][4];
+    uint8_t edge_count[2] = {0, 0};
+    enum { TASK_IDLE, TASK_SETTLE, TASK_DEBOUNCE } task = TASK_IDLE;
+    uint32_t task_until = 0, task_bits = 0;
+    press_at[0] = start + rng_range(5000, 20000);
+    press_at[1] = start + rng_range(5000, 30000);
+
+    // PASSAGENS DO VEÍCULO DE EMERGÊNCIA, QUEDAS DURANTE A PASSAGEM E PULSOS FALSOS; VEÍCULOS (PRINCIPAL E TRANSVERSAL)
+    uint32_t preempt_start = start + rng_range(20000, 60000), preempt_end = preempt_start + rng_range(3000, 15000);
+    uint32_t dropout_at = preempt_start + rng_range(100, 1500), dropout_end = dropout_at + rng_range(1, DETECTOR_DROPOUT_MS);
+    uint32_t glitch_at = start + rng_range(5000, 30000), glitch_end = glitch_at + rng_range(1, DETECTOR_GLITCH_MS);
+    uint32_t vehicle_start[2], vehicle_end[2];
+    for (int c = 0; c < 2; c++)
+    {
+        vehicle_start[c] = start + rng_range(2000, 15000);
+        vehicle_end[c] = vehicle_start[c] + rng_range(500, 4000);
+    }
+
+    // TOQUE DO BUZZER AGENDADO PARA A FASE ATUAL
+    uint32_t beep_at = 0;
+    int8_t beep_phase = -1;
+
+    for (uint32_t t = start + 1; t < end && !log.full; t++)
+    {
+        // BOTÕES: NOVO TOQUE, BORDAS DE DESCIDA (REPIQUE NO APERTO E ÀS VEZES NA SOLTURA)
+        for (int b = 0; b < 2; b++)
+        {
+            if (t == press_at[b])
+            {
+                release_at[b] = t + rng_range(8, 400);
+                edge_count[b] = 0;
+                edges[b][edge_count[b]++] = t;
+                for (uint32_t n = rng_range(0, 2), at = t; n > 0; n--)
+                    edges[b][edge_count[b]++] = at += rng_range(1, 3);
+                if (rng_range(0, 1))
+                    edges[b][edge_count[b]++] = release_at[b] + rng_range(1, 4);
+
+                // UM EM CADA QUATRO TOQUES É REPETIDO DENTRO DO DEBOUNCE (O FIRMWARE DESCARTA)
+                press_at[b] = rng_range(0, 3) == 0 ? t + BUTTON_SETTLE_MS + rng_range(40, DEBOUNCE_MS - 20)
+                                                   : t + rng_range(b ? 15000 : 8000, b ? 60000 : 40000);
+                if (press_at[b] <= release_at[b] + 10)
+                    press_at[b] = release_at[b] + 10 + rng_range(0, 100);
+            }
+
+            for (uint8_t e = 0; e < edge_count[b]; e++)
+            {
+                if (edges[b][e] != t)
+                    continue;
+                input_log_append(&log, INPUT_LOG_EDGE, b, t, 0);
+                if (task == TASK_IDLE)
+                {
+                    task = TASK_SETTLE;
+                    task_until = t + BUTTON_SETTLE_MS;
+                    task_bits = 0;
+                }
+                if (task == TASK_SETTLE && task_until == t + BUTTON_SETTLE_MS)
+                    task_bits |= 1u << b;
+            }
+        }
+
+        // TASK DOS BOTÕES: NÍVEL DEPOIS DO REPIQUE, DEPOIS O DEBOUNCE DESCARTA AS BORDAS
+        if (task == TASK_SETTLE && t == task_until)
+        {
+            bool down[2];
+            for (int b = 0; b < 2; b++)
+            {
+                down[b] = (task_bits >> b & 1) && t < release_at[b];
+                if (task_bits >> b & 1)
+                    input_log_append(&log, INPUT_LOG_LEVEL, b << 1 | down[b], t, 0);
+            }
+            if (down[0])
+            {
+                inputs.night = !inputs.night;
+                notified = true;
+            }
+            if (down[1])
+            {
+                muted = !muted;
+                input_log_append(&log, INPUT_LOG_MUTE, muted, t, 0);
+            }
+            task = TASK_DEBOUNCE;
+            task_until = t + DEBOUNCE_MS;
+        }
+        else if (task == TASK_DEBOUNCE && t == task_until)
+        {
+            task = TASK_IDLE;
+        }
+
+        // DETECTOR DE EMERGÊNCIA: A PASSAGEM COM REPIQUE NAS BORDAS E QUEDAS CURTAS, OU UM PULSO FALSO
+        bool level = t >= preempt_start && t < preempt_end;
+        if (level && t >= dropout_end)
+        {
+            dropout_at = t + rng_range(100, 1500);
+            dropout_end = dropout_at + rng_range(1, DETECTOR_DROPOUT_MS);
+        }
+        if (level && t >= dropout_at)
+            level = false;
+        if (t - preempt_start < DETECTOR_BOUNCE_MS || t - preempt_end < DETECTOR_BOUNCE_MS)
+            level = rng_range(0, 1);
+        if (!level && t >= glitch_at)
+        {
+            level = t < glitch_end;
+            if (!level)
+            {
+                glitch_at = t + rng_range(5000, 30000);
+                glitch_end = glitch_at + rng_range(1, DETECTOR_GLITCH_MS);
+            }
+        }
+        if (t == preempt_end + DETECTOR_BOUNCE_MS)
+        {
+            preempt_start = t + rng_range(30000, 90000);
+            preempt_end = preempt_start + rng_range(3000, 15000);
+            dropout_at = preempt_start + rng_range(100, 1500);
+            dropout_end = dropout_at + rng_range(1, DETECTOR_DROPOUT_MS);
+        }
+
+        // INTERRUPÇÃO: CADA MUDANÇA DE NÍVEL VAI PARA O FILTRO, QUE SÓ ACORDA O CONTROLADOR AO ABRIR UMA DECISÃO
+        if (level != detector)
+        {
+            detector = level;
+            input_log_append(&log, INPUT_LOG_DETECTOR, level, t, 0);
+            if (preempt_filter_edge(&filter, level, t))
+                notified = true;
+        }
+
+        // DETECTORES DE DEMANDA: UM BLOCO DO ADC A CADA 64ms, ACORDA O CONTROLADOR SE MUDAR
+        if ((t - start) % 64 == 0)
+        {
+            uint8_t demand = 0;
+            for (int c = 0; c < 2; c++)
+            {
+                if (t >= vehicle_end[c])
+                {
+                    vehicle_start[c] = t + rng_range(2000, 15000);
+                    vehicle_end[c] = vehicle_start[c] + rng_range(500, 4000);
+                }
+                if (t >= vehicle_start[c])
+                    demand |= c ? CONTROL_DEMAND_CROSS : CONTROL_DEMAND_MAIN;
+            }
+            if (demand != inputs.demand)
+            {
+                inputs.demand = demand;
+                notified = true;
+            }
+        }
+
+        // TERMINAL: VERDE MAIS LONGO NA METADE DA GRAVAÇÃO (GRAVADO JUNTO COM A MUDANÇA)
+        if (t == start + (end - start) / 2)
+        {
+            phase_duration_ms[GREEN_LIGHT] = 4500;
+            input_log_append(&log, INPUT_LOG_DURATION, GREEN_LIGHT, t, 4500);
+            notified = true;
+        }
+
+        // CONTROLADOR: O FILTRO DO DETECTOR, AS ENTRADAS QUE MUDARAM, A VOLTA E A FASE PUBLICADA
+        if (notified || (int32_t)(t - next_wake) >= 0)
+        {
+            inputs.preempt = preempt_filter_update(&filter, t);
+            if (inputs.night != control.inputs.night)
+                input_log_append(&log, INPUT_LOG_NIGHT, inputs.night, t, 0);
+            if (inputs.preempt != control.inputs.preempt)
+                input_log_append(&log, INPUT_LOG_PREEMPT, inputs.preempt, t, 0);
+            if (inputs.demand != control.inputs.demand)
+                input_log_append(&log, INPUT_LOG_DEMAND, inputs.demand, t, 0);
+            input_log_append(&log, INPUT_LOG_TICK, 0, t, 0);
+
+            if (control_step(&control, &inputs, t))
+            {
+                uint8_t phase = ctl.phase[0];
+                bool toggle = ctl.flags[0] & INTERSECTION_TOGGLE;
+                input_log_append(&log, INPUT_LOG_PHASE, phase | toggle << 3, t, 0);
+
+                beep_phase = phase == GREEN_LIGHT || phase == RED_LIGHT || phase == PREEMPT_MODE ||
+                                     (phase == NIGHT_MODE && toggle)
+                                 ? phase
+                                 : -1;
+                beep_at = phase == RED_LIGHT ? t + RED_BEEP_DELAY_MS : t;
+            }
+
+            while ((int32_t)(t - next_wake) >= 0)
+                next_wake += WHEEL_TICK_MS;
+            if (ctl.phase[0] == NIGHT_MODE)
+            {
+                int32_t until = (int32_t)(intersections_next_deadline(&ctl) - t);
+                next_wake = t + (until > 0 ? until : 1);
+            }
+            uint32_t settle = preempt_filter_wait_ms(&filter, t);
+            if (settle && (int32_t)(t + settle - next_wake) < 0)
+                next_wake = t + settle;
+            notified = false;
+        }
+
+        // BUZZER IDEAL: SÓ TOCA SE A FASE AGENDADA AINDA ESTIVER PUBLICADA
+        if (beep_phase >= 0 && t >= beep_at)
+        {
+            if (!muted && ctl.phase[0] == beep_phase)
+                input_log_append(&log, INPUT_LOG_BEEP, beep_phase, t, 0);
+            beep_phase = -1;
+        }
+    }
+
+    printf("# gravacao sintetica: %d s, semente %u, %u registros\n", seconds, seed, log.records);
+    print_hex(buf, log.used);
+    return 0;
+}
+
+// lê a exportação em hexadecimal; linhas que não são só hexadecimal (bytes N, ok, comentários) ficam de fora
+static uint8_t *read_hex(const char *path, size_t *len)
+{
+    FILE *in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    size_t size = 4096;
+    uint8_t *data = malloc(size);
+    char line[256];
+    *len = 0;
+
+    while (data && fgets(line, sizeof(line), in))
+    {
+        size_t n = strlen(line);
+        while (n > 0 && isspace((unsigned char)line[n - 1]))
+            n--;
+        bool hex = n > 0 && n % 2 == 0;
+        for (size_t i = 0; i < n && hex; i++)
+            hex = isxdigit((unsigned char)line[i]);
+        if (!hex)
+            continue;
+
+        if (*len + n / 2 > size)
+        {
+            size *= 2;
+            data = realloc(data, size);
+            if (!data)
+                break;
+        }
+        for (size_t i = 0; i < n; i += 2)
+        {
+            char byte[3] = {line[i], line[i + 1], 0};
+            data[(*len)++] = strtoul(byte, NULL, 16);
+        }
+    }
+    if (in != stdin)
+        fclose(in);
+    return data;
+}
+
+static void print_event(const char *who, const timeline_t *timeline, uint32_t i)
+{
+    if (i >= timeline->count || i >= MAX_PHASES)
+    {
+        printf("  %-11s (fim)\n", who);
+        return;
+    }
+    uint8_t value = timeline->events[i].value;
+    printf("  %-11s %u ms %s%s\n", who, timeline->events[i].ms, phase_name(value & 7),
+           value & 8 ? " (aceso)" : "");
+}
+
+static int replay(const char *path, bool verbose)
+{
+    size_t len;
+    uint8_t *data = read_hex(path, &len);
+    if (!data)
+        return 2;
+
+    input_log_snapshot_t snapshot;
+    input_log_reader_t reader;
+    if (!input_log_open(&reader, data, len, &snapshot))
+    {
+        fprintf(stderr, "%s: gravacao invalida (%zu bytes)\n", path, len);
+        return 2;
+    }
+
+    static intersections_t ctl;
+    control_t control = {.ctl = &ctl};
+    input_log_restore(&snapshot, &control);
+    control_inputs_t inputs = snapshot.inputs;
+    bool muted = snapshot.muted;
+    preempt_filter_t filter = snapshot.detector;
+    uint8_t led = led_color(snapshot.phase[control.main] |
+                            (snapshot.flags[control.main] & INTERSECTION_TOGGLE ? 8 : 0));
+
+    // FASE GRAVADA EM ANDAMENTO (A PRIMEIRA NÃO É COMPLETA: COMEÇOU ANTES DA GRAVAÇÃO)
+    bool open = false, quiet = false, muted_during = false;
+    uint8_t phase = 0;
+    uint32_t phase_start = 0, nominal = 0, beeps = 0;
+
+    metric_t phase_error = {0}, edge_level = {0}, button_phase = {0}, preempt_phase = {0}, detector_output = {0};
+    uint32_t edge_ms[2] = {0, 0}, dropped = 0, released = 0, anomalies = 0, records = 0;
+    bool edge_pending[2] = {false, false};
+    bool level_seen = false, button_pending = false, preempt_pending = false;
+    uint32_t level_ms = 0, button_ms = 0, preempt_ms = 0;
+
+    // DETECTOR: PULSOS E QUEDAS QUE O FILTRO SEGUROU, VOLTAS EM QUE ELE DISCORDA DA GRAVAÇÃO, PREEMPÇÃO SEM SAÍDA
+    uint32_t glitches = 0, dropouts = 0, diverged = 0, unchanged = 0;
+    bool output_pending = false;
+    uint32_t detector_ms = 0;
+
+    input_log_record_t record;
+    while (input_log_next(&reader, &record))
+    {
+        records++;
+        if (verbose)
+            printf("%10u ms  %-9s %2u %d\n", record.ms, input_log_type_name(record.type), record.value, record.extra);
+
+        switch (record.type)
+        {
+        case INPUT_LOG_NIGHT:
+            inputs.night = record.value;
+            quiet = false;
+            break;
+
+        case INPUT_LOG_PREEMPT:
+            inputs.preempt = record.value;
+            quiet = false;
+            if (inputs.preempt)
+            {
+                preempt_pending = true;
+                preempt_ms = record.ms;
+            }
+            break;
+
+        case INPUT_LOG_DEMAND:
+            inputs.demand = record.value;
+            quiet = false;
+            break;
+
+        case INPUT_LOG_DURATION:
+            if (record.value < NUM_PHASES)
+                phase_duration_ms[record.value] = record.extra;
+            quiet = false;
+            break;
+
+        case INPUT_LOG_SHIFT:
+            intersections_shift(&ctl, control.main, record.extra);
+            quiet = false;
+            break;
+
+        case INPUT_LOG_TICK:
+        {
+            // O FILTRO NO INSTANTE DA VOLTA TEM QUE DAR A PREEMPÇÃO QUE O CONTROLADOR GRAVOU
+            bool was_active = filter.active;
+            if (preempt_filter_update(&filter, record.ms) != inputs.preempt)
+            {
+                if (verbose || diverged == 0)
+                    printf("filtro do detector: %s em %u ms, gravado %s\n", filter.active ? "ativo" : "livre",
+                           record.ms, inputs.preempt ? "ativo" : "livre");
+                diverged++;
+            }
+            if (!was_active && filter.active)
+            {
+                output_pending = true;
+                detector_ms = filter.level_ms;
+            }
+            else if (was_active && !filter.active && output_pending)
+            {
+                output_pending = false;
+                unchanged++;
+            }
+
+            // A MESMA VOLTA DO FIRMWARE, COM AS ENTRADAS GRAVADAS ATÉ AQUI
+            if (control_step(&control, &inputs, record.ms))
+            {
+                bool toggle = ctl.flags[control.main] & INTERSECTION_TOGGLE;
+                timeline_add(&replayed, record.ms, ctl.phase[control.main] | toggle << 3);
+                if (verbose)
+                    printf("%10u ms  -> %s\n", record.ms, phase_name(ctl.phase[control.main]));
+            }
+            break;
+        }
+
+        case INPUT_LOG_PHASE:
+        {
+            timeline_add(&recorded, record.ms, record.value);
+            uint8_t next = record.value & 7;
+
+            // PRIMEIRA SAÍDA ALTERADA DEPOIS DA PREEMPÇÃO CONFIRMADA: A COR DO LED
+            if (led_color(record.value) != led)
+            {
+                led = led_color(record.value);
+                if (output_pending)
+                {
+                    metric_add(&detector_output, record.ms - detector_ms);
+                    output_pending = false;
+                }
+            }
+
+            // FASE COMPLETA QUE TERMINOU PELO CICLO NORMAL: PRECISÃO E TOQUES
+            bool natural = (phase == GREEN_LIGHT && next == YELLOW_LIGHT) ||
+                           (phase == YELLOW_LIGHT && next == RED_LIGHT) || (phase == RED_LIGHT && next == GREEN_LIGHT);
+            if (open && natural)
+            {
+                int32_t error = (int32_t)(record.ms - phase_start - nominal);
+                if (quiet)
+                    metric_add(&phase_error, error < 0 ? -error : error);
+                if (phase != YELLOW_LIGHT && !muted_during && beeps != 1)
+                {
+                    printf("toque: %s em %u ms com %u toques\n", phase_name(phase), phase_start, beeps);
+                    anomalies++;
+                }
+            }
+
+            if (button_pending)
+            {
+                metric_add(&button_phase, record.ms - button_ms);
+                button_pending = false;
+            }
+            if (preempt_pending && next == PREEMPT_MODE)
+            {
+                metric_add(&preempt_phase, record.ms - preempt_ms);
+                preempt_pending = false;
+            }
+
+            // O PISCA DO MODO NOTURNO NÃO COMEÇA OUTRA FASE
+            if (!open || next != phase)
+            {
+                open = next < NUM_PHASES;
+                phase = next;
+                phase_start = record.ms;
+                nominal = next < NUM_PHASES ? phase_duration_ms[next] : 0;
+                // SÓ UMA FASE QUE COMEÇOU PELO CICLO NORMAL TEM A DURAÇÃO NOMINAL (A SAÍDA DO NOTURNO SEGUE O CICLO ANTIGO)
+                quiet = natural && !inputs.night && !inputs.preempt && !inputs.demand;
+                muted_during = muted;
+                beeps = 0;
+            }
+            break;
+        }
+
+        case INPUT_LOG_EDGE:
+        {
+            uint8_t button = record.value & 1;
+            // BORDA DENTRO DO DEBOUNCE DEPOIS DE UM NÍVEL LIDO: A TASK DOS BOTÕES DESCARTA
+            if (level_seen && (int32_t)(record.ms - level_ms) <= DEBOUNCE_MS)
+                dropped++;
+            else if (!edge_pending[button])
+            {
+                edge_pending[button] = true;
+                edge_ms[button] = record.ms;
+            }
+            break;
+        }
+
+        case INPUT_LOG_LEVEL:
+        {
+            uint8_t button = record.value >> 1 & 1;
+            bool pressed = record.value & 1;
+            if (edge_pending[button])
+                metric_add(&edge_level, record.ms - edge_ms[button]);
+            edge_pending[button] = false;
+
+            // BORDA DO OUTRO BOTÃO DURANTE O REPIQUE: A TASK JÁ ESTAVA ACORDADA E DESCARTA
+            uint8_t other = !button;
+            if (edge_pending[other] && (int32_t)(edge_ms[other] - (record.ms - BUTTON_SETTLE_MS)) > 0)
+            {
+                edge_pending[other] = false;
+                dropped++;
+            }
+            level_seen = true;
+            level_ms = record.ms;
+            if (!pressed)
+                released++;
+            if (button == 0 && pressed)
+            {
+                button_pending = true;
+                button_ms = record.ms;
+            }
+            break;
+        }
+
+        case INPUT_LOG_BEEP:
+            if (open && record.value == phase)
+                beeps++;
+            // OU O PRIMEIRO TOQUE DA SIRENE (DO VERMELHO PARA A EMERGÊNCIA O LED NÃO MUDA)
+            if (record.value == PREEMPT_MODE && output_pending)
+            {
+                metric_add(&detector_output, record.ms - detector_ms);
+                output_pending = false;
+            }
+            break;
+
+        case INPUT_LOG_DETECTOR:
+            // NÍVEL QUE VOLTA ANTES DE ASSENTAR: PULSO FALSO (LIVRE) OU QUEDA (PREEMPÇÃO ATIVA) QUE O FILTRO SEGUROU
+            if (record.value != filter.level && record.value == filter.active &&
+                record.ms - filter.level_ms < PREEMPT_SETTLE_MS)
+            {
+                if (filter.active)
+                    dropouts++;
+                else
+                    glitches++;
+            }
+            preempt_filter_edge(&filter, record.value, record.ms);
+            break;
+
+        case INPUT_LOG_MUTE:
+            muted = record.value;
+            muted_during = true;
+            break;
+        }
+    }
+
+    // COMPARAÇÃO BYTE A BYTE DAS LINHAS DO TEMPO RECODIFICADAS
+    size_t size = (recorded.count > replayed.count ? recorded.count : replayed.count) * INPUT_LOG_RECORD_MAX + 1;
+    uint8_t *expected = malloc(size), *actual = malloc(size);
+    size_t expected_len = timeline_encode(&recorded, snapshot.now_ms, expected, size);
+    size_t actual_len = timeline_encode(&replayed, snapshot.now_ms, actual, size);
+    bool identical = expected_len == actual_len && memcmp(expected, actual, expected_len) == 0;
+
+    if (reader.pos < reader.len)
+        printf("registro cortado no byte %zu de %zu\n", reader.pos, reader.len);
+
+    if (!identical)
+    {
+        uint32_t i = 0;
+        while (i < recorded.count && i < replayed.count && i < MAX_PHASES &&
+               recorded.events[i].ms == replayed.events[i].ms && recorded.events[i].value == replayed.events[i].value)
+            i++;
+        printf("DIVERGENCIA na fase %u:\n", i);
+        print_event("gravada", &recorded, i);
+        print_event("reproduzida", &replayed, i);
+    }
+
+    printf("%u registros, %u fases gravadas, %u reproduzidas: %s (%zu bytes)\n", records, recorded.count,
+           replayed.count, identical ? "identicas" : "diferentes", expected_len);
+    printf("%u bordas descartadas no debounce, %u toques soltos antes do repique, %u toques errados do buzzer\n",
+           dropped, released, anomalies);
+    printf("detector: %u pulsos falsos e %u quedas filtrados, %u preempcoes sem saida alterada, %u voltas com o "
+           "filtro divergente\n",
+           glitches, dropouts, unchanged, diverged);
+
+    printf("\nmetrica,amostras,media_ms,max_ms\n");
+    metric_print("erro_da_fase", &phase_error);
+    metric_print("borda_ate_nivel", &edge_level);
+    metric_print("botao_ate_fase", &button_phase);
+    metric_print("preempcao_ate_emergencia", &preempt_phase);
+    metric_print("deteccao_ate_saida", &detector_output);
+
+    free(expected);
+    free(actual);
+    free(data);
+    return identical && anomalies == 0 && diverged == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "gerar") == 0)
+        return generate(argc >= 3 ? atoi(argv[2]) : 300, argc >= 4 ? strtoul(argv[3], NULL, 0) : 1);
+    if (argc >= 2)
+        return replay(argv[1], argc >= 3 && strcmp(argv[2], "-v") == 0);
+
+    fprintf(stderr, "uso: %s gerar [segundos] [semente] > entradas.hex | %s <entradas.hex|-> [-v]\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Cliente do terminal de comandos do semáforo (lib/shell.c).
+
+Abre a porta da placa (USB CDC, por exemplo /dev/ttyACM0) ou o pseudo-terminal de
+tools/shell_host.c, envia cada comando e mostra a resposta até "ok" ou "erro: ...".
+Sem comandos, lê os comandos da entrada padrão. Com --eventos liga o acompanhamento
+e mostra os eventos ao vivo até Ctrl+C.
+
+Uso: shell.py /dev/ttyACM0 estado "fase verde 4000" "stats escalonamento"
+     shell.py /dev/ttyACM0 registro > registro.hex   (depois: phase_log.py decode registro.hex)
+     shell.py /dev/ttyACM0 entradas > entradas.hex   (depois: replay_host entradas.hex)
+     shell.py /dev/ttyACM0 --eventos
+"""
+
+import argparse
+import os
+import select
+import sys
+import termios
+import tty
+
+
+class Terminal:
+    def __init__(self, path, timeout):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.timeout = timeout
+        self.pending = b""
+
+    def send(self, line):
+        os.write(self.fd, line.encode("utf-8") + b"\n")
+
+    def read_line(self, timeout):
+        while b"\n" not in self.pending:
+            ready, _, _ = select.select([self.fd], [], [], timeout)
+            if not ready:
+                return None
+            self.pending += os.read(self.fd, 256)
+        line, self.pending = self.pending.split(b"\n", 1)
+        return line.rstrip(b"\r").decode("utf-8", "replace")
+
+    def command(self, line, out):
+        # as linhas da resposta vão para out; o status ("ok" ou "erro: ...") volta para quem chamou
+        self.send(line)
+        while True:
+            reply = self.read_line(self.timeout)
+            if reply is None:
+                return "erro: sem resposta"
+            if reply == "ok" or reply.startswith("erro:"):
+                return reply
+            if not reply.startswith("ev "):
+                print(reply, file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="cliente do terminal de comandos do semáforo")
+    parser.add_argument("port", help="porta da placa ou pseudo-terminal de shell_host")
+    parser.add_argument("commands", nargs="*", help="comandos (sem comandos, lê da entrada padrão)")
+    parser.add_argument("--eventos", action="store_true", help="mostra os eventos ao vivo")
+    parser.add_argument("--timeout", type=float, default=2.0, help="espera máxima por resposta (s)")
+    args = parser.parse_args()
+
+    try:
+        terminal = Terminal(args.port, args.timeout)
+    except OSError as error:
+        print("shell: %s" % error, file=sys.stderr)
+        return 1
+
+    failed = False
+    commands = args.commands or (line.strip() for line in sys.stdin)
+    for line in commands:
+        if not line:
+            continue
+        status = terminal.command(line, sys.stdout)
+        if status != "ok":
+            print("%s: %s" % (line, status), file=sys.stderr)
+            failed = True
+
+    if args.eventos:
+        if terminal.command("eventos sim", sys.stdout) != "ok":
+            return 1
+        try:
+            while True:
+                event = terminal.read_line(None)
+                if event and event.startswith("ev "):
+                    print(event[3:], flush=True)
+        except KeyboardInterrupt:
+            terminal.command("eventos nao", sys.stdout)
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,139 @@
+/*
+    terminal de comandos (lib/shell.c) rodando no computador em um pseudo-terminal
+
+    serve para testar o analisador e o formato das respostas sem a placa: os comandos
+    que mexem no semáforo agem sobre um estado simulado com os mesmos nomes do firmware
+
+    cc -Ilib -o shell_host tools/shell_host.c lib/shell.c
+    ./shell_host                      (mostra o caminho do pseudo-terminal)
+    tools/shell.py <caminho> estado "fase verde 4000" fase
+*/
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "shell.h"
+
+static int terminal;
+static shell_t shell;
+
+static const char *const phase_names[] = {"verde", "amarelo", "vermelho"};
+static const char *const on_off[] = {"nao", "sim"};
+static uint32_t phase_duration_ms[] = {3000, 1500, 4000};
+static bool night;
+static bool mute;
+
+static void host_write(const char *data, size_t len)
+{
+    while (len)
+    {
+        ssize_t sent = write(terminal, data, len);
+        if (sent <= 0)
+            return;
+        data += sent;
+        len -= sent;
+    }
+}
+
+static bool host_state(shell_t *sh, int argc, char **argv)
+{
+    (void)argc;
+    (void)argv;
+
+    shell_puts(sh, night ? "modo noturno\n" : "modo normal\n");
+    shell_puts(sh, "mudo ");
+    shell_puts(sh, on_off[mute]);
+    shell_write(sh, "\n", 1);
+    return true;
+}
+
+static bool host_phase(shell_t *sh, int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            shell_puts(sh, phase_names[i]);
+            shell_write(sh, " ", 1);
+            shell_u32(sh, phase_duration_ms[i]);
+            shell_write(sh, "\n", 1);
+        }
+        return true;
+    }
+
+    int phase = shell_match(argv[1], phase_names, 3);
+    uint32_t ms;
+    if (phase < 0 || argc != 3 || !shell_parse_u32(argv[2], &ms) || ms < 500 || ms > 60000)
+        return false;
+
+    phase_duration_ms[phase] = ms;
+    return true;
+}
+
+static bool host_mode(shell_t *sh, int argc, char **argv)
+{
+    (void)sh;
+
+    static const char *const modes[] = {"normal", "noturno"};
+    int mode = argc == 2 ? shell_match(argv[1], modes, 2) : -1;
+    if (mode < 0)
+        return false;
+    night = mode;
+    return true;
+}
+
+static bool host_mute(shell_t *sh, int argc, char **argv)
+{
+    (void)sh;
+
+    int value = argc == 2 ? shell_match(argv[1], on_off, 2) : -1;
+    if (value < 0)
+        return false;
+    mute = value;
+    return true;
+}
+
+static const shell_command_t host_commands[] = {
+    {"ajuda", "ajuda", shell_help},
+    {"estado", "estado", host_state},
+    {"fase", "fase [verde|amarelo|vermelho <500-60000 ms>]", host_phase},
+    {"modo", "modo normal|noturno", host_mode},
+    {"mudo", "mudo sim|nao", host_mute}};
+
+int main(void)
+{
+    terminal = posix_openpt(O_RDWR | O_NOCTTY);
+    if (terminal < 0 || grantpt(terminal) < 0 || unlockpt(terminal) < 0)
+    {
+        perror("shell_host");
+        return 1;
+    }
+
+    // SEM ECO E SEM TRADUÇÃO DE FIM DE LINHA, COMO O CDC DA PLACA
+    struct termios mode;
+    tcgetattr(terminal, &mode);
+    cfmakeraw(&mode);
+    tcsetattr(terminal, TCSANOW, &mode);
+
+    printf("%s\n", ptsname(terminal));
+    fflush(stdout);
+
+    shell_init(&shell, host_commands, sizeof(host_commands) / sizeof(host_commands[0]), host_write);
+
+    char input[64];
+    ssize_t length;
+    while ((length = read(terminal, input, sizeof(input))) != 0)
+    {
+        // SEM NINGUÉM DO OUTRO LADO O read FALHA: ESPERA O CLIENTE ABRIR DE NOVO
+        if (length < 0)
+        {
+            usleep(100000);
+            continue;
+        }
+        shell_input(&shell, input, length);
+    }
+    return 0;
+}
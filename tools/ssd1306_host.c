@@ -0,0 +1,263 @@
+/*
+    envio do framebuffer do SSD1306 (lib/ssd1306.c) para um I2C falso no computador
+
+    usa os cabeçalhos de bench/host no lugar do SDK; i2c_write_blocking conta as transações,
+    as condições de START e STOP e os bytes no barramento (com o byte de endereço) e entrega
+    os bytes a um controlador SSD1306 emulado: bytes de controle (Co, D/C), comandos com os
+    seus argumentos, janela de colunas e páginas e o endereçamento vertical. depois de cada
+    caso a memória do painel emulado é comparada com o ram_buffer
+
+    um caso com falha aceita só parte dos bytes (NAK no meio da transação: o SDK manda STOP
+    e retorna PICO_ERROR_GENERIC) e confere que os NOPs depois da falha e o envio seguinte do
+    quadro inteiro, como faz o servidor do display, deixam a tela certa. faixas de colunas
+    inválidas têm que ser recusadas sem tocar no barramento. saída em CSV; termina
+    com erro se alguma tela ficar diferente ou se a contagem de transações não for a esperada
+
+    tools/font_compiler.py -o build assets/font.txt
+    cc -O2 -Ibench/host -Ilib -o ssd1306_host tools/ssd1306_host.c lib/ssd1306.c lib/blit.c build/font.c -lm
+    ./ssd1306_host
+*/
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306.h"
+
+#define NO_FAILURE SIZE_MAX
+
+// barramento: contadores e a falha pedida para a próxima transação
+static struct
+{
+    uint32_t transactions, starts, stops, bytes;
+    size_t fail_after; // bytes aceitos antes do NAK (NO_FAILURE = sem falha)
+} bus = {.fail_after = NO_FAILURE};
+
+// controlador emulado: só o que muda onde a imagem é gravada
+static struct
+{
+    uint8_t gddram[HEIGHT / 8][WIDTH];
+    uint8_t mode; // SET_MEM_ADDR: 0 horizontal, 1 vertical, 2 página
+    uint8_t col_start, col_end, page_start, page_end, col, page;
+    uint8_t command, args[6], arg_count, args_needed;
+} panel = {.mode = 2, .col_end = WIDTH - 1, .page_end = HEIGHT / 8 - 1};
+
+static uint8_t command_args(uint8_t command)
+{
+    switch (command)
+    {
+    case SET_COL_ADDR:
+    case SET_PAGE_ADDR:
+        return 2;
+    case SET_SCROLL_RIGHT:
+    case SET_SCROLL_LEFT:
+        return 6;
+    case SET_MEM_ADDR:
+    case SET_CONTRAST:
+    case SET_MUX_RATIO:
+    case SET_DISP_OFFSET:
+    case SET_COM_PIN_CFG:
+    case SET_DISP_CLK_DIV:
+    case SET_PRECHARGE:
+    case SET_VCOM_DESEL:
+    case SET_CHARGE_PUMP:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void panel_command(uint8_t byte)
+{
+    if (panel.args_needed == 0)
+    {
+        panel.command = byte;
+        panel.arg_count = 0;
+        panel.args_needed = command_args(byte);
+        return;
+    }
+
+    panel.args[panel.arg_count++] = byte;
+    if (panel.arg_count < panel.args_needed)
+        return;
+    panel.args_needed = 0;
+
+    switch (panel.command)
+    {
+    case SET_MEM_ADDR:
+        panel.mode = panel.args[0] & 3;
+        break;
+    case SET_COL_ADDR:
+        panel.col = panel.col_start = panel.args[0] & (WIDTH - 1);
+        panel.col_end = panel.args[1] & (WIDTH - 1);
+        break;
+    case SET_PAGE_ADDR:
+        panel.page = panel.page_start = panel.args[0] & (HEIGHT / 8 - 1);
+        panel.page_end = panel.args[1] & (HEIGHT / 8 - 1);
+        break;
+    default:
+        break;
+    }
+}
+
+static void panel_data(uint8_t byte)
+{
+    panel.gddram[panel.page][panel.col] = byte;
+
+    // VERTICAL: DESCE AS PÁGINAS E PASSA PARA A PRÓXIMA COLUNA; HORIZONTAL: O CONTRÁRIO
+    if (panel.mode == 1)
+    {
+        if (panel.page++ >= panel.page_end)
+        {
+            panel.page = panel.page_start;
+            panel.col = panel.col >= panel.col_end ? panel.col_start : panel.col + 1;
+        }
+    }
+    else if (panel.col++ >= panel.col_end)
+    {
+        panel.col = panel.col_start;
+        if (panel.mode == 0)
+            panel.page = panel.page >= panel.page_end ? panel.page_start : panel.page + 1;
+    }
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    enum { CONTROL, COMMAND_ONE, DATA_ONE, COMMANDS, DATA } state = CONTROL;
+    size_t accepted = len < bus.fail_after ? len : bus.fail_after;
+    (void)i2c;
+    (void)addr;
+
+    bus.transactions++;
+    bus.starts++;
+    bus.bytes += 1 + accepted;
+    bus.fail_after = NO_FAILURE;
+
+    // CADA START COMEÇA COM UM BYTE DE CONTROLE: Co = 1 VALE PARA UM BYTE, Co = 0 PARA O RESTO
+    for (size_t i = 0; i < accepted; i++)
+    {
+        uint8_t byte = src[i];
+        switch (state)
+        {
+        case CONTROL:
+            state = byte & 0x80 ? (byte & 0x40 ? DATA_ONE : COMMAND_ONE) : (byte & 0x40 ? DATA : COMMANDS);
+            break;
+        case COMMAND_ONE:
+            panel_command(byte);
+            state = CONTROL;
+            break;
+        case DATA_ONE:
+            panel_data(byte);
+            state = CONTROL;
+            break;
+        case COMMANDS:
+            panel_command(byte);
+            break;
+        case DATA:
+            panel_data(byte);
+            break;
+        }
+    }
+
+    // NAK: O SDK ENCERRA COM STOP MESMO COM nostop
+    if (accepted < len)
+    {
+        bus.stops++;
+        return PICO_ERROR_GENERIC;
+    }
+    if (!nostop)
+        bus.stops++;
+    return len;
+}
+
+void sleep_ms(uint32_t ms)
+{
+    (void)ms;
+}
+
+static ssd1306_t ssd;
+static int failures;
+
+// a memória do painel emulado tem que ser o ram_buffer (colunas de páginas, depois do byte de controle)
+static bool screen_ok(void)
+{
+    for (uint8_t page = 0; page < ssd.pages; page++)
+    {
+        for (uint8_t x = 0; x < ssd.width; x++)
+        {
+            if (panel.gddram[page][x] != ssd.ram_buffer[1 + x * ssd.pages + page])
+                return false;
+        }
+    }
+    return true;
+}
+
+// transactions: as esperadas (um envio é uma transação; uma falha soma a dos NOPs)
+static void report(const char *name, uint32_t transactions, bool sent)
+{
+    bool ok = screen_ok();
+    printf("%s,%u,%u,%u,%u,%u,%s,%s\n", name, transactions, bus.transactions, bus.starts, bus.stops, bus.bytes,
+           sent ? "sim" : "nao", ok ? "sim" : "NAO");
+    if (!ok || !sent || bus.transactions != transactions || bus.starts != bus.stops)
+        failures++;
+    bus.transactions = bus.starts = bus.stops = bus.bytes = 0;
+}
+
+// muda alguns pixels de cada coluna de x0 a x1
+static void scribble(uint8_t x0, uint8_t x1, uint32_t seed)
+{
+    for (uint8_t x = x0; x <= x1; x++)
+        ssd1306_pixel(&ssd, x, (x * 7 + seed) % HEIGHT, true);
+}
+
+int main(void)
+{
+    bool sent;
+
+    printf("caso,transacoes_esperadas,transacoes,starts,stops,bytes,aceito,tela_ok\n");
+
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+    bus.transactions = bus.starts = bus.stops = bus.bytes = 0;
+
+    ssd1306_draw_string(&ssd, "ATENCAO!", 0, 0);
+    sent = ssd1306_send_data(&ssd);
+    report("quadro_inteiro", 1, sent);
+
+    scribble(10, 40, 1);
+    sent = ssd1306_send_columns(&ssd, 10, 40);
+    report("colunas_10_40", 1, sent);
+
+    scribble(0, WIDTH - 1, 2);
+    sent = ssd1306_send_data(&ssd);
+    report("quadro_depois_das_colunas", 1, sent);
+
+    // NAK NA JANELA: O PAINEL FICA NO MEIO DE SET_COL_ADDR; OS NOPS E O QUADRO INTEIRO SEGUINTE O REFAZEM
+    scribble(50, 90, 3);
+    bus.fail_after = 5;
+    sent = ssd1306_send_columns(&ssd, 50, 90);
+    sent = !sent && ssd1306_send_data(&ssd);
+    report("falha_na_janela_e_quadro", 3, sent);
+
+    // NAK NO MEIO DA IMAGEM DE UM ENVIO PARCIAL E DEPOIS UM PARCIAL EM OUTRO LUGAR
+    scribble(20, 100, 4);
+    bus.fail_after = 200;
+    sent = ssd1306_send_columns(&ssd, 20, 100);
+    sent = !sent && ssd1306_send_data(&ssd);
+    scribble(0, 5, 5);
+    sent = sent && ssd1306_send_columns(&ssd, 0, 5);
+    report("falha_na_imagem_e_parcial", 4, sent);
+
+    // FAIXAS INVÁLIDAS: RECUSADAS SEM NENHUMA TRANSAÇÃO; x1 ALÉM DA TELA É LIMITADO À ÚLTIMA COLUNA
+    scribble(WIDTH - 8, WIDTH - 1, 6);
+    sent = !ssd1306_send_columns(&ssd, WIDTH, WIDTH + 10);
+    sent = sent && !ssd1306_send_columns(&ssd, 40, 39);
+    sent = sent && ssd1306_send_columns(&ssd, WIDTH - 8, 255);
+    report("faixas_invalidas_e_x1_limitado", 1, sent);
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        scribble(0, WIDTH - 1, i);
+        sent = ssd1306_send_data(&ssd);
+    }
+    report("quadros_seguidos", 100, sent);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,393 @@
+/*
+    injeção de falhas no supervisor (lib/supervisor.c) e na recuperação pelo watchdog, no computador
+
+    simula em passos de 1ms as tasks críticas do firmware com os mesmos prazos do main, a
+    task do supervisor, o watchdog e os registradores de rascunho que sobrevivem ao reset
+    dele, usando o controlador de cruzamentos de verdade (lib/intersections.c). cada
+    cenário trava uma task (ou nenhuma) e confere:
+
+    - se a placa reinicia, e em quanto tempo (no máximo prazo da task + verificação + watchdog);
+    - se o boot seguinte continua a mesma fase, o modo e o buzzer, ou começa frio no verde;
+    - se a sequência de fases vista na rua continua válida (nunca amarelo -> verde);
+    - se a placa para de reiniciar quando a mesma falha volta a cada boot
+
+    cc -Ilib -o supervisor_host tools/supervisor_host.c lib/supervisor.c lib/intersections.c
+    ./supervisor_host
+*/
+#include <stdio.h>
+#include <string.h>
+#include "supervisor.h"
+#include "intersections.h"
+
+// OS MESMOS DE lib/recovery.h
+#define WATCHDOG_MS 2000
+#define PERIOD_MS 500
+#define STABLE_MS 60000
+
+#define BOOT_MS 5             // reset -> primeira volta do controlador (estado seguro em vermelho)
+#define QUEUE_FULL_MS 300     // servidor do display parado até a fila encher e prender quem desenha
+#define NONE -1
+
+// tasks críticas na ordem de registro do main (sem o motor de saídas)
+enum
+{
+    CONTROLLER,
+    LED,
+    MATRIX,
+    DISPLAY,
+    BUZZER,
+    BUTTONS,
+    DISPLAY_SERVER,
+    TASKS
+};
+
+static const char *const task_names[TASKS] = {"controlador", "led", "matriz", "display", "buzzer", "botoes", "servidor display"};
+static const uint32_t task_timeouts[TASKS] = {2000, 2000, 2000, 2000, 3000, 1000, 2000};
+static const char *const phase_names[NUM_PHASES] = {"verde", "amarelo", "vermelho", "noturno", "emergencia"};
+
+typedef struct
+{
+    const char *name;
+    uint32_t duration_ms;
+    int hang_task;        // task que trava em hang_at_ms (tempo total), ou NONE
+    uint32_t hang_at_ms;
+    bool hang_on_yellow;  // espera o próximo amarelo depois de hang_at_ms para travar
+    int hang_every_boot;  // task que trava hang_at_ms depois de cada boot, ou NONE
+    uint32_t night_at_ms; // toque no botão A (0 = nunca)
+    uint32_t mute_at_ms;  // toque no botão B (0 = nunca)
+    bool corrupt;         // um bit do rascunho muda durante o reset
+    uint32_t power_at_ms; // a placa é desligada e religada (0 = nunca)
+    int resets;           // resets pelo watchdog esperados
+    int resumed;          // boots que continuam o estado esperados
+} scenario_t;
+
+// placa simulada: estado de um boot
+typedef struct
+{
+    intersections_t ctl;
+    uint32_t t; // ms desde o boot
+    uint8_t light;
+    bool night, muted;
+    uint16_t saved_remaining; // tempo restante na última volta do controlador
+    uint32_t next[TASKS]; // próximo despertar periódico
+    bool event[TASKS];    // notificação pendente
+    bool hung[TASKS];
+    uint32_t server_hung_at;
+    uint8_t failed, resets, ignored;
+    uint32_t wd;          // prazo do watchdog
+    uint32_t healthy_since;
+} board_t;
+
+// registradores de rascunho do watchdog (sobrevivem ao reset dele)
+static uint32_t scratch[SUPERVISOR_SCRATCH_WORDS];
+
+// como lib/recovery.c: o supervisor reempacota o último estado salvo pelo controlador
+static void scratch_save(board_t *b)
+{
+    supervisor_state_t state = {
+        .phase = b->light,
+        .night = b->night,
+        .muted = b->muted,
+        .failed = b->failed,
+        .resets = b->resets,
+        .ignored = b->ignored,
+        .remaining_ms = b->saved_remaining};
+    supervisor_pack(&state, scratch);
+}
+
+// boot da placa: o main lê o rascunho e registra as tasks, o controlador retoma a fase
+static bool board_boot(board_t *b, bool watchdog_reset, supervisor_state_t *state)
+{
+    bool resume = supervisor_resume(scratch, watchdog_reset, state);
+
+    memset(b, 0, sizeof(*b));
+    b->failed = SUPERVISOR_NONE;
+    b->resets = state->resets;
+    b->ignored = state->ignored;
+    b->light = GREEN_LIGHT;
+    if (resume)
+    {
+        b->night = state->night;
+        b->muted = state->muted;
+    }
+
+    supervisor_init();
+    for (int i = 0; i < TASKS; i++)
+        supervisor_register(task_names[i], task_timeouts[i], 0);
+    for (int i = 0; i < TASKS; i++)
+    {
+        if (b->ignored & (1u << i))
+            supervisor_ignore(i);
+    }
+
+    intersections_init(&b->ctl, 0);
+    intersections_add(&b->ctl, 0);
+    if (resume)
+        intersections_restore(&b->ctl, 0, state->phase, state->remaining_ms);
+
+    // TODAS AS TASKS RODAM UMA VEZ NO INÍCIO DO ESCALONADOR (AS DE EVENTO SE DECLARAM PARADAS)
+    for (int i = 0; i < TASKS; i++)
+        b->event[i] = true;
+    b->wd = WATCHDOG_MS;
+    return resume;
+}
+
+// a task fica presa no meio de um job: acordou (avisou) e não volta a esperar
+static void hang(board_t *b, int task)
+{
+    if (b->hung[task])
+        return;
+    supervisor_checkin(task, b->t);
+    b->hung[task] = true;
+    if (task == DISPLAY_SERVER)
+        b->server_hung_at = b->t;
+}
+
+// acorda a task no período (period > 0) ou na notificação; retorna true se ela rodou
+static bool task_wake(board_t *b, int task, uint32_t period)
+{
+    if (b->hung[task])
+        return false;
+    bool due = period && (int32_t)(b->t - b->next[task]) >= 0;
+    if (!due && !b->event[task])
+        return false;
+
+    b->event[task] = false;
+    b->next[task] = b->t + period;
+    supervisor_checkin(task, b->t);
+    return true;
+}
+
+// depois do job: sem prazo a task só espera o próximo evento
+static void task_wait(board_t *b, int task, uint32_t period)
+{
+    if (!period && !b->hung[task])
+        supervisor_idle(task);
+}
+
+static void board_step(board_t *b)
+{
+    // CONTROLADOR: A CADA 50ms, OU SÓ NO PISCA DO MODO NOTURNO
+    uint32_t period = b->light == NIGHT_MODE ? intersections_next_deadline(&b->ctl) - b->t : WHEEL_TICK_MS;
+    if (task_wake(b, CONTROLLER, period ? period : 1))
+    {
+        intersections_set_night(&b->ctl, 0, b->night);
+        intersections_step(&b->ctl, b->t);
+        if (intersections_take_changed(&b->ctl, 0))
+        {
+            b->light = b->ctl.phase[0];
+            b->event[LED] = b->event[MATRIX] = b->event[DISPLAY] = b->event[BUZZER] = true;
+        }
+        b->saved_remaining = intersections_remaining(&b->ctl, 0, b->t);
+        scratch_save(b);
+    }
+
+    if (task_wake(b, LED, 0))
+        task_wait(b, LED, 0);
+
+    // MATRIZ ANIMADA (BARRA DA CONTAGEM) FORA DO MODO NOTURNO
+    period = b->light == NIGHT_MODE ? 0 : 20;
+    if (task_wake(b, MATRIX, period))
+        task_wait(b, MATRIX, period);
+
+    // DISPLAY: CAMINHADA NO VERDE, DÍGITO A CADA SEGUNDO, PARADO NO MODO NOTURNO
+    period = b->light == GREEN_LIGHT ? 100 : b->light == NIGHT_MODE ? 0 : 1000;
+    if (task_wake(b, DISPLAY, period))
+    {
+        // COM O SERVIDOR PARADO A FILA ENCHE E O PRÓXIMO DESENHO BLOQUEIA
+        if (b->hung[DISPLAY_SERVER] && b->t - b->server_hung_at >= QUEUE_FULL_MS)
+            hang(b, DISPLAY);
+        b->event[DISPLAY_SERVER] = true;
+        task_wait(b, DISPLAY, period);
+    }
+
+    // BUZZER: TOQUES REPETIDOS NO AMARELO, SENÃO SÓ NA MUDANÇA
+    period = b->light == YELLOW_LIGHT && !b->muted ? 250 : 0;
+    if (task_wake(b, BUZZER, period))
+        task_wait(b, BUZZER, period);
+
+    if (task_wake(b, BUTTONS, 0))
+        task_wait(b, BUTTONS, 0);
+
+    if (task_wake(b, DISPLAY_SERVER, 0))
+        task_wait(b, DISPLAY_SERVER, 0);
+
+    // SUPERVISOR: ALIMENTA O WATCHDOG SÓ COM TODAS AS TASKS EM DIA
+    if (b->t % PERIOD_MS == 0)
+    {
+        uint8_t late = supervisor_check(b->t);
+        if (b->failed == SUPERVISOR_NONE && late == SUPERVISOR_NONE)
+        {
+            b->wd = b->t + WATCHDOG_MS;
+            if (b->resets && b->t - b->healthy_since >= STABLE_MS)
+            {
+                b->resets = 0;
+                scratch_save(b);
+            }
+        }
+        else if (b->failed == SUPERVISOR_NONE)
+        {
+            b->failed = late;
+            scratch_save(b);
+        }
+    }
+}
+
+static bool legal_change(uint8_t from, uint8_t to)
+{
+    // O MODO NOTURNO ENTRA E SAI A QUALQUER MOMENTO (BOTÃO A); NO CICLO SÓ VERDE -> AMARELO -> VERMELHO
+    if (from >= NIGHT_MODE || to >= NIGHT_MODE)
+        return true;
+    return to == (from + 1) % NIGHT_MODE;
+}
+
+static bool run(const scenario_t *sc)
+{
+    board_t board, *b = &board;
+    supervisor_state_t state;
+    memset(scratch, 0, sizeof(scratch));
+    board_boot(b, false, &state);
+
+    int resets = 0, resumed = 0, errors = 0;
+    uint32_t worst_detect = 0, hang_at = 0;
+    bool hung_once = false, yellow_armed = false;
+    uint8_t shown = NUM_PHASES;
+    uint8_t expected = NUM_PHASES; // fase da primeira volta do controlador depois do boot
+
+    for (uint32_t g = 0; g < sc->duration_ms; g++, b->t++)
+    {
+        // TOQUES NOS BOTÕES
+        if (sc->night_at_ms && g == sc->night_at_ms)
+        {
+            b->night = !b->night;
+            b->event[BUTTONS] = b->event[CONTROLLER] = true;
+        }
+        if (sc->mute_at_ms && g == sc->mute_at_ms)
+        {
+            b->muted = !b->muted;
+            b->event[BUTTONS] = b->event[BUZZER] = true;
+        }
+
+        // FALHAS INJETADAS
+        if (sc->hang_task != NONE && !hung_once && g >= sc->hang_at_ms)
+        {
+            if (!sc->hang_on_yellow || (yellow_armed && b->light == YELLOW_LIGHT))
+            {
+                hang(b, sc->hang_task);
+                hang_at = g;
+                hung_once = true;
+            }
+            yellow_armed = b->light != YELLOW_LIGHT;
+        }
+        if (sc->hang_every_boot != NONE && b->t == sc->hang_at_ms)
+        {
+            hang(b, sc->hang_every_boot);
+            hang_at = g;
+        }
+
+        board_step(b);
+
+        if (expected != NUM_PHASES)
+        {
+            if (b->light != expected)
+            {
+                printf("  boot em %u ms: controlador em %s, esperado %s\n", (unsigned)g, phase_names[b->light], phase_names[expected]);
+                errors++;
+            }
+            expected = NUM_PHASES;
+        }
+
+        // SEQUÊNCIA DE FASES NA RUA
+        if (b->light != shown)
+        {
+            if (shown != NUM_PHASES && !legal_change(shown, b->light))
+            {
+                printf("  %u ms: troca %s -> %s\n", (unsigned)g, phase_names[shown], phase_names[b->light]);
+                errors++;
+            }
+            shown = b->light;
+        }
+
+        bool power = sc->power_at_ms && g == sc->power_at_ms;
+        if (!power && b->t < b->wd)
+            continue;
+
+        // RESET: O RASCUNHO SOBREVIVE AO WATCHDOG; DESLIGAR A PLACA APAGA
+        uint8_t before = b->light;
+        bool night = b->night, muted = b->muted;
+        if (power)
+            memset(scratch, 0, sizeof(scratch));
+        else
+        {
+            resets++;
+            if (g - hang_at > worst_detect)
+                worst_detect = g - hang_at;
+            uint32_t bound = task_timeouts[b->failed < TASKS ? b->failed : 0] + PERIOD_MS + WATCHDOG_MS;
+            if (b->failed >= TASKS || g - hang_at > bound)
+            {
+                printf("  reset em %u ms: falha %s, %u ms depois do travamento\n", (unsigned)g,
+                       b->failed < TASKS ? task_names[b->failed] : "nenhuma", (unsigned)(g - hang_at));
+                errors++;
+            }
+        }
+        if (sc->corrupt)
+            scratch[2] ^= 1u << 3;
+
+        g += BOOT_MS;
+        bool resume = board_boot(b, !power, &state);
+        b->t = (uint32_t)-1; // o laço avança para o instante 0 do novo boot
+
+        if (resume)
+        {
+            resumed++;
+            expected = before;
+            if (b->night != night || b->muted != muted)
+            {
+                printf("  boot em %u ms: noturno %d e mudo %d, antes noturno %d e mudo %d\n", (unsigned)g, b->night,
+                       b->muted, night, muted);
+                errors++;
+            }
+        }
+        else
+        {
+            // BOOT FRIO: RECOMEÇA NO VERDE, DEPOIS DO VERMELHO SEGURO
+            expected = GREEN_LIGHT;
+            shown = NUM_PHASES;
+        }
+    }
+
+    if (resets != sc->resets || resumed != sc->resumed)
+    {
+        printf("  esperado %d resets e %d boots continuados, aconteceram %d e %d\n", sc->resets, sc->resumed, resets, resumed);
+        errors++;
+    }
+    if (resets && b->resets && b->t >= STABLE_MS + PERIOD_MS)
+    {
+        printf("  %u resets seguidos ainda contados depois de %u ms sem falhas\n", b->resets, (unsigned)b->t);
+        errors++;
+    }
+
+    printf("%-48s resets %d, continuados %d, maior deteccao %5u ms, ignoradas 0x%02x: %s\n", sc->name, resets, resumed,
+           (unsigned)worst_detect, b->ignored, errors ? "FALHOU" : "ok");
+    return errors == 0;
+}
+
+int main(void)
+{
+    static const scenario_t scenarios[] = {
+        {"sem falhas (10 min)", 600000, NONE, 0, false, NONE, 0, 0, false, 0, 0, 0},
+        {"noturno com as tasks esperando eventos", 600000, NONE, 0, false, NONE, 1000, 0, false, 0, 0, 0},
+        {"servidor do display preso no I2C", 120000, DISPLAY_SERVER, 20300, false, NONE, 0, 0, false, 0, 1, 1},
+        {"controlador travado no amarelo", 120000, CONTROLLER, 30000, true, NONE, 0, 0, false, 0, 1, 1},
+        {"buzzer travado no noturno e mudo", 120000, BUZZER, 15000, false, NONE, 1000, 2000, false, 0, 1, 1},
+        {"led travado durante o vermelho", 120000, LED, 41000, false, NONE, 0, 0, false, 0, 1, 1},
+        {"display travado a cada boot", 300000, NONE, 100, false, DISPLAY_SERVER, 0, 0, false, 0, 5, 3},
+        {"rascunho corrompido no reset", 120000, CONTROLLER, 20000, false, NONE, 1000, 0, true, 0, 1, 0},
+        {"placa desligada e religada", 120000, NONE, 0, false, NONE, 1000, 2000, false, 20000, 0, 0},
+    };
+
+    int failed = 0;
+    for (unsigned i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+        failed += !run(&scenarios[i]);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/*
+    publicação dos lotes de telemetria (lib/telemetry_batch.c) a partir do computador
+
+    monta lotes com um ciclo simulado do semáforo usando o mesmo codificador do firmware
+    e publica no broker MQTT (MQTT 3.1.1, QoS 0) pela rede local, para testar o broker,
+    os consumidores e tools/telemetry_stub.py sem a placa
+
+    cc -Ilib -o telemetry_host tools/telemetry_host.c lib/telemetry_batch.c
+    tools/telemetry_stub.py serve --lotes 5 &
+    ./telemetry_host 127.0.0.1 1883 5
+*/
+#define _DEFAULT_SOURCE
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "telemetry_batch.h"
+
+#define HOST_BATCH_SIZE 512
+#define HOST_COUNTERS 9
+#define HOST_TOPIC "semaforo/telemetria"
+
+static const uint32_t phase_ms[] = {3000, 1500, 4000};
+
+static int send_all(int sock, const uint8_t *data, size_t len)
+{
+    while (len)
+    {
+        ssize_t sent = send(sock, data, len, 0);
+        if (sent <= 0)
+            return -1;
+        data += sent;
+        len -= sent;
+    }
+    return 0;
+}
+
+// cabeçalho fixo do MQTT: tipo + tamanho restante em varint
+static size_t mqtt_header(uint8_t *out, uint8_t type, size_t remaining)
+{
+    size_t n = 0;
+    out[n++] = type;
+    do
+    {
+        out[n] = remaining & 0x7F;
+        remaining >>= 7;
+        if (remaining)
+            out[n] |= 0x80;
+        n++;
+    } while (remaining);
+    return n;
+}
+
+static int mqtt_connect(int sock)
+{
+    static const uint8_t body[] = {0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60, 0, 4, 'h', 'o', 's', 't'};
+    uint8_t packet[2 + sizeof(body)];
+    size_t n = mqtt_header(packet, 0x10, sizeof(body));
+    memcpy(packet + n, body, sizeof(body));
+
+    uint8_t ack[4];
+    if (send_all(sock, packet, n + sizeof(body)) < 0 || recv(sock, ack, sizeof(ack), MSG_WAITALL) != sizeof(ack))
+        return -1;
+    return ack[0] == 0x20 && ack[3] == 0 ? 0 : -1;
+}
+
+static int mqtt_publish(int sock, const uint8_t *payload, size_t len)
+{
+    uint8_t head[8];
+    size_t topic = strlen(HOST_TOPIC);
+    size_t n = mqtt_header(head, 0x30, 2 + topic + len);
+    head[n++] = topic >> 8;
+    head[n++] = topic;
+
+    if (send_all(sock, head, n) < 0 || send_all(sock, (const uint8_t *)HOST_TOPIC, topic) < 0)
+        return -1;
+    return send_all(sock, payload, len);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "uso: %s <endereço> <porta> [lotes]\n", argv[0]);
+        return 2;
+    }
+    int batches = argc > 3 ? atoi(argv[3]) : 5;
+
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(atoi(argv[2]))};
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (inet_pton(AF_INET, argv[1], &addr.sin_addr) != 1 || connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        mqtt_connect(sock) < 0)
+    {
+        perror("telemetry_host");
+        return 1;
+    }
+
+    // CICLO NORMAL SIMULADO: UM LOTE A CADA 10s, COM AS TROCAS DE FASE DESSE INTERVALO
+    uint8_t buf[HOST_BATCH_SIZE];
+    uint32_t now = 0, next_change = phase_ms[0];
+    uint8_t phase = 0;
+    for (int seq = 0; seq < batches; seq++)
+    {
+        telemetry_batch_t batch;
+        telemetry_batch_begin(&batch, buf, sizeof(buf), HOST_COUNTERS, 0, seq, now);
+
+        uint32_t end = now + 10000;
+        while (next_change <= end)
+        {
+            phase = (phase + 1) % 3;
+            telemetry_batch_event(&batch, next_change, 0, phase);
+            next_change += phase_ms[phase];
+        }
+        now = end;
+
+        uint32_t counters[HOST_COUNTERS] = {0, 0, (uint32_t)seq * 3, 0, 0, (uint32_t)seq * 100, 0, 0, 950};
+        size_t len = telemetry_batch_finish(&batch, now, counters, HOST_COUNTERS);
+        if (mqtt_publish(sock, buf, len) < 0)
+        {
+            perror("telemetry_host");
+            return 1;
+        }
+        printf("lote %d: %u eventos, %zu bytes\n", seq, batch.events, len);
+    }
+
+    static const uint8_t disconnect[] = {0xE0, 0};
+    send_all(sock, disconnect, sizeof(disconnect));
+    close(sock);
+    return 0;
+}
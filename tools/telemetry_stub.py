@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Broker MQTT mínimo e decodificador dos lotes de telemetria do semáforo (lib/telemetry.c).
+
+    serve       aceita conexões MQTT 3.1.1 (CONNECT, PUBLISH QoS 0, PINGREQ, DISCONNECT),
+                decodifica cada lote CBOR publicado e mostra em JSON. Com --lotes N
+                termina depois de N lotes e confere se a numeração veio sem buracos.
+    fetch URL   busca o último lote no HTTP da placa (http://<ip>/) e mostra em JSON
+
+Uso: telemetry_stub.py serve [--porta 1883] [--lotes 5]
+     telemetry_stub.py fetch http://192.168.0.20/
+"""
+
+import argparse
+import json
+import socket
+import sys
+import urllib.request
+
+PHASES = ["verde", "amarelo", "vermelho", "noturno", "emergencia"]
+EVENTS = [
+    ("fase", PHASES),
+    ("modo", ["normal", "noturno"]),
+    ("botao", ["A", "B"]),
+    ("mudo", ["nao", "sim"]),
+    ("preempcao", ["inativa", "ativa"]),
+    ("detector", ["principal_livre", "principal_ocupada", "transversal_livre", "transversal_ocupada"]),
+]
+# ordem de TELEMETRY_CNT_* em lib/telemetry.h
+COUNTERS = ["eventos_descartados", "lotes_descartados", "registros", "preempcoes", "preempcao_max_us",
+            "quadros_display", "onda_ok", "onda_ruins", "dormindo_permille"]
+
+
+class CborError(Exception):
+    pass
+
+
+def cbor_decode(data, pos=0):
+    # só o que o firmware gera: inteiros sem sinal, textos, listas (também indefinidas) e mapas
+    if pos >= len(data):
+        raise CborError("lote truncado")
+    head = data[pos]
+    major, info = head >> 5, head & 0x1F
+    pos += 1
+    if head == 0x9F:
+        items = []
+        while data[pos] != 0xFF:
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos + 1
+    if info < 24:
+        value = info
+    elif info in (24, 25, 26, 27):
+        size = 1 << (info - 24)
+        value = int.from_bytes(data[pos:pos + size], "big")
+        pos += size
+    else:
+        raise CborError("item 0x%02x não suportado" % head)
+
+    if major == 0:
+        return value, pos
+    if major == 3:
+        return data[pos:pos + value].decode("utf-8"), pos + value
+    if major == 4:
+        items = []
+        for _ in range(value):
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        items = {}
+        for _ in range(value):
+            key, pos = cbor_decode(data, pos)
+            items[key], pos = cbor_decode(data, pos)
+        return items, pos
+    raise CborError("tipo %d não suportado" % major)
+
+
+def describe(payload):
+    batch, _ = cbor_decode(payload)
+    ms = batch["t0"]
+    events = []
+    for delta, kind, value in batch["ev"]:
+        ms += delta
+        name, values = EVENTS[kind] if kind < len(EVENTS) else ("tipo%d" % kind, [])
+        events.append({"ms": ms, name: values[value] if value < len(values) else value})
+    return {
+        "no": batch["no"],
+        "lote": batch["lote"],
+        "t0": batch["t0"],
+        "t": batch["t"],
+        "eventos": events,
+        "contadores": dict(zip(COUNTERS, batch["cnt"])),
+        "bytes": len(payload),
+    }
+
+
+def read_exact(conn, size):
+    data = b""
+    while len(data) < size:
+        chunk = conn.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError("conexão fechada")
+        data += chunk
+    return data
+
+
+def read_packet(conn):
+    kind = read_exact(conn, 1)[0]
+    remaining, shift = 0, 0
+    while True:
+        byte = read_exact(conn, 1)[0]
+        remaining |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return kind, read_exact(conn, remaining)
+
+
+def serve(args):
+    server = socket.create_server(("127.0.0.1", args.porta))
+    print("broker em 127.0.0.1:%d" % args.porta, file=sys.stderr, flush=True)
+    received, expected, gaps = 0, None, 0
+
+    while args.lotes is None or received < args.lotes:
+        conn, _ = server.accept()
+        with conn:
+            try:
+                while args.lotes is None or received < args.lotes:
+                    kind, body = read_packet(conn)
+                    if kind >> 4 == 1:  # CONNECT
+                        conn.sendall(b"\x20\x02\x00\x00")
+                    elif kind >> 4 == 3:  # PUBLISH (QoS 0: tópico + dados)
+                        size = int.from_bytes(body[:2], "big")
+                        batch = describe(body[2 + size:])
+                        batch["topico"] = body[2:2 + size].decode("utf-8")
+                        print(json.dumps(batch, ensure_ascii=False), flush=True)
+                        if expected is not None and batch["lote"] != expected:
+                            gaps += 1
+                        expected = batch["lote"] + 1
+                        received += 1
+                    elif kind >> 4 == 12:  # PINGREQ
+                        conn.sendall(b"\xd0\x00")
+                    elif kind >> 4 == 14:  # DISCONNECT
+                        break
+            except (ConnectionError, CborError, KeyError, ValueError) as error:
+                print("telemetry_stub: %s" % error, file=sys.stderr)
+                gaps += 1
+
+    if gaps:
+        print("telemetry_stub: %d lotes faltando ou inválidos" % gaps, file=sys.stderr)
+    return 1 if gaps else 0
+
+
+def fetch(args):
+    try:
+        with urllib.request.urlopen(args.url, timeout=5) as response:
+            payload = response.read()
+        print(json.dumps(describe(payload), ensure_ascii=False, indent=2))
+    except (OSError, CborError, KeyError) as error:
+        print("telemetry_stub: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="broker mínimo e decodificador da telemetria do semáforo")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    server = commands.add_parser("serve", help="broker MQTT mínimo que decodifica os lotes")
+    server.add_argument("--porta", type=int, default=1883)
+    server.add_argument("--lotes", type=int, help="termina depois de N lotes")
+    server.set_defaults(run=serve)
+
+    client = commands.add_parser("fetch", help="busca o último lote no HTTP da placa")
+    client.add_argument("url")
+    client.set_defaults(run=fetch)
+
+    args = parser.parse_args()
+    return args.run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())